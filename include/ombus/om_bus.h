@@ -24,26 +24,50 @@
  * ============================================================================ */
 
 #define OM_BUS_SHM_MAGIC       0x4F4D4253U  /* "OMBS" */
-#define OM_BUS_SHM_VERSION     1U
+#define OM_BUS_SHM_VERSION     2U   /* Bump on any header, tail or slot layout change */
 #define OM_BUS_HEADER_PAGE     4096U
 #define OM_BUS_SLOT_HEADER_SIZE 24U
-#define OM_BUS_CONSUMER_ALIGN  64U
+#define OM_BUS_SLOT_TS_SIZE     8U   /* TIMESTAMP: publish_ns after the header */
+#define OM_BUS_CONSUMER_ALIGN  128U  /* Tail line + CLAIM member line */
+#define OM_BUS_CLAIM_MAX_MEMBERS 8U  /* CLAIM members per consumer_index */
 #define OM_BUS_DEFAULT_SLOT_SIZE    256U
 #define OM_BUS_DEFAULT_CAPACITY     4096U
 #define OM_BUS_DEFAULT_MAX_CONSUMERS 8U
 
 #define OM_BUS_FLAG_CRC              0x1U  /* Enable CRC32 on publish/poll */
 #define OM_BUS_FLAG_REJECT_REORDER   0x2U  /* Return error on wal_seq < expected */
+#define OM_BUS_FLAG_VARLEN           0x4U  /* Records span contiguous slots */
+#define OM_BUS_FLAG_TIMESTAMP        0x8U  /* Slot header carries publish time */
+#define OM_BUS_FLAG_KNOWN            0xFU  /* Endpoints reject streams with other bits */
+
+#define OM_BUS_SLOT_FLAG_PAD         0x1U  /* Skip marker: wal_seq = slots to ring end */
+
+/* Mapping placement (OmBusStreamConfig.map_flags). Only HUGETLB is strict;
+ * the others are best-effort and OmBusStreamStats reports what took effect. */
+#define OM_BUS_MAP_HUGETLB           0x1U  /* path must be on hugetlbfs (else INIT) */
+#define OM_BUS_MAP_THP               0x2U  /* madvise(MADV_HUGEPAGE) on every mapping */
+#define OM_BUS_MAP_NUMA_LOCAL        0x4U  /* mbind to the creating thread's node */
+#define OM_BUS_MAP_PREFAULT          0x8U  /* populate page tables at create/open */
 
 /* ============================================================================
  * Slot Header (24 bytes) — sits at the start of each ring slot
+ *
+ * With OM_BUS_FLAG_VARLEN a record occupies
+ * ceil((24 + payload_len) / slot_size) contiguous slots and only the first
+ * slot carries a header. A record never wraps: when it would cross the ring
+ * end the producer writes a PAD header covering the remaining slots and
+ * places the record at index 0.
+ *
+ * With OM_BUS_FLAG_TIMESTAMP the header of each record is followed by a
+ * uint64_t publish_ns (CLOCK_MONOTONIC, comparable across processes on the
+ * host), so payloads start at OM_BUS_SLOT_HEADER_SIZE + OM_BUS_SLOT_TS_SIZE.
  * ============================================================================ */
 
 typedef struct OmBusSlotHeader {
     _Atomic uint64_t seq;       /* Monotonic slot sequence; publish fence */
     uint64_t wal_seq;           /* WAL sequence number */
     uint8_t  wal_type;          /* OmWalType enum value */
-    uint8_t  reserved;          /* Alignment padding */
+    uint8_t  slot_flags;        /* OM_BUS_SLOT_FLAG_* (0 for records) */
     uint16_t payload_len;       /* Payload byte count */
     uint32_t crc32;             /* CRC32 of payload bytes */
 } OmBusSlotHeader;
@@ -63,18 +87,29 @@ typedef struct OmBusShmHeader {
     _Atomic uint64_t min_tail;  /* Cached minimum consumer tail */
     _Atomic uint64_t producer_epoch; /* Incremented on each stream_create */
     char stream_name[64];       /* Null-terminated stream name */
-    uint8_t _pad[OM_BUS_HEADER_PAGE - 112];
+    _Atomic uint32_t waiters;   /* Consumers sleeping in om_bus_endpoint_wait */
+    uint32_t map_flags;         /* OM_BUS_MAP_*: endpoints repeat THP/PREFAULT */
+    _Atomic uint64_t head_wal_seq; /* wal_seq of the last record before head */
+    uint8_t _pad[OM_BUS_HEADER_PAGE - 128];
 } OmBusShmHeader;
 
 /* ============================================================================
- * Consumer Tail (64 bytes, cache-line aligned) — one per consumer slot
+ * Consumer Tail (2 x 64 bytes, cache-line aligned) — one per consumer slot
  * ============================================================================ */
 
 typedef struct OmBusConsumerTail {
     _Atomic uint64_t tail;      /* Consumer read position */
     _Atomic uint64_t wal_seq;   /* Last WAL sequence consumed */
-    _Atomic uint64_t last_poll_ns; /* clock_gettime(MONOTONIC) at last poll */
-    uint8_t _pad[40];           /* Pad to 64 bytes (cache line) */
+    _Atomic uint64_t last_poll_ns; /* MONOTONIC_COARSE ns at last commit */
+    _Atomic uint64_t claim;     /* CLAIM group: next unclaimed position */
+    _Atomic uint32_t members;   /* CLAIM group: attached members */
+    uint32_t _reserved0;
+    _Atomic uint64_t lag_ns;    /* TIMESTAMP: publish-to-poll ns, last record at commit */
+    _Atomic uint64_t lag_max_ns; /* TIMESTAMP: worst publish-to-poll ns since open */
+    uint8_t _pad[8];            /* Pad to 64 bytes (cache line) */
+    /* CLAIM group: one entry per attached member. 0 = free, UINT64_MAX =
+     * attached with nothing held, else the held batch's start + 1. */
+    _Atomic uint64_t held[OM_BUS_CLAIM_MAX_MEMBERS];
 } OmBusConsumerTail;
 
 /* ============================================================================
@@ -101,16 +136,36 @@ typedef void (*OmBusBackpressureCb)(uint64_t head, uint64_t min_tail, void *ctx)
 typedef struct OmBusStreamConfig {
     const char *stream_name;    /* SHM object name (e.g., "/om-bus-engine-0") */
     uint32_t    capacity;       /* Ring capacity, power of two (default 4096) */
-    uint32_t    slot_size;      /* Bytes per slot (default 256) */
+    uint32_t    slot_size;      /* Bytes per slot (default 256; VARLEN: multiple of 8) */
     uint32_t    max_consumers;  /* Maximum consumer count (default 8) */
     uint32_t    flags;          /* Feature flags (OM_BUS_FLAG_CRC, etc.) */
     uint64_t    staleness_ns;   /* Consumer staleness threshold (0 = disabled, default 5s) */
     OmBusBackpressureCb backpressure_cb;  /* Optional backpressure callback */
     void       *backpressure_ctx;         /* User context for callback */
+    uint64_t    epoch;          /* producer_epoch to publish (0 = monotonic now);
+                                 * a fan-out child passes its parent's epoch */
+    const char *path;           /* File-backed ring on local disk instead of POSIX
+                                 * SHM (NULL = shm_open(stream_name)) */
+    uint32_t    sync_every;     /* File-backed: msync(MS_SYNC) the written range
+                                 * every N records (0 = page cache only) */
+    uint32_t    map_flags;      /* OM_BUS_MAP_* placement of the mapping */
 } OmBusStreamConfig;
 
 typedef struct OmBusStream OmBusStream;
 
+/* ----------------------------------------------------------------------------
+ * File-backed streams (config.path) — the ring doubles as a short-term journal.
+ *
+ * The same layout is mmap'd from a regular file. Reopening a file whose
+ * geometry (slot_size, capacity, max_consumers, flags) matches recovers it
+ * instead of reinitializing. Slots, consumer tails and producer_epoch are kept,
+ * so attached consumers do not see EPOCH_CHANGED. Head is rolled forward over
+ * every fully published record, and OmBusStreamStats.last_wal_seq tells the
+ * producer where to resume. Without sync_every the journal survives a
+ * producer crash (page cache), with it a host crash up to the last sync.
+ * Destroy syncs and keeps the file.
+ * -------------------------------------------------------------------------- */
+
 /**
  * Create a new SHM stream (producer side).
  * Creates the shared memory file and initializes the ring.
@@ -122,13 +177,16 @@ int om_bus_stream_create(OmBusStream **out, const OmBusStreamConfig *config);
 
 /**
  * Publish a WAL record to the stream.
- * Copies payload into the next ring slot. Blocks (spins) if ring is full.
+ * Copies payload into the next ring slot (or run of slots with
+ * OM_BUS_FLAG_VARLEN). Blocks (spins) if ring is full.
  * @param stream  Stream handle
  * @param wal_seq WAL sequence number
  * @param wal_type OmWalType enum value
  * @param payload Raw WAL record data
  * @param len     Payload byte count
  * @return 0 on success, OM_ERR_BUS_RECORD_TOO_LARGE if len > slot_size - 24
+ *         (- 32 with OM_BUS_FLAG_TIMESTAMP)
+ *         (VARLEN: if the record needs more than capacity / 2 slots)
  */
 int om_bus_stream_publish(OmBusStream *stream, uint64_t wal_seq,
                           uint8_t wal_type, const void *payload, uint16_t len);
@@ -144,13 +202,59 @@ int om_bus_stream_publish(OmBusStream *stream, uint64_t wal_seq,
 int om_bus_stream_publish_batch(OmBusStream *stream, const OmBusRecord *recs,
                                  uint32_t count);
 
+/**
+ * Reserve ring space for one record so the caller can serialize in place.
+ * Blocks (spins) like publish until the ring has room. Nothing is visible
+ * to consumers until om_bus_stream_commit(). Only one reservation may be
+ * outstanding; publish/publish_batch fail with OM_ERR_BUS_RESERVE_STATE
+ * until it is committed.
+ * @param stream  Stream handle
+ * @param len     Exact payload byte count that will be written
+ * @param ptr_out Output: payload area inside the ring (len bytes writable)
+ * @return 0 on success, OM_ERR_BUS_RECORD_TOO_LARGE, OM_ERR_BUS_RESERVE_STATE
+ */
+int om_bus_stream_reserve(OmBusStream *stream, uint16_t len, void **ptr_out);
+
+/**
+ * Commit the outstanding reservation: fill the slot header (CRC computed
+ * over the in-ring payload when OM_BUS_FLAG_CRC is set) and advance head.
+ * @return 0 on success, OM_ERR_BUS_RESERVE_STATE if nothing is reserved
+ */
+int om_bus_stream_commit(OmBusStream *stream, uint64_t wal_seq, uint8_t wal_type);
+
+/**
+ * Reserve space for `count` records in one backpressure check.
+ * @param lens     Payload byte count per record
+ * @param ptrs_out Output: payload area per record
+ * @return 0 on success, OM_ERR_BUS_RECORD_TOO_LARGE if any record is too
+ *         large or the run needs more than capacity slots,
+ *         OM_ERR_BUS_RESERVE_STATE if a reservation is already outstanding
+ */
+int om_bus_stream_reserve_batch(OmBusStream *stream, const uint16_t *lens,
+                                uint32_t count, void **ptrs_out);
+
+/**
+ * Commit a batch reservation with a single head advancement.
+ * @param count Must equal the reserved count
+ * @return 0 on success, OM_ERR_BUS_RESERVE_STATE on count mismatch or
+ *         nothing reserved
+ */
+int om_bus_stream_commit_batch(OmBusStream *stream, const uint64_t *wal_seqs,
+                               const uint8_t *wal_types, uint32_t count);
+
 /**
  * Stream statistics snapshot.
  */
 typedef struct OmBusStreamStats {
     uint64_t records_published;      /* total records published */
-    uint64_t head;                   /* current head position */
-    uint64_t min_tail;               /* current minimum consumer tail */
+    uint64_t last_wal_seq;           /* last published wal_seq (recovered on reopen) */
+    uint64_t head;                   /* current head position (slots) */
+    uint64_t min_tail;               /* current minimum consumer tail (slots) */
+    uint64_t slots_padded;           /* VARLEN: slots skipped at ring end */
+    uint64_t wake_calls;             /* futex wakes issued for sleeping consumers */
+    uint64_t page_size;              /* page size backing the ring (hugetlb/THP
+                                        if they took effect, else base page) */
+    int32_t  numa_node;              /* node the ring is bound to (-1 = none) */
 } OmBusStreamStats;
 
 /**
@@ -159,7 +263,24 @@ typedef struct OmBusStreamStats {
 void om_bus_stream_stats(const OmBusStream *s, OmBusStreamStats *out);
 
 /**
- * Destroy stream and unlink SHM object.
+ * Replace the stream's producer_epoch and wake sleepers. Attached consumers
+ * see OM_ERR_BUS_EPOCH_CHANGED, exactly as after a producer restart. Used by
+ * a fan-out relay to forward an upstream restart (see om_bus_fanout.h).
+ */
+void om_bus_stream_set_epoch(OmBusStream *stream, uint64_t epoch);
+
+/** Current producer_epoch of the stream */
+uint64_t om_bus_stream_epoch(const OmBusStream *stream);
+
+/**
+ * File-backed: msync(MS_SYNC) everything written since the last sync.
+ * No-op for POSIX SHM streams.
+ * @return 0 on success, OM_ERR_BUS_SHM_MAP if msync fails
+ */
+int om_bus_stream_sync(OmBusStream *stream);
+
+/**
+ * Destroy stream and unlink SHM object (file-backed: sync, keep the file).
  * @param stream Stream handle (NULL-safe)
  */
 void om_bus_stream_destroy(OmBusStream *stream);
@@ -168,10 +289,49 @@ void om_bus_stream_destroy(OmBusStream *stream);
  * Endpoint (Consumer) API
  * ============================================================================ */
 
+/* ----------------------------------------------------------------------------
+ * Consumer groups — scale a stateless stage across cores.
+ *
+ * OM_BUS_GROUP_CLAIM: all members open the same consumer_index and share its
+ *   tail line. Each poll/poll_batch claims the next run of ready records from
+ *   the shared claim cursor (CAS — a fixed fetch-add could split a VARLEN
+ *   record). A claimed batch stays valid until the member's next poll, flush,
+ *   wait or close, which releases it without waiting for other members: the
+ *   shared tail the producer sees stops at the oldest batch still held, so
+ *   the group counts as one consumer in min_tail. Up to
+ *   OM_BUS_CLAIM_MAX_MEMBERS members per index. commit_every and gap
+ *   detection do not apply. A member that dies holding a claim stalls the
+ *   group like a dead consumer.
+ *
+ * OM_BUS_GROUP_PARTITION: each member opens its own consumer_index and reads
+ *   every record, but only delivers records where
+ *   partition_fn(rec) % group_members == member_id (default: wal_seq).
+ *   Skipped records count as consumed; gap detection still sees them all.
+ * -------------------------------------------------------------------------- */
+
+#define OM_BUS_GROUP_NONE       0U
+#define OM_BUS_GROUP_CLAIM      1U
+#define OM_BUS_GROUP_PARTITION  2U
+
+/** Partition key for OM_BUS_GROUP_PARTITION (payload points into the ring) */
+typedef uint32_t (*OmBusPartitionFn)(const OmBusRecord *rec, void *ctx);
+
 typedef struct OmBusEndpointConfig {
     const char *stream_name;    /* SHM object name to attach to */
     uint32_t    consumer_index; /* Pre-assigned consumer index */
     bool        zero_copy;      /* If true, payload points into mmap region */
+    uint32_t    commit_every;   /* Publish tail/wal_seq/heartbeat every N records
+                                   (0/1 = every poll). Always flushed on an
+                                   empty poll, wait, and close. */
+    uint32_t    group_mode;     /* OM_BUS_GROUP_* (0 = ordinary consumer) */
+    uint32_t    group_members;  /* PARTITION: member count */
+    uint32_t    member_id;      /* PARTITION: this member, [0, group_members) */
+    OmBusPartitionFn partition_fn; /* PARTITION: key function (NULL = wal_seq) */
+    void       *partition_ctx;  /* User context for partition_fn */
+    const char *path;           /* File-backed stream (NULL = shm_open(stream_name)) */
+    uint64_t    resume_wal_seq; /* Resume after this wal_seq (e.g. from
+                                   om_bus_endpoint_load_cursor) from this
+                                   index's persisted tail; 0 = live head */
 } OmBusEndpointConfig;
 
 typedef struct OmBusEndpoint OmBusEndpoint;
@@ -179,6 +339,13 @@ typedef struct OmBusEndpoint OmBusEndpoint;
 /**
  * Open an endpoint to an existing SHM stream (consumer side).
  * Maps the shared memory file.
+ * Fails with OM_ERR_BUS_VERSION_MISMATCH when the header has another
+ * OM_BUS_SHM_VERSION or flag bits outside OM_BUS_FLAG_KNOWN.
+ * With resume_wal_seq the endpoint starts at this index's persisted tail
+ * (a record boundary) and skips records up to resume_wal_seq, so a restarted
+ * consumer continues without WAL replay. It fails with OM_ERR_BUS_CURSOR_LOST
+ * when the ring has lapped that tail or the tail already moved past
+ * resume_wal_seq; replay from the WAL instead. Not valid for CLAIM groups.
  * @param out    Output endpoint handle
  * @param config Endpoint configuration
  * @return 0 on success, negative on error
@@ -196,27 +363,174 @@ int om_bus_endpoint_poll(OmBusEndpoint *ep, OmBusRecord *rec);
 
 /**
  * Poll up to max_count records in a batch. Non-blocking.
+ * Payload pointers always point into the mmap region (zero-copy).
+ * One head load covers the run, the tail is published once at the end, and
+ * the batch stops before a record that fails its CRC.
  * @param ep        Endpoint handle
  * @param recs      Output record array
  * @param max_count Maximum records to return
  * @return Number of records read (0 = empty), negative on error
+ *         OM_ERR_BUS_CRC_MISMATCH if the first record fails its CRC
  */
 int om_bus_endpoint_poll_batch(OmBusEndpoint *ep, OmBusRecord *recs,
                                size_t max_count);
 
+/**
+ * Batch iterator: poll_batch without the OmBusRecord array. Lives on the
+ * caller's stack; fields are private to the bus.
+ *
+ *   OmBusBatchIter it;
+ *   if (om_bus_endpoint_iter_begin(ep, &it, 256) == 0) {
+ *       OmBusRecord rec;
+ *       while (om_bus_endpoint_iter_next(&it, &rec) == 1) handle(&rec);
+ *       rc = om_bus_endpoint_iter_end(&it);
+ *   }
+ *
+ * Payloads are zero-copy and stay valid until iter_end (with
+ * commit_every > 1, until the commit after it). Not available to CLAIM
+ * group members.
+ */
+typedef struct OmBusBatchIter {
+    OmBusEndpoint *ep;
+    uint64_t tail;          /* next slot position */
+    uint64_t head;          /* head snapshot: slots below it are published */
+    uint64_t last_seq;      /* last record consumed (delivered or skipped) */
+    uint64_t now;           /* TIMESTAMP: clock read once per batch */
+    uint32_t left;          /* records still deliverable */
+    uint32_t seen;          /* records consumed */
+    uint32_t count;         /* records delivered */
+    int      err;           /* CRC mismatch that ended the batch */
+    bool     epoch_checked;
+} OmBusBatchIter;
+
+/**
+ * Start a batch of up to max_count records.
+ * @return 0 on success, OM_ERR_BUS_EPOCH_CHANGED if the producer restarted,
+ *         OM_ERR_BUS_INIT on bad arguments or a CLAIM group endpoint
+ */
+int om_bus_endpoint_iter_begin(OmBusEndpoint *ep, OmBusBatchIter *it,
+                               size_t max_count);
+
+/**
+ * Next record of the batch (zero-copy).
+ * @return 1 if rec was filled, 0 when the batch is done
+ */
+int om_bus_endpoint_iter_next(OmBusBatchIter *it, OmBusRecord *rec);
+
+/**
+ * Finish the batch: publish tail and wal_seq once.
+ * @return Records delivered (0 = empty), negative as for poll_batch
+ */
+int om_bus_endpoint_iter_end(OmBusBatchIter *it);
+
+#define OM_BUS_WAIT_FOREVER UINT64_MAX
+
+/**
+ * Block until a record is available, the timeout expires, or the producer
+ * restarts. Spins briefly first (spin budget adapts to recent arrival
+ * pattern), then sleeps on a futex over the shared head. The producer only
+ * issues a wake syscall while some consumer is sleeping.
+ * Does not consume: call poll / poll_batch after a positive return.
+ * @param ep         Endpoint handle
+ * @param timeout_ns Maximum time to wait (0 = check only, OM_BUS_WAIT_FOREVER)
+ * @return 1 if a record is available, 0 on timeout,
+ *         OM_ERR_BUS_EPOCH_CHANGED if the producer restarted
+ */
+int om_bus_endpoint_wait(OmBusEndpoint *ep, uint64_t timeout_ns);
+
+/**
+ * Publish the local cursor (tail, wal_seq, heartbeat) to the shared consumer
+ * line now. Only needed with commit_every > 1 when the consumer holds records
+ * for long stretches between polls.
+ * @param ep Endpoint handle
+ */
+void om_bus_endpoint_flush(OmBusEndpoint *ep);
+
 /**
  * Get current WAL sequence position for this endpoint.
+ * Reflects local progress even when not yet committed (commit_every > 1).
  * @param ep Endpoint handle
  * @return Last consumed WAL sequence number
  */
 uint64_t om_bus_endpoint_wal_seq(const OmBusEndpoint *ep);
 
+/**
+ * producer_epoch this endpoint attached under (changes only by reopening).
+ */
+uint64_t om_bus_endpoint_epoch(const OmBusEndpoint *ep);
+
 /**
  * Close endpoint and unmap SHM.
  * @param ep Endpoint handle (NULL-safe)
  */
 void om_bus_endpoint_close(OmBusEndpoint *ep);
 
+/* ============================================================================
+ * Latency (OM_BUS_FLAG_TIMESTAMP streams)
+ * ============================================================================ */
+
+#define OM_BUS_LAT_BUCKETS 40U  /* bucket b: [2^b, 2^(b+1)) ns; 0 also holds 0 */
+
+/**
+ * Publish-to-poll latency of the records this endpoint delivered: poll time
+ * minus the slot's publish_ns, in log2 buckets. Local to the endpoint;
+ * the shared lag gauges are in OmBusConsumerTail (see OmBusMonitor).
+ */
+typedef struct OmBusLatencyStats {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint64_t buckets[OM_BUS_LAT_BUCKETS];
+} OmBusLatencyStats;
+
+/**
+ * Snapshot the endpoint's latency histogram (all zero without TIMESTAMP).
+ */
+void om_bus_endpoint_latency(const OmBusEndpoint *ep, OmBusLatencyStats *out);
+
+/**
+ * Latency at quantile q (e.g. 0.99, 0.999): the upper bound of the bucket
+ * holding it, capped at max_ns. 0 if the histogram is empty.
+ */
+uint64_t om_bus_latency_percentile(const OmBusLatencyStats *st, double q);
+
+/* ============================================================================
+ * Monitor — read-only view of the consumer lines, no consumer slot taken
+ * ============================================================================ */
+
+typedef struct OmBusConsumerLag {
+    uint64_t tail;              /* committed read position (slots) */
+    uint64_t lag_slots;         /* head - tail */
+    uint64_t wal_seq;           /* last WAL sequence committed */
+    uint64_t last_poll_ns;      /* heartbeat (MONOTONIC_COARSE), 0 = never */
+    uint64_t lag_ns;            /* TIMESTAMP: last record's publish-to-poll ns */
+    uint64_t lag_max_ns;        /* TIMESTAMP: worst since the consumer opened */
+} OmBusConsumerLag;
+
+typedef struct OmBusMonitor OmBusMonitor;
+
+/**
+ * Map a stream's header and consumer lines read-only.
+ * @param stream_name SHM name, or the path of a file-backed ring (any name
+ *                    with a '/' after the first character)
+ * @return 0 on success, OM_ERR_BUS_SHM_OPEN / _SHM_MAP / _MAGIC_MISMATCH /
+ *         _VERSION_MISMATCH
+ */
+int om_bus_monitor_open(OmBusMonitor **out, const char *stream_name);
+
+/** Number of consumer lines (the stream's max_consumers) */
+uint32_t om_bus_monitor_consumers(const OmBusMonitor *mon);
+
+/**
+ * Read one consumer's gauges.
+ * @return 0 on success, OM_ERR_BUS_CONSUMER_ID if out of range
+ */
+int om_bus_monitor_read(const OmBusMonitor *mon, uint32_t consumer_index,
+                        OmBusConsumerLag *out);
+
+/** Unmap (NULL-safe) */
+void om_bus_monitor_close(OmBusMonitor *mon);
+
 /* ============================================================================
  * Consumer Cursor Persistence
  * ============================================================================ */
@@ -34,6 +34,9 @@ typedef enum OmBusError {
     OM_ERR_BUS_CONSUMER_STALE   = -821, /**< Consumer heartbeat stale */
     OM_ERR_BUS_TCP_SLOW_WARNING = -822, /**< Server warned: slow client, imminent disconnect */
     OM_ERR_BUS_REORDER_DETECTED = -823, /**< WAL sequence went backward */
+    OM_ERR_BUS_RESERVE_STATE    = -824, /**< Reserve/commit called out of order */
+    OM_ERR_BUS_CURSOR_LOST      = -825, /**< Resume cursor no longer in the ring */
+    OM_ERR_BUS_MCAST_SOCKET     = -826, /**< Multicast socket/join failed */
 } OmBusError;
 
 /**
@@ -69,6 +72,9 @@ static inline const char *om_bus_error_string(int err) {
         case OM_ERR_BUS_CONSUMER_STALE:  return "Consumer heartbeat stale";
         case OM_ERR_BUS_TCP_SLOW_WARNING: return "TCP slow client warning";
         case OM_ERR_BUS_REORDER_DETECTED: return "WAL sequence reorder detected";
+        case OM_ERR_BUS_RESERVE_STATE:   return "Reserve/commit out of order";
+        case OM_ERR_BUS_CURSOR_LOST:     return "Resume cursor no longer in ring";
+        case OM_ERR_BUS_MCAST_SOCKET:    return "Multicast socket setup failed";
         default:                         return "Unknown bus error";
     }
 }
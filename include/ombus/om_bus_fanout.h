@@ -0,0 +1,178 @@
+#ifndef OM_BUS_FANOUT_H
+#define OM_BUS_FANOUT_H
+
+/**
+ * @file om_bus_fanout.h
+ * @brief Header-only fan-out relay: one SHM endpoint -> K child SHM streams
+ *
+ * A stream's max_consumers is fixed at create time and every tail is scanned
+ * on the producer's backpressure path. A fan-out relay takes one consumer
+ * slot on the parent and republishes each polled batch into K child streams
+ * with om_bus_stream_publish_batch(), so 40 consumers can hang off 5 children
+ * while the engine only ever sees 5 tails. Children may be parents of further
+ * fan-outs.
+ *
+ * Records pass through unchanged: wal_seq, wal_type and payload bytes are the
+ * parent's, so gap and reorder detection work end to end. The parent's
+ * producer_epoch is forwarded to every child; after an upstream restart
+ * (OM_ERR_BUS_EPOCH_CHANGED) reopen the parent endpoint and keep stepping, and
+ * child consumers see the same EPOCH_CHANGED they would see attached directly.
+ *
+ * Open the parent endpoint with commit_every = OM_BUS_FANOUT_COMMIT_EVERY:
+ * poll_batch hands out zero-copy views, and the parent tail must not move
+ * past them until every child holds its copy. The parent commit cadence goes
+ * in OmBusFanoutConfig.commit_every instead; the tail is flushed only after
+ * the last child publish. Backpressure is end to end: a full child ring
+ * stalls the step, which stalls the parent (set staleness_ns on children so a
+ * dead leaf consumer cannot hold the tree).
+ *
+ * Delivery is exactly once per child. The polled batch and the number of
+ * children that already hold it live in OmBusFanoutState, so when a child
+ * publish fails the next step retries from that child with the same batch
+ * instead of polling a new one.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ombus/om_bus.h"
+
+#define OM_BUS_FANOUT_BATCH        256U
+#define OM_BUS_FANOUT_COMMIT_EVERY UINT32_MAX
+
+typedef struct OmBusFanoutStats {
+    uint64_t loops;
+    uint64_t batches;            /* non-empty steps */
+    uint64_t records_relayed;    /* per parent record, not per child copy */
+    uint64_t idle_waits;
+    uint64_t epoch_syncs;        /* child epochs rewritten */
+    uint32_t batch_max;
+} OmBusFanoutStats;
+
+/* Batch held between steps; zero-initialize before the first step */
+typedef struct OmBusFanoutState {
+    OmBusRecord        recs[OM_BUS_FANOUT_BATCH];  /* zero-copy views into the parent */
+    const OmBusEndpoint *ep;         /* endpoint the views belong to */
+    uint32_t           count;        /* records held (0 = none) */
+    uint32_t           next_child;   /* children [0, next_child) already hold them */
+    uint32_t           uncommitted;  /* records relayed since the last parent flush */
+} OmBusFanoutState;
+
+typedef struct OmBusFanoutConfig {
+    OmBusEndpoint     *ep;           /* parent consumer (commit_every = OM_BUS_FANOUT_COMMIT_EVERY) */
+    OmBusStream      **children;     /* child producers */
+    uint32_t           child_count;
+    uint32_t           batch;        /* records per step (0 = OM_BUS_FANOUT_BATCH) */
+    uint32_t           commit_every; /* parent tail flush cadence in records (0 = every step) */
+    volatile bool     *running;      /* shutdown flag (NULL = run forever) */
+    uint32_t           poll_us;      /* max idle wait on the parent (0 = default 10us) */
+    OmBusFanoutState  *state;        /* required: held batch + per-child progress */
+    OmBusFanoutStats  *stats;
+} OmBusFanoutConfig;
+
+static inline void om_bus_fanout_stats_reset(OmBusFanoutStats *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+}
+
+/**
+ * One pass: forward the parent epoch, poll one batch (or take the held one),
+ * publish it to every child that does not have it yet, then release the
+ * parent slots every commit_every records.
+ *
+ * Returns records relayed (0 = parent empty), or the first poll/publish
+ * error (e.g. OM_ERR_BUS_EPOCH_CHANGED, OM_ERR_BUS_RECORD_TOO_LARGE when a
+ * child's slots are smaller than the parent's). After a publish error the
+ * batch stays held: children before the failing one are not published again.
+ * Reopening cfg->ep drops a held batch (its views belong to the old mapping).
+ */
+static inline int om_bus_fanout_step(const OmBusFanoutConfig *cfg) {
+    if (!cfg || !cfg->ep || !cfg->state || (!cfg->children && cfg->child_count > 0)) {
+        return -1;
+    }
+    OmBusFanoutState *st = cfg->state;
+    if (st->ep != cfg->ep) {
+        st->ep = cfg->ep;
+        st->count = 0;
+        st->next_child = 0;
+        st->uncommitted = 0;
+    }
+
+    uint64_t epoch = om_bus_endpoint_epoch(cfg->ep);
+    for (uint32_t i = 0; i < cfg->child_count; i++) {
+        if (om_bus_stream_epoch(cfg->children[i]) != epoch) {
+            om_bus_stream_set_epoch(cfg->children[i], epoch);
+            if (cfg->stats) cfg->stats->epoch_syncs++;
+        }
+    }
+
+    if (cfg->stats) cfg->stats->loops++;
+    if (st->count == 0) {
+        uint32_t batch = cfg->batch ? cfg->batch : OM_BUS_FANOUT_BATCH;
+        if (batch > OM_BUS_FANOUT_BATCH) batch = OM_BUS_FANOUT_BATCH;
+        int prc = om_bus_endpoint_poll_batch(cfg->ep, st->recs, batch);
+        if (prc <= 0) {
+            /* An empty poll commits the parent tail by itself */
+            if (prc == 0) st->uncommitted = 0;
+            return prc;
+        }
+        st->count = (uint32_t)prc;
+        st->next_child = 0;
+    }
+
+    /* Slots stay pinned until every child has its copy */
+    for (; st->next_child < cfg->child_count; st->next_child++) {
+        int prc = om_bus_stream_publish_batch(cfg->children[st->next_child],
+                                              st->recs, st->count);
+        if (prc < 0) return prc;
+    }
+    int rc = (int)st->count;
+    st->count = 0;
+    st->uncommitted += (uint32_t)rc;
+    if (st->uncommitted >= cfg->commit_every) {
+        om_bus_endpoint_flush(cfg->ep);
+        st->uncommitted = 0;
+    }
+
+    if (cfg->stats) {
+        OmBusFanoutStats *s = cfg->stats;
+        s->batches++;
+        s->records_relayed += (uint64_t)rc;
+        if ((uint32_t)rc > s->batch_max) s->batch_max = (uint32_t)rc;
+    }
+    return rc;
+}
+
+/**
+ * Run the fan-out loop until *running is false.
+ *
+ * Returns 0 on clean shutdown, negative on the first step error. On
+ * OM_ERR_BUS_EPOCH_CHANGED the caller reopens cfg->ep and runs again.
+ */
+static inline int om_bus_fanout_run(const OmBusFanoutConfig *cfg) {
+    if (!cfg || !cfg->ep) return -1;
+
+    uint32_t poll_us = cfg->poll_us ? cfg->poll_us : 10;
+    uint32_t idle_spins = 0;
+
+    while (!cfg->running || *cfg->running) {
+        int rc = om_bus_fanout_step(cfg);
+        if (rc > 0) {
+            idle_spins = 0;
+        } else if (rc == 0) {
+            idle_spins++;
+            if (idle_spins > 100) {
+                /* Epoch errors surface through the next step */
+                om_bus_endpoint_wait(cfg->ep, (uint64_t)poll_us * 1000ULL);
+                if (cfg->stats) cfg->stats->idle_waits++;
+                idle_spins = 0;
+            }
+        } else {
+            return rc;
+        }
+    }
+    return 0;
+}
+
+#endif /* OM_BUS_FANOUT_H */
@@ -0,0 +1,175 @@
+#ifndef OM_BUS_MCAST_H
+#define OM_BUS_MCAST_H
+
+/**
+ * @file om_bus_mcast.h
+ * @brief UDP multicast transport with TCP gap-fill
+ *
+ * TCP fan-out writes one copy per client per record. The multicast
+ * publisher packs records into sequenced datagrams and sends each one once
+ * to a group; every receiver on the segment joins the group and reads the
+ * same datagram.
+ *
+ * Multicast is unreliable, so the publisher also owns an OmBusTcpServer used
+ * only as a gap-fill side channel: every record goes into its RESEND history
+ * ring (and history_src behind it), and receivers normally stay unconnected.
+ * A receiver that sees the datagram sequence jump connects, sends RESEND from
+ * the first missing wal_seq, takes the replayed records up to the point the
+ * multicast stream resumes, and disconnects again. Records the publisher no
+ * longer holds are reported as OM_ERR_BUS_GAP_DETECTED, as on TCP.
+ *
+ * Publisher: OmBusMcastPublisher — packs, sends, serves gap-fill
+ * Receiver:  OmBusMcastReceiver  — joins, detects datagram gaps, fills them
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "om_bus.h"
+#include "om_bus_error.h"
+#include "om_bus_tcp.h"
+
+/* ============================================================================
+ * Wire Protocol — 32-byte datagram header + record body
+ * ============================================================================ */
+
+#define OM_BUS_MCAST_MAGIC       0x4F4D4D43U  /* "OMMC" */
+#define OM_BUS_MCAST_HEADER_SIZE 32U
+#define OM_BUS_MCAST_MTU         1472U        /* Ethernet 1500 - IP - UDP */
+#define OM_BUS_MCAST_MTU_MAX     65507U       /* largest UDP/IPv4 payload */
+
+/*
+ * Body, per record: { u8 wal_type, varint seq delta from the previous record
+ * (the first from header.prev_seq), varint len, payload }, LEB128 varints as
+ * in a TCP BATCH frame. A datagram with count = 0 is a heartbeat, sent by an
+ * idle publisher so receivers notice a lost last datagram.
+ */
+typedef struct OmBusMcastHeader {
+    uint32_t magic;        /* OM_BUS_MCAST_MAGIC */
+    uint16_t count;        /* records in the body (0 = heartbeat) */
+    uint16_t flags;        /* 0 */
+    uint32_t session;      /* publisher instance; changes on restart */
+    uint32_t body_len;     /* body bytes after the header */
+    uint64_t dgram_seq;    /* from 1, +1 per datagram (heartbeats included) */
+    uint64_t prev_seq;     /* wal_seq of the last record sent before this datagram */
+} __attribute__((packed)) OmBusMcastHeader;
+
+/* ============================================================================
+ * Publisher API
+ * ============================================================================ */
+
+typedef struct OmBusMcastPublisherConfig {
+    const char *group;          /* IPv4 multicast group, e.g. "239.255.0.1" */
+    uint16_t    port;
+    const char *iface_addr;     /* outgoing interface address (NULL = default route) */
+    uint8_t     ttl;            /* hops (0 = 1: stay on the segment) */
+    bool        loop;           /* also deliver to receivers on this host */
+    uint32_t    mtu;            /* max datagram bytes (0 = OM_BUS_MCAST_MTU) */
+    uint32_t    heartbeat_ms;   /* idle heartbeat interval (0 = 100ms) */
+    OmBusTcpServerConfig fill;  /* gap-fill server: history_bytes and/or history_src required */
+} OmBusMcastPublisherConfig;
+
+typedef struct OmBusMcastPublisher OmBusMcastPublisher;
+
+typedef struct OmBusMcastPublisherStats {
+    uint64_t datagrams_sent;
+    uint64_t records_sent;
+    uint64_t bytes_sent;         /* datagram bytes, headers included */
+    uint64_t heartbeats_sent;
+    uint64_t send_errors;        /* datagrams the kernel refused (receivers fill them) */
+    uint64_t fill_requests;      /* RESEND requests on the side channel */
+    uint64_t records_filled;     /* records replayed on the side channel */
+} OmBusMcastPublisherStats;
+
+/**
+ * Create the multicast socket and the gap-fill TCP server.
+ * @return 0 on success, OM_ERR_BUS_MCAST_SOCKET on socket setup failure,
+ *         OM_ERR_BUS_INIT on bad config, or a TCP server error
+ */
+int om_bus_mcast_publisher_create(OmBusMcastPublisher **out,
+                                  const OmBusMcastPublisherConfig *cfg);
+
+/**
+ * Publish records: add them to the gap-fill history, then send them packed
+ * into as few datagrams as the MTU allows. wal_seq must increase.
+ * @return 0 on success, OM_ERR_BUS_RECORD_TOO_LARGE if a record does not fit
+ *         one datagram (nothing is sent), OM_ERR_BUS_REORDER_DETECTED if
+ *         wal_seq goes backward
+ */
+int om_bus_mcast_publish_batch(OmBusMcastPublisher *pub, const OmBusRecord *recs,
+                               uint32_t count);
+
+/** Publish one record in its own datagram. */
+int om_bus_mcast_publish(OmBusMcastPublisher *pub, uint64_t wal_seq,
+                         uint8_t wal_type, const void *payload, uint16_t len);
+
+/**
+ * Drive the gap-fill server and send a heartbeat when idle for heartbeat_ms.
+ * Non-blocking.
+ */
+int om_bus_mcast_publisher_poll_io(OmBusMcastPublisher *pub);
+
+/** Bound port of the gap-fill server (for fill.port = 0). */
+uint16_t om_bus_mcast_publisher_fill_port(const OmBusMcastPublisher *pub);
+
+void om_bus_mcast_publisher_stats(const OmBusMcastPublisher *pub,
+                                  OmBusMcastPublisherStats *out);
+
+/** Close the socket and the gap-fill server. NULL-safe. */
+void om_bus_mcast_publisher_destroy(OmBusMcastPublisher *pub);
+
+/* ============================================================================
+ * Receiver API
+ * ============================================================================ */
+
+typedef struct OmBusMcastReceiverConfig {
+    const char *group;          /* IPv4 multicast group */
+    uint16_t    port;
+    const char *iface_addr;     /* interface to join on (NULL = any) */
+    const char *fill_host;      /* publisher's gap-fill server */
+    uint16_t    fill_port;
+    uint32_t    rcvbuf_bytes;   /* SO_RCVBUF (0 = 4 MB): datagrams queue here during a fill */
+    uint32_t    fill_timeout_ms;/* give up on a fill after this (0 = 1000ms) */
+} OmBusMcastReceiverConfig;
+
+typedef struct OmBusMcastReceiver OmBusMcastReceiver;
+
+typedef struct OmBusMcastReceiverStats {
+    uint64_t datagrams;          /* accepted datagrams (heartbeats included) */
+    uint64_t records;            /* records delivered */
+    uint64_t duplicates;         /* datagrams already seen */
+    uint64_t bad_datagrams;      /* wrong magic or malformed body (dropped) */
+    uint64_t gaps;               /* datagram sequence jumps that lost records */
+    uint64_t records_filled;     /* records delivered from the side channel */
+    uint64_t fills_failed;       /* fills that ended early (timeout, connect, backoff, history) */
+    uint64_t sessions;           /* publisher restarts seen */
+} OmBusMcastReceiverStats;
+
+/**
+ * Bind, join the group and set the socket non-blocking. The fill server is
+ * only connected to while a gap is being filled.
+ * @return 0 on success, OM_ERR_BUS_MCAST_SOCKET on socket/join failure
+ */
+int om_bus_mcast_receiver_create(OmBusMcastReceiver **out,
+                                 const OmBusMcastReceiverConfig *cfg);
+
+/**
+ * Poll for the next record. Non-blocking. Joining mid-stream starts at the
+ * first datagram received. While a gap is filled, records come from the side
+ * channel and the multicast socket is not read.
+ * @param rec Output record (payload 8-byte aligned, valid until the next poll)
+ * @return 1 (record), 0 (nothing yet), OM_ERR_BUS_GAP_DETECTED with rec
+ *         filled when records before it could not be recovered
+ */
+int om_bus_mcast_receiver_poll(OmBusMcastReceiver *rx, OmBusRecord *rec);
+
+/** Last delivered WAL sequence number. */
+uint64_t om_bus_mcast_receiver_wal_seq(const OmBusMcastReceiver *rx);
+
+void om_bus_mcast_receiver_stats(const OmBusMcastReceiver *rx,
+                                 OmBusMcastReceiverStats *out);
+
+/** Leave the group and close. NULL-safe. */
+void om_bus_mcast_receiver_close(OmBusMcastReceiver *rx);
+
+#endif /* OM_BUS_MCAST_H */
@@ -7,6 +7,8 @@
  *
  * Polls records from a local SHM endpoint and broadcasts them to all
  * connected TCP clients. Runs in a loop until *running is set to false.
+ * When idle, blocks in om_bus_endpoint_wait() for up to poll_us so the relay
+ * wakes as soon as the producer publishes instead of sleep-polling.
  */
 
 #include <stdbool.h>
@@ -22,7 +24,7 @@ typedef struct OmBusRelayConfig {
     OmBusEndpoint     *ep;           /* SHM consumer */
     OmBusTcpServer    *srv;          /* TCP broadcaster */
     volatile bool     *running;      /* shutdown flag (NULL = run forever) */
-    uint32_t           poll_us;      /* sleep between empty polls (0 = default 10us) */
+    uint32_t           poll_us;      /* max idle wait between TCP I/O passes (0 = default 10us) */
     struct OmBusRelayStats *stats;
 } OmBusRelayConfig;
 
@@ -104,7 +106,9 @@ static inline int om_bus_relay_run(const OmBusRelayConfig *cfg) {
             }
             idle_spins++;
             if (idle_spins > 100) {
-                usleep(poll_us);
+                /* Epoch errors surface through the next poll_batch */
+                om_bus_endpoint_wait(cfg->ep, (uint64_t)poll_us * 1000ULL);
+                idle_spins = 0;
             }
         } else {
             return rc;
@@ -26,24 +26,125 @@
 #define OM_BUS_TCP_FRAME_MAGIC       0x4F4D5446U  /* "OMTF" */
 #define OM_BUS_TCP_FRAME_HEADER_SIZE 16U
 #define OM_BUS_TCP_WAL_TYPE_SLOW_WARNING 0xFEU  /* Reserved: slow client warning */
+#define OM_BUS_TCP_WAL_TYPE_HELLO        0xFDU  /* Reserved: client -> server capabilities */
+#define OM_BUS_TCP_WAL_TYPE_BATCH        0xFCU  /* Reserved: multi-record frame */
+#define OM_BUS_TCP_WAL_TYPE_RESEND       0xFBU  /* Reserved: resend request / ack */
+#define OM_BUS_TCP_WAL_TYPE_SUBSCRIBE    0xFAU  /* Reserved: client -> server filter */
+#define OM_BUS_TCP_WAL_TYPE_SKIP         0xF9U  /* Reserved: seqs withheld by the filter */
+
+#define OM_BUS_TCP_FRAME_FLAG_LZ         0x01U  /* BATCH body is LZ-compressed */
+#define OM_BUS_TCP_FRAME_FLAG_MORE       0x02U  /* SUBSCRIBE: more frames follow */
 
 typedef struct OmBusTcpFrameHeader {
     uint32_t magic;        /* OM_BUS_TCP_FRAME_MAGIC */
     uint8_t  wal_type;     /* OmWalType enum value */
-    uint8_t  flags;        /* Reserved (0) */
+    uint8_t  flags;        /* OM_BUS_TCP_FRAME_FLAG_* (BATCH only, else 0) */
     uint16_t payload_len;  /* Payload bytes (LE) */
     uint64_t wal_seq;      /* WAL sequence (LE) */
 } __attribute__((packed)) OmBusTcpFrameHeader;
 
+/*
+ * Capabilities, offered by the client in a HELLO frame right after connect
+ * (payload: u32 caps) and enabled on the server by OmBusTcpServerConfig.caps:
+ *   OM_BUS_TCP_CAP_BATCH — runs of records from broadcast_batch() are sent
+ *                          as BATCH frames: header.wal_seq is the first
+ *                          record's seq, the body holds per record
+ *                          { u8 wal_type, varint seq delta from the previous
+ *                          record (0 for the first), varint len, payload }.
+ *                          Varints are LEB128. The body is at most 64 KB.
+ *   OM_BUS_TCP_CAP_LZ    — BATCH bodies may be LZ-compressed (FLAG_LZ):
+ *                          { u16 raw_len, LZ4-style block }. Requires BATCH.
+ * Clients decode both transparently; records come out of poll() as usual.
+ */
+#define OM_BUS_TCP_CAP_BATCH 0x1U
+#define OM_BUS_TCP_CAP_LZ    0x2U
+
+/*
+ * Retransmit: the client sends RESEND (header only, wal_seq = first seq
+ * wanted). The server answers with a RESEND frame of its own (the ack),
+ * then replays [wal_seq, live) as single frames from its history ring —
+ * older seqs from history_src — and only then resumes live frames to that
+ * client. The client drops whatever was in flight before the ack.
+ */
+
+/*
+ * Subscription filter: the client sends SUBSCRIBE frames right after
+ * connect, payload { u64 type_mask, u16 product_id × n } with at most
+ * OM_BUS_TCP_SUBSCRIBE_CHUNK ids per frame; every frame but the last
+ * carries FLAG_MORE, and the last one's type_mask applies. The server then
+ * withholds records whose type is not in the mask or whose product (see
+ * OmBusTcpServerConfig.product_of) is not in the set. Each run of withheld
+ * seqs is reported by a SKIP frame (wal_seq = first seq withheld, payload
+ * u64 = seq after the last), sent ahead of the next record delivered or on
+ * an idle poll_io, so the client still sees real gaps.
+ */
+#define OM_BUS_TCP_SUBSCRIBE_CHUNK 112U
+#define OM_BUS_TCP_TYPE_BIT(t)     ((t) < 63U ? 1ULL << (t) : 1ULL << 63)  /* 63+: one bit */
+
+/** Product ID of a record, or -1 if it has none (passes product filters) */
+typedef int (*OmBusTcpProductFn)(uint8_t wal_type, const void *payload, uint16_t len);
+
+/**
+ * Source of records older than the server's history ring (e.g. the WAL,
+ * see om_bus_wal_history_source() in om_bus_wal.h). Called from
+ * om_bus_tcp_server_poll_io(); next() must do bounded work per call.
+ */
+#define OM_BUS_TCP_HISTORY_AGAIN 2  /* next(): nothing yet, call again later */
+
+typedef struct OmBusTcpHistorySource {
+    /* Cursor at the first record with wal_seq >= from_seq; NULL = unavailable */
+    void *(*open)(void *ctx, uint64_t from_seq);
+    /* 1 = rec filled (payload valid until the next call), 0 = end,
+     * OM_BUS_TCP_HISTORY_AGAIN, negative = error (treated as end) */
+    int   (*next)(void *cursor, OmBusRecord *rec);
+    void  (*close)(void *cursor);
+    void  *ctx;
+} OmBusTcpHistorySource;
+
 /* ============================================================================
  * Server API
  * ============================================================================ */
 
+/*
+ * Server modes:
+ *   OM_BUS_TCP_SERVER_COPY   — each frame is copied into every client's
+ *                              private send_buf; poll() readiness (default).
+ *   OM_BUS_TCP_SERVER_SHARED — each frame is copied once into a shared byte
+ *                              ring; clients keep read offsets into it and are
+ *                              flushed with writev() straight from the ring.
+ *                              epoll edge-triggered readiness (Linux only).
+ *                              A client lagging more than max_lag_bytes behind
+ *                              the ring head is warned and dropped.
+ *                              The ring holds one encoding for everyone, so
+ *                              with caps set every client must offer them;
+ *                              a HELLO lacking any is disconnected, and
+ *                              SUBSCRIBE filters are ignored.
+ *   OM_BUS_TCP_SERVER_URING  — COPY buffering driven by io_uring (Linux only):
+ *                              multishot accept, a multishot poll per client
+ *                              for control frames, and one SEND per client
+ *                              per poll_io() covering its whole backlog, all
+ *                              submitted with a single io_uring_enter().
+ *                              Completions are reaped from the shared CQ
+ *                              ring without a syscall. Create fails with
+ *                              OM_ERR_BUS_INIT where io_uring is unavailable
+ *                              or older than 5.19 (multishot accept).
+ */
+#define OM_BUS_TCP_SERVER_COPY   0U
+#define OM_BUS_TCP_SERVER_SHARED 1U
+#define OM_BUS_TCP_SERVER_URING  2U
+
 typedef struct OmBusTcpServerConfig {
     const char *bind_addr;      /* NULL = "0.0.0.0" */
     uint16_t    port;           /* 0 = ephemeral */
     uint32_t    max_clients;    /* default 64 */
-    uint32_t    send_buf_size;  /* per-client, default 256 KB */
+    uint32_t    send_buf_size;  /* COPY / URING: per-client, default 256 KB */
+    uint32_t    mode;           /* OM_BUS_TCP_SERVER_COPY / _SHARED / _URING */
+    uint32_t    ring_size;      /* SHARED: ring bytes, power of two (default 4 MB) */
+    uint32_t    max_lag_bytes;  /* SHARED: slow-client threshold (default ring_size / 2) */
+    uint32_t    caps;           /* OM_BUS_TCP_CAP_* the server may use (0 = single frames) */
+    uint32_t    history_bytes;  /* RESEND history ring, power of two (0 = ack only) */
+    OmBusTcpHistorySource history_src;  /* older than the ring (open = NULL: none) */
+    OmBusTcpProductFn product_of;       /* COPY / URING: for product filters (NULL = none) */
 } OmBusTcpServerConfig;
 
 typedef struct OmBusTcpServer OmBusTcpServer;
@@ -69,13 +170,20 @@ int om_bus_tcp_server_create(OmBusTcpServer **out, const OmBusTcpServerConfig *c
 int om_bus_tcp_server_broadcast(OmBusTcpServer *srv, uint64_t wal_seq,
                                 uint8_t wal_type, const void *payload, uint16_t len);
 
+/**
+ * Broadcast several records. Clients that negotiated OM_BUS_TCP_CAP_BATCH
+ * get runs of records with non-decreasing wal_seq packed into BATCH frames
+ * (encoded once per format, not per client); others get single frames.
+ * @return 0 on success, OM_ERR_BUS_RECORD_TOO_LARGE (SHARED) if a frame
+ *         exceeds the ring
+ */
 int om_bus_tcp_server_broadcast_batch(OmBusTcpServer *srv,
                                       const OmBusRecord *recs,
                                       uint32_t count);
 
 /**
  * Drive I/O: accept connections, flush send buffers, detect disconnects.
- * Non-blocking (poll with timeout=0).
+ * Non-blocking (poll / epoll_wait with timeout=0).
  * @param srv Server handle
  * @return 0 on success, negative on poll error
  */
@@ -99,7 +207,13 @@ typedef struct OmBusTcpServerStats {
     uint64_t bytes_broadcast;        /* total payload bytes */
     uint64_t clients_accepted;       /* cumulative accepts */
     uint64_t clients_disconnected;   /* cumulative disconnects */
-    uint64_t slow_client_drops;      /* disconnects due to buffer overflow */
+    uint64_t slow_client_drops;      /* disconnects due to buffer overflow / lag */
+    uint64_t max_client_lag;         /* SHARED: largest lag seen at flush (bytes) */
+    uint64_t batch_frames;           /* BATCH frames encoded */
+    uint64_t lz_bytes_saved;         /* BATCH body bytes saved by compression */
+    uint64_t resend_requests;        /* RESEND frames received */
+    uint64_t records_replayed;       /* frames sent during catch-up */
+    uint64_t records_filtered;       /* records withheld by SUBSCRIBE filters (per client) */
 } OmBusTcpServerStats;
 
 /**
@@ -122,18 +236,43 @@ typedef struct OmBusTcpClientConfig {
     uint16_t    port;
     uint32_t    recv_buf_size;  /* default 256 KB */
     uint32_t    flags;          /* OM_BUS_FLAG_REJECT_REORDER, etc. */
+    uint32_t    caps;           /* OM_BUS_TCP_CAP_* offered in the HELLO (0 = none sent) */
+    uint64_t    type_mask;      /* OM_BUS_TCP_TYPE_BIT() of types wanted (0 = all) */
+    const uint16_t *products;   /* product IDs wanted (NULL = all) */
+    uint32_t    product_count;
+    bool        io_uring;       /* Linux: recv via io_uring into a registered buffer */
+    bool        async_connect;  /* return while the connect is in progress */
 } OmBusTcpClientConfig;
 
 typedef struct OmBusTcpClient OmBusTcpClient;
 
 /**
  * Connect to a TCP server (blocking connect, then sets non-blocking).
+ * With cfg->caps set, a HELLO frame is sent before returning; with a type
+ * mask or product set, the SUBSCRIBE frames follow it.
+ * With cfg->io_uring, recv_buf is registered with a private ring and one
+ * READ_FIXED is kept in flight (the socket stays blocking so the kernel
+ * waits for data instead of failing with EAGAIN); poll calls only enter the
+ * kernel to re-arm the read after it completes. Fails with OM_ERR_BUS_INIT
+ * where io_uring is unavailable.
+ * With cfg->async_connect, the socket is non-blocking before connect() and
+ * the call returns while the connect is still in progress; finish it with
+ * om_bus_tcp_client_connect_poll(). Cannot be combined with caps, a
+ * subscription or io_uring (OM_ERR_BUS_INIT).
  * @param out Output client handle
  * @param cfg Client configuration
  * @return 0 on success, negative on error
  */
 int om_bus_tcp_client_connect(OmBusTcpClient **out, const OmBusTcpClientConfig *cfg);
 
+/**
+ * Check an async connect without blocking (SO_ERROR once the socket is
+ * writable). poll/poll_batch return 0 and resend fails with
+ * OM_ERR_BUS_TCP_IO until it has completed.
+ * @return 1 (connected), 0 (still in progress), OM_ERR_BUS_TCP_CONNECT
+ */
+int om_bus_tcp_client_connect_poll(OmBusTcpClient *client);
+
 /**
  * Poll for next frame. Non-blocking.
  * @param client Client handle
@@ -144,6 +283,27 @@ int om_bus_tcp_client_connect(OmBusTcpClient **out, const OmBusTcpClientConfig *
  */
 int om_bus_tcp_client_poll(OmBusTcpClient *client, OmBusRecord *rec);
 
+/**
+ * Poll all complete frames already buffered, up to max_count. Non-blocking.
+ * Reads with recv() into the whole free buffer space until EAGAIN first.
+ * Payload pointers point into the recv buffer and stay valid until the next
+ * poll / poll_batch call.
+ * A frame with a gap, reorder, or slow-client warning ends the batch; if it
+ * is the first frame, its status is returned with recs[0] populated (as
+ * poll() would).
+ * @return Number of records (0 = none), or a negative status as for poll()
+ */
+int om_bus_tcp_client_poll_batch(OmBusTcpClient *client, OmBusRecord *recs,
+                                 uint32_t max_count);
+
+/**
+ * Ask the server to resend from from_seq. Frames already in flight are
+ * dropped until the server's ack; the replay then starts at from_seq, and
+ * anything the server no longer has shows up as OM_ERR_BUS_GAP_DETECTED.
+ * @return 0 on success, OM_ERR_BUS_TCP_IO if the request could not be sent
+ */
+int om_bus_tcp_client_resend(OmBusTcpClient *client, uint64_t from_seq);
+
 /**
  * Get last consumed WAL sequence number.
  */
@@ -170,6 +330,8 @@ typedef struct OmBusTcpAutoClient OmBusTcpAutoClient;
 
 /**
  * Create an auto-reconnect TCP client. Performs initial connect.
+ * After a reconnect, it sends RESEND from om_bus_tcp_auto_client_wal_seq() + 1
+ * so the stream resumes where it stopped.
  * @param out Output handle
  * @param cfg Configuration (base + reconnect params)
  * @return 0 on success, negative on initial connect failure
@@ -184,6 +346,13 @@ int om_bus_tcp_auto_client_create(OmBusTcpAutoClient **out,
  */
 int om_bus_tcp_auto_client_poll(OmBusTcpAutoClient *client, OmBusRecord *rec);
 
+/**
+ * Batch poll with transparent reconnection. Same contract as
+ * om_bus_tcp_client_poll_batch(); returns 0 while reconnecting.
+ */
+int om_bus_tcp_auto_client_poll_batch(OmBusTcpAutoClient *client,
+                                      OmBusRecord *recs, uint32_t max_count);
+
 /**
  * Get last consumed WAL sequence number.
  */
@@ -40,4 +40,41 @@ static inline int om_bus_tcp_poll_public(OmBusTcpClient *client, OmMarketPublicW
     return prc < 0 ? prc : 1;
 }
 
+#ifndef OM_BUS_TCP_MARKET_BATCH
+#define OM_BUS_TCP_MARKET_BATCH 64U
+#endif
+
+/**
+ * Poll every buffered record (up to OM_BUS_TCP_MARKET_BATCH) from the TCP
+ * client and process them with a private worker.
+ * @return Number of records processed, 0 if empty, negative on error
+ */
+static inline int om_bus_tcp_poll_worker_batch(OmBusTcpClient *client, OmMarketWorker *w) {
+    OmBusRecord recs[OM_BUS_TCP_MARKET_BATCH];
+    int n = om_bus_tcp_client_poll_batch(client, recs, OM_BUS_TCP_MARKET_BATCH);
+    if (n <= 0) return n;
+    for (int i = 0; i < n; i++) {
+        int prc = om_market_worker_process(w, (OmWalType)recs[i].wal_type, recs[i].payload);
+        if (prc < 0) return prc;
+    }
+    return n;
+}
+
+/**
+ * Poll every buffered record (up to OM_BUS_TCP_MARKET_BATCH) from the TCP
+ * client and process them with a public worker.
+ * @return Number of records processed, 0 if empty, negative on error
+ */
+static inline int om_bus_tcp_poll_public_batch(OmBusTcpClient *client,
+                                               OmMarketPublicWorker *w) {
+    OmBusRecord recs[OM_BUS_TCP_MARKET_BATCH];
+    int n = om_bus_tcp_client_poll_batch(client, recs, OM_BUS_TCP_MARKET_BATCH);
+    if (n <= 0) return n;
+    for (int i = 0; i < n; i++) {
+        int prc = om_market_public_process(w, (OmWalType)recs[i].wal_type, recs[i].payload);
+        if (prc < 0) return prc;
+    }
+    return n;
+}
+
 #endif /* OM_BUS_TCP_MARKET_H */
@@ -11,14 +11,29 @@
  *
  * Usage:
  *   om_bus_attach_wal(om_engine_get_wal(engine), stream);
+ *
+ * Also provides a WAL-backed OmBusTcpHistorySource, so a TCP relay can
+ * answer RESEND requests older than its in-memory history ring, and the
+ * product lookup a TCP server needs for SUBSCRIBE product filters.
  */
 
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "ombus/om_bus.h"
+#include "ombus/om_bus_tcp.h"
 #include "openmatch/om_wal.h"
 
+/* The WAL buffer is the durable copy, so the post_write hook still copies
+ * once; it does so straight into ring memory via reserve/commit. */
 static inline void _om_bus_wal_cb(uint64_t seq, uint8_t type,
                                    const void *data, uint16_t len, void *ctx) {
-    om_bus_stream_publish((OmBusStream *)ctx, seq, type, data, len);
+    OmBusStream *stream = (OmBusStream *)ctx;
+    void *dst;
+    if (om_bus_stream_reserve(stream, len, &dst) != 0) return;
+    if (len > 0) memcpy(dst, data, len);
+    om_bus_stream_commit(stream, seq, type);
 }
 
 /**
@@ -30,4 +45,113 @@ static inline void om_bus_attach_wal(OmWal *wal, OmBusStream *stream) {
     om_wal_set_post_write(wal, _om_bus_wal_cb, stream);
 }
 
+/* ============================================================================
+ * WAL-backed TCP resend history
+ * ============================================================================ */
+
+#define OM_BUS_WAL_HISTORY_SCAN 4096U  /* WAL records examined per next() */
+
+typedef struct OmBusWalHistory {
+    const char        *wal_path;    /* WAL file (or multi-file pattern) */
+    const OmWalConfig *wal_config;  /* for CRC / data sizes; NULL = defaults */
+} OmBusWalHistory;
+
+typedef struct OmBusWalHistoryCursor {
+    OmWalReplay replay;
+    uint64_t    from_seq;
+} OmBusWalHistoryCursor;
+
+static inline int _om_bus_wal_history_init(const OmBusWalHistory *h, OmWalReplay *replay) {
+    return h->wal_config
+        ? om_wal_replay_init_with_config(replay, h->wal_path, h->wal_config)
+        : om_wal_replay_init(replay, h->wal_path);
+}
+
+/* Seek close to from_seq (file skip + block binary search) so a late
+ * subscriber costs a few reads, not a scan of the day. If the seek fails
+ * (damaged block), start over from the beginning of the log. */
+static inline void *_om_bus_wal_history_open(void *ctx, uint64_t from_seq) {
+    const OmBusWalHistory *h = (const OmBusWalHistory *)ctx;
+    OmBusWalHistoryCursor *c = (OmBusWalHistoryCursor *)calloc(1, sizeof(*c));
+    if (!c) return NULL;
+    if (_om_bus_wal_history_init(h, &c->replay) != 0) {
+        free(c);
+        return NULL;
+    }
+    if (from_seq > 1 && om_wal_replay_seek(&c->replay, from_seq) != 0) {
+        om_wal_replay_close(&c->replay);
+        if (_om_bus_wal_history_init(h, &c->replay) != 0) {
+            free(c);
+            return NULL;
+        }
+    }
+    c->from_seq = from_seq;
+    return c;
+}
+
+/* Skip the few records the seek lands before from_seq, a bounded number per
+ * call so the relay's poll_io keeps going */
+static inline int _om_bus_wal_history_next(void *cursor, OmBusRecord *rec) {
+    OmBusWalHistoryCursor *c = (OmBusWalHistoryCursor *)cursor;
+    for (uint32_t i = 0; i < OM_BUS_WAL_HISTORY_SCAN; i++) {
+        OmWalType type;
+        void *data;
+        uint64_t seq;
+        size_t len;
+        int rc = om_wal_replay_next(&c->replay, &type, &data, &seq, &len);
+        if (rc != 1) return rc < 0 ? rc : 0;
+        if (seq < c->from_seq || len > UINT16_MAX) continue;
+        rec->wal_seq = seq;
+        rec->wal_type = (uint8_t)type;
+        rec->payload_len = (uint16_t)len;
+        rec->payload = data;
+        return 1;
+    }
+    return OM_BUS_TCP_HISTORY_AGAIN;
+}
+
+static inline void _om_bus_wal_history_close(void *cursor) {
+    OmBusWalHistoryCursor *c = (OmBusWalHistoryCursor *)cursor;
+    om_wal_replay_close(&c->replay);
+    free(c);
+}
+
+/**
+ * Fill an OmBusTcpHistorySource that reads from a WAL file.
+ * @param src  Output (e.g. &server_cfg.history_src)
+ * @param h    WAL location; must outlive the server
+ */
+static inline void om_bus_wal_history_source(OmBusTcpHistorySource *src,
+                                             const OmBusWalHistory *h) {
+    src->open = _om_bus_wal_history_open;
+    src->next = _om_bus_wal_history_next;
+    src->close = _om_bus_wal_history_close;
+    src->ctx = (void *)h;
+}
+
+/* ============================================================================
+ * Product lookup for TCP SUBSCRIBE filters
+ * ============================================================================ */
+
+/**
+ * OmBusTcpProductFn for WAL records (OmBusTcpServerConfig.product_of).
+ * @return product_id of INSERT/CANCEL/MATCH/DEACTIVATE/ACTIVATE, else -1
+ */
+static inline int om_bus_wal_product_of(uint8_t wal_type, const void *payload,
+                                        uint16_t len) {
+    size_t off;
+    switch (wal_type) {
+    case OM_WAL_INSERT:     off = offsetof(OmWalInsert, product_id); break;
+    case OM_WAL_CANCEL:     off = offsetof(OmWalCancel, product_id); break;
+    case OM_WAL_MATCH:      off = offsetof(OmWalMatch, product_id); break;
+    case OM_WAL_DEACTIVATE: off = offsetof(OmWalDeactivate, product_id); break;
+    case OM_WAL_ACTIVATE:   off = offsetof(OmWalActivate, product_id); break;
+    default: return -1;
+    }
+    if (!payload || len < off + sizeof(uint16_t)) return -1;
+    uint16_t product;
+    memcpy(&product, (const uint8_t *)payload + off, sizeof(product));
+    return product;
+}
+
 #endif /* OM_BUS_WAL_H */
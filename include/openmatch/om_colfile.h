@@ -0,0 +1,225 @@
+#ifndef OM_COLFILE_H
+#define OM_COLFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Columnar file: WAL records laid out for analytics (see docs/wal_columnar.md)
+ *
+ * A file holds named tables of fixed-width unsigned columns. Rows are cut
+ * into chunks of up to chunk_rows; each chunk stores every column as one
+ * contiguous, 64-byte aligned array plus its min/max. Scans skip chunks whose
+ * min/max cannot satisfy the predicates and hand out the rest as raw arrays,
+ * so aggregations are plain loops over memory.
+ *
+ * Layout (native little-endian, like the WAL):
+ *   [OmColFileHeader][column chunks ...][footer]
+ *   footer = OmColTableDesc[table_count], then per table its
+ *            OmColColumnDesc[column_count] and per chunk an OmColChunkDesc
+ *            followed by OmColChunkColumn[column_count].
+ * footer_offset stays 0 until the writer closes, so readers reject a file
+ * whose export did not finish.
+ */
+
+#define OM_COL_MAGIC "OMCOLF01"
+#define OM_COL_VERSION 1U
+#define OM_COL_ALIGN 64U
+#define OM_COL_NAME_LEN 24U
+#define OM_COL_MAX_TABLES 16U
+#define OM_COL_MAX_COLUMNS 16U
+#define OM_COL_MAX_PREDS 8U
+#define OM_COL_DEFAULT_CHUNK_ROWS 65536U
+
+typedef enum OmColType {
+    OM_COL_U8 = 1,
+    OM_COL_U16 = 2,
+    OM_COL_U32 = 3,
+    OM_COL_U64 = 4
+} OmColType;
+
+/* Bytes per value of a column type */
+static inline uint32_t om_col_type_width(OmColType type) {
+    return 1U << ((uint32_t)type - 1U);
+}
+
+/* File header - 64 bytes at offset 0 */
+typedef struct OmColFileHeader {
+    char     magic[8];          /* OM_COL_MAGIC */
+    uint32_t version;           /* OM_COL_VERSION */
+    uint32_t table_count;
+    uint32_t chunk_rows;        /* max rows per chunk */
+    uint32_t reserved0;
+    uint64_t footer_offset;     /* 0 while the writer is open */
+    uint64_t footer_size;
+    uint64_t first_seq;         /* WAL range exported (informational) */
+    uint64_t last_seq;
+    uint64_t reserved1;
+} OmColFileHeader;
+
+/* Table descriptor - 64 bytes; offsets are relative to the footer start */
+typedef struct OmColTableDesc {
+    char     name[OM_COL_NAME_LEN];
+    uint32_t column_count;
+    uint32_t chunk_count;
+    uint64_t row_count;
+    uint64_t columns_offset;    /* OmColColumnDesc[column_count] */
+    uint64_t chunks_offset;     /* chunk_count x (OmColChunkDesc + columns) */
+    uint64_t reserved;
+} OmColTableDesc;
+
+/* Column descriptor - 32 bytes */
+typedef struct OmColColumnDesc {
+    char     name[OM_COL_NAME_LEN];
+    uint8_t  type;              /* OmColType */
+    uint8_t  reserved[7];
+} OmColColumnDesc;
+
+/* Chunk descriptor - 16 bytes, followed by one OmColChunkColumn per column */
+typedef struct OmColChunkDesc {
+    uint64_t first_row;         /* table row number of the chunk's first row */
+    uint32_t rows;
+    uint32_t reserved;
+} OmColChunkDesc;
+
+/* One column of one chunk - 24 bytes */
+typedef struct OmColChunkColumn {
+    uint64_t offset;            /* file offset of rows x width bytes */
+    uint64_t min;
+    uint64_t max;
+} OmColChunkColumn;
+
+/* ============================================================================
+ * Writer
+ * ============================================================================ */
+
+typedef struct OmColColumnDef {
+    const char *name;
+    OmColType   type;
+} OmColColumnDef;
+
+typedef struct OmColWriter OmColWriter;
+
+/**
+ * Create a columnar file (truncating an existing one).
+ * @param chunk_rows Max rows per chunk (0 = OM_COL_DEFAULT_CHUNK_ROWS)
+ * @return 0 on success, OM_ERR_COL_OPEN, OM_ERR_ALLOC_FAILED
+ */
+int om_col_writer_create(OmColWriter **out, const char *path, uint32_t chunk_rows);
+
+/**
+ * Declare a table. Tables may be added at any point before close.
+ * @return table index (>= 0), or OM_ERR_COL_SCHEMA (name too long, duplicate,
+ *         too many tables/columns), OM_ERR_ALLOC_FAILED
+ */
+int om_col_writer_add_table(OmColWriter *w, const char *name,
+                            const OmColColumnDef *columns, uint32_t column_count);
+
+/**
+ * Append one row; values[i] is truncated to column i's width.
+ * A full chunk is written out before returning. Once that fails, every
+ * later append fails with OM_ERR_COL_WRITE; close still frees the writer.
+ * @return 0 on success, OM_ERR_OUT_OF_RANGE (bad table), OM_ERR_COL_WRITE,
+ *         OM_ERR_ALLOC_FAILED
+ */
+int om_col_writer_append(OmColWriter *w, uint32_t table, const uint64_t *values);
+
+/* Record the WAL sequence range in the header (informational) */
+void om_col_writer_set_seq_range(OmColWriter *w, uint64_t first_seq, uint64_t last_seq);
+
+/**
+ * Write the partial chunks and the footer, then free the writer.
+ * The writer is freed on error too; the file is left without a footer.
+ * @return 0 on success, OM_ERR_COL_WRITE
+ */
+int om_col_writer_close(OmColWriter *w);
+
+/* ============================================================================
+ * Reader
+ * ============================================================================ */
+
+typedef struct OmColFile OmColFile;
+
+/**
+ * Map a columnar file read-only and validate its footer.
+ * @return 0 on success, OM_ERR_COL_OPEN, OM_ERR_COL_FORMAT,
+ *         OM_ERR_COL_INCOMPLETE, OM_ERR_ALLOC_FAILED
+ */
+int om_col_open(OmColFile **out, const char *path);
+void om_col_close(OmColFile *f);
+
+const OmColFileHeader *om_col_header(const OmColFile *f);
+uint32_t om_col_table_count(const OmColFile *f);
+const OmColTableDesc *om_col_table(const OmColFile *f, uint32_t table);
+const OmColColumnDesc *om_col_column(const OmColFile *f, uint32_t table, uint32_t column);
+
+/* Index of a table / column by name, or OM_ERR_NOT_FOUND */
+int om_col_table_find(const OmColFile *f, const char *name);
+int om_col_column_find(const OmColFile *f, uint32_t table, const char *name);
+
+/* Chunk metadata: descriptor and its per-column offset/min/max */
+const OmColChunkDesc *om_col_chunk(const OmColFile *f, uint32_t table, uint32_t chunk);
+const OmColChunkColumn *om_col_chunk_column(const OmColFile *f, uint32_t table,
+                                            uint32_t chunk, uint32_t column);
+
+/* ============================================================================
+ * Scan
+ * ============================================================================ */
+
+/* Inclusive range predicate: min <= column <= max */
+typedef struct OmColPred {
+    uint32_t column;
+    uint64_t min;
+    uint64_t max;
+} OmColPred;
+
+/* One chunk handed out by a scan */
+typedef struct OmColBatch {
+    uint64_t first_row;         /* table row number of row 0 */
+    uint32_t rows;              /* rows in the chunk */
+    uint32_t count;             /* rows selected */
+    const uint32_t *sel;        /* selected row indexes, ascending; NULL = all rows */
+    const void *cols[OM_COL_MAX_COLUMNS];   /* column arrays, rows entries each */
+} OmColBatch;
+
+typedef struct OmColScan {
+    const OmColFile *file;
+    uint32_t table;
+    uint32_t next_chunk;
+    uint32_t pred_count;
+    OmColPred preds[OM_COL_MAX_PREDS];
+    uint32_t *sel;              /* chunk_rows entries */
+    uint64_t chunks_skipped;    /* rejected by min/max */
+    uint64_t chunks_scanned;    /* predicates evaluated per row, or all rows matched */
+    uint64_t rows_selected;
+} OmColScan;
+
+/**
+ * Start a scan of `table`. Predicates are AND'ed; a chunk whose min/max
+ * lies inside every predicate is returned without row filtering (sel NULL).
+ * @return 0 on success, OM_ERR_OUT_OF_RANGE (table/column/pred_count),
+ *         OM_ERR_ALLOC_FAILED
+ */
+int om_col_scan_init(OmColScan *scan, const OmColFile *f, uint32_t table,
+                     const OmColPred *preds, uint32_t pred_count);
+
+/**
+ * Next chunk with at least one selected row.
+ * @return 1 (batch filled), 0 (end of table)
+ */
+int om_col_scan_next(OmColScan *scan, OmColBatch *batch);
+void om_col_scan_close(OmColScan *scan);
+
+/* Value of row `row` in a column array of the given type */
+static inline uint64_t om_col_value(const void *col, OmColType type, uint32_t row) {
+    switch (type) {
+        case OM_COL_U8:  return ((const uint8_t *)col)[row];
+        case OM_COL_U16: return ((const uint16_t *)col)[row];
+        case OM_COL_U32: return ((const uint32_t *)col)[row];
+        case OM_COL_U64:
+        default:         return ((const uint64_t *)col)[row];
+    }
+}
+
+#endif /* OM_COLFILE_H */
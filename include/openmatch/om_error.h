@@ -16,6 +16,8 @@
  *   -400 to -499: Engine errors
  *   -500 to -599: Market/Worker errors
  *   -600 to -699: Ring buffer errors
+ *   -700 to -799: Perf config errors
+ *   -900 to -998: Columnar file errors (-800 to -899: ombus/om_bus_error.h)
  */
 
 /**
@@ -101,6 +103,13 @@ typedef enum OmError {
     /* Perf config errors (-700 to -799) */
     OM_ERR_PERF_CONFIG      = -700, /**< Performance config validation failed */
 
+    /* Columnar file errors (-900 to -998) */
+    OM_ERR_COL_OPEN         = -900, /**< Columnar file open/create failed */
+    OM_ERR_COL_WRITE        = -901, /**< Columnar file write failed */
+    OM_ERR_COL_FORMAT       = -902, /**< Bad magic, version or footer */
+    OM_ERR_COL_INCOMPLETE   = -903, /**< Export did not finish (no footer) */
+    OM_ERR_COL_SCHEMA       = -904, /**< Invalid table or column definition */
+
     /* Reserved for future use */
     OM_ERR_UNKNOWN          = -999  /**< Unknown error */
 } OmError;
@@ -174,6 +183,11 @@ static inline const char *om_error_string(OmError err) {
         case OM_ERR_RING_COND_INIT:  return "Ring cond init failed";
         case OM_ERR_RING_CONSUMER_ID: return "Invalid consumer index";
         case OM_ERR_PERF_CONFIG:     return "Perf config validation failed";
+        case OM_ERR_COL_OPEN:        return "Columnar file open failed";
+        case OM_ERR_COL_WRITE:       return "Columnar file write failed";
+        case OM_ERR_COL_FORMAT:      return "Columnar file format invalid";
+        case OM_ERR_COL_INCOMPLETE:  return "Columnar file incomplete";
+        case OM_ERR_COL_SCHEMA:      return "Columnar schema invalid";
         case OM_ERR_UNKNOWN:         return "Unknown error";
         default:                     return "Unrecognized error code";
     }
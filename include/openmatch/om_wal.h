@@ -138,6 +138,10 @@ typedef struct OmWal {
     void (*post_write)(uint64_t seq, uint8_t type, const void *data,
                        uint16_t len, void *ctx);
     void *post_write_ctx;
+
+    /* Timestamp source for INSERT/CANCEL/DEACTIVATE/ACTIVATE (NULL = CLOCK_MONOTONIC) */
+    uint64_t (*clock_ns)(void *ctx);
+    void *clock_ctx;
 } OmWal;
 
 /* Initialize WAL with high-performance settings */
@@ -163,6 +167,16 @@ void om_wal_set_slab(OmWal *wal, struct OmDualSlab *slab);
 void om_wal_set_post_write(OmWal *wal,
     void (*fn)(uint64_t, uint8_t, const void*, uint16_t, void*), void *ctx);
 
+/**
+ * Set the timestamp source for records the WAL stamps itself. Generators and
+ * replays use it to write recorded or synthetic time; MATCH records carry the
+ * caller's timestamp_ns either way.
+ * @param wal WAL context
+ * @param fn  Returns nanoseconds (NULL restores CLOCK_MONOTONIC)
+ * @param ctx User context passed to fn
+ */
+void om_wal_set_clock(OmWal *wal, uint64_t (*fn)(void *ctx), void *ctx);
+
 /* Write operations - all return sequence number on success, 0 on failure */
 /* These are FAST PATH - just append to buffer, no syscalls, no locks */
 
@@ -271,6 +285,31 @@ void om_wal_replay_close(OmWalReplay *replay);
 int om_wal_replay_next(OmWalReplay *replay, OmWalType *type, void **data, 
                        uint64_t *sequence, size_t *data_len);
 
+/**
+ * Position replay at or shortly before the record with the given sequence.
+ * Sequences increase through the log, so a multi-file replay skips files
+ * whose successor starts at or before it, then binary-searches 4KB blocks of
+ * the file (resyncing on a chain of valid records). The next replay_next
+ * returns a record with seq <= sequence when one exists, so callers still
+ * skip the few records before the target. Call on a freshly initialized
+ * replay: files already passed are not reopened.
+ * @return 0 on success, negative on error
+ */
+int om_wal_replay_seek(OmWalReplay *replay, uint64_t sequence);
+
+/**
+ * Position replay at the first record starting at or after byte `offset` of
+ * the current file, resyncing the same way as om_wal_replay_seek (a chain of
+ * records with consecutive sequences, CRC-checked when enabled). Lets several
+ * readers split one file into byte ranges: a record belongs to the range
+ * holding its header, see last_record_offset.
+ * @param record_offset Offset of that record, file_size if none (may be NULL)
+ * @param sequence Its sequence, 0 if none (may be NULL)
+ * @return 1 if positioned on a record, 0 if none follows offset, negative on error
+ */
+int om_wal_replay_seek_offset(OmWalReplay *replay, uint64_t offset, uint64_t *record_offset,
+                              uint64_t *sequence);
+
 /* Append a custom WAL record (type >= OM_WAL_USER_BASE) */
 uint64_t om_wal_append_custom(OmWal *wal, OmWalType type, const void *data, size_t len);
 
@@ -0,0 +1,588 @@
+/**
+ * @file om_bus_mcast.c
+ * @brief UDP multicast transport with TCP gap-fill
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ombus/om_bus_mcast.h"
+
+#define OM_MCAST_DEFAULT_HEARTBEAT_MS 100U
+#define OM_MCAST_DEFAULT_RCVBUF       (4U * 1024U * 1024U)
+#define OM_MCAST_DEFAULT_FILL_MS      1000U
+#define OM_MCAST_FILL_BACKOFF_MIN_MS  50U
+#define OM_MCAST_FILL_BACKOFF_MAX_MS  5000U
+#define OM_MCAST_HOST_MAX             64U
+
+/* ============================================================================
+ * Internal structures
+ * ============================================================================ */
+
+struct OmBusMcastPublisher {
+    int             fd;             /* UDP socket, connected to the group */
+    uint32_t        mtu;
+    uint32_t        heartbeat_ms;
+    uint32_t        session;
+    uint64_t        dgram_seq;      /* last datagram sent */
+    uint64_t        last_seq;       /* last wal_seq sent */
+    uint64_t        last_send_ms;
+    uint8_t        *buf;            /* datagram being packed (mtu bytes) */
+    OmBusTcpServer *fill;           /* gap-fill side channel */
+    OmBusMcastPublisherStats stats;
+};
+
+struct OmBusMcastReceiver {
+    int      fd;
+    struct ip_mreq mreq;
+    uint8_t *buf;                   /* last datagram (OM_BUS_MCAST_MTU_MAX) */
+    uint8_t *copy_buf;              /* aligned payload copy (UINT16_MAX + 1) */
+    /* Datagram being delivered */
+    uint32_t pos;
+    uint32_t end;
+    uint32_t left;                  /* records not yet decoded */
+    uint64_t prev;                  /* seq of the previous decoded record */
+    uint32_t session;
+    uint64_t expected_dgram;        /* next datagram seq (0 = none this session) */
+    bool     started;               /* first datagram seen */
+    uint64_t last_wal_seq;
+    /* Gap-fill: records (last_wal_seq, fill_last] come from the side channel */
+    OmBusTcpClient *fill;           /* open only while filling */
+    bool     filling;
+    bool     fill_requested;        /* connected and RESEND sent */
+    bool     fill_lost;             /* some records of this fill were not recovered */
+    uint64_t fill_last;
+    uint64_t fill_deadline_ms;
+    uint64_t fill_retry_ms;         /* no connect before this after a failure */
+    uint32_t fill_backoff_ms;       /* next failure's backoff (0 = minimum) */
+    uint32_t fill_timeout_ms;
+    uint16_t fill_port;
+    char     fill_host[OM_MCAST_HOST_MAX];
+    OmBusMcastReceiverStats stats;
+};
+
+/* ============================================================================
+ * Helpers
+ * ============================================================================ */
+
+static uint64_t _monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+static int _set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) return -1;
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+/* Parse an IPv4 multicast group */
+static bool _group_addr(const char *group, struct in_addr *out) {
+    if (!group || inet_pton(AF_INET, group, out) != 1) return false;
+    return IN_MULTICAST(ntohl(out->s_addr));
+}
+
+/* ----------------------------------------------------------------------------
+ * LEB128 varints (as in TCP BATCH bodies)
+ * -------------------------------------------------------------------------- */
+
+static inline uint32_t _varint_put(uint8_t *p, uint64_t v) {
+    uint32_t n = 0;
+    while (v >= 0x80U) {
+        p[n++] = (uint8_t)(v | 0x80U);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static inline uint32_t _varint_len(uint64_t v) {
+    uint32_t n = 1;
+    while (v >= 0x80U) { v >>= 7; n++; }
+    return n;
+}
+
+static inline bool _varint_get(const uint8_t *p, uint32_t end, uint32_t *pos,
+                               uint64_t *out) {
+    uint64_t v = 0;
+    for (uint32_t shift = 0; shift < 64U; shift += 7U) {
+        if (*pos >= end) return false;
+        uint8_t b = p[(*pos)++];
+        v |= (uint64_t)(b & 0x7FU) << shift;
+        if (!(b & 0x80U)) { *out = v; return true; }
+    }
+    return false;
+}
+
+/* ============================================================================
+ * Publisher
+ * ============================================================================ */
+
+int om_bus_mcast_publisher_create(OmBusMcastPublisher **out,
+                                  const OmBusMcastPublisherConfig *cfg) {
+    if (!out || !cfg) return OM_ERR_BUS_INIT;
+    uint32_t mtu = cfg->mtu ? cfg->mtu : OM_BUS_MCAST_MTU;
+    if (mtu <= OM_BUS_MCAST_HEADER_SIZE || mtu > OM_BUS_MCAST_MTU_MAX) return OM_ERR_BUS_INIT;
+    if (cfg->fill.history_bytes == 0 && !cfg->fill.history_src.open) return OM_ERR_BUS_INIT;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(cfg->port);
+    if (!_group_addr(cfg->group, &addr.sin_addr)) return OM_ERR_BUS_INIT;
+    struct in_addr iface = { .s_addr = htonl(INADDR_ANY) };
+    if (cfg->iface_addr && inet_pton(AF_INET, cfg->iface_addr, &iface) != 1) {
+        return OM_ERR_BUS_INIT;
+    }
+
+    OmBusMcastPublisher *pub = calloc(1, sizeof(*pub));
+    if (!pub) return OM_ERR_BUS_INIT;
+    pub->fd = -1;
+    pub->mtu = mtu;
+    pub->heartbeat_ms = cfg->heartbeat_ms ? cfg->heartbeat_ms : OM_MCAST_DEFAULT_HEARTBEAT_MS;
+    pub->buf = malloc(mtu);
+    if (!pub->buf) {
+        free(pub);
+        return OM_ERR_BUS_INIT;
+    }
+
+    /* Session: distinguishes a restarted publisher whose datagram seqs
+     * start over */
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    pub->session = (uint32_t)ts.tv_nsec ^ (uint32_t)ts.tv_sec ^ ((uint32_t)getpid() << 16);
+    if (pub->session == 0) pub->session = 1;
+
+    OmBusTcpServerConfig fill = cfg->fill;
+    fill.mode = OM_BUS_TCP_SERVER_COPY;
+    int rc = om_bus_tcp_server_create(&pub->fill, &fill);
+    if (rc != 0) {
+        om_bus_mcast_publisher_destroy(pub);
+        return rc;
+    }
+
+    pub->fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (pub->fd < 0) {
+        om_bus_mcast_publisher_destroy(pub);
+        return OM_ERR_BUS_MCAST_SOCKET;
+    }
+    unsigned char ttl = cfg->ttl ? cfg->ttl : 1U;
+    unsigned char loop = cfg->loop ? 1U : 0U;
+    if (setsockopt(pub->fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) < 0 ||
+        setsockopt(pub->fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0 ||
+        (cfg->iface_addr &&
+         setsockopt(pub->fd, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) < 0) ||
+        connect(pub->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        om_bus_mcast_publisher_destroy(pub);
+        return OM_ERR_BUS_MCAST_SOCKET;
+    }
+
+    pub->last_send_ms = _monotonic_ms();
+    *out = pub;
+    return 0;
+}
+
+/* Finish the datagram in pub->buf and send it. The seq is spent even if the
+ * kernel refuses it: receivers see the gap and fill it. */
+static void _pub_send(OmBusMcastPublisher *pub, uint16_t count, uint32_t len,
+                      uint64_t prev_seq) {
+    OmBusMcastHeader hdr;
+    hdr.magic = OM_BUS_MCAST_MAGIC;
+    hdr.count = count;
+    hdr.flags = 0;
+    hdr.session = pub->session;
+    hdr.body_len = len - OM_BUS_MCAST_HEADER_SIZE;
+    hdr.dgram_seq = ++pub->dgram_seq;
+    hdr.prev_seq = prev_seq;
+    memcpy(pub->buf, &hdr, OM_BUS_MCAST_HEADER_SIZE);
+
+    ssize_t n;
+    do {
+        n = send(pub->fd, pub->buf, len, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n == (ssize_t)len) {
+        pub->stats.datagrams_sent++;
+        pub->stats.bytes_sent += len;
+    } else {
+        pub->stats.send_errors++;
+    }
+    pub->last_send_ms = _monotonic_ms();
+}
+
+static inline uint32_t _pub_rec_size(uint64_t prev, const OmBusRecord *rec) {
+    return 1U + _varint_len(rec->wal_seq - prev) + _varint_len(rec->payload_len)
+         + rec->payload_len;
+}
+
+int om_bus_mcast_publish_batch(OmBusMcastPublisher *pub, const OmBusRecord *recs,
+                               uint32_t count) {
+    if (!pub || (!recs && count > 0)) return OM_ERR_BUS_INIT;
+    if (count == 0) return 0;
+
+    /* Validate first so a batch is sent whole or not at all */
+    uint64_t prev = pub->last_seq;
+    for (uint32_t i = 0; i < count; i++) {
+        if (recs[i].wal_seq <= prev) return OM_ERR_BUS_REORDER_DETECTED;
+        if (OM_BUS_MCAST_HEADER_SIZE + _pub_rec_size(prev, &recs[i]) > pub->mtu) {
+            return OM_ERR_BUS_RECORD_TOO_LARGE;
+        }
+        prev = recs[i].wal_seq;
+    }
+
+    /* History first: a receiver may ask for these as soon as it sees them */
+    int rc = om_bus_tcp_server_broadcast_batch(pub->fill, recs, count);
+    if (rc < 0) return rc;
+
+    uint8_t *buf = pub->buf;
+    uint32_t pos = OM_BUS_MCAST_HEADER_SIZE;
+    uint16_t n = 0;
+    uint64_t dgram_prev = pub->last_seq;
+    prev = pub->last_seq;
+    for (uint32_t i = 0; i < count; i++) {
+        const OmBusRecord *rec = &recs[i];
+        if (pos + _pub_rec_size(prev, rec) > pub->mtu || n == UINT16_MAX) {
+            _pub_send(pub, n, pos, dgram_prev);
+            pos = OM_BUS_MCAST_HEADER_SIZE;
+            n = 0;
+            dgram_prev = prev;
+        }
+        buf[pos++] = rec->wal_type;
+        pos += _varint_put(buf + pos, rec->wal_seq - prev);
+        pos += _varint_put(buf + pos, rec->payload_len);
+        if (rec->payload_len > 0) memcpy(buf + pos, rec->payload, rec->payload_len);
+        pos += rec->payload_len;
+        prev = rec->wal_seq;
+        n++;
+    }
+    _pub_send(pub, n, pos, dgram_prev);
+
+    pub->last_seq = prev;
+    pub->stats.records_sent += count;
+    return 0;
+}
+
+int om_bus_mcast_publish(OmBusMcastPublisher *pub, uint64_t wal_seq,
+                         uint8_t wal_type, const void *payload, uint16_t len) {
+    OmBusRecord rec = {
+        .wal_seq = wal_seq, .wal_type = wal_type, .payload_len = len, .payload = payload,
+    };
+    return om_bus_mcast_publish_batch(pub, &rec, 1);
+}
+
+int om_bus_mcast_publisher_poll_io(OmBusMcastPublisher *pub) {
+    if (!pub) return OM_ERR_BUS_INIT;
+    if (_monotonic_ms() - pub->last_send_ms >= pub->heartbeat_ms) {
+        _pub_send(pub, 0, OM_BUS_MCAST_HEADER_SIZE, pub->last_seq);
+        pub->stats.heartbeats_sent++;
+    }
+    return om_bus_tcp_server_poll_io(pub->fill);
+}
+
+uint16_t om_bus_mcast_publisher_fill_port(const OmBusMcastPublisher *pub) {
+    return pub ? om_bus_tcp_server_port(pub->fill) : 0;
+}
+
+void om_bus_mcast_publisher_stats(const OmBusMcastPublisher *pub,
+                                  OmBusMcastPublisherStats *out) {
+    if (!pub || !out) return;
+    *out = pub->stats;
+    OmBusTcpServerStats ts;
+    om_bus_tcp_server_stats(pub->fill, &ts);
+    out->fill_requests = ts.resend_requests;
+    out->records_filled = ts.records_replayed;
+}
+
+void om_bus_mcast_publisher_destroy(OmBusMcastPublisher *pub) {
+    if (!pub) return;
+    if (pub->fd >= 0) close(pub->fd);
+    om_bus_tcp_server_destroy(pub->fill);
+    free(pub->buf);
+    free(pub);
+}
+
+/* ============================================================================
+ * Receiver
+ * ============================================================================ */
+
+int om_bus_mcast_receiver_create(OmBusMcastReceiver **out,
+                                 const OmBusMcastReceiverConfig *cfg) {
+    if (!out || !cfg) return OM_ERR_BUS_INIT;
+    if (cfg->fill_host && strlen(cfg->fill_host) >= OM_MCAST_HOST_MAX) return OM_ERR_BUS_INIT;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(cfg->port);
+    if (!_group_addr(cfg->group, &addr.sin_addr)) return OM_ERR_BUS_INIT;
+
+    OmBusMcastReceiver *rx = calloc(1, sizeof(*rx));
+    if (!rx) return OM_ERR_BUS_INIT;
+    rx->fd = -1;
+    rx->mreq.imr_multiaddr = addr.sin_addr;
+    rx->mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (cfg->iface_addr &&
+        inet_pton(AF_INET, cfg->iface_addr, &rx->mreq.imr_interface) != 1) {
+        free(rx);
+        return OM_ERR_BUS_INIT;
+    }
+    rx->fill_timeout_ms = cfg->fill_timeout_ms ? cfg->fill_timeout_ms : OM_MCAST_DEFAULT_FILL_MS;
+    rx->fill_port = cfg->fill_port;
+    if (cfg->fill_host) memcpy(rx->fill_host, cfg->fill_host, strlen(cfg->fill_host) + 1U);
+
+    rx->buf = malloc(OM_BUS_MCAST_MTU_MAX);
+    rx->copy_buf = malloc((size_t)UINT16_MAX + 1U);
+    if (!rx->buf || !rx->copy_buf) {
+        free(rx->buf);
+        free(rx->copy_buf);
+        free(rx);
+        return OM_ERR_BUS_INIT;
+    }
+    rx->fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (rx->fd < 0) {
+        om_bus_mcast_receiver_close(rx);
+        return OM_ERR_BUS_MCAST_SOCKET;
+    }
+
+    /* Several receivers on one host share the port; binding the group
+     * address keeps unrelated unicast traffic on that port out */
+    int one = 1;
+    int rcvbuf = (int)(cfg->rcvbuf_bytes ? cfg->rcvbuf_bytes : OM_MCAST_DEFAULT_RCVBUF);
+    setsockopt(rx->fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#ifdef SO_REUSEPORT
+    setsockopt(rx->fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+#endif
+    setsockopt(rx->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    if (bind(rx->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        setsockopt(rx->fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &rx->mreq, sizeof(rx->mreq)) < 0 ||
+        _set_nonblocking(rx->fd) < 0) {
+        om_bus_mcast_receiver_close(rx);
+        return OM_ERR_BUS_MCAST_SOCKET;
+    }
+
+    *out = rx;
+    return 0;
+}
+
+/* Deliver rec: a jump past last_wal_seq + 1 means records were lost for good */
+static inline int _rx_deliver(OmBusMcastReceiver *rx, const OmBusRecord *rec) {
+    int status = rec->wal_seq > rx->last_wal_seq + 1U ? OM_ERR_BUS_GAP_DETECTED : 1;
+    rx->last_wal_seq = rec->wal_seq;
+    rx->stats.records++;
+    return status;
+}
+
+/* End the fill and disconnect. Delivered fill payloads live in copy_buf, so
+ * the client can go at once. */
+static void _rx_fill_end(OmBusMcastReceiver *rx) {
+    rx->filling = false;
+    om_bus_tcp_client_close(rx->fill);
+    rx->fill = NULL;
+    if (rx->fill_lost || rx->last_wal_seq < rx->fill_last) rx->stats.fills_failed++;
+}
+
+/* The side channel failed (connect, RESEND, timeout or a bad frame): no new
+ * connect until the backoff passes, doubling up to the maximum. Gaps in the
+ * meantime surface as GAP instead of blocking in connect per datagram. */
+static void _rx_fill_fail(OmBusMcastReceiver *rx) {
+    uint32_t backoff = rx->fill_backoff_ms ? rx->fill_backoff_ms : OM_MCAST_FILL_BACKOFF_MIN_MS;
+    rx->fill_retry_ms = _monotonic_ms() + backoff;
+    rx->fill_backoff_ms = backoff < OM_MCAST_FILL_BACKOFF_MAX_MS / 2U
+                        ? backoff * 2U : OM_MCAST_FILL_BACKOFF_MAX_MS;
+    _rx_fill_end(rx);
+}
+
+/* Start connecting to the side channel for (last_wal_seq, upto]. The connect
+ * is non-blocking; _rx_fill_poll() sends the RESEND once it completes. The
+ * timeout runs from here, so an unreachable host costs fill_timeout_ms. */
+static void _rx_fill_start(OmBusMcastReceiver *rx, uint64_t upto) {
+    rx->fill_last = upto;
+    rx->filling = true;
+    rx->fill_requested = false;
+    rx->fill_lost = false;
+    uint64_t now = _monotonic_ms();
+    if (rx->fill_host[0] == '\0' || now < rx->fill_retry_ms) {
+        _rx_fill_end(rx);
+        return;
+    }
+    rx->fill_deadline_ms = now + rx->fill_timeout_ms;
+    OmBusTcpClientConfig ccfg = { .host = rx->fill_host, .port = rx->fill_port,
+                                  .async_connect = true };
+    if (om_bus_tcp_client_connect(&rx->fill, &ccfg) != 0) {
+        rx->fill = NULL;
+        _rx_fill_fail(rx);
+    }
+}
+
+/* Next record from the side channel. The replay runs into live frames, so
+ * the fill ends at fill_last or at the first record past it. Returns 0 while
+ * connecting, waiting or once the fill has ended. */
+static int _rx_fill_poll(OmBusMcastReceiver *rx, OmBusRecord *rec) {
+    if (!rx->fill_requested) {
+        int rc = om_bus_tcp_client_connect_poll(rx->fill);
+        if (rc == 0) {
+            if (_monotonic_ms() >= rx->fill_deadline_ms) _rx_fill_fail(rx);
+            return 0;
+        }
+        if (rc < 0 || om_bus_tcp_client_resend(rx->fill, rx->last_wal_seq + 1U) != 0) {
+            _rx_fill_fail(rx);
+            return 0;
+        }
+        rx->fill_requested = true;
+    }
+    for (;;) {
+        int rc = om_bus_tcp_client_poll(rx->fill, rec);
+        if (rc == 0) {
+            if (_monotonic_ms() >= rx->fill_deadline_ms) _rx_fill_fail(rx);
+            return 0;
+        }
+        /* The client's own gap status is relative to the replay start */
+        if (rc != 1 && rc != OM_ERR_BUS_GAP_DETECTED) {
+            _rx_fill_fail(rx);
+            return 0;
+        }
+        if (rec->wal_seq <= rx->last_wal_seq) continue;
+        if (rec->wal_seq > rx->fill_last) {
+            _rx_fill_end(rx);
+            return 0;
+        }
+        rx->stats.records_filled++;
+        rx->fill_backoff_ms = 0;
+        if (rec->payload_len > 0) memcpy(rx->copy_buf, rec->payload, rec->payload_len);
+        rec->payload = rx->copy_buf;
+        int status = _rx_deliver(rx, rec);
+        if (status != 1) rx->fill_lost = true;
+        if (rec->wal_seq == rx->fill_last) _rx_fill_end(rx);
+        return status;
+    }
+}
+
+/* Accept a datagram of n bytes in rx->buf */
+static void _rx_accept(OmBusMcastReceiver *rx, uint32_t n) {
+    OmBusMcastHeader hdr;
+    if (n < OM_BUS_MCAST_HEADER_SIZE) {
+        rx->stats.bad_datagrams++;
+        return;
+    }
+    memcpy(&hdr, rx->buf, OM_BUS_MCAST_HEADER_SIZE);
+    if (hdr.magic != OM_BUS_MCAST_MAGIC || hdr.body_len != n - OM_BUS_MCAST_HEADER_SIZE) {
+        rx->stats.bad_datagrams++;
+        return;
+    }
+    if (hdr.session != rx->session) {
+        if (rx->session != 0) rx->stats.sessions++;
+        rx->session = hdr.session;
+        rx->expected_dgram = 0;
+    }
+    if (rx->expected_dgram != 0 && hdr.dgram_seq < rx->expected_dgram) {
+        rx->stats.duplicates++;
+        return;
+    }
+    rx->expected_dgram = hdr.dgram_seq + 1U;
+    rx->stats.datagrams++;
+    if (!rx->started) {
+        rx->started = true;
+        rx->last_wal_seq = hdr.prev_seq;  /* joined mid-stream */
+    }
+
+    rx->pos = OM_BUS_MCAST_HEADER_SIZE;
+    rx->end = n;
+    rx->left = hdr.count;
+    rx->prev = hdr.prev_seq;
+
+    /* prev_seq chains the datagrams: records were lost only if it is ahead
+     * of us (a lost heartbeat costs nothing). The datagram stays in buf,
+     * unread, while the fill runs. */
+    if (hdr.prev_seq > rx->last_wal_seq) {
+        rx->stats.gaps++;
+        _rx_fill_start(rx, hdr.prev_seq);
+    }
+}
+
+/* Next record of the current datagram; records already filled are skipped */
+static int _rx_next(OmBusMcastReceiver *rx, OmBusRecord *rec) {
+    const uint8_t *buf = rx->buf;
+    while (rx->left > 0) {
+        uint32_t pos = rx->pos;
+        uint64_t delta, len;
+        if (pos >= rx->end) break;
+        uint8_t wal_type = buf[pos++];
+        if (!_varint_get(buf, rx->end, &pos, &delta) ||
+            !_varint_get(buf, rx->end, &pos, &len) || len > rx->end - pos) {
+            break;
+        }
+        rx->pos = pos + (uint32_t)len;
+        rx->left--;
+        rx->prev += delta;
+        if (rx->prev <= rx->last_wal_seq) continue;
+        rec->wal_seq = rx->prev;
+        rec->wal_type = wal_type;
+        rec->payload_len = (uint16_t)len;
+        /* Records are packed, so a payload may sit at any offset: hand out
+         * an 8-byte-aligned copy when it does not */
+        if (((uintptr_t)(buf + pos) & 7U) == 0) {
+            rec->payload = buf + pos;
+        } else {
+            memcpy(rx->copy_buf, buf + pos, (size_t)len);
+            rec->payload = rx->copy_buf;
+        }
+        return _rx_deliver(rx, rec);
+    }
+    if (rx->left > 0) {
+        rx->stats.bad_datagrams++;
+        rx->left = 0;
+    }
+    return 0;
+}
+
+int om_bus_mcast_receiver_poll(OmBusMcastReceiver *rx, OmBusRecord *rec) {
+    if (!rx || !rec) return OM_ERR_BUS_INIT;
+
+    for (;;) {
+        if (rx->filling) {
+            int rc = _rx_fill_poll(rx, rec);
+            if (rc != 0 || rx->filling) return rc;
+        }
+        if (rx->left > 0) {
+            int rc = _rx_next(rx, rec);
+            if (rc != 0) return rc;
+            continue;
+        }
+        ssize_t n = recv(rx->fd, rx->buf, OM_BUS_MCAST_MTU_MAX, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            return OM_ERR_BUS_MCAST_SOCKET;
+        }
+        _rx_accept(rx, (uint32_t)n);
+    }
+}
+
+uint64_t om_bus_mcast_receiver_wal_seq(const OmBusMcastReceiver *rx) {
+    return rx ? rx->last_wal_seq : 0;
+}
+
+void om_bus_mcast_receiver_stats(const OmBusMcastReceiver *rx,
+                                 OmBusMcastReceiverStats *out) {
+    if (!rx || !out) return;
+    *out = rx->stats;
+}
+
+void om_bus_mcast_receiver_close(OmBusMcastReceiver *rx) {
+    if (!rx) return;
+    if (rx->fd >= 0) {
+        setsockopt(rx->fd, IPPROTO_IP, IP_DROP_MEMBERSHIP, &rx->mreq, sizeof(rx->mreq));
+        close(rx->fd);
+    }
+    om_bus_tcp_client_close(rx->fill);
+    free(rx->buf);
+    free(rx->copy_buf);
+    free(rx);
+}
@@ -10,6 +10,23 @@
 #include <time.h>
 #include <unistd.h>
 
+#if defined(__linux__)
+#include <limits.h>
+#include <linux/futex.h>
+#include <linux/magic.h>
+#include <linux/mempolicy.h>
+#include <stdio.h>
+#include <sys/syscall.h>
+#include <sys/vfs.h>
+#endif
+
+_Static_assert(sizeof(OmBusConsumerTail) == OM_BUS_CONSUMER_ALIGN,
+               "OmBusConsumerTail must fill OM_BUS_CONSUMER_ALIGN");
+
+/* OmBusConsumerTail.held: no member / member holding nothing */
+#define OM_BUS_CLAIM_FREE 0U
+#define OM_BUS_CLAIM_IDLE UINT64_MAX
+
 /* ============================================================================
  * Internal helpers
  * ============================================================================ */
@@ -32,6 +49,64 @@ static inline uint64_t _om_bus_monotonic_ns(void) {
     return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 }
 
+/* Heartbeat clock: tick-granular (1-4ms) but a few ns via vDSO. Same base as
+ * CLOCK_MONOTONIC; staleness thresholds are far above the tick. */
+static inline uint64_t _om_bus_coarse_ns(void) {
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC_COARSE
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* ----------------------------------------------------------------------------
+ * Futex on the low 32 bits of the shared head (Linux). Shared (not PRIVATE)
+ * futex ops so producer and consumers in different processes meet.
+ * Elsewhere consumers fall back to a short sleep-poll loop.
+ * -------------------------------------------------------------------------- */
+
+#define OM_BUS_WAIT_SPIN_MIN      16U
+#define OM_BUS_WAIT_SPIN_MAX      4096U
+#define OM_BUS_WAIT_SPIN_DEFAULT  256U
+#define OM_BUS_WAIT_POLL_NS       50000ULL  /* sleep-poll step without futex */
+
+static inline uint32_t *_om_bus_futex_word(_Atomic uint64_t *p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return (uint32_t *)p + 1;
+#else
+    return (uint32_t *)p;
+#endif
+}
+
+static void _om_bus_futex_wake(_Atomic uint64_t *p) {
+#if defined(__linux__)
+    syscall(SYS_futex, _om_bus_futex_word(p), FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#else
+    (void)p;
+#endif
+}
+
+static void _om_bus_futex_wait(_Atomic uint64_t *p, uint64_t expected, uint64_t timeout_ns) {
+    if (timeout_ns > OM_BUS_WAIT_POLL_NS * 20U) {
+        timeout_ns = OM_BUS_WAIT_POLL_NS * 20U; /* bounded: re-check epoch */
+    }
+#if defined(__linux__)
+    struct timespec ts = {
+        .tv_sec = (time_t)(timeout_ns / 1000000000ULL),
+        .tv_nsec = (long)(timeout_ns % 1000000000ULL),
+    };
+    syscall(SYS_futex, _om_bus_futex_word(p), FUTEX_WAIT, (uint32_t)expected,
+            &ts, NULL, 0);
+#else
+    (void)expected;
+    if (timeout_ns > OM_BUS_WAIT_POLL_NS) timeout_ns = OM_BUS_WAIT_POLL_NS;
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = (long)timeout_ns };
+    nanosleep(&ts, NULL);
+#endif
+}
+
 #ifdef OM_BUS_ENABLE_ERRNO_FALLBACK
 static bool _om_bus_ftruncate_fallback_ok(int err, size_t current_size, size_t required_size) {
     if (current_size < required_size) {
@@ -140,6 +215,30 @@ static inline void *_om_bus_slot(void *base, uint32_t max_consumers,
     return slots_base + idx * slot_size;
 }
 
+/* Record header bytes before the payload (TIMESTAMP adds publish_ns) */
+static inline uint32_t _om_bus_hdr_size(uint32_t flags) {
+    return OM_BUS_SLOT_HEADER_SIZE
+         + ((flags & OM_BUS_FLAG_TIMESTAMP) ? OM_BUS_SLOT_TS_SIZE : 0U);
+}
+
+/* Number of slots occupied by a record (VARLEN mode) */
+static inline uint32_t _om_bus_span(uint32_t slot_size, uint32_t hdr_size,
+                                    uint32_t len) {
+    return (hdr_size + len + slot_size - 1U) / slot_size;
+}
+
+/* Largest payload a stream accepts */
+static inline uint32_t _om_bus_max_payload(uint32_t capacity, uint32_t slot_size,
+                                           uint32_t flags) {
+    uint32_t hdr_size = _om_bus_hdr_size(flags);
+    if (!(flags & OM_BUS_FLAG_VARLEN)) {
+        return slot_size - hdr_size;
+    }
+    /* Half the ring: a PAD run plus the record must always fit */
+    uint64_t max = (uint64_t)(capacity / 2U) * slot_size - hdr_size;
+    return max > UINT16_MAX ? UINT16_MAX : (uint32_t)max;
+}
+
 /* Scan consumer tails and return the minimum */
 static uint64_t _om_bus_min_tail(OmBusConsumerTail *tails, uint32_t count) {
     uint64_t min_val = UINT64_MAX;
@@ -154,14 +253,14 @@ static uint64_t _om_bus_min_tail(OmBusConsumerTail *tails, uint32_t count) {
 static uint64_t _om_bus_min_tail_live(OmBusConsumerTail *tails, uint32_t count,
                                        uint64_t staleness_ns) {
     uint64_t min_val = UINT64_MAX;
-    uint64_t now = staleness_ns ? _om_bus_monotonic_ns() : 0;
+    uint64_t now = staleness_ns ? _om_bus_coarse_ns() : 0;
     for (uint32_t i = 0; i < count; i++) {
         uint64_t t = atomic_load_explicit(&tails[i].tail, memory_order_acquire);
         if (staleness_ns) {
             uint64_t poll_ns = atomic_load_explicit(&tails[i].last_poll_ns,
                                                      memory_order_relaxed);
             /* Skip consumers that never polled (poll_ns == 0) or are stale */
-            if (poll_ns == 0 || (now - poll_ns) > staleness_ns) continue;
+            if (poll_ns == 0 || (now > poll_ns && now - poll_ns > staleness_ns)) continue;
         }
         if (t < min_val) min_val = t;
     }
@@ -182,15 +281,155 @@ struct OmBusStream {
     uint32_t mask;
     uint32_t max_consumers;
     uint32_t flags;
+    uint32_t max_payload;       /* largest accepted payload */
+    uint32_t hdr_size;          /* record header bytes (24, 32 with TIMESTAMP) */
+    bool varlen;                /* OM_BUS_FLAG_VARLEN */
+    bool timestamps;            /* OM_BUS_FLAG_TIMESTAMP */
     char shm_name[64];         /* for shm_unlink on destroy */
     uint64_t records_published; /* stats counter */
+    uint64_t slots_padded;      /* VARLEN: slots skipped at ring end */
+    uint64_t wake_calls;        /* futex wakes issued */
     uint64_t staleness_ns;     /* consumer staleness threshold (0 = disabled) */
+    uint64_t page_size;         /* page size backing the ring (stats) */
+    int32_t numa_node;          /* OM_BUS_MAP_NUMA_LOCAL node, -1 = unbound */
+    bool file_backed;           /* config.path: regular file, kept on destroy */
+    uint32_t sync_every;        /* file-backed: records per msync (0 = none) */
+    uint32_t unsynced;          /* records published since the last msync */
+    uint64_t synced_head;       /* head at the last msync */
+    uint64_t resv_head;         /* reserve/commit: first reserved position */
+    uint32_t resv_count;        /* reserved records awaiting commit (0 = none) */
     OmBusBackpressureCb backpressure_cb;
     void *backpressure_ctx;
 };
 
+/* Open the backing object: a regular file with config->path, else POSIX SHM */
+static int _om_bus_stream_open_fd(const OmBusStreamConfig *config) {
+    if (config->path) return open(config->path, O_CREAT | O_RDWR, 0600);
+    return shm_open(config->stream_name, O_CREAT | O_RDWR, 0600);
+}
+
+/* A file-backed journal is never unlinked on failure: it may hold data */
+static void _om_bus_stream_unlink(const OmBusStreamConfig *config) {
+    if (!config->path) shm_unlink(config->stream_name);
+}
+
+/* File-backed reopen: is the mapped header a ring with our geometry? */
+static bool _om_bus_stream_recoverable(const OmBusShmHeader *hdr, uint32_t capacity,
+                                       uint32_t slot_size, uint32_t max_consumers,
+                                       uint32_t flags) {
+    return hdr->magic == OM_BUS_SHM_MAGIC && hdr->version == OM_BUS_SHM_VERSION
+        && hdr->capacity == capacity && hdr->slot_size == slot_size
+        && hdr->max_consumers == max_consumers && hdr->flags == flags;
+}
+
+static void _om_bus_stream_recover(OmBusStream *stream);
+
+/* ----------------------------------------------------------------------------
+ * Mapping placement (OM_BUS_MAP_*)
+ * -------------------------------------------------------------------------- */
+
+/* Huge page size when fd lives on hugetlbfs, else 0 */
+static size_t _om_bus_hugetlb_page(int fd) {
+#if defined(__linux__)
+    struct statfs sfs;
+    if (fstatfs(fd, &sfs) == 0 && (unsigned long)sfs.f_type == HUGETLBFS_MAGIC) {
+        return (size_t)sfs.f_bsize;
+    }
+#endif
+    (void)fd;
+    return 0;
+}
+
+/* Bind [map, map + len) to the calling thread's node before first touch;
+ * pages already present (recovered file) are migrated. -1 if unsupported. */
+static int32_t _om_bus_numa_bind(void *map, size_t len) {
+#if defined(__linux__) && defined(SYS_mbind) && defined(SYS_getcpu)
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0 || node >= 64U) return -1;
+    unsigned long mask = 1UL << node;
+    /* maxnode counts one past the mask bits (kernel decrements it) */
+    if (syscall(SYS_mbind, map, len, MPOL_BIND, &mask, 65UL, MPOL_MF_MOVE) != 0) {
+        return -1;
+    }
+    return (int32_t)node;
+#else
+    (void)map;
+    (void)len;
+    return -1;
+#endif
+}
+
+/* THP hint for this process's mapping (each process advises its own) */
+static void _om_bus_map_advise(void *map, size_t len, uint32_t map_flags) {
+#ifdef MADV_HUGEPAGE
+    if (map_flags & OM_BUS_MAP_THP) madvise(map, len, MADV_HUGEPAGE);
+#else
+    (void)map;
+    (void)len;
+    (void)map_flags;
+#endif
+}
+
+/* Populate page tables so the first publish/poll per page does not fault.
+ * Falls back to touching one byte per page where MADV_POPULATE_* is absent
+ * (read faults; a shared file page may still take a write fault later). */
+static void _om_bus_prefault(void *map, size_t len, bool write) {
+#if defined(MADV_POPULATE_READ) && defined(MADV_POPULATE_WRITE)
+    if (madvise(map, len, write ? MADV_POPULATE_WRITE : MADV_POPULATE_READ) == 0) return;
+#else
+    (void)write;
+#endif
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    const volatile char *p = (const volatile char *)map;
+    for (size_t off = 0; off < len; off += page) (void)p[off];
+}
+
+/* Page size actually backing the mapping: the hugetlbfs page, a THP PMD if
+ * /proc/self/smaps shows PMD-mapped pages for it, else the base page */
+static uint64_t _om_bus_map_page_size(void *map, size_t huge, uint32_t map_flags) {
+    uint64_t base = (uint64_t)sysconf(_SC_PAGESIZE);
+    if (huge) return huge;
+#if defined(__linux__)
+    if (!(map_flags & OM_BUS_MAP_THP)) return base;
+    FILE *f = fopen("/proc/self/smaps", "r");
+    if (!f) return base;
+    char line[256];
+    bool in_map = false;
+    uint64_t pmd_kb = 0;
+    unsigned long start = 0;
+    unsigned long end = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+            if (in_map) break;
+            in_map = (start == (unsigned long)(uintptr_t)map);
+            continue;
+        }
+        unsigned long kb = 0;
+        if (in_map && (sscanf(line, "ShmemPmdMapped: %lu kB", &kb) == 1 ||
+                       sscanf(line, "FilePmdMapped: %lu kB", &kb) == 1 ||
+                       sscanf(line, "AnonHugePages: %lu kB", &kb) == 1)) {
+            pmd_kb += kb;
+        }
+    }
+    fclose(f);
+    if (pmd_kb == 0) return base;
+    uint64_t pmd = 2U * 1024U * 1024U;
+    f = fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r");
+    if (f) {
+        unsigned long v = 0;
+        if (fscanf(f, "%lu", &v) == 1 && v) pmd = v;
+        fclose(f);
+    }
+    return pmd;
+#else
+    (void)map_flags;
+    return base;
+#endif
+}
+
 int om_bus_stream_create(OmBusStream **out, const OmBusStreamConfig *config) {
-    if (!out || !config || !config->stream_name) {
+    if (!out || !config || (!config->stream_name && !config->path)) {
         return OM_ERR_BUS_INIT;
     }
 
@@ -201,17 +440,30 @@ int om_bus_stream_create(OmBusStream **out, const OmBusStreamConfig *config) {
     if (!_om_bus_is_power_of_two(capacity)) {
         return OM_ERR_BUS_NOT_POW2;
     }
-    if (slot_size < OM_BUS_SLOT_HEADER_SIZE + 1) {
+    if ((config->flags & ~OM_BUS_FLAG_KNOWN) ||
+        slot_size < _om_bus_hdr_size(config->flags) + 1U) {
+        return OM_ERR_BUS_INIT;
+    }
+    /* VARLEN places slot headers at arbitrary slots: keep them 8-byte aligned */
+    if ((config->flags & OM_BUS_FLAG_VARLEN) && (slot_size & 7U) != 0U) {
         return OM_ERR_BUS_INIT;
     }
 
     size_t total = _om_bus_shm_size(capacity, slot_size, max_consumers);
 
-    int fd = shm_open(config->stream_name, O_CREAT | O_RDWR, 0600);
+    int fd = _om_bus_stream_open_fd(config);
     if (fd < 0) {
         return OM_ERR_BUS_SHM_CREATE;
     }
 
+    /* hugetlbfs files are sized in whole huge pages */
+    size_t huge = _om_bus_hugetlb_page(fd);
+    if ((config->map_flags & OM_BUS_MAP_HUGETLB) && !huge) {
+        close(fd);
+        return OM_ERR_BUS_INIT;
+    }
+    if (huge) total = (total + huge - 1U) & ~(huge - 1U);
+
     struct stat st;
     bool needs_resize = true;
     if (fstat(fd, &st) == 0) {
@@ -226,12 +478,12 @@ int om_bus_stream_create(OmBusStream **out, const OmBusStreamConfig *config) {
         size_t post_size = have_post_size ? (size_t)post_trunc_st.st_size : 0U;
         if (!_om_bus_ftruncate_fallback_ok(trunc_errno, post_size, total)) {
             close(fd);
-            shm_unlink(config->stream_name);
+            _om_bus_stream_unlink(config);
             return OM_ERR_BUS_SHM_CREATE;
         }
 #else
         close(fd);
-        shm_unlink(config->stream_name);
+        _om_bus_stream_unlink(config);
         return OM_ERR_BUS_SHM_CREATE;
 #endif
     }
@@ -239,47 +491,71 @@ int om_bus_stream_create(OmBusStream **out, const OmBusStreamConfig *config) {
     void *map = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
     close(fd);
     if (map == MAP_FAILED) {
-        shm_unlink(config->stream_name);
+        _om_bus_stream_unlink(config);
         return OM_ERR_BUS_SHM_MAP;
     }
 
-    /* Zero-fill (mmap of ftruncate'd file is already zeroed, but be explicit) */
-    memset(map, 0, total);
+    /* Placement before the first touch (the memset below faults every page) */
+    int32_t numa_node = (config->map_flags & OM_BUS_MAP_NUMA_LOCAL)
+        ? _om_bus_numa_bind(map, total) : -1;
+    _om_bus_map_advise(map, total, config->map_flags);
 
-    /* Initialize header */
     OmBusShmHeader *hdr = (OmBusShmHeader *)map;
-    hdr->magic = OM_BUS_SHM_MAGIC;
-    hdr->version = OM_BUS_SHM_VERSION;
-    hdr->slot_size = slot_size;
-    hdr->capacity = capacity;
-    hdr->max_consumers = max_consumers;
-    hdr->flags = config->flags;
-    atomic_init(&hdr->head, 0U);
-    atomic_init(&hdr->min_tail, 0U);
-    atomic_init(&hdr->producer_epoch, _om_bus_monotonic_ns());
-    strncpy(hdr->stream_name, config->stream_name, sizeof(hdr->stream_name) - 1);
-    hdr->stream_name[sizeof(hdr->stream_name) - 1] = '\0';
-
-    /* Initialize consumer tails */
     OmBusConsumerTail *tails = _om_bus_consumer_tails(map);
-    for (uint32_t i = 0; i < max_consumers; i++) {
-        atomic_init(&tails[i].tail, 0U);
-        atomic_init(&tails[i].wal_seq, 0U);
-        atomic_init(&tails[i].last_poll_ns, 0U);
-    }
+    bool recover = config->path && !needs_resize &&
+        _om_bus_stream_recoverable(hdr, capacity, slot_size, max_consumers,
+                                   config->flags);
+
+    if (!recover) {
+        /* Zero-fill (mmap of ftruncate'd file is already zeroed, but be explicit) */
+        memset(map, 0, total);
+
+        /* Initialize header */
+        hdr->magic = OM_BUS_SHM_MAGIC;
+        hdr->version = OM_BUS_SHM_VERSION;
+        hdr->slot_size = slot_size;
+        hdr->capacity = capacity;
+        hdr->max_consumers = max_consumers;
+        hdr->flags = config->flags;
+        atomic_init(&hdr->head, 0U);
+        atomic_init(&hdr->min_tail, 0U);
+        atomic_init(&hdr->producer_epoch,
+                    config->epoch ? config->epoch : _om_bus_monotonic_ns());
+        atomic_init(&hdr->waiters, 0U);
+        atomic_init(&hdr->head_wal_seq, 0U);
+        const char *label = config->stream_name ? config->stream_name : config->path;
+        strncpy(hdr->stream_name, label, sizeof(hdr->stream_name) - 1);
+        hdr->stream_name[sizeof(hdr->stream_name) - 1] = '\0';
+
+        /* Initialize consumer tails */
+        for (uint32_t i = 0; i < max_consumers; i++) {
+            atomic_init(&tails[i].tail, 0U);
+            atomic_init(&tails[i].wal_seq, 0U);
+            atomic_init(&tails[i].last_poll_ns, 0U);
+            atomic_init(&tails[i].claim, 0U);
+            atomic_init(&tails[i].members, 0U);
+            atomic_init(&tails[i].lag_ns, 0U);
+            atomic_init(&tails[i].lag_max_ns, 0U);
+            for (uint32_t m = 0; m < OM_BUS_CLAIM_MAX_MEMBERS; m++) {
+                atomic_init(&tails[i].held[m], OM_BUS_CLAIM_FREE);
+            }
+        }
 
-    /* Initialize slot sequences */
-    for (uint32_t i = 0; i < capacity; i++) {
-        OmBusSlotHeader *slot = (OmBusSlotHeader *)_om_bus_slot(
-            map, max_consumers, slot_size, i);
-        atomic_init(&slot->seq, (uint64_t)i);
+        /* Initialize slot sequences */
+        for (uint32_t i = 0; i < capacity; i++) {
+            OmBusSlotHeader *slot = (OmBusSlotHeader *)_om_bus_slot(
+                map, max_consumers, slot_size, i);
+            atomic_init(&slot->seq, (uint64_t)i);
+        }
     }
+    hdr->map_flags = config->map_flags;
+    if (config->map_flags & OM_BUS_MAP_PREFAULT) _om_bus_prefault(map, total, true);
 
     /* Allocate stream handle */
     OmBusStream *s = calloc(1, sizeof(*s));
     if (!s) {
         munmap(map, total);
-        shm_unlink(config->stream_name);
+        _om_bus_stream_unlink(config);
         return OM_ERR_BUS_INIT;
     }
     s->map = map;
@@ -291,33 +567,39 @@ int om_bus_stream_create(OmBusStream **out, const OmBusStreamConfig *config) {
     s->mask = capacity - 1U;
     s->max_consumers = max_consumers;
     s->flags = config->flags;
+    s->max_payload = _om_bus_max_payload(capacity, slot_size, config->flags);
+    s->hdr_size = _om_bus_hdr_size(config->flags);
+    s->varlen = (config->flags & OM_BUS_FLAG_VARLEN) != 0;
+    s->timestamps = (config->flags & OM_BUS_FLAG_TIMESTAMP) != 0;
     s->staleness_ns = config->staleness_ns;
     s->backpressure_cb = config->backpressure_cb;
     s->backpressure_ctx = config->backpressure_ctx;
-    strncpy(s->shm_name, config->stream_name, sizeof(s->shm_name) - 1);
-    s->shm_name[sizeof(s->shm_name) - 1] = '\0';
+    s->file_backed = config->path != NULL;
+    s->sync_every = config->path ? config->sync_every : 0U;
+    if (config->stream_name) {
+        strncpy(s->shm_name, config->stream_name, sizeof(s->shm_name) - 1);
+        s->shm_name[sizeof(s->shm_name) - 1] = '\0';
+    }
+
+    s->numa_node = numa_node;
+    s->page_size = _om_bus_map_page_size(map, huge, config->map_flags);
+
+    if (recover) _om_bus_stream_recover(s);
+    s->synced_head = atomic_load_explicit(&hdr->head, memory_order_relaxed);
 
     *out = s;
     return 0;
 }
 
-int om_bus_stream_publish(OmBusStream *stream, uint64_t wal_seq,
-                          uint8_t wal_type, const void *payload, uint16_t len) {
-    if (!stream) return OM_ERR_BUS_INIT;
-    if (len > stream->slot_size - OM_BUS_SLOT_HEADER_SIZE) {
-        return OM_ERR_BUS_RECORD_TOO_LARGE;
-    }
-
-    uint64_t head = atomic_load_explicit(&stream->hdr->head, memory_order_relaxed);
-
-    /* Backpressure: phased spin while ring is full
-     * Phase 1: 10 iterations  — cpu_relax()      (~100ns)
-     * Phase 2: 32 iterations  — cpu_relax()      (~300ns)
-     * Phase 3: sched_yield()  + callback          (~50-100us) */
+/* Spin until the ring has room for `need` slots past head; returns min_tail.
+ * Phase 1: 10 iterations  — cpu_relax()      (~100ns)
+ * Phase 2: 32 iterations  — cpu_relax()      (~300ns)
+ * Phase 3: sched_yield()  + callback          (~50-100us) */
+static uint64_t _om_bus_wait_room(OmBusStream *stream, uint64_t head, uint64_t need) {
     uint32_t pressure_spins = 0;
     while (1) {
         uint64_t mt = atomic_load_explicit(&stream->hdr->min_tail, memory_order_acquire);
-        if ((head - mt) < stream->capacity) break;
+        if ((head - mt) + need <= stream->capacity) return mt;
         if ((pressure_spins & 31U) == 0U) {
             mt = _om_bus_min_tail_live(stream->tails, stream->max_consumers,
                                         stream->staleness_ns);
@@ -335,17 +617,71 @@ int om_bus_stream_publish(OmBusStream *stream, uint64_t wal_seq,
         }
         pressure_spins++;
     }
+}
+
+static inline OmBusSlotHeader *_om_bus_stream_slot(const OmBusStream *stream,
+                                                   uint64_t pos) {
+    return (OmBusSlotHeader *)_om_bus_slot(stream->map, stream->max_consumers,
+                                           stream->slot_size, pos & stream->mask);
+}
+
+/* Slots needed to place a record at head, including a PAD run if the record
+ * would otherwise cross the ring end. */
+static inline uint32_t _om_bus_need(const OmBusStream *stream, uint64_t head,
+                                    uint32_t span, uint32_t *pad_out) {
+    uint32_t pad = 0;
+    if (stream->varlen) {
+        uint32_t idx = (uint32_t)(head & stream->mask);
+        if (idx + span > stream->capacity) pad = stream->capacity - idx;
+    }
+    *pad_out = pad;
+    return pad + span;
+}
+
+/* Fill a PAD header at head covering `pad` slots; seq is left to the caller */
+static inline OmBusSlotHeader *_om_bus_fill_pad(OmBusStream *stream, uint64_t head,
+                                                uint32_t pad) {
+    OmBusSlotHeader *slot = _om_bus_stream_slot(stream, head);
+    slot->wal_seq = pad;
+    slot->wal_type = 0;
+    slot->slot_flags = OM_BUS_SLOT_FLAG_PAD;
+    slot->payload_len = 0;
+    slot->crc32 = 0;
+    stream->slots_padded += pad;
+    return slot;
+}
+
+/* Write a PAD header at head covering `pad` slots (ring must have room) */
+static inline void _om_bus_write_pad(OmBusStream *stream, uint64_t head, uint32_t pad) {
+    OmBusSlotHeader *slot = _om_bus_fill_pad(stream, head, pad);
+    atomic_store_explicit(&slot->seq, head + 1U, memory_order_release);
+}
+
+/* VARLEN: a slot that was a continuation on the previous lap holds payload
+ * bytes in its seq word, which may equal pos + 1 by chance. Zero the seq of
+ * the next record start before publishing the record in front of it, so a
+ * consumer that catches up to `next` never trusts a stale word. The slot is
+ * free unless the ring is exactly full (next - min_tail == capacity), and
+ * then it is min_tail itself: an old record start whose seq is pos + 1 - capacity. */
+static inline void _om_bus_clear_next(OmBusStream *stream, uint64_t next, uint64_t mt) {
+    if (!stream->varlen || next - mt >= stream->capacity) return;
+    atomic_store_explicit(&_om_bus_stream_slot(stream, next)->seq, 0U,
+                          memory_order_relaxed);
+}
 
-    uint64_t idx = head & stream->mask;
-    OmBusSlotHeader *slot = (OmBusSlotHeader *)_om_bus_slot(
-        stream->map, stream->max_consumers, stream->slot_size, idx);
+/* Write one record at head (ring must have room past min_tail mt) */
+static inline void _om_bus_write_record(OmBusStream *stream, uint64_t head,
+                                        uint64_t mt, uint64_t wal_seq, uint8_t wal_type,
+                                        const void *payload, uint16_t len,
+                                        uint64_t publish_ns) {
+    OmBusSlotHeader *slot = _om_bus_stream_slot(stream, head);
 
-    /* Backpressure above guarantees head - min_tail < capacity, so this
-     * slot has been consumed by all consumers and is safe to overwrite.
+    /* Backpressure guarantees head - min_tail + span <= capacity, so these
+     * slots have been consumed by all consumers and are safe to overwrite.
      * No slot-level seq spin needed (single producer). */
 
     /* Copy payload into slot */
-    char *payload_dst = (char *)slot + OM_BUS_SLOT_HEADER_SIZE;
+    char *payload_dst = (char *)slot + stream->hdr_size;
     if (payload && len > 0) {
         memcpy(payload_dst, payload, len);
     }
@@ -353,15 +689,196 @@ int om_bus_stream_publish(OmBusStream *stream, uint64_t wal_seq,
     /* Fill non-atomic header fields */
     slot->wal_seq = wal_seq;
     slot->wal_type = wal_type;
-    slot->reserved = 0;
+    slot->slot_flags = 0;
     slot->payload_len = len;
     slot->crc32 = (stream->flags & OM_BUS_FLAG_CRC) ? _om_bus_crc32(payload, len) : 0;
+    if (stream->timestamps) {
+        memcpy((char *)slot + OM_BUS_SLOT_HEADER_SIZE, &publish_ns, sizeof(publish_ns));
+    }
+    _om_bus_clear_next(stream, head + _om_bus_span(stream->slot_size, stream->hdr_size, len),
+                       mt);
 
     /* Publish fence: make payload visible before seq update */
     atomic_store_explicit(&slot->seq, head + 1U, memory_order_release);
+}
+
+/* msync [addr, addr + len) after widening it to whole pages */
+static int _om_bus_msync_range(void *map, size_t off, size_t len, int how) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t start = off & ~(page - 1U);
+    return msync((char *)map + start, off + len - start, how);
+}
+
+/* File-backed: write back the header page, the consumer lines and the slots
+ * covering [synced_head, head) — two runs when the range wraps the ring */
+static int _om_bus_stream_msync(OmBusStream *stream, uint64_t head) {
+    size_t slots_off = OM_BUS_HEADER_PAGE
+                     + (size_t)stream->max_consumers * OM_BUS_CONSUMER_ALIGN;
+    int rc = 0;
+    if (head - stream->synced_head >= stream->capacity) {
+        rc |= _om_bus_msync_range(stream->map, 0, stream->map_size, MS_SYNC);
+    } else if (head != stream->synced_head) {
+        uint32_t from = (uint32_t)(stream->synced_head & stream->mask);
+        uint32_t to = (uint32_t)(head & stream->mask);
+        if (from < to) {
+            rc |= _om_bus_msync_range(stream->map, slots_off + (size_t)from * stream->slot_size,
+                                      (size_t)(to - from) * stream->slot_size, MS_SYNC);
+        } else {
+            rc |= _om_bus_msync_range(stream->map, slots_off + (size_t)from * stream->slot_size,
+                                      (size_t)(stream->capacity - from) * stream->slot_size,
+                                      MS_SYNC);
+            if (to) rc |= _om_bus_msync_range(stream->map, slots_off,
+                                              (size_t)to * stream->slot_size, MS_SYNC);
+        }
+    }
+    /* Header last. Kernel writeback may still reach the disk with the header
+     * first; recovery checks the slots instead of trusting head. */
+    rc |= _om_bus_msync_range(stream->map, 0, slots_off, MS_SYNC);
+    stream->synced_head = head;
+    stream->unsynced = 0;
+    return rc ? OM_ERR_BUS_SHM_MAP : 0;
+}
+
+/* Slots covered by a well-formed record or PAD run at pos, 0 if the slot is
+ * not one: stale or torn seq, impossible length or PAD run, record crossing
+ * the ring end, or (CRC streams) a payload that never reached the disk */
+static uint32_t _om_bus_recover_span(const OmBusStream *stream, uint64_t pos,
+                                     bool *is_pad) {
+    const OmBusSlotHeader *slot = _om_bus_stream_slot(stream, pos);
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + 1U) return 0;
+    uint32_t idx = (uint32_t)(pos & stream->mask);
+    if (slot->slot_flags & OM_BUS_SLOT_FLAG_PAD) {
+        *is_pad = true;
+        if (!stream->varlen || slot->wal_seq == 0 || idx + slot->wal_seq != stream->capacity) {
+            return 0;
+        }
+        return (uint32_t)slot->wal_seq;
+    }
+    *is_pad = false;
+    if (slot->slot_flags != 0 || slot->payload_len > stream->max_payload) return 0;
+    uint32_t span = stream->varlen
+        ? _om_bus_span(stream->slot_size, stream->hdr_size, slot->payload_len) : 1U;
+    if (idx + span > stream->capacity) return 0;
+    if ((stream->flags & OM_BUS_FLAG_CRC) &&
+        _om_bus_crc32((const char *)slot + stream->hdr_size, slot->payload_len) != slot->crc32) {
+        return 0;
+    }
+    return span;
+}
+
+/* File-backed reopen. msync order does not bind the kernel's own writeback,
+ * so after a host crash the persisted head may point past slots that never
+ * reached the disk, or fall short of records that did. Rebuild head from the
+ * slots: start at the lowest consumer tail still inside the ring (a record
+ * boundary every consumer has yet to pass) and follow the chain of
+ * well-formed records for at most one lap. That rolls head back past torn
+ * records and forward over records whose head store was lost. Every slot
+ * outside the chain gets a zero seq, so neither a stale word nor a record
+ * written after the torn one is read as a record. Then refresh the consumer heartbeats so staleness is measured from
+ * now (the coarse clock does not survive a reboot) and recompute min_tail. */
+static void _om_bus_stream_recover(OmBusStream *stream) {
+    OmBusShmHeader *hdr = stream->hdr;
+    uint64_t head = atomic_load_explicit(&hdr->head, memory_order_relaxed);
+    uint64_t start = head;
+    uint64_t wal_seq = atomic_load_explicit(&hdr->head_wal_seq, memory_order_relaxed);
+    for (uint32_t i = 0; i < stream->max_consumers; i++) {
+        uint64_t t = atomic_load_explicit(&stream->tails[i].tail, memory_order_relaxed);
+        if (t < start && head - t <= stream->capacity) {
+            start = t;
+            wal_seq = atomic_load_explicit(&stream->tails[i].wal_seq, memory_order_relaxed);
+        }
+    }
+
+    uint64_t pos = start;
+    while (1) {
+        bool is_pad;
+        uint32_t span = _om_bus_recover_span(stream, pos, &is_pad);
+        if (span == 0 || (pos - start) + span > stream->capacity) break;
+        if (!is_pad) wal_seq = _om_bus_stream_slot(stream, pos)->wal_seq;
+        pos += span;
+    }
+    /* Outside [start, pos) nothing is live. Records past a torn one still
+     * carry seq == pos + 1 and would be read once head reaches them again. */
+    for (uint64_t p = pos; p - start < stream->capacity; p++) {
+        atomic_store_explicit(&_om_bus_stream_slot(stream, p)->seq, 0U,
+                              memory_order_relaxed);
+    }
+    atomic_store_explicit(&hdr->head_wal_seq, wal_seq, memory_order_relaxed);
+    atomic_store_explicit(&hdr->head, pos, memory_order_release);
+
+    /* A tail past the rolled-back head read records that are gone: park it
+     * at head so head - min_tail stays within the ring. The producer
+     * republishes from head_wal_seq + 1, which that consumer sees as a
+     * reorder. */
+    for (uint32_t i = 0; i < stream->max_consumers; i++) {
+        uint64_t t = atomic_load_explicit(&stream->tails[i].tail, memory_order_relaxed);
+        if (t > pos && t - pos <= stream->capacity) {
+            atomic_store_explicit(&stream->tails[i].tail, pos, memory_order_relaxed);
+            atomic_store_explicit(&stream->tails[i].wal_seq, wal_seq, memory_order_relaxed);
+        }
+        uint64_t c = atomic_load_explicit(&stream->tails[i].claim, memory_order_relaxed);
+        if (c > pos && c - pos <= stream->capacity) {
+            atomic_store_explicit(&stream->tails[i].claim, pos, memory_order_relaxed);
+        }
+    }
+
+    uint64_t now = _om_bus_coarse_ns();
+    for (uint32_t i = 0; i < stream->max_consumers; i++) {
+        if (atomic_load_explicit(&stream->tails[i].last_poll_ns, memory_order_relaxed)) {
+            atomic_store_explicit(&stream->tails[i].last_poll_ns, now, memory_order_relaxed);
+        }
+    }
+    atomic_store_explicit(&hdr->min_tail,
+                          _om_bus_min_tail(stream->tails, stream->max_consumers),
+                          memory_order_release);
+}
+
+/* Advance the shared head and wake sleeping consumers, if any.
+ * seq_cst store/load pairs with the waiter's fetch_add + head re-check so a
+ * consumer cannot go to sleep on a head value the producer has already
+ * moved past without the producer seeing it as a waiter. wal_seq is the last
+ * record below head (journal resume point for a file-backed restart). */
+static inline void _om_bus_store_head(OmBusStream *stream, uint64_t head,
+                                      uint64_t wal_seq, uint32_t count) {
+    if (count == 0) return;
+    atomic_store_explicit(&stream->hdr->head_wal_seq, wal_seq, memory_order_relaxed);
+    atomic_store_explicit(&stream->hdr->head, head, memory_order_seq_cst);
+    if (atomic_load_explicit(&stream->hdr->waiters, memory_order_seq_cst) != 0U) {
+        _om_bus_futex_wake(&stream->hdr->head);
+        stream->wake_calls++;
+    }
+    if (stream->sync_every) {
+        stream->unsynced += count;
+        if (stream->unsynced >= stream->sync_every) _om_bus_stream_msync(stream, head);
+    }
+}
+
+int om_bus_stream_publish(OmBusStream *stream, uint64_t wal_seq,
+                          uint8_t wal_type, const void *payload, uint16_t len) {
+    if (!stream) return OM_ERR_BUS_INIT;
+    if (stream->resv_count) return OM_ERR_BUS_RESERVE_STATE;
+    if (len > stream->max_payload) {
+        return OM_ERR_BUS_RECORD_TOO_LARGE;
+    }
+
+    uint64_t head = atomic_load_explicit(&stream->hdr->head, memory_order_relaxed);
+
+    uint32_t span = stream->varlen
+        ? _om_bus_span(stream->slot_size, stream->hdr_size, len) : 1U;
+    uint32_t pad;
+    uint32_t need = _om_bus_need(stream, head, span, &pad);
+    uint64_t mt = _om_bus_wait_room(stream, head, need);
+
+    if (pad) {
+        _om_bus_write_pad(stream, head, pad);
+        head += pad;
+    }
+    /* Stamped after the room wait: backpressure is not publish latency */
+    uint64_t now = stream->timestamps ? _om_bus_monotonic_ns() : 0U;
+    _om_bus_write_record(stream, head, mt, wal_seq, wal_type, payload, len, now);
 
     /* Advance head */
-    atomic_store_explicit(&stream->hdr->head, head + 1U, memory_order_release);
+    _om_bus_store_head(stream, head + span, wal_seq, 1U);
     stream->records_published++;
 
     return 0;
@@ -370,92 +887,189 @@ int om_bus_stream_publish(OmBusStream *stream, uint64_t wal_seq,
 int om_bus_stream_publish_batch(OmBusStream *stream, const OmBusRecord *recs,
                                  uint32_t count) {
     if (!stream || (!recs && count > 0)) return OM_ERR_BUS_INIT;
+    if (stream->resv_count) return OM_ERR_BUS_RESERVE_STATE;
 
     /* Validate all records fit before writing any */
-    uint32_t max_payload = stream->slot_size - OM_BUS_SLOT_HEADER_SIZE;
     for (uint32_t i = 0; i < count; i++) {
-        if (recs[i].payload_len > max_payload) return OM_ERR_BUS_RECORD_TOO_LARGE;
+        if (recs[i].payload_len > stream->max_payload) return OM_ERR_BUS_RECORD_TOO_LARGE;
     }
 
     uint64_t head = atomic_load_explicit(&stream->hdr->head, memory_order_relaxed);
-    uint32_t i = 0;
-
-    while (i < count) {
-        uint64_t mt = 0;
-        uint32_t pressure_spins = 0;
-        while (1) {
-            mt = atomic_load_explicit(&stream->hdr->min_tail, memory_order_acquire);
-            if ((head - mt) < stream->capacity) break;
-            if ((pressure_spins & 31U) == 0U) {
-                mt = _om_bus_min_tail_live(stream->tails, stream->max_consumers,
-                                            stream->staleness_ns);
-                atomic_store_explicit(&stream->hdr->min_tail, mt,
-                                      memory_order_release);
-            }
-            if (pressure_spins < 10) {
-                _om_bus_cpu_relax();
-            } else if (pressure_spins < 42) {
-                _om_bus_cpu_relax();
-            } else {
-                if (pressure_spins == 42 && stream->backpressure_cb) {
-                    stream->backpressure_cb(head, mt, stream->backpressure_ctx);
-                }
-                sched_yield();
-            }
-            pressure_spins++;
+    uint64_t mt = atomic_load_explicit(&stream->hdr->min_tail, memory_order_acquire);
+    /* One clock read per batch; re-read only after a room wait */
+    uint64_t now = stream->timestamps ? _om_bus_monotonic_ns() : 0U;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const OmBusRecord *rec = &recs[i];
+        uint32_t span = stream->varlen
+            ? _om_bus_span(stream->slot_size, stream->hdr_size, rec->payload_len) : 1U;
+        uint32_t pad;
+        uint32_t need = _om_bus_need(stream, head, span, &pad);
+
+        /* Cached min_tail covers most of the batch; only re-check when the
+         * known free space is exhausted */
+        if ((head - mt) + need > stream->capacity) {
+            mt = _om_bus_wait_room(stream, head, need);
+            if (stream->timestamps) now = _om_bus_monotonic_ns();
         }
 
-        uint64_t available = stream->capacity - (head - mt);
-        uint32_t chunk = count - i;
-        if ((uint64_t)chunk > available) {
-            chunk = (uint32_t)available;
+        if (pad) {
+            _om_bus_write_pad(stream, head, pad);
+            head += pad;
         }
+        _om_bus_write_record(stream, head, mt, rec->wal_seq, rec->wal_type,
+                             rec->payload, rec->payload_len, now);
+        head += span;
+    }
 
-        for (uint32_t j = 0; j < chunk; j++) {
-            uint64_t idx = head & stream->mask;
-            OmBusSlotHeader *slot = (OmBusSlotHeader *)_om_bus_slot(
-                stream->map, stream->max_consumers, stream->slot_size, idx);
-            const OmBusRecord *rec = &recs[i + j];
+    /* Single head advancement for the batch */
+    _om_bus_store_head(stream, head, count ? recs[count - 1].wal_seq : 0U, count);
+    stream->records_published += count;
 
-            char *payload_dst = (char *)slot + OM_BUS_SLOT_HEADER_SIZE;
-            if (rec->payload && rec->payload_len > 0) {
-                memcpy(payload_dst, rec->payload, rec->payload_len);
-            }
+    return 0;
+}
 
-            slot->wal_seq = rec->wal_seq;
-            slot->wal_type = rec->wal_type;
-            slot->reserved = 0;
-            slot->payload_len = rec->payload_len;
-            slot->crc32 = (stream->flags & OM_BUS_FLAG_CRC)
-                ? _om_bus_crc32(rec->payload, rec->payload_len) : 0;
+/* ----------------------------------------------------------------------------
+ * Reserve / commit — serialize directly into ring memory.
+ * Reserve waits for room and fills PAD/record headers (payload_len only) but
+ * leaves every slot seq stale, so consumers see nothing. Commit walks the run
+ * from resv_head, fills wal_seq/type/CRC, publishes each seq and advances
+ * head once.
+ * -------------------------------------------------------------------------- */
+
+int om_bus_stream_reserve_batch(OmBusStream *stream, const uint16_t *lens,
+                                uint32_t count, void **ptrs_out) {
+    if (!stream || !lens || !ptrs_out || count == 0) return OM_ERR_BUS_INIT;
+    if (stream->resv_count) return OM_ERR_BUS_RESERVE_STATE;
+
+    uint64_t head = atomic_load_explicit(&stream->hdr->head, memory_order_relaxed);
 
-            atomic_store_explicit(&slot->seq, head + 1U, memory_order_release);
-            head++;
+    /* Total slots for the run, PAD runs included (positions are fixed by head) */
+    uint64_t need = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (lens[i] > stream->max_payload) return OM_ERR_BUS_RECORD_TOO_LARGE;
+        uint32_t span = stream->varlen
+            ? _om_bus_span(stream->slot_size, stream->hdr_size, lens[i]) : 1U;
+        uint32_t pad;
+        need += _om_bus_need(stream, head + need, span, &pad);
+        if (need > stream->capacity) return OM_ERR_BUS_RECORD_TOO_LARGE;
+    }
+    uint64_t mt = _om_bus_wait_room(stream, head, need);
+
+    /* Every header position in the run, and the one after it, gets a zero
+     * seq (see _om_bus_clear_next): commit publishes them one at a time and
+     * a consumer reads each start before its record is committed */
+    uint64_t pos = head;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t span = stream->varlen
+            ? _om_bus_span(stream->slot_size, stream->hdr_size, lens[i]) : 1U;
+        uint32_t pad;
+        _om_bus_need(stream, pos, span, &pad);
+        if (pad) {
+            _om_bus_clear_next(stream, pos, mt);
+            _om_bus_fill_pad(stream, pos, pad);
+            pos += pad;
         }
+        _om_bus_clear_next(stream, pos, mt);
+        OmBusSlotHeader *slot = _om_bus_stream_slot(stream, pos);
+        slot->slot_flags = 0;
+        slot->payload_len = lens[i];
+        ptrs_out[i] = (char *)slot + stream->hdr_size;
+        pos += span;
+    }
+    _om_bus_clear_next(stream, pos, mt);
+
+    stream->resv_head = head;
+    stream->resv_count = count;
+    return 0;
+}
 
-        i += chunk;
+int om_bus_stream_commit_batch(OmBusStream *stream, const uint64_t *wal_seqs,
+                               const uint8_t *wal_types, uint32_t count) {
+    if (!stream || !wal_seqs || !wal_types) return OM_ERR_BUS_INIT;
+    if (stream->resv_count == 0 || count != stream->resv_count) {
+        return OM_ERR_BUS_RESERVE_STATE;
     }
 
-    /* Single head advancement for the batch */
-    atomic_store_explicit(&stream->hdr->head, head, memory_order_release);
-    stream->records_published += count;
+    uint64_t pos = stream->resv_head;
+    uint64_t now = stream->timestamps ? _om_bus_monotonic_ns() : 0U;
+    for (uint32_t i = 0; i < count; i++) {
+        OmBusSlotHeader *slot = _om_bus_stream_slot(stream, pos);
+        if (slot->slot_flags & OM_BUS_SLOT_FLAG_PAD) {
+            uint64_t pad = slot->wal_seq;
+            atomic_store_explicit(&slot->seq, pos + 1U, memory_order_release);
+            pos += pad;
+            slot = _om_bus_stream_slot(stream, pos);
+        }
+        uint16_t len = slot->payload_len;
+        slot->wal_seq = wal_seqs[i];
+        slot->wal_type = wal_types[i];
+        slot->crc32 = (stream->flags & OM_BUS_FLAG_CRC)
+            ? _om_bus_crc32((char *)slot + stream->hdr_size, len) : 0;
+        if (stream->timestamps) {
+            memcpy((char *)slot + OM_BUS_SLOT_HEADER_SIZE, &now, sizeof(now));
+        }
+        atomic_store_explicit(&slot->seq, pos + 1U, memory_order_release);
+        pos += stream->varlen
+            ? _om_bus_span(stream->slot_size, stream->hdr_size, len) : 1U;
+    }
 
+    stream->resv_count = 0;
+    _om_bus_store_head(stream, pos, wal_seqs[count - 1], count);
+    stream->records_published += count;
     return 0;
 }
 
+int om_bus_stream_reserve(OmBusStream *stream, uint16_t len, void **ptr_out) {
+    return om_bus_stream_reserve_batch(stream, &len, 1, ptr_out);
+}
+
+int om_bus_stream_commit(OmBusStream *stream, uint64_t wal_seq, uint8_t wal_type) {
+    return om_bus_stream_commit_batch(stream, &wal_seq, &wal_type, 1);
+}
+
 void om_bus_stream_stats(const OmBusStream *s, OmBusStreamStats *out) {
     if (!s || !out) return;
     out->records_published = s->records_published;
+    out->last_wal_seq = atomic_load_explicit(&s->hdr->head_wal_seq, memory_order_relaxed);
     out->head = atomic_load_explicit(&s->hdr->head, memory_order_relaxed);
     out->min_tail = atomic_load_explicit(&s->hdr->min_tail, memory_order_relaxed);
+    out->slots_padded = s->slots_padded;
+    out->wake_calls = s->wake_calls;
+    out->page_size = s->page_size;
+    out->numa_node = s->numa_node;
+}
+
+void om_bus_stream_set_epoch(OmBusStream *stream, uint64_t epoch) {
+    if (!stream) return;
+    atomic_store_explicit(&stream->hdr->producer_epoch, epoch, memory_order_release);
+    _om_bus_futex_wake(&stream->hdr->head);
+}
+
+uint64_t om_bus_stream_epoch(const OmBusStream *stream) {
+    return stream ? atomic_load_explicit(&stream->hdr->producer_epoch,
+                                         memory_order_acquire) : 0U;
+}
+
+int om_bus_stream_sync(OmBusStream *stream) {
+    if (!stream) return OM_ERR_BUS_INIT;
+    if (!stream->file_backed) return 0;
+    return _om_bus_stream_msync(stream,
+        atomic_load_explicit(&stream->hdr->head, memory_order_relaxed));
 }
 
 void om_bus_stream_destroy(OmBusStream *stream) {
     if (!stream) return;
     if (stream->map && stream->map != MAP_FAILED) {
+        /* Let sleeping consumers re-check instead of waiting out the timeout */
+        _om_bus_futex_wake(&stream->hdr->head);
+        /* File-backed: the journal outlives the producer */
+        if (stream->file_backed) {
+            _om_bus_msync_range(stream->map, 0, stream->map_size, MS_SYNC);
+        }
         munmap(stream->map, stream->map_size);
     }
-    shm_unlink(stream->shm_name);
+    if (!stream->file_backed) shm_unlink(stream->shm_name);
     free(stream);
 }
 
@@ -475,17 +1089,311 @@ struct OmBusEndpoint {
     uint32_t max_consumers;
     uint32_t flags;
     bool zero_copy;
+    bool varlen;                /* OM_BUS_FLAG_VARLEN */
+    bool timestamps;            /* OM_BUS_FLAG_TIMESTAMP */
+    uint32_t hdr_size;          /* record header bytes (24, 32 with TIMESTAMP) */
+    uint32_t wait_spins;        /* adaptive spin budget for endpoint_wait */
+    uint32_t commit_every;      /* records per shared tail publish (>= 1) */
+    uint32_t pending;           /* records consumed since last commit */
+    uint64_t tail;              /* local read cursor (authoritative) */
+    uint64_t committed_tail;    /* last tail published to the shared line */
+    uint64_t last_wal_seq;      /* last WAL sequence consumed */
     uint64_t expected_wal_seq;  /* For gap detection */
     uint64_t producer_epoch;    /* Epoch at time of open, for restart detection */
     void *copy_buf;             /* Copy buffer (when !zero_copy) */
+    uint32_t group_mode;        /* OM_BUS_GROUP_* */
+    uint32_t group_members;     /* PARTITION: member count */
+    uint32_t member_id;         /* PARTITION: this member */
+    int gap_pending;            /* PARTITION: gap seen on a skipped record */
+    OmBusPartitionFn partition_fn;
+    void *partition_ctx;
+    bool claim_held;            /* CLAIM: [claim_start, tail) not yet released */
+    uint64_t claim_start;
+    uint32_t claim_slot;        /* CLAIM: this member's entry in held[] */
+    uint64_t lat_last;          /* TIMESTAMP: latency of the last delivered record */
+    uint64_t lat_max_pub;       /* lat.max_ns last folded into lag_max_ns */
+    OmBusLatencyStats lat;      /* TIMESTAMP: publish-to-poll histogram */
 };
 
+static inline OmBusSlotHeader *_om_bus_endpoint_slot(const OmBusEndpoint *ep,
+                                                     uint64_t pos) {
+    return (OmBusSlotHeader *)_om_bus_slot(ep->map, ep->max_consumers,
+                                           ep->slot_size, pos & ep->mask);
+}
+
+/* Slots covered by the record at slot (1 unless VARLEN) */
+static inline uint32_t _om_bus_endpoint_span(const OmBusEndpoint *ep,
+                                             const OmBusSlotHeader *slot) {
+    return ep->varlen ? _om_bus_span(ep->slot_size, ep->hdr_size, slot->payload_len) : 1U;
+}
+
+/* TIMESTAMP: fold now - publish_ns of the record at slot into the histogram.
+ * Bucket b holds [2^b, 2^(b+1)) ns; a clock read that lands before the
+ * publish (another CPU, same clock) counts as 0. */
+static inline void _om_bus_endpoint_lat(OmBusEndpoint *ep,
+                                        const OmBusSlotHeader *slot, uint64_t now) {
+    uint64_t publish_ns;
+    memcpy(&publish_ns, (const char *)slot + OM_BUS_SLOT_HEADER_SIZE, sizeof(publish_ns));
+    uint64_t lat = now > publish_ns ? now - publish_ns : 0U;
+    uint32_t b = lat ? 63U - (uint32_t)__builtin_clzll(lat) : 0U;
+    if (b >= OM_BUS_LAT_BUCKETS) b = OM_BUS_LAT_BUCKETS - 1U;
+    ep->lat.buckets[b]++;
+    ep->lat.count++;
+    ep->lat.sum_ns += lat;
+    if (lat > ep->lat.max_ns) ep->lat.max_ns = lat;
+    ep->lat_last = lat;
+}
+
+/* Raise *v to at least val (CLAIM members share the line) */
+static inline void _om_bus_atomic_max(_Atomic uint64_t *v, uint64_t val) {
+    uint64_t cur = atomic_load_explicit(v, memory_order_relaxed);
+    while (cur < val &&
+           !atomic_compare_exchange_weak_explicit(v, &cur, val, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+/* Publish tail, wal_seq and heartbeat to the shared consumer line, then
+ * refresh min_tail if we were the minimum */
+static void _om_bus_endpoint_commit(OmBusEndpoint *ep) {
+    OmBusConsumerTail *ct = &ep->tails[ep->consumer_index];
+    uint64_t prev_tail = ep->committed_tail;
+    uint64_t new_tail = ep->tail;
+    atomic_store_explicit(&ct->tail, new_tail, memory_order_release);
+    atomic_store_explicit(&ct->wal_seq, ep->last_wal_seq, memory_order_release);
+    atomic_store_explicit(&ct->last_poll_ns, _om_bus_coarse_ns(),
+                          memory_order_relaxed);
+    if (ep->timestamps && ep->lat.count) {
+        atomic_store_explicit(&ct->lag_ns, ep->lat_last, memory_order_relaxed);
+        if (ep->lat.max_ns > ep->lat_max_pub) {
+            _om_bus_atomic_max(&ct->lag_max_ns, ep->lat.max_ns);
+            ep->lat_max_pub = ep->lat.max_ns;
+        }
+    }
+    ep->committed_tail = new_tail;
+    ep->pending = 0;
+
+    uint64_t cached_min = atomic_load_explicit(&ep->hdr->min_tail, memory_order_acquire);
+    if (prev_tail == cached_min || new_tail < cached_min) {
+        uint64_t mt = _om_bus_min_tail(ep->tails, ep->max_consumers);
+        atomic_store_explicit(&ep->hdr->min_tail, mt, memory_order_release);
+    }
+}
+
+/* Advance the local cursor past `count` records; commit every commit_every */
+static inline void _om_bus_endpoint_advance(OmBusEndpoint *ep, uint64_t new_tail,
+                                            uint64_t wal_seq, uint32_t count) {
+    ep->tail = new_tail;
+    if (count == 0) return;
+    ep->last_wal_seq = wal_seq;
+    ep->pending += count;
+    if (ep->pending >= ep->commit_every) _om_bus_endpoint_commit(ep);
+}
+
+static inline bool _om_bus_endpoint_epoch_ok(const OmBusEndpoint *ep) {
+    return atomic_load_explicit(&ep->hdr->producer_epoch, memory_order_acquire)
+        == ep->producer_epoch;
+}
+
+/* CLAIM group: drop our hold, then move the shared tail up to the oldest
+ * start still held (the claim cursor if none). Never waits: a batch released
+ * ahead of an older one stays behind that hold, and dropping the oldest hold
+ * moves the tail past both. Every hold that is dropped, claimed or not, ends
+ * here; the store and the loads are seq_cst so of two members dropping at
+ * once, at least one sees the other's hold gone. */
+static void _om_bus_endpoint_unhold(OmBusEndpoint *ep) {
+    OmBusConsumerTail *ct = &ep->tails[ep->consumer_index];
+    atomic_store(&ct->held[ep->claim_slot], OM_BUS_CLAIM_IDLE);
+
+    uint64_t target = atomic_load(&ct->claim);
+    for (uint32_t m = 0; m < OM_BUS_CLAIM_MAX_MEMBERS; m++) {
+        uint64_t h = atomic_load(&ct->held[m]);
+        if (h != OM_BUS_CLAIM_FREE && h != OM_BUS_CLAIM_IDLE && h - 1U < target) {
+            target = h - 1U;
+        }
+    }
+
+    uint64_t prev = atomic_load_explicit(&ct->tail, memory_order_acquire);
+    while (prev < target) {
+        if (atomic_compare_exchange_weak_explicit(&ct->tail, &prev, target,
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            uint64_t cached_min = atomic_load_explicit(&ep->hdr->min_tail,
+                                                       memory_order_acquire);
+            if (prev == cached_min || target < cached_min) {
+                uint64_t mt = _om_bus_min_tail(ep->tails, ep->max_consumers);
+                atomic_store_explicit(&ep->hdr->min_tail, mt, memory_order_release);
+            }
+            break;
+        }
+    }
+}
+
+/* CLAIM group: hand the held batch back and publish progress to the line */
+static void _om_bus_endpoint_release(OmBusEndpoint *ep) {
+    if (!ep->claim_held) return;
+    OmBusConsumerTail *ct = &ep->tails[ep->consumer_index];
+    ep->claim_held = false;
+    _om_bus_atomic_max(&ct->wal_seq, ep->last_wal_seq);
+    atomic_store_explicit(&ct->last_poll_ns, _om_bus_coarse_ns(), memory_order_relaxed);
+    if (ep->timestamps && ep->lat.count) {
+        atomic_store_explicit(&ct->lag_ns, ep->lat_last, memory_order_relaxed);
+        if (ep->lat.max_ns > ep->lat_max_pub) {
+            _om_bus_atomic_max(&ct->lag_max_ns, ep->lat.max_ns);
+            ep->lat_max_pub = ep->lat.max_ns;
+        }
+    }
+    _om_bus_endpoint_unhold(ep);
+}
+
+/* Empty poll: nothing to read, so flush any uncommitted progress (including
+ * PAD skips) — the producer may be waiting on it */
+static inline void _om_bus_endpoint_idle(OmBusEndpoint *ep) {
+    if (ep->group_mode == OM_BUS_GROUP_CLAIM) {
+        _om_bus_endpoint_release(ep);
+    } else if (ep->tail != ep->committed_tail || ep->pending) {
+        _om_bus_endpoint_commit(ep);
+    }
+}
+
+/* CLAIM group: release the previous batch, then claim the next run of up to
+ * max_count ready records from the shared claim cursor. Records inside a
+ * claimed run cannot be overwritten: the shared tail stays <= claim_start
+ * until we release. Payload pointers are zero-copy. */
+static int _om_bus_endpoint_claim(OmBusEndpoint *ep, OmBusRecord *recs,
+                                  size_t max_count) {
+    OmBusConsumerTail *ct = &ep->tails[ep->consumer_index];
+
+    _om_bus_endpoint_release(ep);
+    if (!_om_bus_endpoint_epoch_ok(ep)) return OM_ERR_BUS_EPOCH_CHANGED;
+
+    _Atomic uint64_t *held = &ct->held[ep->claim_slot];
+    bool holding = false;
+    uint64_t start = atomic_load_explicit(&ct->claim, memory_order_acquire);
+    while (1) {
+        /* Empty ring: leave held[] alone, an idle poll stays cheap */
+        if (atomic_load_explicit(&_om_bus_endpoint_slot(ep, start)->seq,
+                                 memory_order_acquire) != start + 1U) {
+            if (holding) _om_bus_endpoint_unhold(ep);
+            return 0;
+        }
+        /* Hold start before claiming it: a release that reads the claim
+         * cursor after our CAS also reads this, so the tail stays <= start */
+        atomic_store_explicit(held, start + 1U, memory_order_release);
+        holding = true;
+        uint64_t pos = start;
+        size_t count = 0;
+        int err = 0;
+        while (count < max_count) {
+            OmBusSlotHeader *slot = _om_bus_endpoint_slot(ep, pos);
+            if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + 1U) {
+                break;
+            }
+            if (slot->slot_flags & OM_BUS_SLOT_FLAG_PAD) {
+                pos += slot->wal_seq;
+                continue;
+            }
+            const void *payload_src = (const char *)slot + ep->hdr_size;
+            if ((ep->flags & OM_BUS_FLAG_CRC) &&
+                _om_bus_crc32(payload_src, slot->payload_len) != slot->crc32) {
+                err = OM_ERR_BUS_CRC_MISMATCH;
+                break;
+            }
+            recs[count].wal_seq = slot->wal_seq;
+            recs[count].wal_type = slot->wal_type;
+            recs[count].payload_len = slot->payload_len;
+            recs[count].payload = payload_src;
+            pos += _om_bus_endpoint_span(ep, slot);
+            count++;
+        }
+
+        if (count == 0 && err) {
+            _om_bus_endpoint_unhold(ep);
+            return err; /* leave the bad record unclaimed */
+        }
+        if (pos == start) {
+            _om_bus_endpoint_unhold(ep);
+            return 0;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(&ct->claim, &start, pos,
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            ep->claim_start = start;
+            ep->tail = pos;
+            ep->claim_held = true;
+            if (count > 0) ep->last_wal_seq = recs[count - 1].wal_seq;
+            /* Claimed slots stay put until release: headers are still ours */
+            if (ep->timestamps && count > 0) {
+                uint64_t now = _om_bus_monotonic_ns();
+                for (size_t i = 0; i < count; i++) {
+                    _om_bus_endpoint_lat(ep, (const OmBusSlotHeader *)
+                        ((const char *)recs[i].payload - ep->hdr_size), now);
+                }
+            }
+            return (int)count;
+        }
+        /* Lost the race: start now holds the current claim cursor */
+    }
+}
+
+/* PARTITION group: does this member deliver rec? */
+static inline bool _om_bus_endpoint_mine(const OmBusEndpoint *ep,
+                                         const OmBusRecord *rec) {
+    if (ep->group_mode != OM_BUS_GROUP_PARTITION) return true;
+    uint32_t key = ep->partition_fn ? ep->partition_fn(rec, ep->partition_ctx)
+                                    : (uint32_t)rec->wal_seq;
+    return key % ep->group_members == ep->member_id;
+}
+
+/* Resume from this index's persisted tail: it is a record boundary, and no
+ * slot in [tail, head) has been reused while head - tail <= capacity. Skip
+ * records up to resume_wal_seq; the rest is delivered with normal gap
+ * detection from resume_wal_seq + 1. */
+static int _om_bus_endpoint_resume(OmBusEndpoint *ep, OmBusConsumerTail *ct,
+                                   uint64_t resume_wal_seq) {
+    uint64_t head = atomic_load_explicit(&ep->hdr->head, memory_order_acquire);
+    uint64_t pos = atomic_load_explicit(&ct->tail, memory_order_acquire);
+    uint64_t done = atomic_load_explicit(&ct->wal_seq, memory_order_acquire);
+    if (pos > head || head - pos > ep->capacity || done > resume_wal_seq) {
+        return OM_ERR_BUS_CURSOR_LOST;
+    }
+    while (pos != head) {
+        OmBusSlotHeader *slot = _om_bus_endpoint_slot(ep, pos);
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + 1U) {
+            return OM_ERR_BUS_CURSOR_LOST;
+        }
+        if (slot->slot_flags & OM_BUS_SLOT_FLAG_PAD) {
+            pos += slot->wal_seq;
+            continue;
+        }
+        if (slot->wal_seq > resume_wal_seq) break;
+        pos += _om_bus_endpoint_span(ep, slot);
+    }
+    /* The producer may have lapped us while we scanned */
+    if (atomic_load_explicit(&ep->hdr->head, memory_order_acquire) - pos > ep->capacity) {
+        return OM_ERR_BUS_CURSOR_LOST;
+    }
+    ep->tail = pos;
+    ep->committed_tail = pos;
+    ep->last_wal_seq = resume_wal_seq;
+    ep->expected_wal_seq = resume_wal_seq + 1U;
+    atomic_store_explicit(&ct->tail, pos, memory_order_release);
+    atomic_store_explicit(&ct->wal_seq, resume_wal_seq, memory_order_release);
+    atomic_store_explicit(&ct->last_poll_ns, _om_bus_coarse_ns(), memory_order_relaxed);
+    return 0;
+}
+
 int om_bus_endpoint_open(OmBusEndpoint **out, const OmBusEndpointConfig *config) {
-    if (!out || !config || !config->stream_name) {
+    if (!out || !config || (!config->stream_name && !config->path)) {
+        return OM_ERR_BUS_INIT;
+    }
+    if (config->resume_wal_seq && config->group_mode == OM_BUS_GROUP_CLAIM) {
         return OM_ERR_BUS_INIT;
     }
 
-    int fd = shm_open(config->stream_name, O_RDWR, 0);
+    int fd = config->path ? open(config->path, O_RDWR)
+                          : shm_open(config->stream_name, O_RDWR, 0);
     if (fd < 0) {
         return OM_ERR_BUS_SHM_OPEN;
     }
@@ -511,14 +1419,22 @@ int om_bus_endpoint_open(OmBusEndpoint **out, const OmBusEndpointConfig *config)
         munmap(map, total);
         return OM_ERR_BUS_MAGIC_MISMATCH;
     }
-    if (hdr->version != OM_BUS_SHM_VERSION) {
+    if (hdr->version != OM_BUS_SHM_VERSION || (hdr->flags & ~OM_BUS_FLAG_KNOWN)) {
         munmap(map, total);
         return OM_ERR_BUS_VERSION_MISMATCH;
     }
+    _om_bus_map_advise(map, total, hdr->map_flags);
+    if (hdr->map_flags & OM_BUS_MAP_PREFAULT) _om_bus_prefault(map, total, false);
     if (config->consumer_index >= hdr->max_consumers) {
         munmap(map, total);
         return OM_ERR_BUS_CONSUMER_ID;
     }
+    if (config->group_mode > OM_BUS_GROUP_PARTITION ||
+        (config->group_mode == OM_BUS_GROUP_PARTITION &&
+         config->member_id >= config->group_members)) {
+        munmap(map, total);
+        return OM_ERR_BUS_INIT;
+    }
 
     OmBusEndpoint *ep = calloc(1, sizeof(*ep));
     if (!ep) {
@@ -537,12 +1453,23 @@ int om_bus_endpoint_open(OmBusEndpoint **out, const OmBusEndpointConfig *config)
     ep->max_consumers = hdr->max_consumers;
     ep->flags = hdr->flags;
     ep->zero_copy = config->zero_copy;
+    ep->varlen = (hdr->flags & OM_BUS_FLAG_VARLEN) != 0;
+    ep->timestamps = (hdr->flags & OM_BUS_FLAG_TIMESTAMP) != 0;
+    ep->hdr_size = _om_bus_hdr_size(hdr->flags);
+    ep->wait_spins = OM_BUS_WAIT_SPIN_DEFAULT;
+    ep->commit_every = config->commit_every ? config->commit_every : 1U;
     ep->expected_wal_seq = 0;
     ep->producer_epoch = atomic_load_explicit(&hdr->producer_epoch,
                                                memory_order_acquire);
+    ep->group_mode = config->group_mode;
+    ep->group_members = config->group_members;
+    ep->member_id = config->member_id;
+    ep->partition_fn = config->partition_fn;
+    ep->partition_ctx = config->partition_ctx;
 
     if (!config->zero_copy) {
-        ep->copy_buf = malloc(hdr->slot_size);
+        ep->copy_buf = malloc(_om_bus_max_payload(hdr->capacity, hdr->slot_size,
+                                                  hdr->flags));
         if (!ep->copy_buf) {
             munmap(map, total);
             free(ep);
@@ -551,11 +1478,54 @@ int om_bus_endpoint_open(OmBusEndpoint **out, const OmBusEndpointConfig *config)
     }
 
     /* Initialize consumer tail to current head (start from live position) */
+    OmBusConsumerTail *ct = &ep->tails[config->consumer_index];
     uint64_t cur_head = atomic_load_explicit(&hdr->head, memory_order_acquire);
-    atomic_store_explicit(&ep->tails[config->consumer_index].tail,
-                          cur_head, memory_order_release);
-    atomic_store_explicit(&ep->tails[config->consumer_index].wal_seq,
-                          0U, memory_order_release);
+    if (config->group_mode == OM_BUS_GROUP_CLAIM) {
+        /* First member (or a group the ring has lapped) starts the shared
+         * cursor at the live head; later members join where the group is. */
+        uint32_t prev = atomic_fetch_add_explicit(&ct->members, 1U,
+                                                  memory_order_acq_rel);
+        uint32_t slot = 0;
+        while (slot < OM_BUS_CLAIM_MAX_MEMBERS) {
+            uint64_t free_val = OM_BUS_CLAIM_FREE;
+            if (atomic_compare_exchange_strong(&ct->held[slot], &free_val,
+                                               OM_BUS_CLAIM_IDLE)) {
+                break;
+            }
+            slot++;
+        }
+        if (slot == OM_BUS_CLAIM_MAX_MEMBERS) {
+            atomic_fetch_sub_explicit(&ct->members, 1U, memory_order_acq_rel);
+            free(ep->copy_buf);
+            munmap(map, total);
+            free(ep);
+            return OM_ERR_BUS_INIT;
+        }
+        ep->claim_slot = slot;
+        uint64_t c = atomic_load_explicit(&ct->claim, memory_order_acquire);
+        if ((prev == 0U || cur_head - c > ep->capacity) &&
+            atomic_compare_exchange_strong_explicit(&ct->claim, &c, cur_head,
+                                                    memory_order_acq_rel,
+                                                    memory_order_acquire)) {
+            atomic_store_explicit(&ct->tail, cur_head, memory_order_release);
+            atomic_store_explicit(&ct->wal_seq, 0U, memory_order_release);
+        }
+        ep->tail = atomic_load_explicit(&ct->claim, memory_order_acquire);
+        ep->committed_tail = ep->tail;
+    } else if (config->resume_wal_seq) {
+        int rc = _om_bus_endpoint_resume(ep, ct, config->resume_wal_seq);
+        if (rc != 0) {
+            free(ep->copy_buf);
+            munmap(map, total);
+            free(ep);
+            return rc;
+        }
+    } else {
+        ep->tail = cur_head;
+        ep->committed_tail = cur_head;
+        atomic_store_explicit(&ct->tail, cur_head, memory_order_release);
+        atomic_store_explicit(&ct->wal_seq, 0U, memory_order_release);
+    }
 
     *out = ep;
     return 0;
@@ -564,75 +1534,189 @@ int om_bus_endpoint_open(OmBusEndpoint **out, const OmBusEndpointConfig *config)
 int om_bus_endpoint_poll(OmBusEndpoint *ep, OmBusRecord *rec) {
     if (!ep || !rec) return OM_ERR_BUS_INIT;
 
-    /* Epoch check: detect producer restart */
-    uint64_t epoch = atomic_load_explicit(&ep->hdr->producer_epoch,
-                                           memory_order_acquire);
-    if (epoch != ep->producer_epoch) return OM_ERR_BUS_EPOCH_CHANGED;
+    if (ep->group_mode == OM_BUS_GROUP_CLAIM) {
+        int n = _om_bus_endpoint_claim(ep, rec, 1);
+        if (n == 1 && !ep->zero_copy) {
+            memcpy(ep->copy_buf, rec->payload, rec->payload_len);
+            rec->payload = ep->copy_buf;
+        }
+        return n;
+    }
 
-    uint64_t tail = atomic_load_explicit(
-        &ep->tails[ep->consumer_index].tail, memory_order_relaxed);
-    uint64_t idx = tail & ep->mask;
+    /* Epoch check: detect producer restart. With commit_every > 1 it runs
+     * once per commit window (and on every empty poll) instead of per record. */
+    bool epoch_checked = (ep->pending == 0);
+    if (epoch_checked && !_om_bus_endpoint_epoch_ok(ep)) {
+        return OM_ERR_BUS_EPOCH_CHANGED;
+    }
 
-    OmBusSlotHeader *slot = (OmBusSlotHeader *)_om_bus_slot(
-        ep->map, ep->max_consumers, ep->slot_size, idx);
+    while (1) {
+        uint64_t tail = ep->tail;
+        OmBusSlotHeader *slot = _om_bus_endpoint_slot(ep, tail);
+
+        /* Check if slot is ready */
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != tail + 1U) {
+            _om_bus_endpoint_idle(ep);
+            if (!epoch_checked && !_om_bus_endpoint_epoch_ok(ep)) {
+                return OM_ERR_BUS_EPOCH_CHANGED;
+            }
+            return 0; /* empty */
+        }
 
-    /* Check if slot is ready */
-    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != tail + 1U) {
-        return 0; /* empty */
-    }
+        /* VARLEN: skip PAD run at ring end */
+        if (slot->slot_flags & OM_BUS_SLOT_FLAG_PAD) {
+            ep->tail = tail + slot->wal_seq;
+            continue;
+        }
 
-    /* Read header fields */
-    rec->wal_seq = slot->wal_seq;
-    rec->wal_type = slot->wal_type;
-    rec->payload_len = slot->payload_len;
+        /* Read header fields */
+        rec->wal_seq = slot->wal_seq;
+        rec->wal_type = slot->wal_type;
+        rec->payload_len = slot->payload_len;
 
-    const void *payload_src = (const char *)slot + OM_BUS_SLOT_HEADER_SIZE;
+        const void *payload_src = (const char *)slot + ep->hdr_size;
 
-    /* CRC check */
-    if (ep->flags & OM_BUS_FLAG_CRC) {
-        uint32_t computed = _om_bus_crc32(payload_src, slot->payload_len);
-        if (computed != slot->crc32) {
-            return OM_ERR_BUS_CRC_MISMATCH;
+        /* CRC check */
+        if (ep->flags & OM_BUS_FLAG_CRC) {
+            uint32_t computed = _om_bus_crc32(payload_src, slot->payload_len);
+            if (computed != slot->crc32) {
+                return OM_ERR_BUS_CRC_MISMATCH;
+            }
         }
-    }
 
-    /* Deliver payload */
-    if (ep->zero_copy) {
+        /* Gap / reorder detection (over every record, delivered or not) */
+        int result = 1;
+        if (ep->expected_wal_seq > 0 && rec->wal_seq != ep->expected_wal_seq) {
+            if (rec->wal_seq > ep->expected_wal_seq) {
+                result = OM_ERR_BUS_GAP_DETECTED;
+            } else if (ep->flags & OM_BUS_FLAG_REJECT_REORDER) {
+                result = OM_ERR_BUS_REORDER_DETECTED;
+            }
+        }
+        ep->expected_wal_seq = rec->wal_seq + 1;
+
+        /* Advance tail */
+        _om_bus_endpoint_advance(ep, tail + _om_bus_endpoint_span(ep, slot),
+                                 rec->wal_seq, 1U);
+
+        /* PARTITION: skip other members' records; report a gap seen on a
+         * skipped record with the next record we do deliver */
         rec->payload = payload_src;
-    } else {
-        memcpy(ep->copy_buf, payload_src, slot->payload_len);
-        rec->payload = ep->copy_buf;
-    }
+        if (!_om_bus_endpoint_mine(ep, rec)) {
+            if (result != 1) ep->gap_pending = result;
+            continue;
+        }
+        if (result == 1 && ep->gap_pending) {
+            result = ep->gap_pending;
+        }
+        ep->gap_pending = 0;
+        if (ep->timestamps) _om_bus_endpoint_lat(ep, slot, _om_bus_monotonic_ns());
 
-    /* Gap / reorder detection */
-    int result = 1;
-    if (ep->expected_wal_seq > 0 && rec->wal_seq != ep->expected_wal_seq) {
-        if (rec->wal_seq > ep->expected_wal_seq) {
-            result = OM_ERR_BUS_GAP_DETECTED;
-        } else if (ep->flags & OM_BUS_FLAG_REJECT_REORDER) {
-            result = OM_ERR_BUS_REORDER_DETECTED;
+        /* Deliver payload */
+        if (!ep->zero_copy) {
+            memcpy(ep->copy_buf, payload_src, rec->payload_len);
+            rec->payload = ep->copy_buf;
         }
+        return result;
     }
-    ep->expected_wal_seq = rec->wal_seq + 1;
+}
 
-    /* Advance tail */
-    uint64_t prev_tail = tail;
-    uint64_t new_tail = tail + 1U;
-    atomic_store_explicit(&ep->tails[ep->consumer_index].tail,
-                          new_tail, memory_order_release);
-    atomic_store_explicit(&ep->tails[ep->consumer_index].wal_seq,
-                          rec->wal_seq, memory_order_release);
-    atomic_store_explicit(&ep->tails[ep->consumer_index].last_poll_ns,
-                          _om_bus_monotonic_ns(), memory_order_relaxed);
+/* Batch scan. One acquire load of head per batch: the producer stores head
+ * after the slot seqs it covers, so slots below the snapshot need no per-slot
+ * check; past it (a publish_batch still in flight) fall back to the slot seq.
+ * Prefetch (ENABLE_PREFETCH builds) stays below the snapshot so it never
+ * pulls a line the producer is still writing. Payloads point into the mmap
+ * (zero-copy): records are not released before _om_bus_iter_finish publishes
+ * the tail. */
+#define OM_BUS_PREFETCH_SLOTS 4U
+
+#if defined(OM_ENABLE_PREFETCH) && (defined(__GNUC__) || defined(__clang__))
+#define OM_BUS_PREFETCH(ptr) __builtin_prefetch((ptr))
+#else
+#define OM_BUS_PREFETCH(ptr) ((void)0)
+#endif
 
-    /* Refresh min_tail if we were the minimum */
-    uint64_t cached_min = atomic_load_explicit(&ep->hdr->min_tail, memory_order_acquire);
-    if (prev_tail == cached_min || new_tail < cached_min) {
-        uint64_t mt = _om_bus_min_tail(ep->tails, ep->max_consumers);
-        atomic_store_explicit(&ep->hdr->min_tail, mt, memory_order_release);
+static inline void _om_bus_iter_init(OmBusEndpoint *ep, OmBusBatchIter *it,
+                                     size_t max_count, bool epoch_checked) {
+    it->ep = ep;
+    it->tail = ep->tail;
+    it->head = atomic_load_explicit(&ep->hdr->head, memory_order_acquire);
+    /* Lapped or restarted under us: trust only the slot seqs */
+    if (it->head - it->tail > ep->capacity) it->head = it->tail;
+    it->last_seq = 0;
+    it->now = 0;
+    it->left = max_count > UINT32_MAX ? UINT32_MAX : (uint32_t)max_count;
+    it->seen = 0;
+    it->count = 0;
+    it->err = 0;
+    it->epoch_checked = epoch_checked;
+}
+
+static inline int _om_bus_iter_next(OmBusBatchIter *it, OmBusRecord *rec) {
+    OmBusEndpoint *ep = it->ep;
+
+    while (it->left > 0) {
+        uint64_t tail = it->tail;
+        OmBusSlotHeader *slot = _om_bus_endpoint_slot(ep, tail);
+
+        if (tail >= it->head) {
+            if (atomic_load_explicit(&slot->seq, memory_order_acquire) != tail + 1U) {
+                break;
+            }
+        } else if (tail + OM_BUS_PREFETCH_SLOTS < it->head) {
+            OM_BUS_PREFETCH(_om_bus_endpoint_slot(ep, tail + OM_BUS_PREFETCH_SLOTS));
+        }
+        if (slot->slot_flags & OM_BUS_SLOT_FLAG_PAD) {
+            it->tail = tail + slot->wal_seq;
+            continue;
+        }
+
+        const void *payload_src = (const char *)slot + ep->hdr_size;
+        if ((ep->flags & OM_BUS_FLAG_CRC) &&
+            _om_bus_crc32(payload_src, slot->payload_len) != slot->crc32) {
+            it->err = OM_ERR_BUS_CRC_MISMATCH; /* stop before the bad record */
+            break;
+        }
+
+        rec->wal_seq = slot->wal_seq;
+        rec->wal_type = slot->wal_type;
+        rec->payload_len = slot->payload_len;
+        rec->payload = payload_src;
+
+        it->tail = tail + _om_bus_endpoint_span(ep, slot);
+        it->last_seq = rec->wal_seq;
+        it->seen++;
+        if (!_om_bus_endpoint_mine(ep, rec)) continue;
+        if (ep->timestamps) {
+            if (it->now == 0) it->now = _om_bus_monotonic_ns();
+            _om_bus_endpoint_lat(ep, slot, it->now);
+        }
+        it->left--;
+        it->count++;
+        return 1;
     }
+    it->left = 0;
+    return 0;
+}
+
+/* Single tail / wal_seq publish for the whole batch (min_tail is refreshed
+ * by that commit, so once per batch too) */
+static inline int _om_bus_iter_finish(OmBusBatchIter *it) {
+    OmBusEndpoint *ep = it->ep;
 
-    return result;
+    if (it->seen > 0) {
+        ep->expected_wal_seq = it->last_seq + 1U;
+        _om_bus_endpoint_advance(ep, it->tail, it->last_seq, it->seen);
+    }
+    if (it->count == 0) {
+        if (it->seen == 0) ep->tail = it->tail;
+        _om_bus_endpoint_idle(ep);
+        if (!it->epoch_checked && !_om_bus_endpoint_epoch_ok(ep)) {
+            return OM_ERR_BUS_EPOCH_CHANGED;
+        }
+        if (it->err) return it->err;
+    }
+    return (int)it->count;
 }
 
 int om_bus_endpoint_poll_batch(OmBusEndpoint *ep, OmBusRecord *recs,
@@ -640,80 +1724,161 @@ int om_bus_endpoint_poll_batch(OmBusEndpoint *ep, OmBusRecord *recs,
     if (!ep || !recs) return OM_ERR_BUS_INIT;
     if (max_count == 0) return 0;
 
+    if (ep->group_mode == OM_BUS_GROUP_CLAIM) {
+        return _om_bus_endpoint_claim(ep, recs, max_count);
+    }
+
     /* Epoch check */
-    uint64_t epoch = atomic_load_explicit(&ep->hdr->producer_epoch,
-                                           memory_order_acquire);
-    if (epoch != ep->producer_epoch) return OM_ERR_BUS_EPOCH_CHANGED;
+    bool epoch_checked = (ep->pending == 0);
+    if (epoch_checked && !_om_bus_endpoint_epoch_ok(ep)) {
+        return OM_ERR_BUS_EPOCH_CHANGED;
+    }
 
-    uint64_t tail = atomic_load_explicit(
-        &ep->tails[ep->consumer_index].tail, memory_order_relaxed);
-    size_t count = 0;
+    /* Batch forces zero_copy semantics: there is one copy buffer, so payload
+     * pointers stay in the mmap and the caller must process them before the
+     * producer wraps */
+    OmBusBatchIter it;
+    _om_bus_iter_init(ep, &it, max_count, epoch_checked);
+    while (_om_bus_iter_next(&it, &recs[it.count])) {
+    }
+    return _om_bus_iter_finish(&it);
+}
 
-    while (count < max_count) {
-        uint64_t idx = (tail + count) & ep->mask;
+int om_bus_endpoint_iter_begin(OmBusEndpoint *ep, OmBusBatchIter *it,
+                               size_t max_count) {
+    if (!ep || !it || ep->group_mode == OM_BUS_GROUP_CLAIM) return OM_ERR_BUS_INIT;
 
-        OmBusSlotHeader *slot = (OmBusSlotHeader *)_om_bus_slot(
-            ep->map, ep->max_consumers, ep->slot_size, idx);
+    bool epoch_checked = (ep->pending == 0);
+    if (epoch_checked && !_om_bus_endpoint_epoch_ok(ep)) {
+        return OM_ERR_BUS_EPOCH_CHANGED;
+    }
+    _om_bus_iter_init(ep, it, max_count, epoch_checked);
+    return 0;
+}
 
-        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != tail + count + 1U) {
-            break;
-        }
+int om_bus_endpoint_iter_next(OmBusBatchIter *it, OmBusRecord *rec) {
+    if (!it || !it->ep || !rec) return 0;
+    return _om_bus_iter_next(it, rec);
+}
 
-        recs[count].wal_seq = slot->wal_seq;
-        recs[count].wal_type = slot->wal_type;
-        recs[count].payload_len = slot->payload_len;
+int om_bus_endpoint_iter_end(OmBusBatchIter *it) {
+    if (!it || !it->ep) return OM_ERR_BUS_INIT;
+    int rc = _om_bus_iter_finish(it);
+    it->ep = NULL;
+    return rc;
+}
 
-        const void *payload_src = (const char *)slot + OM_BUS_SLOT_HEADER_SIZE;
+int om_bus_endpoint_wait(OmBusEndpoint *ep, uint64_t timeout_ns) {
+    if (!ep) return OM_ERR_BUS_INIT;
 
-        if (ep->flags & OM_BUS_FLAG_CRC) {
-            uint32_t computed = _om_bus_crc32(payload_src, slot->payload_len);
-            if (computed != slot->crc32) {
-                break; /* stop batch on CRC error */
-            }
-        }
+    OmBusShmHeader *hdr = ep->hdr;
+    uint64_t tail = (ep->group_mode == OM_BUS_GROUP_CLAIM)
+        ? atomic_load_explicit(&ep->tails[ep->consumer_index].claim, memory_order_acquire)
+        : ep->tail;
 
-        if (ep->zero_copy) {
-            recs[count].payload = payload_src;
-        } else {
-            /* For batch, each record needs its own copy area.
-             * We only have one copy buffer, so batch forces zero_copy semantics
-             * for the payload pointer (points into mmap). Caller must process
-             * before the producer wraps. */
-            recs[count].payload = payload_src;
+    if (atomic_load_explicit(&hdr->producer_epoch, memory_order_acquire)
+        != ep->producer_epoch) {
+        return OM_ERR_BUS_EPOCH_CHANGED;
+    }
+    if (atomic_load_explicit(&hdr->head, memory_order_acquire) != tail) return 1;
+    if (timeout_ns == 0) return 0;
+
+    /* About to idle: make local progress visible to the producer */
+    _om_bus_endpoint_idle(ep);
+
+    /* Phase 1: spin. Budget doubles when data shows up while spinning and
+     * halves when we end up sleeping, so bursty streams stay in user space
+     * and idle streams stop burning the core quickly. */
+    for (uint32_t i = 0; i < ep->wait_spins; i++) {
+        _om_bus_cpu_relax();
+        if (atomic_load_explicit(&hdr->head, memory_order_acquire) != tail) {
+            if (ep->wait_spins < OM_BUS_WAIT_SPIN_MAX) ep->wait_spins <<= 1;
+            return 1;
         }
-
-        count++;
     }
+    if (ep->wait_spins > OM_BUS_WAIT_SPIN_MIN) ep->wait_spins >>= 1;
 
-    if (count > 0) {
-        uint64_t prev_tail = tail;
-        uint64_t new_tail = tail + count;
-        ep->expected_wal_seq = recs[count - 1].wal_seq + 1U;
-        atomic_store_explicit(&ep->tails[ep->consumer_index].tail,
-                              new_tail, memory_order_release);
-        atomic_store_explicit(&ep->tails[ep->consumer_index].wal_seq,
-                              recs[count - 1].wal_seq, memory_order_release);
+    /* Phase 2: sleep on the head futex */
+    uint64_t start = _om_bus_monotonic_ns();
+    while (1) {
+        atomic_fetch_add_explicit(&hdr->waiters, 1U, memory_order_seq_cst);
+        uint64_t head = atomic_load_explicit(&hdr->head, memory_order_seq_cst);
+        if (head == tail) {
+            uint64_t elapsed = _om_bus_monotonic_ns() - start;
+            uint64_t remaining = (elapsed < timeout_ns) ? timeout_ns - elapsed : 0U;
+            if (remaining > 0) _om_bus_futex_wait(&hdr->head, head, remaining);
+        }
+        atomic_fetch_sub_explicit(&hdr->waiters, 1U, memory_order_relaxed);
+        /* Heartbeat: a sleeping consumer is idle, not stale */
         atomic_store_explicit(&ep->tails[ep->consumer_index].last_poll_ns,
-                              _om_bus_monotonic_ns(), memory_order_relaxed);
+                              _om_bus_coarse_ns(), memory_order_relaxed);
 
-        uint64_t cached_min = atomic_load_explicit(&ep->hdr->min_tail, memory_order_acquire);
-        if (prev_tail == cached_min || new_tail < cached_min) {
-            uint64_t mt = _om_bus_min_tail(ep->tails, ep->max_consumers);
-            atomic_store_explicit(&ep->hdr->min_tail, mt, memory_order_release);
+        if (atomic_load_explicit(&hdr->head, memory_order_acquire) != tail) return 1;
+        if (atomic_load_explicit(&hdr->producer_epoch, memory_order_acquire)
+            != ep->producer_epoch) {
+            return OM_ERR_BUS_EPOCH_CHANGED;
+        }
+        if (timeout_ns != OM_BUS_WAIT_FOREVER &&
+            _om_bus_monotonic_ns() - start >= timeout_ns) {
+            return 0;
         }
     }
+}
+
+void om_bus_endpoint_flush(OmBusEndpoint *ep) {
+    if (!ep) return;
+    if (ep->group_mode == OM_BUS_GROUP_CLAIM) {
+        _om_bus_endpoint_release(ep);
+    } else {
+        _om_bus_endpoint_commit(ep);
+    }
+}
 
-    return (int)count;
+void om_bus_endpoint_latency(const OmBusEndpoint *ep, OmBusLatencyStats *out) {
+    if (!out) return;
+    if (!ep) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    *out = ep->lat;
+}
+
+uint64_t om_bus_latency_percentile(const OmBusLatencyStats *st, double q) {
+    if (!st || st->count == 0) return 0;
+    if (q < 0.0) q = 0.0;
+    if (q > 1.0) q = 1.0;
+    /* Rank of the q-quantile record, 1-based */
+    uint64_t rank = (uint64_t)(q * (double)st->count);
+    if ((double)rank < q * (double)st->count || rank == 0) rank++;
+    if (rank > st->count) rank = st->count;
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < OM_BUS_LAT_BUCKETS; b++) {
+        seen += st->buckets[b];
+        if (seen >= rank) {
+            uint64_t upper = (b + 1U < 64U) ? (2ULL << b) - 1U : UINT64_MAX;
+            return upper < st->max_ns ? upper : st->max_ns;
+        }
+    }
+    return st->max_ns;
 }
 
 uint64_t om_bus_endpoint_wal_seq(const OmBusEndpoint *ep) {
     if (!ep) return 0;
-    return atomic_load_explicit(&ep->tails[ep->consumer_index].wal_seq,
-                                memory_order_acquire);
+    return ep->last_wal_seq;
+}
+
+uint64_t om_bus_endpoint_epoch(const OmBusEndpoint *ep) {
+    return ep ? ep->producer_epoch : 0U;
 }
 
 void om_bus_endpoint_close(OmBusEndpoint *ep) {
     if (!ep) return;
+    _om_bus_endpoint_idle(ep);
+    if (ep->group_mode == OM_BUS_GROUP_CLAIM) {
+        OmBusConsumerTail *ct = &ep->tails[ep->consumer_index];
+        atomic_store(&ct->held[ep->claim_slot], OM_BUS_CLAIM_FREE);
+        atomic_fetch_sub_explicit(&ct->members, 1U, memory_order_acq_rel);
+    }
     free(ep->copy_buf);
     if (ep->map && ep->map != MAP_FAILED) {
         munmap(ep->map, ep->map_size);
@@ -728,8 +1893,7 @@ void om_bus_endpoint_close(OmBusEndpoint *ep) {
 int om_bus_endpoint_save_cursor(const OmBusEndpoint *ep, const char *path) {
     if (!ep || !path) return OM_ERR_BUS_INIT;
 
-    uint64_t wal_seq = atomic_load_explicit(&ep->tails[ep->consumer_index].wal_seq,
-                                             memory_order_relaxed);
+    uint64_t wal_seq = ep->last_wal_seq;
 
     uint8_t buf[16];
     uint32_t magic = OM_BUS_CURSOR_MAGIC;
@@ -772,3 +1936,98 @@ int om_bus_endpoint_load_cursor(const char *path, uint64_t *wal_seq_out) {
     *wal_seq_out = wal_seq;
     return 0;
 }
+
+/* ============================================================================
+ * OmBusMonitor — read-only consumer gauges
+ * ============================================================================ */
+
+struct OmBusMonitor {
+    void *map;                  /* header page + consumer lines, PROT_READ */
+    size_t map_size;
+    OmBusShmHeader *hdr;
+    OmBusConsumerTail *tails;
+    uint32_t max_consumers;
+};
+
+int om_bus_monitor_open(OmBusMonitor **out, const char *stream_name) {
+    if (!out || !stream_name) return OM_ERR_BUS_INIT;
+
+    /* A name with a '/' past the first character is a file-backed ring */
+    int fd = strchr(stream_name + 1, '/') ? open(stream_name, O_RDONLY)
+                                          : shm_open(stream_name, O_RDONLY, 0);
+    if (fd < 0) return OM_ERR_BUS_SHM_OPEN;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)OM_BUS_HEADER_PAGE) {
+        close(fd);
+        return OM_ERR_BUS_SHM_OPEN;
+    }
+    OmBusShmHeader probe;
+    if (pread(fd, &probe, sizeof(probe), 0) != (ssize_t)sizeof(probe)) {
+        close(fd);
+        return OM_ERR_BUS_SHM_OPEN;
+    }
+    if (probe.magic != OM_BUS_SHM_MAGIC) {
+        close(fd);
+        return OM_ERR_BUS_MAGIC_MISMATCH;
+    }
+    if (probe.version != OM_BUS_SHM_VERSION) {
+        close(fd);
+        return OM_ERR_BUS_VERSION_MISMATCH;
+    }
+
+    /* The slots are never touched: map only what the gauges live in, in
+     * whole huge pages on hugetlbfs (munmap of a partial one fails) */
+    size_t total = OM_BUS_HEADER_PAGE
+                 + (size_t)probe.max_consumers * OM_BUS_CONSUMER_ALIGN;
+    size_t huge = _om_bus_hugetlb_page(fd);
+    if (huge) total = (total + huge - 1U) & ~(huge - 1U);
+    if ((size_t)st.st_size < total) {
+        close(fd);
+        return OM_ERR_BUS_SHM_OPEN;
+    }
+    void *map = mmap(NULL, total, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return OM_ERR_BUS_SHM_MAP;
+
+    OmBusMonitor *mon = calloc(1, sizeof(*mon));
+    if (!mon) {
+        munmap(map, total);
+        return OM_ERR_BUS_INIT;
+    }
+    mon->map = map;
+    mon->map_size = total;
+    mon->hdr = (OmBusShmHeader *)map;
+    mon->tails = _om_bus_consumer_tails(map);
+    mon->max_consumers = probe.max_consumers;
+    *out = mon;
+    return 0;
+}
+
+uint32_t om_bus_monitor_consumers(const OmBusMonitor *mon) {
+    return mon ? mon->max_consumers : 0U;
+}
+
+int om_bus_monitor_read(const OmBusMonitor *mon, uint32_t consumer_index,
+                        OmBusConsumerLag *out) {
+    if (!mon || !out) return OM_ERR_BUS_INIT;
+    if (consumer_index >= mon->max_consumers) return OM_ERR_BUS_CONSUMER_ID;
+
+    OmBusConsumerTail *ct = &mon->tails[consumer_index];
+    uint64_t head = atomic_load_explicit(&mon->hdr->head, memory_order_acquire);
+    out->tail = atomic_load_explicit(&ct->tail, memory_order_acquire);
+    out->lag_slots = head > out->tail ? head - out->tail : 0U;
+    out->wal_seq = atomic_load_explicit(&ct->wal_seq, memory_order_acquire);
+    out->last_poll_ns = atomic_load_explicit(&ct->last_poll_ns, memory_order_relaxed);
+    out->lag_ns = atomic_load_explicit(&ct->lag_ns, memory_order_relaxed);
+    out->lag_max_ns = atomic_load_explicit(&ct->lag_max_ns, memory_order_relaxed);
+    return 0;
+}
+
+void om_bus_monitor_close(OmBusMonitor *mon) {
+    if (!mon) return;
+    if (mon->map && mon->map != MAP_FAILED) {
+        munmap(mon->map, mon->map_size);
+    }
+    free(mon);
+}
@@ -11,10 +11,23 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <arpa/inet.h>
 #include <time.h>
 #include <unistd.h>
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#define OM_TCP_URING 1
+#endif
+#endif
+
 #include "ombus/om_bus_tcp.h"
 
 /* ============================================================================
@@ -30,11 +43,55 @@
 #define OM_TCP_DEFAULT_MAX_CLIENTS   64U
 #define OM_TCP_DEFAULT_SEND_BUF_SIZE (256U * 1024U)
 #define OM_TCP_DEFAULT_RECV_BUF_SIZE (256U * 1024U)
+#define OM_TCP_DEFAULT_RING_SIZE     (4U * 1024U * 1024U)
+#define OM_TCP_LISTEN_TAG            UINT32_MAX  /* epoll data for listen fd */
+#define OM_TCP_CTRL_BUF_SIZE         256U        /* client -> server control frames */
+#define OM_TCP_BATCH_BODY_MAX        UINT16_MAX  /* BATCH body (raw) bytes */
+#define OM_TCP_LZ_HASH_BITS          12U
+#define OM_TCP_LZ_MIN_MATCH          4U
+#define OM_TCP_CAPS_ALL              (OM_BUS_TCP_CAP_BATCH | OM_BUS_TCP_CAP_LZ)
+#define OM_TCP_SKIP_FRAME_SIZE       (OM_BUS_TCP_FRAME_HEADER_SIZE + 8U)
+#define OM_TCP_PRODUCT_WORDS         ((UINT16_MAX + 1U) / 64U)  /* filter bitmap */
+#define OM_TCP_SKIP_FLUSH_MS         50U         /* idle SKIP report interval */
+#define OM_TCP_REPLAY_SCAN_BUDGET    1024U       /* catch-up records examined per fill */
+
+/* io_uring user_data: op << 56 | slot generation << 32 | slot index */
+#define OM_TCP_IO_ACCEPT             1U
+#define OM_TCP_IO_POLL               2U
+#define OM_TCP_IO_SEND               3U
+#define OM_TCP_IO_REMOVE             4U
+#define OM_TCP_IO_READ               5U
+#define OM_TCP_IO_TAG(op, gen, idx)  (((uint64_t)(op) << 56) | \
+                                      ((uint64_t)((gen) & 0xFFFFFFU) << 32) | (uint32_t)(idx))
 
 /* ============================================================================
  * Internal structures
  * ============================================================================ */
 
+#ifdef OM_TCP_URING
+/* Minimal io_uring over raw syscalls (no liburing): SQ/CQ rings mapped once,
+ * completions read straight from shared memory */
+typedef struct OmTcpUring {
+    int                  fd;
+    uint32_t             sq_entries;
+    uint32_t            *sq_head;
+    uint32_t            *sq_tail;
+    uint32_t            *sq_mask;
+    uint32_t            *sq_array;
+    uint32_t            *sq_flags;     /* IORING_SQ_CQ_OVERFLOW */
+    uint32_t             sq_local;     /* tail incl. SQEs not yet published */
+    uint32_t             sq_pending;   /* prepared since the last enter */
+    struct io_uring_sqe *sqes;
+    uint32_t            *cq_head;
+    uint32_t            *cq_tail;
+    uint32_t            *cq_mask;
+    struct io_uring_cqe *cqes;
+    void                *ring_map;
+    size_t               ring_len;
+    size_t               sqes_len;
+} OmTcpUring;
+#endif
+
 typedef struct OmBusTcpClientSlot {
     int      fd;                /* -1 = unused */
     uint8_t *send_buf;
@@ -42,6 +99,42 @@ typedef struct OmBusTcpClientSlot {
     uint32_t send_used;         /* total bytes pending (offset + unsent) */
     uint32_t send_offset;       /* bytes already flushed */
     bool     disconnect_pending;
+    /* SHARED mode */
+    uint64_t ring_off;          /* next ring byte to send (absolute) */
+    bool     writable;          /* last EPOLLOUT edge not yet consumed by EAGAIN */
+    bool     slow;              /* lag exceeded: final flush + warning, then close */
+    /* Control frames from the client (HELLO) */
+    uint32_t caps;              /* negotiated OM_BUS_TCP_CAP_* */
+    uint32_t ctrl_len;
+    uint8_t  ctrl_buf[OM_TCP_CTRL_BUF_SIZE];
+    /* RESEND catch-up: history frames are copied into send_buf (SHARED
+     * slots allocate one on first use); live frames are withheld meanwhile */
+    bool     resend_pending;    /* SHARED: start once ring_off reaches the head */
+    bool     replaying;
+    bool     src_used;          /* history_src already consulted */
+    bool     src_held;          /* src_rec fetched but not yet sent */
+    uint64_t replay_seq;        /* next seq owed to the client */
+    uint64_t replay_pos;        /* next history entry */
+    void    *src_cursor;
+    OmBusRecord src_rec;
+    /* SUBSCRIBE filter: a run of withheld seqs [skip_from, skip_to) is
+     * reported by one SKIP frame ahead of the next frame sent */
+    bool     filtered;
+    bool     skipping;
+    bool     sub_any;           /* staged set has ids */
+    uint64_t type_mask;
+    uint64_t *products;         /* product bitmap (NULL = every product) */
+    uint64_t *sub_stage;        /* set still arriving (FLAG_MORE frames) */
+    uint64_t skip_from;
+    uint64_t skip_to;
+    /* URING mode: completions carry io_gen so stale ones from a previous
+     * client of this slot are dropped; send_buf is not compacted while a
+     * SEND is in flight. A slot closed under a SEND is parked (io_closing)
+     * with its send_buf until that SEND completes. */
+    uint32_t io_gen;
+    uint32_t io_sending;        /* bytes in the SEND in flight (0 = none) */
+    bool     io_polled;         /* multishot poll armed */
+    bool     io_closing;        /* closed; SEND still reads send_buf */
 } OmBusTcpClientSlot;
 
 struct OmBusTcpServer {
@@ -53,6 +146,48 @@ struct OmBusTcpServer {
     uint32_t             client_count;
     uint32_t             send_buf_size;
     uint16_t             port;         /* actual bound port */
+    /* SHARED mode: one copy per frame, per-client offsets */
+    uint32_t             mode;
+    int                  epfd;
+    uint8_t             *ring;
+    uint32_t             ring_size;    /* power of two */
+    uint32_t             max_lag;
+    uint64_t             ring_head;    /* absolute bytes written */
+#ifdef __linux__
+    struct epoll_event  *events;
+#endif
+#ifdef OM_TCP_URING
+    OmTcpUring           uring;        /* URING mode (fd -1 otherwise) */
+    bool                 accept_armed; /* multishot accept outstanding */
+#endif
+    uint64_t             stats_max_client_lag;
+    /* BATCH encoding: one frame stream per format, built once per call */
+    uint32_t             caps;
+    uint8_t             *enc[3];       /* [0] plain, [1] LZ, [2] one filtered view */
+    uint32_t             enc_cap[3];
+    uint8_t             *lz_scratch;   /* compressor output */
+    uint16_t            *lz_table;     /* compressor hash -> position */
+    uint64_t             stats_batch_frames;
+    uint64_t             stats_lz_bytes_saved;
+    /* RESEND history: plain frames in a byte ring, indexed by entry */
+    uint8_t             *hist;
+    uint32_t             hist_size;    /* power of two */
+    uint64_t             hist_head;    /* absolute bytes written */
+    uint64_t            *hist_off;     /* entry -> absolute offset */
+    uint64_t             hist_mask;    /* index ring: hist_size / 16 entries */
+    uint64_t             hist_lo;      /* oldest intact entry */
+    uint64_t             hist_n;       /* entries appended */
+    OmBusTcpHistorySource history_src;
+    uint64_t             stats_resend_requests;
+    uint64_t             stats_records_replayed;
+    /* SUBSCRIBE filters: per-call scratch for one slot's view */
+    OmBusTcpProductFn    product_of;
+    OmBusRecord         *flt_recs;     /* 2 × flt_cap: records + SKIP markers */
+    uint64_t            *flt_marks;    /* SKIP payloads (seq after the run) */
+    int                 *flt_prod;     /* product of each input record */
+    uint32_t             flt_cap;
+    uint64_t             skip_flush_ms;
+    uint64_t             stats_records_filtered;
     /* Stats counters */
     uint64_t             stats_records_broadcast;
     uint64_t             stats_bytes_broadcast;
@@ -70,12 +205,35 @@ struct OmBusTcpClient {
     uint32_t flags;             /* OM_BUS_FLAG_REJECT_REORDER, etc. */
     uint64_t expected_wal_seq;
     uint64_t last_wal_seq;
+    /* BATCH frame being unpacked; stays at recv_offset until exhausted */
+    bool     resync;            /* RESEND sent: drop frames until the ack */
+    bool     connecting;        /* async connect still in progress */
+    bool     in_batch;
+    bool     batch_lz;          /* body lives in lz_buf, not recv_buf */
+    uint32_t batch_pos;         /* next record offset within the body */
+    uint32_t batch_len;         /* body bytes */
+    uint32_t batch_frame;       /* frame bytes to consume once exhausted */
+    uint64_t batch_seq;         /* seq of the previous record */
+    uint8_t *lz_buf;            /* decompressed body (allocated on first use) */
+#ifdef OM_TCP_URING
+    /* io_uring: one READ_FIXED into [recv_used, recv_buf_size) in flight;
+     * the buffer is not compacted until it completes */
+    OmTcpUring uring;           /* fd -1 = plain recv() */
+    bool     io_fixed;          /* recv_buf registered: READ_FIXED */
+    bool     io_reading;
+#endif
 };
 
 /* ============================================================================
  * Helpers
  * ============================================================================ */
 
+static uint64_t _monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
 static int _set_nonblocking(int fd) {
     int flags = fcntl(fd, F_GETFL, 0);
     if (flags < 0) return -1;
@@ -112,6 +270,268 @@ static void _set_keepalive(int fd) {
 #endif
 }
 
+/* ----------------------------------------------------------------------------
+ * io_uring (Linux, raw syscalls)
+ * -------------------------------------------------------------------------- */
+
+#ifdef OM_TCP_URING
+static int _uring_init(OmTcpUring *r, uint32_t entries) {
+    memset(r, 0, sizeof(*r));
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    r->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (r->fd < 0) return -1;
+    if (!(p.features & IORING_FEAT_SINGLE_MMAP)) {
+        close(r->fd);
+        r->fd = -1;
+        return -1;
+    }
+
+    size_t sq_len = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+    size_t cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    r->ring_len = sq_len > cq_len ? sq_len : cq_len;
+    r->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->ring_map = mmap(NULL, r->ring_len, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+    if (r->ring_map == MAP_FAILED) {
+        close(r->fd);
+        r->fd = -1;
+        return -1;
+    }
+    r->sqes = mmap(NULL, r->sqes_len, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) {
+        munmap(r->ring_map, r->ring_len);
+        close(r->fd);
+        r->fd = -1;
+        return -1;
+    }
+
+    uint8_t *m = r->ring_map;
+    r->sq_entries = p.sq_entries;
+    r->sq_head = (uint32_t *)(m + p.sq_off.head);
+    r->sq_tail = (uint32_t *)(m + p.sq_off.tail);
+    r->sq_mask = (uint32_t *)(m + p.sq_off.ring_mask);
+    r->sq_array = (uint32_t *)(m + p.sq_off.array);
+    r->sq_flags = (uint32_t *)(m + p.sq_off.flags);
+    r->sq_local = *r->sq_tail;
+    r->cq_head = (uint32_t *)(m + p.cq_off.head);
+    r->cq_tail = (uint32_t *)(m + p.cq_off.tail);
+    r->cq_mask = (uint32_t *)(m + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe *)(m + p.cq_off.cqes);
+    return 0;
+}
+
+static void _uring_exit(OmTcpUring *r) {
+    if (r->fd < 0) return;
+    munmap(r->sqes, r->sqes_len);
+    munmap(r->ring_map, r->ring_len);
+    close(r->fd);
+    r->fd = -1;
+}
+
+/* Publish prepared SQEs and enter once; wait_nr > 0 also waits for
+ * completions. Completions that overflowed a full CQ ring are held by the
+ * kernel until an enter with GETEVENTS, so one is made whenever the overflow
+ * flag is up. Returns 0 or -errno. */
+static int _uring_submit(OmTcpUring *r, uint32_t wait_nr) {
+    __atomic_store_n(r->sq_tail, r->sq_local, __ATOMIC_RELEASE);
+    uint32_t n = r->sq_pending;
+    uint32_t flags = wait_nr ? IORING_ENTER_GETEVENTS : 0U;
+    if (__atomic_load_n(r->sq_flags, __ATOMIC_ACQUIRE) & IORING_SQ_CQ_OVERFLOW) {
+        flags |= IORING_ENTER_GETEVENTS;
+    }
+    if (n == 0 && flags == 0) return 0;
+    for (;;) {
+        long rc = syscall(__NR_io_uring_enter, r->fd, n, wait_nr, flags, NULL, 0);
+        if (rc >= 0) {
+            r->sq_pending -= (uint32_t)rc < n ? (uint32_t)rc : n;
+            return 0;
+        }
+        if (errno != EINTR) return -errno;
+    }
+}
+
+/* The server needs ACCEPT, POLL_ADD, POLL_REMOVE and SEND, with multishot
+ * poll (5.13) and multishot accept (5.19). The probe lists opcodes but not
+ * their flags, so the flags are gated on the kernel release: an older kernel
+ * fails the multishot accept with -EINVAL on every re-arm. */
+static bool _uring_server_supported(const OmTcpUring *r) {
+    struct utsname u;
+    unsigned major = 0, minor = 0;
+    if (uname(&u) != 0 || sscanf(u.release, "%u.%u", &major, &minor) != 2) return false;
+    if (major < 5 || (major == 5 && minor < 19)) return false;
+
+    size_t len = sizeof(struct io_uring_probe) + 256U * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = calloc(1, len);
+    if (!probe) return false;
+    bool ok = syscall(__NR_io_uring_register, r->fd, IORING_REGISTER_PROBE, probe, 256) >= 0;
+    static const uint8_t ops[] = {
+        IORING_OP_ACCEPT, IORING_OP_POLL_ADD, IORING_OP_POLL_REMOVE, IORING_OP_SEND,
+    };
+    for (size_t i = 0; ok && i < sizeof(ops); i++) {
+        ok = ops[i] <= probe->last_op && (probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED);
+    }
+    free(probe);
+    return ok;
+}
+
+/* Next free SQE, zeroed; submits queued entries first when the SQ is full */
+static struct io_uring_sqe *_uring_sqe(OmTcpUring *r) {
+    uint32_t head = __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE);
+    if (r->sq_local - head >= r->sq_entries) {
+        if (_uring_submit(r, 0) < 0) return NULL;
+        head = __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE);
+        if (r->sq_local - head >= r->sq_entries) return NULL;
+    }
+    uint32_t idx = r->sq_local & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    r->sq_array[idx] = idx;
+    r->sq_local++;
+    r->sq_pending++;
+    return sqe;
+}
+#endif
+
+/* ----------------------------------------------------------------------------
+ * LEB128 varints (BATCH seq deltas and lengths)
+ * -------------------------------------------------------------------------- */
+
+static inline uint32_t _varint_put(uint8_t *p, uint64_t v) {
+    uint32_t n = 0;
+    while (v >= 0x80U) {
+        p[n++] = (uint8_t)(v | 0x80U);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static inline uint32_t _varint_len(uint64_t v) {
+    uint32_t n = 1;
+    while (v >= 0x80U) { v >>= 7; n++; }
+    return n;
+}
+
+static inline bool _varint_get(const uint8_t *p, uint32_t end, uint32_t *pos,
+                               uint64_t *out) {
+    uint64_t v = 0;
+    for (uint32_t shift = 0; shift < 64U; shift += 7U) {
+        if (*pos >= end) return false;
+        uint8_t b = p[(*pos)++];
+        v |= (uint64_t)(b & 0x7FU) << shift;
+        if (!(b & 0x80U)) { *out = v; return true; }
+    }
+    return false;
+}
+
+/* ----------------------------------------------------------------------------
+ * LZ: LZ4-style block codec for BATCH bodies (<= 64 KB, so 16-bit offsets).
+ * Sequence: token (hi nibble literal len, lo nibble match len - 4, 15 means
+ * "extended by following bytes, 255 = continue"), literals, u16 LE offset,
+ * match extension. The last sequence has literals only.
+ * -------------------------------------------------------------------------- */
+
+static inline uint32_t _lz_hash(uint32_t v) {
+    return (v * 2654435761U) >> (32U - OM_TCP_LZ_HASH_BITS);
+}
+
+static uint8_t *_lz_put_len(uint8_t *op, uint32_t len) {
+    len -= 15U;
+    while (len >= 255U) { *op++ = 255U; len -= 255U; }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+/* Emit literals plus an optional match (mlen == 0: last sequence) */
+static uint8_t *_lz_emit(uint8_t *op, const uint8_t *lit, uint32_t lit_len,
+                         uint32_t off, uint32_t mlen) {
+    uint8_t *token = op++;
+    *token = (uint8_t)((lit_len < 15U ? lit_len : 15U) << 4);
+    if (lit_len >= 15U) op = _lz_put_len(op, lit_len);
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+    if (mlen == 0) return op;
+    *op++ = (uint8_t)(off & 0xFFU);
+    *op++ = (uint8_t)(off >> 8);
+    uint32_t ml = mlen - OM_TCP_LZ_MIN_MATCH;
+    *token |= (uint8_t)(ml < 15U ? ml : 15U);
+    if (ml >= 15U) op = _lz_put_len(op, ml);
+    return op;
+}
+
+/* Compress src[0..n) (n <= 64 KB) into dst, which must hold
+ * n + n / 255 + 16 bytes. The table needs no reset between calls: stale
+ * entries are verified against the current input before use. */
+static uint32_t _lz_compress(const uint8_t *src, uint32_t n, uint8_t *dst,
+                             uint16_t *table) {
+    uint8_t *op = dst;
+    uint32_t anchor = 0, ip = 0;
+    while (ip + OM_TCP_LZ_MIN_MATCH <= n) {
+        uint32_t v, cv;
+        memcpy(&v, src + ip, 4);
+        uint32_t h = _lz_hash(v);
+        uint32_t cand = table[h];
+        table[h] = (uint16_t)ip;
+        if (cand < ip && (memcpy(&cv, src + cand, 4), cv == v)) {
+            uint32_t mlen = OM_TCP_LZ_MIN_MATCH;
+            while (ip + mlen < n && src[cand + mlen] == src[ip + mlen]) mlen++;
+            op = _lz_emit(op, src + anchor, ip - anchor, ip - cand, mlen);
+            ip += mlen;
+            anchor = ip;
+        } else {
+            ip++;
+        }
+    }
+    op = _lz_emit(op, src + anchor, n - anchor, 0, 0);
+    return (uint32_t)(op - dst);
+}
+
+/* Decompress exactly out_len bytes; -1 on malformed input */
+static int _lz_decompress(const uint8_t *src, uint32_t n, uint8_t *dst,
+                          uint32_t out_len) {
+    const uint8_t *ip = src, *iend = src + n;
+    uint32_t op = 0;
+    while (ip < iend) {
+        uint8_t token = *ip++;
+        uint32_t lit = token >> 4;
+        if (lit == 15U) {
+            uint8_t b;
+            do {
+                if (ip >= iend) return -1;
+                b = *ip++;
+                lit += b;
+            } while (b == 255U);
+        }
+        if (lit > (uint32_t)(iend - ip) || lit > out_len - op) return -1;
+        memcpy(dst + op, ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == iend) break;  /* last sequence */
+
+        if (iend - ip < 2) return -1;
+        uint32_t off = (uint32_t)ip[0] | ((uint32_t)ip[1] << 8);
+        ip += 2;
+        uint32_t ml = token & 0x0FU;
+        if (ml == 15U) {
+            uint8_t b;
+            do {
+                if (ip >= iend) return -1;
+                b = *ip++;
+                ml += b;
+            } while (b == 255U);
+        }
+        ml += OM_TCP_LZ_MIN_MATCH;
+        if (off == 0 || off > op || ml > out_len - op) return -1;
+        for (uint32_t k = 0; k < ml; k++) {  /* overlapping copy */
+            dst[op + k] = dst[op - off + k];
+        }
+        op += ml;
+    }
+    return op == out_len ? 0 : -1;
+}
+
 /* ============================================================================
  * Server
  * ============================================================================ */
@@ -121,6 +541,28 @@ int om_bus_tcp_server_create(OmBusTcpServer **out, const OmBusTcpServerConfig *c
 
     uint32_t max_clients = cfg->max_clients ? cfg->max_clients : OM_TCP_DEFAULT_MAX_CLIENTS;
     uint32_t send_buf_sz = cfg->send_buf_size ? cfg->send_buf_size : OM_TCP_DEFAULT_SEND_BUF_SIZE;
+    uint32_t ring_sz = cfg->ring_size ? cfg->ring_size : OM_TCP_DEFAULT_RING_SIZE;
+
+    if (cfg->mode > OM_BUS_TCP_SERVER_URING) return OM_ERR_BUS_INIT;
+    if ((cfg->caps & ~OM_TCP_CAPS_ALL) != 0U ||
+        ((cfg->caps & OM_BUS_TCP_CAP_LZ) && !(cfg->caps & OM_BUS_TCP_CAP_BATCH))) {
+        return OM_ERR_BUS_INIT;
+    }
+#ifndef __linux__
+    if (cfg->mode == OM_BUS_TCP_SERVER_SHARED) return OM_ERR_BUS_INIT;
+#endif
+#ifndef OM_TCP_URING
+    if (cfg->mode == OM_BUS_TCP_SERVER_URING) return OM_ERR_BUS_INIT;
+#endif
+    if (cfg->mode == OM_BUS_TCP_SERVER_SHARED && (ring_sz & (ring_sz - 1U)) != 0U) {
+        return OM_ERR_BUS_NOT_POW2;
+    }
+    if ((cfg->history_bytes & (cfg->history_bytes - 1U)) != 0U) {
+        return OM_ERR_BUS_NOT_POW2;
+    }
+    if (cfg->history_src.open && (!cfg->history_src.next || !cfg->history_src.close)) {
+        return OM_ERR_BUS_INIT;
+    }
 
     OmBusTcpServer *srv = calloc(1, sizeof(*srv));
     if (!srv) return OM_ERR_BUS_INIT;
@@ -129,6 +571,14 @@ int om_bus_tcp_server_create(OmBusTcpServer **out, const OmBusTcpServerConfig *c
     srv->send_buf_size = send_buf_sz;
     srv->client_count = 0;
     srv->listen_fd = -1;
+    srv->mode = cfg->mode;
+    srv->epfd = -1;
+#ifdef OM_TCP_URING
+    srv->uring.fd = -1;
+#endif
+    srv->caps = cfg->caps;
+    srv->history_src = cfg->history_src;
+    srv->product_of = cfg->product_of;
 
     /* Allocate client slots */
     srv->clients = calloc(max_clients, sizeof(OmBusTcpClientSlot));
@@ -179,12 +629,63 @@ int om_bus_tcp_server_create(OmBusTcpServer **out, const OmBusTcpServerConfig *c
     getsockname(srv->listen_fd, (struct sockaddr *)&bound, &blen);
     srv->port = ntohs(bound.sin_port);
 
-    if (_set_nonblocking(srv->listen_fd) < 0) {
+    /* URING: accept is armed in the ring, which needs a blocking socket */
+    if (srv->mode != OM_BUS_TCP_SERVER_URING && _set_nonblocking(srv->listen_fd) < 0) {
         close(srv->listen_fd);
         free(srv->pollfds); free(srv->clients); free(srv);
         return OM_ERR_BUS_TCP_BIND;
     }
 
+    if (cfg->history_bytes >= OM_BUS_TCP_FRAME_HEADER_SIZE) {
+        srv->hist_size = cfg->history_bytes;
+        srv->hist_mask = cfg->history_bytes / OM_BUS_TCP_FRAME_HEADER_SIZE - 1U;
+        srv->hist = malloc(cfg->history_bytes);
+        srv->hist_off = malloc((srv->hist_mask + 1U) * sizeof(uint64_t));
+        if (!srv->hist || !srv->hist_off) {
+            om_bus_tcp_server_destroy(srv);
+            return OM_ERR_BUS_INIT;
+        }
+    }
+
+    if (srv->caps & OM_BUS_TCP_CAP_LZ) {
+        srv->lz_scratch = malloc(OM_TCP_BATCH_BODY_MAX + OM_TCP_BATCH_BODY_MAX / 255U + 16U);
+        srv->lz_table = calloc(1U << OM_TCP_LZ_HASH_BITS, sizeof(uint16_t));
+        if (!srv->lz_scratch || !srv->lz_table) {
+            om_bus_tcp_server_destroy(srv);
+            return OM_ERR_BUS_INIT;
+        }
+    }
+
+#ifdef __linux__
+    if (srv->mode == OM_BUS_TCP_SERVER_SHARED) {
+        srv->ring_size = ring_sz;
+        srv->max_lag = cfg->max_lag_bytes ? cfg->max_lag_bytes : ring_sz / 2U;
+        if (srv->max_lag > ring_sz) srv->max_lag = ring_sz;
+        srv->ring = malloc(ring_sz);
+        srv->events = calloc(1 + max_clients, sizeof(struct epoll_event));
+        srv->epfd = epoll_create1(EPOLL_CLOEXEC);
+        if (!srv->ring || !srv->events || srv->epfd < 0) {
+            om_bus_tcp_server_destroy(srv);
+            return OM_ERR_BUS_INIT;
+        }
+        struct epoll_event ev = { .events = EPOLLIN | EPOLLET,
+                                  .data.u32 = OM_TCP_LISTEN_TAG };
+        if (epoll_ctl(srv->epfd, EPOLL_CTL_ADD, srv->listen_fd, &ev) < 0) {
+            om_bus_tcp_server_destroy(srv);
+            return OM_ERR_BUS_TCP_IO;
+        }
+    }
+#endif
+#ifdef OM_TCP_URING
+    /* Per client: a SEND, a poll and its removal; plus accept */
+    if (srv->mode == OM_BUS_TCP_SERVER_URING &&
+        (_uring_init(&srv->uring, max_clients < 1024U ? 3U * max_clients + 2U : 4096U) < 0 ||
+         !_uring_server_supported(&srv->uring))) {
+        om_bus_tcp_server_destroy(srv);
+        return OM_ERR_BUS_INIT;
+    }
+#endif
+
     *out = srv;
     return 0;
 }
@@ -197,31 +698,71 @@ uint32_t om_bus_tcp_server_client_count(const OmBusTcpServer *srv) {
     return srv ? srv->client_count : 0;
 }
 
+static void _server_src_close(OmBusTcpServer *srv, OmBusTcpClientSlot *slot) {
+    if (slot->src_cursor) {
+        srv->history_src.close(slot->src_cursor);
+        slot->src_cursor = NULL;
+    }
+    slot->src_held = false;
+}
+
 static void _server_close_client(OmBusTcpServer *srv, uint32_t idx) {
     OmBusTcpClientSlot *slot = &srv->clients[idx];
     if (slot->fd >= 0) {
-        shutdown(slot->fd, SHUT_WR);
+        shutdown(slot->fd, SHUT_WR);  /* also fails a SEND still in flight */
         close(slot->fd);
         slot->fd = -1;
     }
-    free(slot->send_buf);
-    slot->send_buf = NULL;
+#ifdef OM_TCP_URING
+    /* The armed poll holds the socket open until it is removed */
+    if (slot->io_polled) {
+        struct io_uring_sqe *sqe = _uring_sqe(&srv->uring);
+        if (sqe) {
+            sqe->opcode = IORING_OP_POLL_REMOVE;
+            sqe->addr = OM_TCP_IO_TAG(OM_TCP_IO_POLL, slot->io_gen, idx);
+            sqe->user_data = OM_TCP_IO_TAG(OM_TCP_IO_REMOVE, slot->io_gen, idx);
+        }
+    }
+#endif
+    /* The kernel may still be reading send_buf for a SEND in flight: park
+     * the slot until its completion (the shutdown makes that prompt) */
+    if (slot->io_sending > 0) {
+        slot->io_closing = true;
+    } else {
+        slot->io_gen++;
+        free(slot->send_buf);
+        slot->send_buf = NULL;
+    }
+    slot->io_polled = false;
     slot->send_used = 0;
     slot->send_offset = 0;
     slot->disconnect_pending = false;
+    slot->ring_off = 0;
+    slot->writable = false;
+    slot->slow = false;
+    slot->caps = 0;
+    slot->ctrl_len = 0;
+    _server_src_close(srv, slot);
+    slot->resend_pending = false;
+    slot->replaying = false;
+    free(slot->products);
+    free(slot->sub_stage);
+    slot->products = NULL;
+    slot->sub_stage = NULL;
+    slot->filtered = false;
+    slot->skipping = false;
+    slot->sub_any = false;
     srv->client_count--;
     srv->stats_clients_disconnected++;
 }
 
-static void _server_append_frame(OmBusTcpServer *srv,
-                                 OmBusTcpClientSlot *slot,
-                                 uint64_t wal_seq,
-                                 uint8_t wal_type,
-                                 const void *payload,
-                                 uint16_t len) {
-    uint32_t frame_size = OM_BUS_TCP_FRAME_HEADER_SIZE + len;
-
-    if (slot->send_used + frame_size > slot->send_buf_size) {
+/* Make room for frame_size bytes in the client's send_buf. On overflow,
+ * queue a slow-client warning, mark the client for disconnect and return
+ * NULL. */
+static uint8_t *_server_slot_reserve(OmBusTcpServer *srv,
+                                     OmBusTcpClientSlot *slot,
+                                     uint32_t frame_size) {
+    if (slot->send_used + frame_size > slot->send_buf_size && slot->io_sending == 0) {
         uint32_t pending = slot->send_used - slot->send_offset;
         if (slot->send_offset > 0 && pending > 0) {
             memmove(slot->send_buf, slot->send_buf + slot->send_offset, pending);
@@ -251,9 +792,23 @@ static void _server_append_frame(OmBusTcpServer *srv,
         }
         slot->disconnect_pending = true;
         srv->stats_slow_client_drops++;
-        return;
+        return NULL;
     }
 
+    uint8_t *dst = slot->send_buf + slot->send_used;
+    slot->send_used += frame_size;
+    return dst;
+}
+
+static void _server_append_frame(OmBusTcpServer *srv,
+                                 OmBusTcpClientSlot *slot,
+                                 uint64_t wal_seq,
+                                 uint8_t wal_type,
+                                 const void *payload,
+                                 uint16_t len) {
+    uint8_t *dst = _server_slot_reserve(srv, slot, OM_BUS_TCP_FRAME_HEADER_SIZE + len);
+    if (!dst) return;
+
     OmBusTcpFrameHeader hdr;
     hdr.magic = OM_BUS_TCP_FRAME_MAGIC;
     hdr.wal_type = wal_type;
@@ -261,69 +816,1207 @@ static void _server_append_frame(OmBusTcpServer *srv,
     hdr.payload_len = len;
     hdr.wal_seq = wal_seq;
 
-    memcpy(slot->send_buf + slot->send_used, &hdr, OM_BUS_TCP_FRAME_HEADER_SIZE);
-    if (len > 0 && payload) {
-        memcpy(slot->send_buf + slot->send_used + OM_BUS_TCP_FRAME_HEADER_SIZE, payload, len);
+    memcpy(dst, &hdr, OM_BUS_TCP_FRAME_HEADER_SIZE);
+    if (len > 0 && payload) {
+        memcpy(dst + OM_BUS_TCP_FRAME_HEADER_SIZE, payload, len);
+    }
+}
+
+/* Size of the frame starting at p (stream built by _server_encode) */
+static inline uint32_t _frame_size_at(const uint8_t *p) {
+    OmBusTcpFrameHeader hdr;
+    memcpy(&hdr, p, OM_BUS_TCP_FRAME_HEADER_SIZE);
+    return OM_BUS_TCP_FRAME_HEADER_SIZE + hdr.payload_len;
+}
+
+/* Append an encoded frame stream, frame by frame, so overflow handling is
+ * the same as for single frames */
+static void _server_append_stream(OmBusTcpServer *srv, OmBusTcpClientSlot *slot,
+                                  const uint8_t *stream, uint32_t len) {
+    uint32_t off = 0;
+    while (off < len && !slot->disconnect_pending) {
+        uint32_t fsz = _frame_size_at(stream + off);
+        uint8_t *dst = _server_slot_reserve(srv, slot, fsz);
+        if (!dst) return;
+        memcpy(dst, stream + off, fsz);
+        off += fsz;
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * SUBSCRIBE filters (COPY mode): a filtered slot gets its own view of each
+ * broadcast — the records it wants, each preceded by a SKIP frame when
+ * records were withheld before it. Products are looked up once per record.
+ * -------------------------------------------------------------------------- */
+
+static inline int _server_product(const OmBusTcpServer *srv, uint8_t wal_type,
+                                  const void *payload, uint16_t len) {
+    return srv->product_of ? srv->product_of(wal_type, payload, len) : -1;
+}
+
+static inline bool _server_slot_wants(const OmBusTcpClientSlot *slot, uint8_t wal_type,
+                                      int product) {
+    if (!(slot->type_mask & OM_BUS_TCP_TYPE_BIT(wal_type))) return false;
+    if (product < 0 || !slot->products) return true;
+    if (product > (int)UINT16_MAX) return false;
+    return (slot->products[(uint32_t)product >> 6] >> ((uint32_t)product & 63U)) & 1U;
+}
+
+/* Filter one record; returns whether to send it. When the withheld run so
+ * far has to be reported first (this record is sent, or its seq does not
+ * extend the run), the run moves to mark[] and *mark_due is set. */
+static bool _server_filter_step(OmBusTcpServer *srv, OmBusTcpClientSlot *slot,
+                                uint64_t wal_seq, uint8_t wal_type, int product,
+                                bool *mark_due, uint64_t mark[2]) {
+    bool wanted = _server_slot_wants(slot, wal_type, product);
+    *mark_due = slot->skipping && (wanted || wal_seq != slot->skip_to);
+    if (*mark_due) {
+        mark[0] = slot->skip_from;
+        mark[1] = slot->skip_to;
+        slot->skipping = false;
+    }
+    if (!wanted) {
+        if (!slot->skipping) {
+            slot->skipping = true;
+            slot->skip_from = wal_seq;
+        }
+        slot->skip_to = wal_seq + 1U;
+        srv->stats_records_filtered++;
+    }
+    return wanted;
+}
+
+static void _server_put_skip(uint8_t *dst, const uint64_t mark[2]) {
+    OmBusTcpFrameHeader hdr;
+    hdr.magic = OM_BUS_TCP_FRAME_MAGIC;
+    hdr.wal_type = OM_BUS_TCP_WAL_TYPE_SKIP;
+    hdr.flags = 0;
+    hdr.payload_len = 8;
+    hdr.wal_seq = mark[0];
+    memcpy(dst, &hdr, OM_BUS_TCP_FRAME_HEADER_SIZE);
+    memcpy(dst + OM_BUS_TCP_FRAME_HEADER_SIZE, &mark[1], 8);
+}
+
+/* Report the slot's pending run now (idle flush, filter removed) */
+static void _server_flush_skip(OmBusTcpServer *srv, OmBusTcpClientSlot *slot) {
+    if (!slot->skipping) return;
+    slot->skipping = false;
+    uint8_t *dst = _server_slot_reserve(srv, slot, OM_TCP_SKIP_FRAME_SIZE);
+    if (!dst) return;
+    uint64_t mark[2] = { slot->skip_from, slot->skip_to };
+    _server_put_skip(dst, mark);
+}
+
+/* Size the scratch for count records and look up their products */
+static int _server_filter_prepare(OmBusTcpServer *srv, const OmBusRecord *recs,
+                                  uint32_t count) {
+    if (srv->flt_cap < count) {
+        OmBusRecord *r = realloc(srv->flt_recs, (size_t)count * 2U * sizeof(*r));
+        if (!r) return OM_ERR_BUS_INIT;
+        srv->flt_recs = r;
+        uint64_t *m = realloc(srv->flt_marks, (size_t)count * sizeof(*m));
+        if (!m) return OM_ERR_BUS_INIT;
+        srv->flt_marks = m;
+        int *p = realloc(srv->flt_prod, (size_t)count * sizeof(*p));
+        if (!p) return OM_ERR_BUS_INIT;
+        srv->flt_prod = p;
+        srv->flt_cap = count;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        srv->flt_prod[i] = _server_product(srv, recs[i].wal_type, recs[i].payload,
+                                           recs[i].payload_len);
+    }
+    return 0;
+}
+
+/* Build the slot's view of recs in srv->flt_recs; returns its length */
+static uint32_t _server_filter_view(OmBusTcpServer *srv, OmBusTcpClientSlot *slot,
+                                    const OmBusRecord *recs, uint32_t count,
+                                    uint64_t *bytes) {
+    uint32_t n = 0, m = 0;
+    *bytes = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        bool due;
+        uint64_t mark[2];
+        bool wanted = _server_filter_step(srv, slot, recs[i].wal_seq, recs[i].wal_type,
+                                          srv->flt_prod[i], &due, mark);
+        if (due) {
+            srv->flt_marks[m] = mark[1];
+            OmBusRecord *r = &srv->flt_recs[n++];
+            r->wal_seq = mark[0];
+            r->wal_type = OM_BUS_TCP_WAL_TYPE_SKIP;
+            r->payload_len = 8;
+            r->payload = &srv->flt_marks[m++];
+            *bytes += 8U;
+        }
+        if (wanted) {
+            srv->flt_recs[n++] = recs[i];
+            *bytes += recs[i].payload_len;
+        }
+    }
+    return n;
+}
+
+/* ----------------------------------------------------------------------------
+ * BATCH encoding: runs of >= 2 records with non-decreasing wal_seq become
+ * BATCH frames (body <= 64 KB), LZ-compressed when `lz` and that is smaller.
+ * Anything else is written as a single frame. The stream is built into
+ * srv->enc[buf] once per broadcast_batch call and format, and shared by
+ * all unfiltered clients.
+ * -------------------------------------------------------------------------- */
+
+static int _server_encode(OmBusTcpServer *srv, int buf, const OmBusRecord *recs,
+                          uint32_t count, uint64_t bytes, bool lz,
+                          uint32_t *len_out) {
+    /* Worst case per record is a single frame: 16 + len */
+    uint64_t need = bytes + (uint64_t)count * OM_BUS_TCP_FRAME_HEADER_SIZE;
+    if (need > UINT32_MAX) return OM_ERR_BUS_RECORD_TOO_LARGE;
+    if (srv->enc_cap[buf] < need) {
+        uint8_t *nb = realloc(srv->enc[buf], (size_t)need);
+        if (!nb) return OM_ERR_BUS_INIT;
+        srv->enc[buf] = nb;
+        srv->enc_cap[buf] = (uint32_t)need;
+    }
+
+    uint8_t *out = srv->enc[buf];
+    uint32_t pos = 0;
+    uint32_t i = 0;
+    while (i < count) {
+        /* Size the run starting at i */
+        uint32_t j = i;
+        uint32_t raw = 0;
+        uint64_t prev = recs[i].wal_seq;
+        while (j < count) {
+            if (recs[j].wal_seq < prev) break;
+            uint32_t rsz = 1U + _varint_len(recs[j].wal_seq - prev)
+                         + _varint_len(recs[j].payload_len) + recs[j].payload_len;
+            if (raw + rsz > OM_TCP_BATCH_BODY_MAX) break;
+            raw += rsz;
+            prev = recs[j].wal_seq;
+            j++;
+        }
+
+        OmBusTcpFrameHeader hdr;
+        hdr.magic = OM_BUS_TCP_FRAME_MAGIC;
+        hdr.flags = 0;
+        hdr.wal_seq = recs[i].wal_seq;
+        uint8_t *body = out + pos + OM_BUS_TCP_FRAME_HEADER_SIZE;
+
+        if (j - i < 2U) {
+            hdr.wal_type = recs[i].wal_type;
+            hdr.payload_len = recs[i].payload_len;
+            memcpy(out + pos, &hdr, OM_BUS_TCP_FRAME_HEADER_SIZE);
+            if (recs[i].payload_len > 0 && recs[i].payload) {
+                memcpy(body, recs[i].payload, recs[i].payload_len);
+            }
+            pos += OM_BUS_TCP_FRAME_HEADER_SIZE + recs[i].payload_len;
+            i++;
+            continue;
+        }
+
+        uint32_t bp = 0;
+        prev = recs[i].wal_seq;
+        for (uint32_t k = i; k < j; k++) {
+            body[bp++] = recs[k].wal_type;
+            bp += _varint_put(body + bp, recs[k].wal_seq - prev);
+            bp += _varint_put(body + bp, recs[k].payload_len);
+            if (recs[k].payload_len > 0 && recs[k].payload) {
+                memcpy(body + bp, recs[k].payload, recs[k].payload_len);
+            }
+            bp += recs[k].payload_len;
+            prev = recs[k].wal_seq;
+        }
+
+        if (lz) {
+            uint32_t clen = _lz_compress(body, bp, srv->lz_scratch, srv->lz_table);
+            if (clen + 2U < bp) {
+                uint16_t raw_len = (uint16_t)bp;
+                memcpy(body, &raw_len, 2);
+                memcpy(body + 2, srv->lz_scratch, clen);
+                srv->stats_lz_bytes_saved += bp - (clen + 2U);
+                bp = clen + 2U;
+                hdr.flags = OM_BUS_TCP_FRAME_FLAG_LZ;
+            }
+        }
+
+        hdr.wal_type = OM_BUS_TCP_WAL_TYPE_BATCH;
+        hdr.payload_len = (uint16_t)bp;
+        memcpy(out + pos, &hdr, OM_BUS_TCP_FRAME_HEADER_SIZE);
+        pos += OM_BUS_TCP_FRAME_HEADER_SIZE + bp;
+        srv->stats_batch_frames++;
+        i = j;
+    }
+
+    *len_out = pos;
+    return 0;
+}
+
+/* ----------------------------------------------------------------------------
+ * SHARED mode: frames are written once into a byte ring; each client sends
+ * [ring_off, ring_head) with writev (two iovecs when the range wraps).
+ * Nothing pins the ring: a client further behind than max_lag is dropped at
+ * the next poll_io, and one more than ring_size behind has lost its data.
+ * -------------------------------------------------------------------------- */
+
+/* Copy len bytes in/out of a power-of-two byte ring at absolute offset at */
+static void _ring_write(uint8_t *ring, uint32_t size, uint64_t at,
+                        const void *src, uint32_t len) {
+    uint32_t idx = (uint32_t)(at & (size - 1U));
+    uint32_t first = size - idx;
+    if (first > len) first = len;
+    memcpy(ring + idx, src, first);
+    if (len > first) {
+        memcpy(ring, (const uint8_t *)src + first, len - first);
+    }
+}
+
+static void _ring_read(const uint8_t *ring, uint32_t size, uint64_t at,
+                       void *dst, uint32_t len) {
+    uint32_t idx = (uint32_t)(at & (size - 1U));
+    uint32_t first = size - idx;
+    if (first > len) first = len;
+    memcpy(dst, ring + idx, first);
+    if (len > first) {
+        memcpy((uint8_t *)dst + first, ring, len - first);
+    }
+}
+
+static void _server_ring_copy(OmBusTcpServer *srv, const void *src, uint32_t len) {
+    _ring_write(srv->ring, srv->ring_size, srv->ring_head, src, len);
+    srv->ring_head += len;
+}
+
+static void _server_ring_append_frame(OmBusTcpServer *srv, uint64_t wal_seq,
+                                      uint8_t wal_type, const void *payload,
+                                      uint16_t len) {
+    OmBusTcpFrameHeader hdr;
+    hdr.magic = OM_BUS_TCP_FRAME_MAGIC;
+    hdr.wal_type = wal_type;
+    hdr.flags = 0;
+    hdr.payload_len = len;
+    hdr.wal_seq = wal_seq;
+    _server_ring_copy(srv, &hdr, OM_BUS_TCP_FRAME_HEADER_SIZE);
+    if (len > 0 && payload) {
+        _server_ring_copy(srv, payload, len);
+    }
+}
+
+/* Fill iov[0..1] with ring bytes [from, to); returns iovec count */
+static int _server_ring_iov(const OmBusTcpServer *srv, uint64_t from, uint64_t to,
+                            struct iovec *iov) {
+    uint32_t len = (uint32_t)(to - from);
+    uint32_t idx = (uint32_t)(from & (srv->ring_size - 1U));
+    uint32_t first = srv->ring_size - idx;
+    if (first >= len) {
+        iov[0].iov_base = srv->ring + idx;
+        iov[0].iov_len = len;
+        return 1;
+    }
+    iov[0].iov_base = srv->ring + idx;
+    iov[0].iov_len = first;
+    iov[1].iov_base = srv->ring;
+    iov[1].iov_len = len - first;
+    return 2;
+}
+
+/* ----------------------------------------------------------------------------
+ * RESEND history: every broadcast record is kept as a plain frame in a
+ * byte ring (history_bytes). Entries whose bytes have been overwritten are
+ * retired from hist_lo; a record larger than the ring retires everything,
+ * so the replay shows a gap rather than skipping it silently.
+ * -------------------------------------------------------------------------- */
+
+static void _server_hist_append(OmBusTcpServer *srv, uint64_t wal_seq,
+                                uint8_t wal_type, const void *payload, uint16_t len) {
+    uint32_t fsz = OM_BUS_TCP_FRAME_HEADER_SIZE + len;
+    if (fsz > srv->hist_size) {
+        srv->hist_lo = srv->hist_n;
+        return;
+    }
+    OmBusTcpFrameHeader hdr;
+    hdr.magic = OM_BUS_TCP_FRAME_MAGIC;
+    hdr.wal_type = wal_type;
+    hdr.flags = 0;
+    hdr.payload_len = len;
+    hdr.wal_seq = wal_seq;
+    _ring_write(srv->hist, srv->hist_size, srv->hist_head, &hdr, OM_BUS_TCP_FRAME_HEADER_SIZE);
+    if (len > 0 && payload) {
+        _ring_write(srv->hist, srv->hist_size, srv->hist_head + OM_BUS_TCP_FRAME_HEADER_SIZE,
+                    payload, len);
+    }
+    srv->hist_off[srv->hist_n & srv->hist_mask] = srv->hist_head;
+    srv->hist_head += fsz;
+    srv->hist_n++;
+    while (srv->hist_lo < srv->hist_n &&
+           srv->hist_off[srv->hist_lo & srv->hist_mask] + srv->hist_size < srv->hist_head) {
+        srv->hist_lo++;
+    }
+}
+
+static inline void _server_hist_header(const OmBusTcpServer *srv, uint64_t entry,
+                                       OmBusTcpFrameHeader *hdr) {
+    _ring_read(srv->hist, srv->hist_size, srv->hist_off[entry & srv->hist_mask],
+               hdr, OM_BUS_TCP_FRAME_HEADER_SIZE);
+}
+
+/* First intact entry with wal_seq >= seq (hist_n if none) */
+static uint64_t _server_hist_find(const OmBusTcpServer *srv, uint64_t seq) {
+    uint64_t lo = srv->hist_lo, hi = srv->hist_n;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2U;
+        OmBusTcpFrameHeader hdr;
+        _server_hist_header(srv, mid, &hdr);
+        if (hdr.wal_seq < seq) lo = mid + 1U;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/* Compact the slot's send_buf and return its free bytes */
+static uint32_t _server_slot_room(OmBusTcpClientSlot *slot) {
+    if (slot->send_offset > 0 && slot->io_sending == 0) {
+        uint32_t pending = slot->send_used - slot->send_offset;
+        if (pending > 0) {
+            memmove(slot->send_buf, slot->send_buf + slot->send_offset, pending);
+        }
+        slot->send_used = pending;
+        slot->send_offset = 0;
+    }
+    return slot->send_buf_size - slot->send_used;
+}
+
+/* Queue the RESEND ack and, with a history ring, enter catch-up from
+ * replay_seq. Without one, the ack alone resyncs the client to live. */
+static void _server_resend_start(OmBusTcpServer *srv, OmBusTcpClientSlot *slot) {
+    if (!slot->send_buf) {
+        slot->send_buf = malloc(srv->send_buf_size);
+        if (!slot->send_buf) {
+            slot->disconnect_pending = true;
+            return;
+        }
+        slot->send_buf_size = srv->send_buf_size;
+        slot->send_used = 0;
+        slot->send_offset = 0;
+    }
+    _server_src_close(srv, slot);
+    slot->replaying = false;
+
+    uint8_t *dst = _server_slot_reserve(srv, slot, OM_BUS_TCP_FRAME_HEADER_SIZE);
+    if (!dst) return;
+    OmBusTcpFrameHeader hdr;
+    hdr.magic = OM_BUS_TCP_FRAME_MAGIC;
+    hdr.wal_type = OM_BUS_TCP_WAL_TYPE_RESEND;
+    hdr.flags = 0;
+    hdr.payload_len = 0;
+    hdr.wal_seq = slot->replay_seq;
+    memcpy(dst, &hdr, OM_BUS_TCP_FRAME_HEADER_SIZE);
+
+    if (!srv->hist) return;
+    slot->replaying = true;
+    slot->src_used = false;
+    slot->replay_pos = _server_hist_find(srv, slot->replay_seq);
+}
+
+/* Catch-up: copy frames owed to the client into its send_buf while they
+ * fit — from history_src while the seq is older than the history ring,
+ * then from the ring. Work per call is bounded by send_buf space and by
+ * OM_TCP_REPLAY_SCAN_BUDGET records examined, filtered ones included, so a
+ * filter that drops most of the WAL cannot stall poll_io; the next poll_io
+ * resumes. Once the newest history entry is out, the slot goes live again. */
+static void _server_replay_fill(OmBusTcpServer *srv, OmBusTcpClientSlot *slot) {
+    uint32_t room = _server_slot_room(slot);
+    uint32_t budget = OM_TCP_REPLAY_SCAN_BUDGET;
+    for (;;) {
+        if (budget-- == 0) return;
+        if (slot->replay_pos < srv->hist_lo) {
+            slot->replay_pos = srv->hist_lo;  /* overwritten while catching up */
+        }
+        OmBusTcpFrameHeader hdr;
+        bool have_entry = slot->replay_pos < srv->hist_n;
+        if (have_entry) _server_hist_header(srv, slot->replay_pos, &hdr);
+
+        /* Older than the ring: consult history_src once */
+        if (!slot->src_cursor && !slot->src_used && srv->history_src.open &&
+            (!have_entry || hdr.wal_seq > slot->replay_seq)) {
+            slot->src_used = true;
+            slot->src_cursor = srv->history_src.open(srv->history_src.ctx, slot->replay_seq);
+        }
+        if (slot->src_cursor) {
+            if (!slot->src_held) {
+                int rc = srv->history_src.next(slot->src_cursor, &slot->src_rec);
+                if (rc == OM_BUS_TCP_HISTORY_AGAIN) return;
+                if (rc != 1) {
+                    _server_src_close(srv, slot);
+                    continue;
+                }
+                slot->src_held = true;
+            }
+            const OmBusRecord *rec = &slot->src_rec;
+            if (rec->wal_seq < slot->replay_seq) {
+                slot->src_held = false;
+                continue;
+            }
+            if (have_entry && rec->wal_seq >= hdr.wal_seq) {
+                _server_src_close(srv, slot);  /* the ring takes over */
+                continue;
+            }
+            uint32_t fsz = OM_BUS_TCP_FRAME_HEADER_SIZE + rec->payload_len;
+            if (slot->filtered) {
+                if (room < fsz + OM_TCP_SKIP_FRAME_SIZE) return;
+                bool due;
+                uint64_t mark[2];
+                int product = _server_product(srv, rec->wal_type, rec->payload,
+                                              rec->payload_len);
+                bool wanted = _server_filter_step(srv, slot, rec->wal_seq, rec->wal_type,
+                                                  product, &due, mark);
+                if (due) {
+                    _server_put_skip(slot->send_buf + slot->send_used, mark);
+                    slot->send_used += OM_TCP_SKIP_FRAME_SIZE;
+                    room -= OM_TCP_SKIP_FRAME_SIZE;
+                }
+                if (!wanted) {
+                    slot->replay_seq = rec->wal_seq + 1U;
+                    slot->src_held = false;
+                    continue;
+                }
+            } else if (room < fsz) {
+                return;
+            }
+            OmBusTcpFrameHeader fh;
+            fh.magic = OM_BUS_TCP_FRAME_MAGIC;
+            fh.wal_type = rec->wal_type;
+            fh.flags = 0;
+            fh.payload_len = rec->payload_len;
+            fh.wal_seq = rec->wal_seq;
+            uint8_t *dst = slot->send_buf + slot->send_used;
+            memcpy(dst, &fh, OM_BUS_TCP_FRAME_HEADER_SIZE);
+            if (rec->payload_len > 0) {
+                memcpy(dst + OM_BUS_TCP_FRAME_HEADER_SIZE, rec->payload, rec->payload_len);
+            }
+            slot->send_used += fsz;
+            room -= fsz;
+            slot->replay_seq = rec->wal_seq + 1U;
+            slot->src_held = false;
+            srv->stats_records_replayed++;
+            continue;
+        }
+
+        if (!have_entry) {
+            slot->replaying = false;
+            slot->ring_off = srv->ring_head;  /* SHARED: ring so far was replayed */
+            return;
+        }
+        if (hdr.wal_seq < slot->replay_seq) {
+            slot->replay_pos++;
+            continue;
+        }
+        uint32_t fsz = OM_BUS_TCP_FRAME_HEADER_SIZE + hdr.payload_len;
+        if (slot->filtered) {
+            /* Copy behind room for a SKIP frame, then keep or drop it */
+            if (room < fsz + OM_TCP_SKIP_FRAME_SIZE) return;
+            uint8_t *at = slot->send_buf + slot->send_used;
+            _ring_read(srv->hist, srv->hist_size,
+                       srv->hist_off[slot->replay_pos & srv->hist_mask],
+                       at + OM_TCP_SKIP_FRAME_SIZE, fsz);
+            bool due;
+            uint64_t mark[2];
+            int product = _server_product(srv, hdr.wal_type,
+                                          at + OM_TCP_SKIP_FRAME_SIZE + OM_BUS_TCP_FRAME_HEADER_SIZE,
+                                          hdr.payload_len);
+            bool wanted = _server_filter_step(srv, slot, hdr.wal_seq, hdr.wal_type,
+                                              product, &due, mark);
+            uint32_t used = 0;
+            if (due) {
+                _server_put_skip(at, mark);
+                used = OM_TCP_SKIP_FRAME_SIZE;
+            }
+            if (wanted) {
+                if (!due) memmove(at, at + OM_TCP_SKIP_FRAME_SIZE, fsz);
+                used += fsz;
+                srv->stats_records_replayed++;
+            }
+            slot->send_used += used;
+            room -= used;
+            slot->replay_seq = hdr.wal_seq + 1U;
+            slot->replay_pos++;
+            continue;
+        }
+        if (room < fsz) return;
+        _ring_read(srv->hist, srv->hist_size, srv->hist_off[slot->replay_pos & srv->hist_mask],
+                   slot->send_buf + slot->send_used, fsz);
+        slot->send_used += fsz;
+        room -= fsz;
+        slot->replay_seq = hdr.wal_seq + 1U;
+        slot->replay_pos++;
+        srv->stats_records_replayed++;
+    }
+}
+
+/* Send as much of [ring_off, ring_head) as the socket takes. On a slow
+ * client, make one last attempt to send its backlog plus a warning frame. */
+/* SHARED: send the slot's catch-up send_buf until EAGAIN */
+static void _server_flush_buf(OmBusTcpClientSlot *slot) {
+    while (slot->writable && slot->send_offset < slot->send_used) {
+        ssize_t n = send(slot->fd, slot->send_buf + slot->send_offset,
+                         slot->send_used - slot->send_offset, OM_MSG_NOSIGNAL);
+        if (n > 0) {
+            slot->send_offset += (uint32_t)n;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            slot->writable = false;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            slot->disconnect_pending = true;
+            return;
+        }
+    }
+    if (slot->send_offset == slot->send_used) {
+        slot->send_offset = 0;
+        slot->send_used = 0;
+    }
+}
+
+static void _server_flush_shared(OmBusTcpServer *srv, OmBusTcpClientSlot *slot) {
+    /* Catch-up bytes go first; the ring resumes once they are out */
+    if (slot->replaying || slot->send_used > slot->send_offset) {
+        if (slot->replaying && !slot->disconnect_pending) _server_replay_fill(srv, slot);
+        _server_flush_buf(slot);
+        if (slot->replaying || slot->send_used > slot->send_offset) return;
+    }
+
+    uint64_t head = srv->ring_head;
+    uint64_t lag = head - slot->ring_off;
+    if (lag > srv->stats_max_client_lag) srv->stats_max_client_lag = lag;
+
+    if (!slot->disconnect_pending && lag > srv->max_lag) {
+        slot->disconnect_pending = true;
+        slot->slow = true;
+        srv->stats_slow_client_drops++;
+    }
+
+    if (slot->disconnect_pending) {
+        /* Data past ring_size has been overwritten: nothing safe to send */
+        if (!slot->slow || lag > srv->ring_size) return;
+        struct iovec iov[3];
+        int cnt = lag ? _server_ring_iov(srv, slot->ring_off, head, iov) : 0;
+        OmBusTcpFrameHeader whdr;
+        whdr.magic = OM_BUS_TCP_FRAME_MAGIC;
+        whdr.wal_type = OM_BUS_TCP_WAL_TYPE_SLOW_WARNING;
+        whdr.flags = 0;
+        whdr.payload_len = 8;
+        whdr.wal_seq = 0;
+        uint8_t warn[OM_BUS_TCP_FRAME_HEADER_SIZE + 8];
+        uint32_t warn_payload[2] = {
+            lag > UINT32_MAX ? UINT32_MAX : (uint32_t)lag,
+            srv->max_lag,
+        };
+        memcpy(warn, &whdr, OM_BUS_TCP_FRAME_HEADER_SIZE);
+        memcpy(warn + OM_BUS_TCP_FRAME_HEADER_SIZE, warn_payload, 8);
+        iov[cnt].iov_base = warn;
+        iov[cnt].iov_len = sizeof(warn);
+        struct msghdr msg = { .msg_iov = iov, .msg_iovlen = (size_t)cnt + 1U };
+        (void)sendmsg(slot->fd, &msg, OM_MSG_NOSIGNAL);
+        return;
+    }
+
+    while (slot->writable && slot->ring_off != head) {
+        struct iovec iov[2];
+        int cnt = _server_ring_iov(srv, slot->ring_off, head, iov);
+        struct msghdr msg = { .msg_iov = iov, .msg_iovlen = (size_t)cnt };
+        ssize_t n = sendmsg(slot->fd, &msg, OM_MSG_NOSIGNAL);
+        if (n > 0) {
+            slot->ring_off += (uint64_t)n;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            slot->writable = false;  /* wait for the next EPOLLOUT edge */
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            slot->disconnect_pending = true;
+            return;
+        }
+    }
+
+    /* RESEND: switch to catch-up at a frame boundary, i.e. the ring head */
+    if (slot->resend_pending && slot->ring_off == head && !slot->disconnect_pending) {
+        slot->resend_pending = false;
+        _server_resend_start(srv, slot);
+        if (slot->replaying) _server_replay_fill(srv, slot);
+        _server_flush_buf(slot);
+    }
+}
+
+static void _server_hist_append_batch(OmBusTcpServer *srv, const OmBusRecord *recs,
+                                      uint32_t count) {
+    if (!srv->hist) return;
+    for (uint32_t i = 0; i < count; i++) {
+        _server_hist_append(srv, recs[i].wal_seq, recs[i].wal_type,
+                            recs[i].payload, recs[i].payload_len);
+    }
+}
+
+/* Send a filtered slot its view of recs, BATCH-encoded when negotiated.
+ * _server_filter_prepare() must have run for recs. */
+static int _server_send_view(OmBusTcpServer *srv, OmBusTcpClientSlot *slot,
+                             const OmBusRecord *recs, uint32_t count) {
+    uint64_t bytes;
+    uint32_t n = _server_filter_view(srv, slot, recs, count, &bytes);
+    if (n >= 2U && (slot->caps & OM_BUS_TCP_CAP_BATCH)) {
+        uint32_t len = 0;
+        int rc = _server_encode(srv, 2, srv->flt_recs, n, bytes,
+                                (slot->caps & OM_BUS_TCP_CAP_LZ) != 0U, &len);
+        if (rc < 0) return rc;
+        _server_append_stream(srv, slot, srv->enc[2], len);
+        return 0;
+    }
+    for (uint32_t i = 0; i < n && !slot->disconnect_pending; i++) {
+        const OmBusRecord *r = &srv->flt_recs[i];
+        _server_append_frame(srv, slot, r->wal_seq, r->wal_type, r->payload, r->payload_len);
+    }
+    return 0;
+}
+
+int om_bus_tcp_server_broadcast(OmBusTcpServer *srv, uint64_t wal_seq,
+                                 uint8_t wal_type, const void *payload, uint16_t len) {
+    if (!srv) return OM_ERR_BUS_INIT;
+
+    if (srv->mode == OM_BUS_TCP_SERVER_SHARED) {
+        if (OM_BUS_TCP_FRAME_HEADER_SIZE + (uint32_t)len > srv->ring_size) {
+            return OM_ERR_BUS_RECORD_TOO_LARGE;
+        }
+        if (srv->hist) _server_hist_append(srv, wal_seq, wal_type, payload, len);
+        _server_ring_append_frame(srv, wal_seq, wal_type, payload, len);
+        srv->stats_records_broadcast++;
+        srv->stats_bytes_broadcast += len;
+        return 0;
+    }
+
+    if (srv->hist) _server_hist_append(srv, wal_seq, wal_type, payload, len);
+    OmBusRecord rec = { .wal_seq = wal_seq, .wal_type = wal_type,
+                        .payload_len = len, .payload = payload };
+    bool prepared = false;
+    for (uint32_t i = 0; i < srv->max_clients; i++) {
+        OmBusTcpClientSlot *slot = &srv->clients[i];
+        if (slot->fd < 0 || slot->disconnect_pending || slot->replaying) continue;
+        if (slot->filtered) {
+            if (!prepared) {
+                int rc = _server_filter_prepare(srv, &rec, 1);
+                if (rc < 0) return rc;
+                prepared = true;
+            }
+            int rc = _server_send_view(srv, slot, &rec, 1);
+            if (rc < 0) return rc;
+            continue;
+        }
+        _server_append_frame(srv, slot, wal_seq, wal_type, payload, len);
+    }
+
+    srv->stats_records_broadcast++;
+    srv->stats_bytes_broadcast += len;
+    return 0;
+}
+
+int om_bus_tcp_server_broadcast_batch(OmBusTcpServer *srv,
+                                      const OmBusRecord *recs,
+                                      uint32_t count) {
+    if (!srv || (!recs && count > 0)) {
+        return OM_ERR_BUS_INIT;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    uint64_t bytes = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        bytes += recs[i].payload_len;
+    }
+
+    if (srv->mode == OM_BUS_TCP_SERVER_SHARED && (srv->caps & OM_BUS_TCP_CAP_BATCH)) {
+        /* One encoding in the ring for every client */
+        int lz = (srv->caps & OM_BUS_TCP_CAP_LZ) ? 1 : 0;
+        uint32_t len = 0;
+        int rc = _server_encode(srv, lz, recs, count, bytes, lz != 0, &len);
+        if (rc < 0) return rc;
+        for (uint32_t off = 0; off < len; off += _frame_size_at(srv->enc[lz] + off)) {
+            if (_frame_size_at(srv->enc[lz] + off) > srv->ring_size) {
+                return OM_ERR_BUS_RECORD_TOO_LARGE;
+            }
+        }
+        _server_hist_append_batch(srv, recs, count);
+        for (uint32_t off = 0; off < len;) {
+            uint32_t fsz = _frame_size_at(srv->enc[lz] + off);
+            _server_ring_copy(srv, srv->enc[lz] + off, fsz);
+            off += fsz;
+        }
+        srv->stats_records_broadcast += count;
+        srv->stats_bytes_broadcast += bytes;
+        return 0;
+    }
+
+    if (srv->mode == OM_BUS_TCP_SERVER_SHARED) {
+        for (uint32_t i = 0; i < count; i++) {
+            if (OM_BUS_TCP_FRAME_HEADER_SIZE + (uint32_t)recs[i].payload_len
+                > srv->ring_size) {
+                return OM_ERR_BUS_RECORD_TOO_LARGE;
+            }
+        }
+        _server_hist_append_batch(srv, recs, count);
+        for (uint32_t i = 0; i < count; i++) {
+            _server_ring_append_frame(srv, recs[i].wal_seq, recs[i].wal_type,
+                                      recs[i].payload, recs[i].payload_len);
+        }
+        srv->stats_records_broadcast += count;
+        srv->stats_bytes_broadcast += bytes;
+        return 0;
+    }
+
+    _server_hist_append_batch(srv, recs, count);
+
+    /* Encode each BATCH format some client negotiated, once */
+    uint32_t enc_len[2] = {0, 0};
+    bool enc_ready[2] = {false, false};
+    if (count >= 2U) {
+        for (uint32_t c = 0; c < srv->max_clients; c++) {
+            OmBusTcpClientSlot *slot = &srv->clients[c];
+            if (slot->fd < 0 || slot->disconnect_pending || slot->replaying ||
+                slot->filtered || !(slot->caps & OM_BUS_TCP_CAP_BATCH)) {
+                continue;
+            }
+            int lz = (slot->caps & OM_BUS_TCP_CAP_LZ) ? 1 : 0;
+            if (enc_ready[lz]) continue;
+            int rc = _server_encode(srv, lz, recs, count, bytes, lz != 0, &enc_len[lz]);
+            if (rc < 0) return rc;
+            enc_ready[lz] = true;
+        }
+    }
+
+    bool prepared = false;
+    for (uint32_t c = 0; c < srv->max_clients; c++) {
+        OmBusTcpClientSlot *slot = &srv->clients[c];
+        if (slot->fd < 0 || slot->disconnect_pending || slot->replaying) {
+            continue;
+        }
+        if (slot->filtered) {
+            if (!prepared) {
+                int rc = _server_filter_prepare(srv, recs, count);
+                if (rc < 0) return rc;
+                prepared = true;
+            }
+            int rc = _server_send_view(srv, slot, recs, count);
+            if (rc < 0) return rc;
+            continue;
+        }
+        int lz = (slot->caps & OM_BUS_TCP_CAP_LZ) ? 1 : 0;
+        if (enc_ready[lz] && (slot->caps & OM_BUS_TCP_CAP_BATCH)) {
+            _server_append_stream(srv, slot, srv->enc[lz], enc_len[lz]);
+            continue;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            if (slot->disconnect_pending) {
+                break;
+            }
+            _server_append_frame(srv,
+                                 slot,
+                                 recs[i].wal_seq,
+                                 recs[i].wal_type,
+                                 recs[i].payload,
+                                 recs[i].payload_len);
+        }
+    }
+
+    srv->stats_records_broadcast += count;
+    srv->stats_bytes_broadcast += bytes;
+    return 0;
+}
+
+/* Apply one control frame. Returns false to disconnect the client. */
+static bool _server_handle_ctrl(OmBusTcpServer *srv, OmBusTcpClientSlot *slot,
+                                const OmBusTcpFrameHeader *hdr,
+                                const uint8_t *payload) {
+    if (hdr->wal_type == OM_BUS_TCP_WAL_TYPE_HELLO) {
+        if (hdr->payload_len < 4U) return false;
+        uint32_t offered;
+        memcpy(&offered, payload, 4);
+        /* SHARED: the ring has one encoding, the client must take it */
+        if (srv->mode == OM_BUS_TCP_SERVER_SHARED && (srv->caps & ~offered)) {
+            return false;
+        }
+        slot->caps = offered & srv->caps;
+        if (!(slot->caps & OM_BUS_TCP_CAP_BATCH)) slot->caps = 0;
+    } else if (hdr->wal_type == OM_BUS_TCP_WAL_TYPE_SUBSCRIBE) {
+        if (hdr->payload_len < 8U || (hdr->payload_len - 8U) % 2U != 0U) return false;
+        /* SHARED: one byte stream for everyone, nothing to filter per client */
+        if (srv->mode == OM_BUS_TCP_SERVER_SHARED) return true;
+        uint32_t n = (hdr->payload_len - 8U) / 2U;
+        if (n > 0 && !slot->sub_stage) {
+            slot->sub_stage = calloc(OM_TCP_PRODUCT_WORDS, sizeof(uint64_t));
+            if (!slot->sub_stage) return false;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            uint16_t id;
+            memcpy(&id, payload + 8U + 2U * i, 2);
+            slot->sub_stage[id >> 6] |= 1ULL << (id & 63U);
+        }
+        slot->sub_any = slot->sub_any || n > 0;
+        if (hdr->flags & OM_BUS_TCP_FRAME_FLAG_MORE) return true;
+
+        /* Last frame: the staged set replaces the current one */
+        uint64_t mask;
+        memcpy(&mask, payload, 8);
+        slot->type_mask = mask ? mask : UINT64_MAX;
+        if (slot->sub_any) {
+            uint64_t *prev = slot->products;
+            slot->products = slot->sub_stage;
+            slot->sub_stage = prev;
+            if (prev) memset(prev, 0, OM_TCP_PRODUCT_WORDS * sizeof(uint64_t));
+        } else {
+            free(slot->products);
+            slot->products = NULL;
+        }
+        slot->sub_any = false;
+        slot->filtered = slot->products || slot->type_mask != UINT64_MAX;
+        if (!slot->filtered) _server_flush_skip(srv, slot);
+    } else if (hdr->wal_type == OM_BUS_TCP_WAL_TYPE_RESEND) {
+        srv->stats_resend_requests++;
+        _server_src_close(srv, slot);
+        slot->replaying = false;
+        slot->skipping = false;  /* the replay starts over at wal_seq */
+        slot->replay_seq = hdr->wal_seq;
+        if (srv->mode == OM_BUS_TCP_SERVER_SHARED) {
+            slot->resend_pending = true;  /* at the next frame boundary */
+        } else {
+            _server_resend_start(srv, slot);
+        }
+    }
+    return true;  /* unknown control frames are ignored */
+}
+
+/* Drain client -> server bytes (non-blocking, until EAGAIN) and apply any
+ * complete control frames. Returns false on FIN, error or bad framing. */
+static bool _server_read_ctrl(OmBusTcpServer *srv, OmBusTcpClientSlot *slot) {
+    for (;;) {
+        ssize_t n = recv(slot->fd, slot->ctrl_buf + slot->ctrl_len,
+                         OM_TCP_CTRL_BUF_SIZE - slot->ctrl_len,
+                         OM_MSG_NOSIGNAL | MSG_DONTWAIT);  /* URING sockets block */
+        if (n == 0) return false;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        slot->ctrl_len += (uint32_t)n;
+
+        uint32_t off = 0;
+        while (slot->ctrl_len - off >= OM_BUS_TCP_FRAME_HEADER_SIZE) {
+            OmBusTcpFrameHeader hdr;
+            memcpy(&hdr, slot->ctrl_buf + off, OM_BUS_TCP_FRAME_HEADER_SIZE);
+            uint32_t fsz = OM_BUS_TCP_FRAME_HEADER_SIZE + hdr.payload_len;
+            if (hdr.magic != OM_BUS_TCP_FRAME_MAGIC || fsz > OM_TCP_CTRL_BUF_SIZE) {
+                return false;
+            }
+            if (slot->ctrl_len - off < fsz) break;
+            if (!_server_handle_ctrl(srv, slot, &hdr,
+                                     slot->ctrl_buf + off + OM_BUS_TCP_FRAME_HEADER_SIZE)) {
+                return false;
+            }
+            off += fsz;
+        }
+        if (off > 0) {
+            memmove(slot->ctrl_buf, slot->ctrl_buf + off, slot->ctrl_len - off);
+            slot->ctrl_len -= off;
+        }
+    }
+}
+
+/* Take an accepted socket into a free slot. Returns the slot index, or
+ * UINT32_MAX if the socket was closed (no room / no memory). */
+static uint32_t _server_add_client(OmBusTcpServer *srv, int cfd) {
+    /* Find free slot */
+    uint32_t slot_idx = UINT32_MAX;
+    for (uint32_t i = 0; i < srv->max_clients; i++) {
+        if (srv->clients[i].fd < 0 && !srv->clients[i].io_closing) { slot_idx = i; break; }
+    }
+
+    if (slot_idx == UINT32_MAX) {
+        close(cfd); /* no room */
+        return UINT32_MAX;
+    }
+
+    /* URING: SEND on a blocking socket waits in the ring, not with EAGAIN */
+    if (srv->mode != OM_BUS_TCP_SERVER_URING) _set_nonblocking(cfd);
+    _set_tcp_nodelay(cfd);
+    _set_keepalive(cfd);
+#ifdef __APPLE__
+    _set_nosigpipe(cfd);
+#endif
+
+    OmBusTcpClientSlot *slot = &srv->clients[slot_idx];
+    slot->fd = cfd;
+    if (srv->mode == OM_BUS_TCP_SERVER_SHARED) {
+#ifdef __linux__
+        struct epoll_event ev = {
+            .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET,
+            .data.u32 = slot_idx,
+        };
+        if (epoll_ctl(srv->epfd, EPOLL_CTL_ADD, cfd, &ev) < 0) {
+            close(cfd);
+            slot->fd = -1;
+            return UINT32_MAX;
+        }
+#endif
+        /* Start at the live head; writable until the first EAGAIN */
+        slot->ring_off = srv->ring_head;
+        slot->writable = true;
+        slot->slow = false;
+    } else {
+        slot->send_buf = malloc(srv->send_buf_size);
+        if (!slot->send_buf) {
+            close(cfd);
+            slot->fd = -1;
+            return UINT32_MAX;
+        }
+        slot->send_buf_size = srv->send_buf_size;
+        slot->send_used = 0;
+        slot->send_offset = 0;
+    }
+    slot->disconnect_pending = false;
+    slot->caps = 0;
+    slot->ctrl_len = 0;
+    srv->client_count++;
+    srv->stats_clients_accepted++;
+    return slot_idx;
+}
+
+/* Accept all pending connections (listen fd is non-blocking) */
+static void _server_accept(OmBusTcpServer *srv) {
+    for (;;) {
+        int cfd = accept(srv->listen_fd, NULL, NULL);
+        if (cfd < 0) break;
+        _server_add_client(srv, cfd);
+    }
+}
+
+#ifdef __linux__
+static int _server_poll_io_shared(OmBusTcpServer *srv) {
+    int n = epoll_wait(srv->epfd, srv->events, (int)srv->max_clients + 1, 0);
+    if (n < 0) {
+        if (errno != EINTR) return OM_ERR_BUS_TCP_IO;
+        n = 0;
+    }
+
+    for (int i = 0; i < n; i++) {
+        uint32_t si = srv->events[i].data.u32;
+        uint32_t ev = srv->events[i].events;
+        if (si == OM_TCP_LISTEN_TAG) {
+            _server_accept(srv);
+            continue;
+        }
+        OmBusTcpClientSlot *slot = &srv->clients[si];
+        if (slot->fd < 0) continue;
+        if (ev & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) {
+            slot->disconnect_pending = true;
+        } else if ((ev & EPOLLIN) && !_server_read_ctrl(srv, slot)) {
+            slot->disconnect_pending = true;
+        }
+        if (ev & EPOLLOUT) {
+            slot->writable = true;
+        }
+    }
+
+    /* Flush every client from the shared ring, then reap */
+    for (uint32_t i = 0; i < srv->max_clients; i++) {
+        OmBusTcpClientSlot *slot = &srv->clients[i];
+        if (slot->fd < 0) continue;
+        _server_flush_shared(srv, slot);
+        if (slot->disconnect_pending) _server_close_client(srv, i);
     }
-    slot->send_used += frame_size;
+    return 0;
 }
+#endif
 
-int om_bus_tcp_server_broadcast(OmBusTcpServer *srv, uint64_t wal_seq,
-                                 uint8_t wal_type, const void *payload, uint16_t len) {
-    if (!srv) return OM_ERR_BUS_INIT;
+/* COPY / URING: top up catch-up clients and report idle SKIP runs, so the
+ * send_bufs hold everything owed before I/O is issued */
+static void _server_copy_prepare(OmBusTcpServer *srv) {
+    for (uint32_t i = 0; i < srv->max_clients; i++) {
+        OmBusTcpClientSlot *slot = &srv->clients[i];
+        if (slot->fd >= 0 && slot->replaying && !slot->disconnect_pending) {
+            _server_replay_fill(srv, slot);
+        }
+    }
 
+    /* Report withheld runs to filtered clients gone idle */
+    uint64_t now = 0;
     for (uint32_t i = 0; i < srv->max_clients; i++) {
         OmBusTcpClientSlot *slot = &srv->clients[i];
-        if (slot->fd < 0 || slot->disconnect_pending) continue;
-        _server_append_frame(srv, slot, wal_seq, wal_type, payload, len);
+        if (slot->fd < 0 || !slot->skipping || slot->replaying || slot->disconnect_pending) {
+            continue;
+        }
+        if (now == 0) {
+            now = _monotonic_ms();
+            if (now - srv->skip_flush_ms < OM_TCP_SKIP_FLUSH_MS) break;
+            srv->skip_flush_ms = now;
+        }
+        _server_flush_skip(srv, slot);
     }
+}
 
-    srv->stats_records_broadcast++;
-    srv->stats_bytes_broadcast += len;
-    return 0;
+#ifdef OM_TCP_URING
+static void _server_uring_arm_accept(OmBusTcpServer *srv) {
+    struct io_uring_sqe *sqe = _uring_sqe(&srv->uring);
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = srv->listen_fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = OM_TCP_IO_TAG(OM_TCP_IO_ACCEPT, 0, 0);
+    srv->accept_armed = true;
 }
 
-int om_bus_tcp_server_broadcast_batch(OmBusTcpServer *srv,
-                                      const OmBusRecord *recs,
-                                      uint32_t count) {
-    if (!srv || (!recs && count > 0)) {
-        return OM_ERR_BUS_INIT;
+static void _server_uring_arm_poll(OmBusTcpServer *srv, uint32_t idx) {
+    OmBusTcpClientSlot *slot = &srv->clients[idx];
+    struct io_uring_sqe *sqe = _uring_sqe(&srv->uring);
+    if (!sqe) {
+        slot->disconnect_pending = true;
+        return;
     }
-    if (count == 0) {
-        return 0;
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = slot->fd;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->poll32_events = EPOLLIN | EPOLLRDHUP;  /* epoll bits = poll bits */
+    sqe->user_data = OM_TCP_IO_TAG(OM_TCP_IO_POLL, slot->io_gen, idx);
+    slot->io_polled = true;
+}
+
+static void _server_uring_complete(OmBusTcpServer *srv, const struct io_uring_cqe *cqe) {
+    uint32_t op = (uint32_t)(cqe->user_data >> 56);
+    uint32_t gen = (uint32_t)(cqe->user_data >> 32) & 0xFFFFFFU;
+    uint32_t idx = (uint32_t)cqe->user_data;
+    bool more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+
+    if (op == OM_TCP_IO_ACCEPT) {
+        if (!more) srv->accept_armed = false;  /* re-armed by poll_io */
+        if (cqe->res < 0) return;
+        uint32_t si = _server_add_client(srv, cqe->res);
+        if (si != UINT32_MAX) _server_uring_arm_poll(srv, si);
+        return;
     }
+    if (op != OM_TCP_IO_POLL && op != OM_TCP_IO_SEND) return;
 
-    uint64_t bytes = 0;
-    for (uint32_t i = 0; i < count; i++) {
-        bytes += recs[i].payload_len;
+    OmBusTcpClientSlot *slot = &srv->clients[idx];
+    if (op == OM_TCP_IO_SEND && slot->io_closing && (slot->io_gen & 0xFFFFFFU) == gen) {
+        /* The parked slot's last SEND is done: free it for reuse */
+        slot->io_closing = false;
+        slot->io_sending = 0;
+        slot->io_gen++;
+        free(slot->send_buf);
+        slot->send_buf = NULL;
+        return;
     }
+    if (slot->fd < 0 || (slot->io_gen & 0xFFFFFFU) != gen) return;  /* stale */
 
-    for (uint32_t c = 0; c < srv->max_clients; c++) {
-        OmBusTcpClientSlot *slot = &srv->clients[c];
-        if (slot->fd < 0 || slot->disconnect_pending) {
-            continue;
+    if (op == OM_TCP_IO_POLL) {
+        if (!more) slot->io_polled = false;
+        if (cqe->res < 0) {
+            if (cqe->res != -ECANCELED) slot->disconnect_pending = true;
+        } else if (cqe->res & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) {
+            slot->disconnect_pending = true;
+        } else if ((cqe->res & EPOLLIN) && !_server_read_ctrl(srv, slot)) {
+            slot->disconnect_pending = true;
         }
-        for (uint32_t i = 0; i < count; i++) {
-            if (slot->disconnect_pending) {
-                break;
+        if (!slot->io_polled && !slot->disconnect_pending) _server_uring_arm_poll(srv, idx);
+        return;
+    }
+
+    slot->io_sending = 0;
+    if (cqe->res > 0) {
+        slot->send_offset += (uint32_t)cqe->res;
+        if (slot->send_offset == slot->send_used) {
+            slot->send_offset = 0;
+            slot->send_used = 0;
+        }
+    } else if (cqe->res != -EAGAIN && cqe->res != -EINTR) {
+        slot->disconnect_pending = true;
+    }
+    if (slot->disconnect_pending) _server_close_client(srv, idx);
+}
+
+/* Reap every completion in the CQ ring */
+static void _server_uring_reap(OmBusTcpServer *srv) {
+    OmTcpUring *r = &srv->uring;
+    uint32_t head = *r->cq_head;
+    uint32_t tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        for (; head != tail; head++) {
+            _server_uring_complete(srv, &r->cqes[head & *r->cq_mask]);
+        }
+        __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+        tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+    }
+}
+
+/* Destroy: wait out the SENDs of parked slots so their send_bufs can go */
+static void _server_uring_drain(OmBusTcpServer *srv) {
+    for (;;) {
+        _server_uring_reap(srv);
+        bool parked = false;
+        for (uint32_t i = 0; i < srv->max_clients && !parked; i++) {
+            parked = srv->clients[i].io_closing;
+        }
+        if (!parked || _uring_submit(&srv->uring, 1) < 0) return;
+    }
+}
+
+/* URING: reap completions from the CQ ring, queue one SEND per client with
+ * bytes pending and none in flight, then submit everything in one enter */
+static int _server_poll_io_uring(OmBusTcpServer *srv) {
+    OmTcpUring *r = &srv->uring;
+    _server_uring_reap(srv);
+    if (!srv->accept_armed) _server_uring_arm_accept(srv);
+
+    _server_copy_prepare(srv);
+
+    for (uint32_t i = 0; i < srv->max_clients; i++) {
+        OmBusTcpClientSlot *slot = &srv->clients[i];
+        if (slot->fd < 0) continue;
+        uint32_t pending = slot->send_used - slot->send_offset;
+        if (slot->disconnect_pending) {
+            /* One last non-blocking SEND delivers the warning frame, as in
+             * COPY; its completion closes. A SEND stuck in flight is failed
+             * by the shutdown and reaped by the parked slot. */
+            if (slot->io_sending > 0 || pending == 0) {
+                _server_close_client(srv, i);
+                continue;
             }
-            _server_append_frame(srv,
-                                 slot,
-                                 recs[i].wal_seq,
-                                 recs[i].wal_type,
-                                 recs[i].payload,
-                                 recs[i].payload_len);
+        } else if (slot->io_sending > 0 || pending == 0) {
+            continue;
         }
+        /* Compact now, while nothing is in flight: the SEND pins its bytes */
+        _server_slot_room(slot);
+        struct io_uring_sqe *sqe = _uring_sqe(r);
+        if (!sqe) break;
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = slot->fd;
+        sqe->addr = (uint64_t)(uintptr_t)slot->send_buf;
+        sqe->len = pending;
+        sqe->msg_flags = MSG_NOSIGNAL | (slot->disconnect_pending ? MSG_DONTWAIT : 0);
+        sqe->user_data = OM_TCP_IO_TAG(OM_TCP_IO_SEND, slot->io_gen, i);
+        slot->io_sending = pending;
     }
 
-    srv->stats_records_broadcast += count;
-    srv->stats_bytes_broadcast += bytes;
-    return 0;
+    return _uring_submit(r, 0) < 0 ? OM_ERR_BUS_TCP_IO : 0;
 }
+#endif
 
 int om_bus_tcp_server_poll_io(OmBusTcpServer *srv) {
     if (!srv) return OM_ERR_BUS_INIT;
 
+#ifdef __linux__
+    if (srv->mode == OM_BUS_TCP_SERVER_SHARED) return _server_poll_io_shared(srv);
+#endif
+#ifdef OM_TCP_URING
+    if (srv->mode == OM_BUS_TCP_SERVER_URING) return _server_poll_io_uring(srv);
+#endif
+
+    _server_copy_prepare(srv);
+
     /* Build pollfd array */
     nfds_t nfds = 0;
 
@@ -357,43 +2050,7 @@ int om_bus_tcp_server_poll_io(OmBusTcpServer *srv) {
 
     /* Accept new connections */
     if (srv->pollfds[0].revents & POLLIN) {
-        for (;;) {
-            int cfd = accept(srv->listen_fd, NULL, NULL);
-            if (cfd < 0) break;
-
-            /* Find free slot */
-            uint32_t slot_idx = UINT32_MAX;
-            for (uint32_t i = 0; i < srv->max_clients; i++) {
-                if (srv->clients[i].fd < 0) { slot_idx = i; break; }
-            }
-
-            if (slot_idx == UINT32_MAX) {
-                close(cfd); /* no room */
-                continue;
-            }
-
-            _set_nonblocking(cfd);
-            _set_tcp_nodelay(cfd);
-            _set_keepalive(cfd);
-#ifdef __APPLE__
-            _set_nosigpipe(cfd);
-#endif
-
-            OmBusTcpClientSlot *slot = &srv->clients[slot_idx];
-            slot->fd = cfd;
-            slot->send_buf = malloc(srv->send_buf_size);
-            if (!slot->send_buf) {
-                close(cfd);
-                slot->fd = -1;
-                continue;
-            }
-            slot->send_buf_size = srv->send_buf_size;
-            slot->send_used = 0;
-            slot->send_offset = 0;
-            slot->disconnect_pending = false;
-            srv->client_count++;
-            srv->stats_clients_accepted++;
-        }
+        _server_accept(srv);
     }
 
     /* Process client I/O */
@@ -407,13 +2064,9 @@ int om_bus_tcp_server_poll_io(OmBusTcpServer *srv) {
         /* Detect disconnect */
         if (rev & (POLLHUP | POLLERR)) {
             slot->disconnect_pending = true;
-        } else if (rev & POLLIN) {
-            /* Peek to detect FIN */
-            char tmp;
-            ssize_t n = recv(slot->fd, &tmp, 1, MSG_PEEK | OM_MSG_NOSIGNAL);
-            if (n == 0) {
-                slot->disconnect_pending = true;
-            }
+        } else if ((rev & POLLIN) && !_server_read_ctrl(srv, slot)) {
+            /* FIN or malformed control frame */
+            slot->disconnect_pending = true;
         }
 
         /* Flush send buffer (also flush disconnect_pending to deliver warning frame) */
@@ -454,6 +2107,12 @@ void om_bus_tcp_server_stats(const OmBusTcpServer *srv, OmBusTcpServerStats *out
     out->clients_accepted = srv->stats_clients_accepted;
     out->clients_disconnected = srv->stats_clients_disconnected;
     out->slow_client_drops = srv->stats_slow_client_drops;
+    out->max_client_lag = srv->stats_max_client_lag;
+    out->batch_frames = srv->stats_batch_frames;
+    out->lz_bytes_saved = srv->stats_lz_bytes_saved;
+    out->resend_requests = srv->stats_resend_requests;
+    out->records_replayed = srv->stats_records_replayed;
+    out->records_filtered = srv->stats_records_filtered;
 }
 
 void om_bus_tcp_server_destroy(OmBusTcpServer *srv) {
@@ -464,9 +2123,34 @@ void om_bus_tcp_server_destroy(OmBusTcpServer *srv) {
             _server_close_client(srv, i);
     }
 
+#ifdef OM_TCP_URING
+    /* Closing the ring cancels whatever is still in flight; the SENDs that
+     * read client send_bufs are waited for first */
+    if (srv->uring.fd >= 0) {
+        _server_uring_drain(srv);
+        if (srv->listen_fd >= 0) shutdown(srv->listen_fd, SHUT_RDWR);
+    }
+    _uring_exit(&srv->uring);
+#endif
     if (srv->listen_fd >= 0)
         close(srv->listen_fd);
+    if (srv->epfd >= 0)
+        close(srv->epfd);
 
+#ifdef __linux__
+    free(srv->events);
+#endif
+    free(srv->ring);
+    free(srv->enc[0]);
+    free(srv->enc[1]);
+    free(srv->enc[2]);
+    free(srv->flt_recs);
+    free(srv->flt_marks);
+    free(srv->flt_prod);
+    free(srv->lz_scratch);
+    free(srv->lz_table);
+    free(srv->hist);
+    free(srv->hist_off);
     free(srv->pfd_to_slot);
     free(srv->pollfds);
     free(srv->clients);
@@ -477,8 +2161,80 @@ void om_bus_tcp_server_destroy(OmBusTcpServer *srv) {
  * Client
  * ============================================================================ */
 
+/* Blocking-style send on a non-blocking socket (connect-time control frames) */
+static int _client_send_all(int fd, const uint8_t *buf, uint32_t len) {
+    uint32_t off = 0;
+    while (off < len) {
+        ssize_t n = send(fd, buf + off, len - off, OM_MSG_NOSIGNAL);
+        if (n > 0) {
+            off += (uint32_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            struct pollfd pfd = { .fd = fd, .events = POLLOUT, .revents = 0 };
+            if (poll(&pfd, 1, 1000) <= 0) return OM_ERR_BUS_TCP_IO;
+        } else {
+            return OM_ERR_BUS_TCP_IO;
+        }
+    }
+    return 0;
+}
+
+/* SUBSCRIBE frames: ids in chunks, FLAG_MORE on all but the last */
+static int _client_subscribe(int fd, const OmBusTcpClientConfig *cfg) {
+    uint32_t chunks = (cfg->product_count + OM_BUS_TCP_SUBSCRIBE_CHUNK - 1U)
+                    / OM_BUS_TCP_SUBSCRIBE_CHUNK;
+    if (chunks == 0) chunks = 1;
+    uint32_t frame_max = OM_BUS_TCP_FRAME_HEADER_SIZE + 8U + 2U * OM_BUS_TCP_SUBSCRIBE_CHUNK;
+    uint8_t *buf = malloc((size_t)chunks * frame_max);
+    if (!buf) return OM_ERR_BUS_INIT;
+
+    uint32_t pos = 0;
+    for (uint32_t c = 0; c < chunks; c++) {
+        uint32_t first = c * OM_BUS_TCP_SUBSCRIBE_CHUNK;
+        uint32_t n = cfg->product_count - first;
+        if (n > OM_BUS_TCP_SUBSCRIBE_CHUNK) n = OM_BUS_TCP_SUBSCRIBE_CHUNK;
+        if (cfg->product_count == 0) n = 0;
+        OmBusTcpFrameHeader hdr;
+        hdr.magic = OM_BUS_TCP_FRAME_MAGIC;
+        hdr.wal_type = OM_BUS_TCP_WAL_TYPE_SUBSCRIBE;
+        hdr.flags = (c + 1U < chunks) ? OM_BUS_TCP_FRAME_FLAG_MORE : 0;
+        hdr.payload_len = (uint16_t)(8U + 2U * n);
+        hdr.wal_seq = 0;
+        memcpy(buf + pos, &hdr, OM_BUS_TCP_FRAME_HEADER_SIZE);
+        memcpy(buf + pos + OM_BUS_TCP_FRAME_HEADER_SIZE, &cfg->type_mask, 8);
+        if (n > 0) {
+            memcpy(buf + pos + OM_BUS_TCP_FRAME_HEADER_SIZE + 8U, cfg->products + first, 2U * n);
+        }
+        pos += OM_BUS_TCP_FRAME_HEADER_SIZE + hdr.payload_len;
+    }
+    int rc = _client_send_all(fd, buf, pos);
+    free(buf);
+    return rc;
+}
+
+#ifdef OM_TCP_URING
+/* Ring for the recv path. recv_buf is registered when the memlock limit
+ * allows; otherwise plain READ is used. */
+static int _client_uring_init(OmBusTcpClient *client) {
+    if (_uring_init(&client->uring, 4U) < 0) return -1;
+    struct iovec iov = { .iov_base = client->recv_buf, .iov_len = client->recv_buf_size };
+    client->io_fixed = syscall(__NR_io_uring_register, client->uring.fd,
+                               IORING_REGISTER_BUFFERS, &iov, 1U) == 0;
+    return 0;
+}
+#endif
+
 int om_bus_tcp_client_connect(OmBusTcpClient **out, const OmBusTcpClientConfig *cfg) {
     if (!out || !cfg || !cfg->host) return OM_ERR_BUS_INIT;
+    if (cfg->product_count > 0 && !cfg->products) return OM_ERR_BUS_INIT;
+#ifndef OM_TCP_URING
+    if (cfg->io_uring) return OM_ERR_BUS_INIT;
+#endif
+    /* HELLO/SUBSCRIBE go out before returning, which needs the connection */
+    if (cfg->async_connect &&
+        (cfg->io_uring || cfg->caps || cfg->type_mask || cfg->product_count))
+        return OM_ERR_BUS_INIT;
 
     uint32_t recv_buf_sz = cfg->recv_buf_size ? cfg->recv_buf_size : OM_TCP_DEFAULT_RECV_BUF_SIZE;
 
@@ -494,14 +2250,19 @@ int om_bus_tcp_client_connect(OmBusTcpClient **out, const OmBusTcpClientConfig *
         return OM_ERR_BUS_TCP_CONNECT;
     }
 
-    /* Blocking connect */
+    /* Blocking connect, then non-blocking (io_uring: the ring does the
+     * waiting). Async: non-blocking first, EINPROGRESS is finished by
+     * om_bus_tcp_client_connect_poll(). */
+    bool connecting = false;
+    if (cfg->async_connect) _set_nonblocking(fd);
     if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-        close(fd);
-        return OM_ERR_BUS_TCP_CONNECT;
+        if (!cfg->async_connect || errno != EINPROGRESS) {
+            close(fd);
+            return OM_ERR_BUS_TCP_CONNECT;
+        }
+        connecting = true;
     }
-
-    /* Set non-blocking after connect */
-    _set_nonblocking(fd);
+    if (!cfg->io_uring && !cfg->async_connect) _set_nonblocking(fd);
     _set_tcp_nodelay(fd);
     _set_keepalive(fd);
 #ifdef __APPLE__
@@ -512,6 +2273,10 @@ int om_bus_tcp_client_connect(OmBusTcpClient **out, const OmBusTcpClientConfig *
     if (!client) { close(fd); return OM_ERR_BUS_INIT; }
 
     client->fd = fd;
+    client->connecting = connecting;
+#ifdef OM_TCP_URING
+    client->uring.fd = -1;
+#endif
     client->recv_buf = malloc(recv_buf_sz);
     if (!client->recv_buf) { close(fd); free(client); return OM_ERR_BUS_INIT; }
     client->recv_buf_size = recv_buf_sz;
@@ -520,15 +2285,66 @@ int om_bus_tcp_client_connect(OmBusTcpClient **out, const OmBusTcpClientConfig *
     client->flags = cfg->flags;
     client->expected_wal_seq = 0;
     client->last_wal_seq = 0;
+#ifdef OM_TCP_URING
+    if (cfg->io_uring && _client_uring_init(client) < 0) {
+        om_bus_tcp_client_close(client);
+        return OM_ERR_BUS_INIT;
+    }
+#endif
+
+    /* Offer capabilities; the server answers by switching encodings */
+    if (cfg->caps) {
+        OmBusTcpFrameHeader hdr;
+        hdr.magic = OM_BUS_TCP_FRAME_MAGIC;
+        hdr.wal_type = OM_BUS_TCP_WAL_TYPE_HELLO;
+        hdr.flags = 0;
+        hdr.payload_len = 4;
+        hdr.wal_seq = 0;
+        uint8_t hello[OM_BUS_TCP_FRAME_HEADER_SIZE + 4];
+        memcpy(hello, &hdr, OM_BUS_TCP_FRAME_HEADER_SIZE);
+        memcpy(hello + OM_BUS_TCP_FRAME_HEADER_SIZE, &cfg->caps, 4);
+        if (send(fd, hello, sizeof(hello), OM_MSG_NOSIGNAL) != (ssize_t)sizeof(hello)) {
+            om_bus_tcp_client_close(client);
+            return OM_ERR_BUS_TCP_CONNECT;
+        }
+    }
+
+    if (cfg->type_mask || cfg->product_count) {
+        int rc = _client_subscribe(fd, cfg);
+        if (rc < 0) {
+            om_bus_tcp_client_close(client);
+            return rc == OM_ERR_BUS_INIT ? rc : OM_ERR_BUS_TCP_CONNECT;
+        }
+    }
 
     *out = client;
     return 0;
 }
 
-int om_bus_tcp_client_poll(OmBusTcpClient *client, OmBusRecord *rec) {
-    if (!client || !rec) return OM_ERR_BUS_INIT;
+int om_bus_tcp_client_connect_poll(OmBusTcpClient *client) {
+    if (!client) return OM_ERR_BUS_INIT;
     if (client->fd < 0) return OM_ERR_BUS_TCP_DISCONNECTED;
+    if (!client->connecting) return 1;
+
+    struct pollfd pfd = { .fd = client->fd, .events = POLLOUT };
+    int n = poll(&pfd, 1, 0);
+    if (n < 0) return errno == EINTR ? 0 : OM_ERR_BUS_TCP_CONNECT;
+    if (n == 0) return 0;
+
+    /* Writable means finished either way; SO_ERROR says which */
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(client->fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0)
+        return OM_ERR_BUS_TCP_CONNECT;
+    client->connecting = false;
+    return 1;
+}
 
+/* Compact the recv buffer (deferred so payload pointers handed out by the
+ * previous call stay valid until now), then recv into the free space. With
+ * `drain`, keep reading until EAGAIN or the buffer is full. Returns true if
+ * the peer closed or the socket failed. */
+static void _client_compact(OmBusTcpClient *client) {
     /* Compact buffer if needed: only when offset exceeds half the buffer
      * or when there's no room to recv more data. This avoids memmove on
      * every poll while still keeping space for new data. */
@@ -541,77 +2357,405 @@ int om_bus_tcp_client_poll(OmBusTcpClient *client, OmBusRecord *rec) {
         client->recv_used = pending;
         client->recv_offset = 0;
     }
+}
+
+#ifdef OM_TCP_URING
+/* io_uring: take the read's completion from the CQ ring if it is there (no
+ * syscall), then compact and re-arm it into the free space. With `drain`,
+ * loop while re-armed reads complete at submit time. */
+static bool _client_fill_uring(OmBusTcpClient *client, bool drain) {
+    OmTcpUring *r = &client->uring;
+    for (;;) {
+        uint32_t head = *r->cq_head;
+        if (head != __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE)) {
+            int res = r->cqes[head & *r->cq_mask].res;
+            __atomic_store_n(r->cq_head, head + 1U, __ATOMIC_RELEASE);
+            client->io_reading = false;
+            if (res == 0) return true;
+            if (res < 0 && res != -EAGAIN && res != -EINTR) return true;
+            if (res > 0) client->recv_used += (uint32_t)res;
+        } else if (client->io_reading) {
+            return false;
+        }
+
+        _client_compact(client);
+        if (client->recv_used == client->recv_buf_size) return false;
+        struct io_uring_sqe *sqe = _uring_sqe(r);
+        if (!sqe) return true;
+        sqe->opcode = client->io_fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe->fd = client->fd;
+        sqe->addr = (uint64_t)(uintptr_t)(client->recv_buf + client->recv_used);
+        sqe->len = client->recv_buf_size - client->recv_used;
+        sqe->buf_index = 0;
+        sqe->user_data = OM_TCP_IO_TAG(OM_TCP_IO_READ, 0, 0);
+        client->io_reading = true;
+        if (_uring_submit(r, 0) < 0) return true;
+        if (!drain) return false;
+    }
+}
+#endif
+
+static bool _client_fill(OmBusTcpClient *client, bool drain) {
+#ifdef OM_TCP_URING
+    if (client->uring.fd >= 0) return _client_fill_uring(client, drain);
+#endif
+    _client_compact(client);
 
     /* Try to recv more data */
-    bool peer_closed = false;
-    if (client->recv_used < client->recv_buf_size) {
+    while (client->recv_used < client->recv_buf_size) {
         ssize_t n = recv(client->fd,
                          client->recv_buf + client->recv_used,
                          client->recv_buf_size - client->recv_used,
                          OM_MSG_NOSIGNAL);
         if (n > 0) {
             client->recv_used += (uint32_t)n;
+            if (!drain) break;
         } else if (n == 0) {
-            peer_closed = true;
-        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
-            peer_closed = true;
+            return true;
+        } else if (errno == EINTR) {
+            continue;
+        } else {
+            return errno != EAGAIN && errno != EWOULDBLOCK;
         }
     }
+    return false;
+}
 
-    /* Try to parse one frame from recv_offset */
-    uint32_t avail = client->recv_used - client->recv_offset;
-    if (avail < OM_BUS_TCP_FRAME_HEADER_SIZE)
-        return peer_closed ? OM_ERR_BUS_TCP_DISCONNECTED : 0;
+/* After a RESEND, frames that were already in flight are superseded by the
+ * replay: drop them up to and including the server's ack. A slow-client
+ * warning is left for the caller to report. Returns 1 once resynced (or at
+ * a warning), 0 while the ack is still outstanding. */
+static int _client_resync(OmBusTcpClient *client) {
+    while (client->resync) {
+        uint32_t avail = client->recv_used - client->recv_offset;
+        if (avail < OM_BUS_TCP_FRAME_HEADER_SIZE) return 0;
+        OmBusTcpFrameHeader hdr;
+        memcpy(&hdr, client->recv_buf + client->recv_offset, OM_BUS_TCP_FRAME_HEADER_SIZE);
+        if (hdr.magic != OM_BUS_TCP_FRAME_MAGIC) return OM_ERR_BUS_TCP_PROTOCOL;
+        if (hdr.wal_type == OM_BUS_TCP_WAL_TYPE_SLOW_WARNING) return 1;
+        uint32_t frame_size = OM_BUS_TCP_FRAME_HEADER_SIZE + hdr.payload_len;
+        if (avail < frame_size) return 0;
+        client->recv_offset += frame_size;
+        if (hdr.wal_type == OM_BUS_TCP_WAL_TYPE_RESEND) client->resync = false;
+    }
+    return 1;
+}
 
-    uint8_t *frame_start = client->recv_buf + client->recv_offset;
-    OmBusTcpFrameHeader hdr;
-    memcpy(&hdr, frame_start, OM_BUS_TCP_FRAME_HEADER_SIZE);
+/* Gap / reorder status for a frame's wal_seq (does not update state) */
+static inline int _client_seq_status(const OmBusTcpClient *client, uint64_t wal_seq) {
+    if (client->expected_wal_seq > 0 && wal_seq != client->expected_wal_seq) {
+        if (wal_seq > client->expected_wal_seq) return OM_ERR_BUS_GAP_DETECTED;
+        if (client->flags & OM_BUS_FLAG_REJECT_REORDER) return OM_ERR_BUS_REORDER_DETECTED;
+    }
+    return 1;
+}
+
+/* SKIP frame: the server withheld [wal_seq, to). It only moves the expected
+ * seq when it starts right there, so a real gap before it is still reported
+ * by the next record. */
+static int _client_skip(OmBusTcpClient *client, uint64_t wal_seq,
+                        const void *payload, uint16_t len) {
+    if (len != 8U) return OM_ERR_BUS_TCP_PROTOCOL;
+    uint64_t to;
+    memcpy(&to, payload, 8);
+    if (to <= wal_seq) return OM_ERR_BUS_TCP_PROTOCOL;
+    if (client->expected_wal_seq == 0 || wal_seq == client->expected_wal_seq) {
+        client->expected_wal_seq = to;
+        client->last_wal_seq = to - 1U;
+    }
+    return 0;
+}
+
+/* Start unpacking the BATCH frame at recv_offset (body follows the header
+ * in the recv buffer). The frame is consumed once its last record is. */
+static int _client_batch_open(OmBusTcpClient *client, const OmBusTcpFrameHeader *hdr,
+                              const uint8_t *body) {
+    if (hdr->flags & ~OM_BUS_TCP_FRAME_FLAG_LZ) return OM_ERR_BUS_TCP_PROTOCOL;
+    if (hdr->flags & OM_BUS_TCP_FRAME_FLAG_LZ) {
+        if (hdr->payload_len < 2U) return OM_ERR_BUS_TCP_PROTOCOL;
+        if (!client->lz_buf) {
+            client->lz_buf = malloc(OM_TCP_BATCH_BODY_MAX);
+            if (!client->lz_buf) return OM_ERR_BUS_INIT;
+        }
+        uint16_t raw_len;
+        memcpy(&raw_len, body, 2);
+        if (_lz_decompress(body + 2, hdr->payload_len - 2U, client->lz_buf, raw_len) < 0) {
+            return OM_ERR_BUS_TCP_PROTOCOL;
+        }
+        client->batch_len = raw_len;
+        client->batch_lz = true;
+    } else {
+        client->batch_len = hdr->payload_len;
+        client->batch_lz = false;
+    }
+    if (client->batch_len == 0) return OM_ERR_BUS_TCP_PROTOCOL;
+    client->batch_pos = 0;
+    client->batch_seq = hdr->wal_seq;
+    client->batch_frame = OM_BUS_TCP_FRAME_HEADER_SIZE + hdr->payload_len;
+    client->in_batch = true;
+    return 0;
+}
 
-    if (hdr.magic != OM_BUS_TCP_FRAME_MAGIC)
+/* Decode the next record of the open BATCH frame into rec without consuming
+ * it; *next_pos is where the following record starts. The body is located
+ * afresh on each call since compaction may have moved the frame. */
+static int _client_batch_peek(const OmBusTcpClient *client, OmBusRecord *rec,
+                              uint32_t *next_pos) {
+    const uint8_t *body = client->batch_lz
+        ? client->lz_buf
+        : client->recv_buf + client->recv_offset + OM_BUS_TCP_FRAME_HEADER_SIZE;
+    uint32_t pos = client->batch_pos;
+    uint32_t end = client->batch_len;
+    uint64_t delta, len;
+    if (pos >= end) return OM_ERR_BUS_TCP_PROTOCOL;
+    uint8_t wal_type = body[pos++];
+    if (!_varint_get(body, end, &pos, &delta) || !_varint_get(body, end, &pos, &len) ||
+        len > end - pos) {
         return OM_ERR_BUS_TCP_PROTOCOL;
+    }
+    rec->wal_seq = client->batch_seq + delta;
+    rec->wal_type = wal_type;
+    rec->payload_len = (uint16_t)len;
+    rec->payload = body + pos;
+    *next_pos = pos + (uint32_t)len;
+    return 1;
+}
 
-    uint32_t frame_size = OM_BUS_TCP_FRAME_HEADER_SIZE + hdr.payload_len;
-    if (avail < frame_size)
-        return peer_closed ? OM_ERR_BUS_TCP_DISCONNECTED : 0;
+/* Consume the peeked record; close the frame after its last one (its bytes
+ * stay in the buffer until the next call compacts) */
+static inline void _client_batch_advance(OmBusTcpClient *client, uint64_t wal_seq,
+                                         uint32_t next_pos) {
+    client->batch_seq = wal_seq;
+    client->batch_pos = next_pos;
+    if (next_pos == client->batch_len) {
+        client->in_batch = false;
+        client->recv_offset += client->batch_frame;
+    }
+}
 
-    /* Fill output record — payload points into recv buffer (stable until next poll) */
-    rec->wal_seq = hdr.wal_seq;
-    rec->wal_type = hdr.wal_type;
-    rec->payload_len = hdr.payload_len;
-    rec->payload = frame_start + OM_BUS_TCP_FRAME_HEADER_SIZE;
+int om_bus_tcp_client_poll(OmBusTcpClient *client, OmBusRecord *rec) {
+    if (!client || !rec) return OM_ERR_BUS_INIT;
+    if (client->fd < 0) return OM_ERR_BUS_TCP_DISCONNECTED;
+    if (client->connecting) {
+        int rc = om_bus_tcp_client_connect_poll(client);
+        if (rc <= 0) return rc;
+    }
 
-    /* Advance offset past this frame (data stays in buffer until next poll) */
-    client->recv_offset += frame_size;
+    bool peer_closed = _client_fill(client, false);
 
-    /* Slow client warning frame — don't deliver as a record */
-    if (hdr.wal_type == OM_BUS_TCP_WAL_TYPE_SLOW_WARNING) {
-        return OM_ERR_BUS_TCP_SLOW_WARNING;
+    if (client->resync) {
+        int rc = _client_resync(client);
+        if (rc < 0) return rc;
+        if (rc == 0) return peer_closed ? OM_ERR_BUS_TCP_DISCONNECTED : 0;
     }
 
-    /* Gap / reorder detection */
-    int result = 1;
-    if (client->expected_wal_seq > 0 && hdr.wal_seq != client->expected_wal_seq) {
-        if (hdr.wal_seq > client->expected_wal_seq) {
-            result = OM_ERR_BUS_GAP_DETECTED;
-        } else if (client->flags & OM_BUS_FLAG_REJECT_REORDER) {
-            result = OM_ERR_BUS_REORDER_DETECTED;
+    /* SKIP frames/records are applied and passed over */
+    for (;;) {
+        if (!client->in_batch) {
+            /* Try to parse one frame from recv_offset */
+            uint32_t avail = client->recv_used - client->recv_offset;
+            if (avail < OM_BUS_TCP_FRAME_HEADER_SIZE)
+                return peer_closed ? OM_ERR_BUS_TCP_DISCONNECTED : 0;
+
+            uint8_t *frame_start = client->recv_buf + client->recv_offset;
+            OmBusTcpFrameHeader hdr;
+            memcpy(&hdr, frame_start, OM_BUS_TCP_FRAME_HEADER_SIZE);
+
+            if (hdr.magic != OM_BUS_TCP_FRAME_MAGIC)
+                return OM_ERR_BUS_TCP_PROTOCOL;
+
+            uint32_t frame_size = OM_BUS_TCP_FRAME_HEADER_SIZE + hdr.payload_len;
+            if (avail < frame_size)
+                return peer_closed ? OM_ERR_BUS_TCP_DISCONNECTED : 0;
+
+            if (hdr.wal_type == OM_BUS_TCP_WAL_TYPE_BATCH) {
+                int rc = _client_batch_open(client, &hdr,
+                                            frame_start + OM_BUS_TCP_FRAME_HEADER_SIZE);
+                if (rc < 0) return rc;
+            } else {
+                /* Fill output record — payload points into recv buffer (stable until next poll) */
+                rec->wal_seq = hdr.wal_seq;
+                rec->wal_type = hdr.wal_type;
+                rec->payload_len = hdr.payload_len;
+                rec->payload = frame_start + OM_BUS_TCP_FRAME_HEADER_SIZE;
+
+                /* Advance offset past this frame (data stays in buffer until next poll) */
+                client->recv_offset += frame_size;
+
+                /* Slow client warning frame — don't deliver as a record */
+                if (hdr.wal_type == OM_BUS_TCP_WAL_TYPE_SLOW_WARNING) {
+                    return OM_ERR_BUS_TCP_SLOW_WARNING;
+                }
+                if (hdr.wal_type != OM_BUS_TCP_WAL_TYPE_SKIP) break;
+                int rc = _client_skip(client, rec->wal_seq, rec->payload, rec->payload_len);
+                if (rc < 0) return rc;
+                continue;
+            }
         }
+
+        /* Next record of an open BATCH frame */
+        uint32_t next_pos;
+        int rc = _client_batch_peek(client, rec, &next_pos);
+        if (rc < 0) return rc;
+        _client_batch_advance(client, rec->wal_seq, next_pos);
+        if (rec->wal_type != OM_BUS_TCP_WAL_TYPE_SKIP) break;
+        rc = _client_skip(client, rec->wal_seq, rec->payload, rec->payload_len);
+        if (rc < 0) return rc;
     }
-    client->expected_wal_seq = hdr.wal_seq + 1;
-    client->last_wal_seq = hdr.wal_seq;
+
+    /* Gap / reorder detection */
+    int result = _client_seq_status(client, rec->wal_seq);
+    client->expected_wal_seq = rec->wal_seq + 1;
+    client->last_wal_seq = rec->wal_seq;
 
     return result;
 }
 
+int om_bus_tcp_client_poll_batch(OmBusTcpClient *client, OmBusRecord *recs,
+                                 uint32_t max_count) {
+    if (!client || !recs) return OM_ERR_BUS_INIT;
+    if (client->fd < 0) return OM_ERR_BUS_TCP_DISCONNECTED;
+    if (max_count == 0) return 0;
+    if (client->connecting) {
+        int rc = om_bus_tcp_client_connect_poll(client);
+        if (rc <= 0) return rc;
+    }
+
+    bool peer_closed = _client_fill(client, true);
+
+    if (client->resync) {
+        int rc = _client_resync(client);
+        if (rc < 0) return rc;
+        if (rc == 0) return peer_closed ? OM_ERR_BUS_TCP_DISCONNECTED : 0;
+    }
+
+    uint32_t count = 0;
+    bool lz_used = false;  /* lz_buf holds payloads already returned */
+    while (count < max_count) {
+        OmBusRecord *rec = &recs[count];
+        int status;
+
+        if (client->in_batch) {
+            uint32_t next_pos;
+            int rc = _client_batch_peek(client, rec, &next_pos);
+            if (rc < 0) return count ? (int)count : rc;
+            if (rec->wal_type == OM_BUS_TCP_WAL_TYPE_SKIP) {
+                rc = _client_skip(client, rec->wal_seq, rec->payload, rec->payload_len);
+                if (rc < 0) return count ? (int)count : rc;
+                _client_batch_advance(client, rec->wal_seq, next_pos);
+                continue;
+            }
+            status = _client_seq_status(client, rec->wal_seq);
+            if (status != 1 && count > 0) break;
+            _client_batch_advance(client, rec->wal_seq, next_pos);
+            lz_used = lz_used || client->batch_lz;
+        } else {
+            uint32_t avail = client->recv_used - client->recv_offset;
+            if (avail < OM_BUS_TCP_FRAME_HEADER_SIZE) break;
+
+            uint8_t *frame_start = client->recv_buf + client->recv_offset;
+            OmBusTcpFrameHeader hdr;
+            memcpy(&hdr, frame_start, OM_BUS_TCP_FRAME_HEADER_SIZE);
+
+            /* Errors and out-of-band frames end the batch; they are reported
+             * on their own once everything before them has been returned */
+            if (hdr.magic != OM_BUS_TCP_FRAME_MAGIC) {
+                return count ? (int)count : OM_ERR_BUS_TCP_PROTOCOL;
+            }
+            uint32_t frame_size = OM_BUS_TCP_FRAME_HEADER_SIZE + hdr.payload_len;
+            if (avail < frame_size) break;
+
+            if (hdr.wal_type == OM_BUS_TCP_WAL_TYPE_SKIP) {
+                int rc = _client_skip(client, hdr.wal_seq,
+                                      frame_start + OM_BUS_TCP_FRAME_HEADER_SIZE,
+                                      hdr.payload_len);
+                if (rc < 0) return count ? (int)count : rc;
+                client->recv_offset += frame_size;
+                continue;
+            }
+
+            if (hdr.wal_type == OM_BUS_TCP_WAL_TYPE_BATCH) {
+                /* A second LZ frame would overwrite payloads in lz_buf */
+                if (lz_used && (hdr.flags & OM_BUS_TCP_FRAME_FLAG_LZ)) break;
+                int rc = _client_batch_open(client, &hdr,
+                                            frame_start + OM_BUS_TCP_FRAME_HEADER_SIZE);
+                if (rc < 0) return count ? (int)count : rc;
+                continue;
+            }
+
+            status = (hdr.wal_type == OM_BUS_TCP_WAL_TYPE_SLOW_WARNING)
+                ? OM_ERR_BUS_TCP_SLOW_WARNING : _client_seq_status(client, hdr.wal_seq);
+            if (status != 1 && count > 0) break;
+
+            rec->wal_seq = hdr.wal_seq;
+            rec->wal_type = hdr.wal_type;
+            rec->payload_len = hdr.payload_len;
+            rec->payload = frame_start + OM_BUS_TCP_FRAME_HEADER_SIZE;
+            client->recv_offset += frame_size;
+
+            if (status == OM_ERR_BUS_TCP_SLOW_WARNING) return status;
+        }
+
+        client->expected_wal_seq = rec->wal_seq + 1;
+        client->last_wal_seq = rec->wal_seq;
+        if (status != 1) return status; /* recs[0] populated, like poll() */
+        count++;
+    }
+
+    if (count == 0 && peer_closed) return OM_ERR_BUS_TCP_DISCONNECTED;
+    return (int)count;
+}
+
+int om_bus_tcp_client_resend(OmBusTcpClient *client, uint64_t from_seq) {
+    if (!client || from_seq == 0) return OM_ERR_BUS_INIT;
+    if (client->fd < 0) return OM_ERR_BUS_TCP_DISCONNECTED;
+    if (client->connecting) return OM_ERR_BUS_TCP_IO;
+
+    OmBusTcpFrameHeader hdr;
+    hdr.magic = OM_BUS_TCP_FRAME_MAGIC;
+    hdr.wal_type = OM_BUS_TCP_WAL_TYPE_RESEND;
+    hdr.flags = 0;
+    hdr.payload_len = 0;
+    hdr.wal_seq = from_seq;
+    ssize_t n;
+    do {
+        n = send(client->fd, &hdr, OM_BUS_TCP_FRAME_HEADER_SIZE, OM_MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    if (n != (ssize_t)OM_BUS_TCP_FRAME_HEADER_SIZE) return OM_ERR_BUS_TCP_IO;
+
+    /* A half-consumed BATCH frame is superseded by the replay too */
+    if (client->in_batch) {
+        client->recv_offset += client->batch_frame;
+        client->in_batch = false;
+    }
+    client->resync = true;
+    client->expected_wal_seq = from_seq;
+    return 0;
+}
+
 uint64_t om_bus_tcp_client_wal_seq(const OmBusTcpClient *client) {
     return client ? client->last_wal_seq : 0;
 }
 
 void om_bus_tcp_client_close(OmBusTcpClient *client) {
     if (!client) return;
+#ifdef OM_TCP_URING
+    /* Wake the read in flight and wait for it before recv_buf goes away */
+    if (client->uring.fd >= 0) {
+        if (client->io_reading) {
+            shutdown(client->fd, SHUT_RDWR);
+            while (*client->uring.cq_head ==
+                   __atomic_load_n(client->uring.cq_tail, __ATOMIC_ACQUIRE)) {
+                if (_uring_submit(&client->uring, 1) < 0) break;
+            }
+        }
+        _uring_exit(&client->uring);
+    }
+#endif
     if (client->fd >= 0)
         close(client->fd);
     free(client->recv_buf);
+    free(client->lz_buf);
     free(client);
 }
 
@@ -619,12 +2763,6 @@ void om_bus_tcp_client_close(OmBusTcpClient *client) {
  * Auto-Reconnect Client
  * ============================================================================ */
 
-static uint64_t _monotonic_ms(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
-}
-
 struct OmBusTcpAutoClient {
     OmBusTcpClient          *inner;
     OmBusTcpAutoClientConfig cfg;
@@ -656,39 +2794,60 @@ int om_bus_tcp_auto_client_create(OmBusTcpAutoClient **out,
     return 0;
 }
 
-int om_bus_tcp_auto_client_poll(OmBusTcpAutoClient *client, OmBusRecord *rec) {
-    if (!client || !rec) return OM_ERR_BUS_INIT;
+/* If disconnected, try to reconnect. Returns 1 when connected, 0 while
+ * backing off, negative once retries are exhausted. */
+static int _auto_client_ensure(OmBusTcpAutoClient *client) {
+    if (!client->disconnected) return 1;
 
-    /* If disconnected, try to reconnect */
-    if (client->disconnected) {
-        uint64_t now = _monotonic_ms();
-        if (now < client->next_retry_ms) return 0; /* still in backoff */
+    uint64_t now = _monotonic_ms();
+    if (now < client->next_retry_ms) return 0; /* still in backoff */
 
-        /* Check max retries */
-        if (client->cfg.max_retries > 0 &&
-            client->retry_count >= client->cfg.max_retries) {
-            return OM_ERR_BUS_TCP_DISCONNECTED;
-        }
+    /* Check max retries */
+    if (client->cfg.max_retries > 0 &&
+        client->retry_count >= client->cfg.max_retries) {
+        return OM_ERR_BUS_TCP_DISCONNECTED;
+    }
 
-        /* Attempt reconnect */
-        OmBusTcpClient *new_inner = NULL;
-        int rc = om_bus_tcp_client_connect(&new_inner, &client->cfg.base);
-        if (rc < 0) {
-            client->retry_count++;
-            /* Exponential backoff */
-            client->current_backoff_ms = client->current_backoff_ms * 2;
-            if (client->current_backoff_ms > client->cfg.retry_max_ms)
-                client->current_backoff_ms = client->cfg.retry_max_ms;
-            client->next_retry_ms = _monotonic_ms() + client->current_backoff_ms;
-            return 0; /* reconnecting */
-        }
+    /* Attempt reconnect */
+    OmBusTcpClient *new_inner = NULL;
+    int rc = om_bus_tcp_client_connect(&new_inner, &client->cfg.base);
+    if (rc < 0) {
+        client->retry_count++;
+        /* Exponential backoff */
+        client->current_backoff_ms = client->current_backoff_ms * 2;
+        if (client->current_backoff_ms > client->cfg.retry_max_ms)
+            client->current_backoff_ms = client->cfg.retry_max_ms;
+        client->next_retry_ms = _monotonic_ms() + client->current_backoff_ms;
+        return 0; /* reconnecting */
+    }
 
-        /* Reconnected successfully */
-        client->inner = new_inner;
-        client->disconnected = false;
-        client->retry_count = 0;
-        client->current_backoff_ms = client->cfg.retry_base_ms;
+    /* Reconnected successfully: resume where the old connection stopped */
+    if (client->last_wal_seq > 0) {
+        (void)om_bus_tcp_client_resend(new_inner, client->last_wal_seq + 1);
     }
+    client->inner = new_inner;
+    client->disconnected = false;
+    client->retry_count = 0;
+    client->current_backoff_ms = client->cfg.retry_base_ms;
+    return 1;
+}
+
+/* Inner client reported disconnect: drop it and schedule a reconnect */
+static void _auto_client_lost(OmBusTcpAutoClient *client) {
+    uint64_t seq = om_bus_tcp_client_wal_seq(client->inner);
+    if (seq > client->last_wal_seq) client->last_wal_seq = seq;
+    om_bus_tcp_client_close(client->inner);
+    client->inner = NULL;
+    client->disconnected = true;
+    client->current_backoff_ms = client->cfg.retry_base_ms;
+    client->next_retry_ms = _monotonic_ms() + client->current_backoff_ms;
+}
+
+int om_bus_tcp_auto_client_poll(OmBusTcpAutoClient *client, OmBusRecord *rec) {
+    if (!client || !rec) return OM_ERR_BUS_INIT;
+
+    int ready = _auto_client_ensure(client);
+    if (ready <= 0) return ready;
 
     /* Normal poll */
     int rc = om_bus_tcp_client_poll(client->inner, rec);
@@ -697,17 +2856,32 @@ int om_bus_tcp_auto_client_poll(OmBusTcpAutoClient *client, OmBusRecord *rec) {
         return 1;
     }
     if (rc == OM_ERR_BUS_TCP_DISCONNECTED) {
-        om_bus_tcp_client_close(client->inner);
-        client->inner = NULL;
-        client->disconnected = true;
-        client->current_backoff_ms = client->cfg.retry_base_ms;
-        client->next_retry_ms = _monotonic_ms() + client->current_backoff_ms;
+        _auto_client_lost(client);
         return 0; /* will retry on next poll */
     }
 
     return rc; /* 0 (no frame), gap, protocol error, etc. */
 }
 
+int om_bus_tcp_auto_client_poll_batch(OmBusTcpAutoClient *client,
+                                      OmBusRecord *recs, uint32_t max_count) {
+    if (!client || !recs) return OM_ERR_BUS_INIT;
+
+    int ready = _auto_client_ensure(client);
+    if (ready <= 0) return ready;
+
+    int rc = om_bus_tcp_client_poll_batch(client->inner, recs, max_count);
+    if (rc > 0) {
+        client->last_wal_seq = recs[rc - 1].wal_seq;
+        return rc;
+    }
+    if (rc == OM_ERR_BUS_TCP_DISCONNECTED) {
+        _auto_client_lost(client);
+        return 0;
+    }
+    return rc;
+}
+
 uint64_t om_bus_tcp_auto_client_wal_seq(const OmBusTcpAutoClient *client) {
     if (!client) return 0;
     if (client->inner)
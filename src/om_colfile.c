@@ -0,0 +1,658 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "om_colfile.h"
+#include "om_error.h"
+
+_Static_assert(sizeof(OmColFileHeader) == 64, "OmColFileHeader must be 64 bytes");
+_Static_assert(sizeof(OmColTableDesc) == 64, "OmColTableDesc must be 64 bytes");
+_Static_assert(sizeof(OmColColumnDesc) == 32, "OmColColumnDesc must be 32 bytes");
+_Static_assert(sizeof(OmColChunkDesc) == 16, "OmColChunkDesc must be 16 bytes");
+_Static_assert(sizeof(OmColChunkColumn) == 24, "OmColChunkColumn must be 24 bytes");
+
+#define COL_WRITE_BUFFER (1024 * 1024)
+
+/* Bytes of one chunk entry in the footer */
+static inline size_t col_chunk_stride(uint32_t column_count) {
+    return sizeof(OmColChunkDesc) + (size_t)column_count * sizeof(OmColChunkColumn);
+}
+
+static inline bool col_type_valid(uint8_t type) {
+    return type >= OM_COL_U8 && type <= OM_COL_U64;
+}
+
+/* ============================================================================
+ * Writer
+ * ============================================================================ */
+
+typedef struct ColWriterTable {
+    OmColTableDesc desc;
+    OmColColumnDesc cols[OM_COL_MAX_COLUMNS];
+    uint8_t *buf[OM_COL_MAX_COLUMNS];   /* chunk_rows values per column */
+    uint32_t fill;                      /* rows buffered for the current chunk */
+    uint8_t *chunks;                    /* footer entries, chunk_count x stride */
+    uint32_t chunks_cap;
+} ColWriterTable;
+
+struct OmColWriter {
+    FILE *fp;
+    char *io_buf;
+    uint64_t offset;                    /* bytes written so far */
+    uint32_t chunk_rows;
+    uint32_t table_count;
+    ColWriterTable *tables[OM_COL_MAX_TABLES];
+    OmColFileHeader hdr;
+    bool failed;
+};
+
+static void col_write(OmColWriter *w, const void *data, size_t len) {
+    if (w->failed || len == 0) {
+        return;
+    }
+    if (fwrite(data, 1, len, w->fp) != len) {
+        w->failed = true;
+        return;
+    }
+    w->offset += len;
+}
+
+/* Zero-fill up to the next OM_COL_ALIGN boundary */
+static void col_pad(OmColWriter *w) {
+    static const uint8_t zeros[OM_COL_ALIGN];
+    size_t rem = (size_t)(w->offset % OM_COL_ALIGN);
+    if (rem) {
+        col_write(w, zeros, OM_COL_ALIGN - rem);
+    }
+}
+
+static void col_minmax(const void *data, OmColType type, uint32_t rows,
+                       uint64_t *min_out, uint64_t *max_out) {
+    uint64_t lo = UINT64_MAX, hi = 0;
+#define COL_MINMAX(T) do { \
+        const T *v = data; \
+        for (uint32_t i = 0; i < rows; i++) { \
+            uint64_t x = v[i]; \
+            lo = x < lo ? x : lo; \
+            hi = x > hi ? x : hi; \
+        } \
+    } while (0)
+    switch (type) {
+        case OM_COL_U8:  COL_MINMAX(uint8_t); break;
+        case OM_COL_U16: COL_MINMAX(uint16_t); break;
+        case OM_COL_U32: COL_MINMAX(uint32_t); break;
+        case OM_COL_U64:
+        default:         COL_MINMAX(uint64_t); break;
+    }
+#undef COL_MINMAX
+    *min_out = lo;
+    *max_out = hi;
+}
+
+/* Write the buffered rows of a table as one chunk */
+static int col_flush_chunk(OmColWriter *w, ColWriterTable *t) {
+    if (t->fill == 0) {
+        return 0;
+    }
+    size_t stride = col_chunk_stride(t->desc.column_count);
+    if (t->desc.chunk_count == t->chunks_cap) {
+        uint32_t cap = t->chunks_cap ? t->chunks_cap * 2U : 64U;
+        uint8_t *chunks = realloc(t->chunks, (size_t)cap * stride);
+        if (!chunks) {
+            /* The chunk stays buffered at full fill: no append may follow */
+            w->failed = true;
+            return OM_ERR_ALLOC_FAILED;
+        }
+        t->chunks = chunks;
+        t->chunks_cap = cap;
+    }
+    uint8_t *entry = t->chunks + (size_t)t->desc.chunk_count * stride;
+    OmColChunkDesc cd = {
+        .first_row = t->desc.row_count - t->fill,
+        .rows = t->fill,
+    };
+    memcpy(entry, &cd, sizeof(cd));
+    for (uint32_t c = 0; c < t->desc.column_count; c++) {
+        OmColType type = (OmColType)t->cols[c].type;
+        OmColChunkColumn cc;
+        col_pad(w);
+        cc.offset = w->offset;
+        col_minmax(t->buf[c], type, t->fill, &cc.min, &cc.max);
+        col_write(w, t->buf[c], (size_t)t->fill * om_col_type_width(type));
+        memcpy(entry + sizeof(cd) + c * sizeof(cc), &cc, sizeof(cc));
+    }
+    if (w->failed) {
+        return OM_ERR_COL_WRITE;
+    }
+    t->desc.chunk_count++;
+    t->fill = 0;
+    return 0;
+}
+
+int om_col_writer_create(OmColWriter **out, const char *path, uint32_t chunk_rows) {
+    if (!out || !path) {
+        return OM_ERR_NULL_PARAM;
+    }
+    OmColWriter *w = calloc(1, sizeof(*w));
+    if (!w) {
+        return OM_ERR_ALLOC_FAILED;
+    }
+    w->chunk_rows = chunk_rows ? chunk_rows : OM_COL_DEFAULT_CHUNK_ROWS;
+    w->fp = fopen(path, "wb");
+    if (!w->fp) {
+        free(w);
+        return OM_ERR_COL_OPEN;
+    }
+    w->io_buf = malloc(COL_WRITE_BUFFER);
+    if (w->io_buf) {
+        setvbuf(w->fp, w->io_buf, _IOFBF, COL_WRITE_BUFFER);
+    }
+    memcpy(w->hdr.magic, OM_COL_MAGIC, sizeof(w->hdr.magic));
+    w->hdr.version = OM_COL_VERSION;
+    w->hdr.chunk_rows = w->chunk_rows;
+    /* footer_offset stays 0 until close */
+    col_write(w, &w->hdr, sizeof(w->hdr));
+    if (w->failed) {
+        fclose(w->fp);
+        free(w->io_buf);
+        free(w);
+        return OM_ERR_COL_OPEN;
+    }
+    *out = w;
+    return 0;
+}
+
+int om_col_writer_add_table(OmColWriter *w, const char *name,
+                            const OmColColumnDef *columns, uint32_t column_count) {
+    if (!w || !name || !columns) {
+        return OM_ERR_NULL_PARAM;
+    }
+    if (w->table_count == OM_COL_MAX_TABLES || column_count == 0 ||
+        column_count > OM_COL_MAX_COLUMNS || strlen(name) >= OM_COL_NAME_LEN) {
+        return OM_ERR_COL_SCHEMA;
+    }
+    for (uint32_t i = 0; i < w->table_count; i++) {
+        if (strcmp(w->tables[i]->desc.name, name) == 0) {
+            return OM_ERR_COL_SCHEMA;
+        }
+    }
+    ColWriterTable *t = calloc(1, sizeof(*t));
+    if (!t) {
+        return OM_ERR_ALLOC_FAILED;
+    }
+    memcpy(t->desc.name, name, strlen(name) + 1);
+    t->desc.column_count = column_count;
+    for (uint32_t c = 0; c < column_count; c++) {
+        const OmColColumnDef *def = &columns[c];
+        bool dup = false;
+        for (uint32_t k = 0; k < c; k++) {
+            dup |= def->name && strcmp(columns[k].name, def->name) == 0;
+        }
+        if (!def->name || strlen(def->name) >= OM_COL_NAME_LEN ||
+            !col_type_valid((uint8_t)def->type) || dup) {
+            for (uint32_t k = 0; k < c; k++) {
+                free(t->buf[k]);
+            }
+            free(t);
+            return OM_ERR_COL_SCHEMA;
+        }
+        memcpy(t->cols[c].name, def->name, strlen(def->name) + 1);
+        t->cols[c].type = (uint8_t)def->type;
+        t->buf[c] = malloc((size_t)w->chunk_rows * om_col_type_width(def->type));
+        if (!t->buf[c]) {
+            for (uint32_t k = 0; k < c; k++) {
+                free(t->buf[k]);
+            }
+            free(t);
+            return OM_ERR_ALLOC_FAILED;
+        }
+    }
+    w->tables[w->table_count] = t;
+    return (int)w->table_count++;
+}
+
+int om_col_writer_append(OmColWriter *w, uint32_t table, const uint64_t *values) {
+    if (!w || !values) {
+        return OM_ERR_NULL_PARAM;
+    }
+    if (table >= w->table_count) {
+        return OM_ERR_OUT_OF_RANGE;
+    }
+    if (w->failed) {
+        return OM_ERR_COL_WRITE;
+    }
+    ColWriterTable *t = w->tables[table];
+    uint32_t row = t->fill;
+    for (uint32_t c = 0; c < t->desc.column_count; c++) {
+        switch ((OmColType)t->cols[c].type) {
+            case OM_COL_U8:  ((uint8_t *)t->buf[c])[row] = (uint8_t)values[c]; break;
+            case OM_COL_U16: ((uint16_t *)t->buf[c])[row] = (uint16_t)values[c]; break;
+            case OM_COL_U32: ((uint32_t *)t->buf[c])[row] = (uint32_t)values[c]; break;
+            case OM_COL_U64:
+            default:         ((uint64_t *)t->buf[c])[row] = values[c]; break;
+        }
+    }
+    t->fill++;
+    t->desc.row_count++;
+    if (t->fill == w->chunk_rows) {
+        return col_flush_chunk(w, t);
+    }
+    return 0;
+}
+
+void om_col_writer_set_seq_range(OmColWriter *w, uint64_t first_seq, uint64_t last_seq) {
+    if (w) {
+        w->hdr.first_seq = first_seq;
+        w->hdr.last_seq = last_seq;
+    }
+}
+
+static void col_writer_free(OmColWriter *w) {
+    for (uint32_t i = 0; i < w->table_count; i++) {
+        ColWriterTable *t = w->tables[i];
+        for (uint32_t c = 0; c < t->desc.column_count; c++) {
+            free(t->buf[c]);
+        }
+        free(t->chunks);
+        free(t);
+    }
+    free(w);
+}
+
+int om_col_writer_close(OmColWriter *w) {
+    if (!w) {
+        return OM_ERR_NULL_PARAM;
+    }
+    int rc = 0;
+    for (uint32_t i = 0; i < w->table_count && rc == 0; i++) {
+        rc = col_flush_chunk(w, w->tables[i]);
+    }
+
+    /* Footer: table descriptors, then each table's columns and chunks */
+    col_pad(w);
+    uint64_t footer_offset = w->offset;
+    uint64_t rel = (uint64_t)w->table_count * sizeof(OmColTableDesc);
+    for (uint32_t i = 0; i < w->table_count; i++) {
+        ColWriterTable *t = w->tables[i];
+        t->desc.columns_offset = rel;
+        rel += (uint64_t)t->desc.column_count * sizeof(OmColColumnDesc);
+        t->desc.chunks_offset = rel;
+        rel += (uint64_t)t->desc.chunk_count * col_chunk_stride(t->desc.column_count);
+    }
+    for (uint32_t i = 0; i < w->table_count; i++) {
+        col_write(w, &w->tables[i]->desc, sizeof(OmColTableDesc));
+    }
+    for (uint32_t i = 0; i < w->table_count; i++) {
+        ColWriterTable *t = w->tables[i];
+        col_write(w, t->cols, (size_t)t->desc.column_count * sizeof(OmColColumnDesc));
+        col_write(w, t->chunks,
+                  (size_t)t->desc.chunk_count * col_chunk_stride(t->desc.column_count));
+    }
+
+    /* Publishing footer_offset last marks the file complete */
+    w->hdr.table_count = w->table_count;
+    w->hdr.footer_offset = footer_offset;
+    w->hdr.footer_size = w->offset - footer_offset;
+    if (rc == 0 && !w->failed) {
+        if (fflush(w->fp) != 0 || fseek(w->fp, 0, SEEK_SET) != 0 ||
+            fwrite(&w->hdr, sizeof(w->hdr), 1, w->fp) != 1) {
+            w->failed = true;
+        }
+    }
+    if (fclose(w->fp) != 0) {
+        w->failed = true;
+    }
+    if (rc == 0 && w->failed) {
+        rc = OM_ERR_COL_WRITE;
+    }
+    free(w->io_buf);
+    col_writer_free(w);
+    return rc;
+}
+
+/* ============================================================================
+ * Reader
+ * ============================================================================ */
+
+struct OmColFile {
+    const uint8_t *map;
+    size_t size;
+    const OmColFileHeader *hdr;
+    const OmColTableDesc *tables;
+    const uint8_t *footer;
+};
+
+static inline const OmColColumnDesc *col_columns(const OmColFile *f, const OmColTableDesc *t) {
+    return (const OmColColumnDesc *)(f->footer + t->columns_offset);
+}
+
+static inline const uint8_t *col_chunk_entry(const OmColFile *f, const OmColTableDesc *t,
+                                             uint32_t chunk) {
+    return f->footer + t->chunks_offset + (size_t)chunk * col_chunk_stride(t->column_count);
+}
+
+static bool col_name_valid(const char *name) {
+    return memchr(name, '\0', OM_COL_NAME_LEN) != NULL && name[0] != '\0';
+}
+
+/* Check that every footer offset and column array lies inside the file */
+static int col_validate(const OmColFile *f) {
+    const OmColFileHeader *h = f->hdr;
+    if (memcmp(h->magic, OM_COL_MAGIC, sizeof(h->magic)) != 0 || h->version != OM_COL_VERSION) {
+        return OM_ERR_COL_FORMAT;
+    }
+    if (h->footer_offset == 0) {
+        return OM_ERR_COL_INCOMPLETE;
+    }
+    if (h->footer_offset % OM_COL_ALIGN != 0 || h->footer_offset < sizeof(*h) ||
+        h->footer_offset > f->size || h->footer_size > f->size - h->footer_offset ||
+        h->table_count > OM_COL_MAX_TABLES || h->chunk_rows == 0 ||
+        (uint64_t)h->table_count * sizeof(OmColTableDesc) > h->footer_size) {
+        return OM_ERR_COL_FORMAT;
+    }
+    for (uint32_t i = 0; i < h->table_count; i++) {
+        const OmColTableDesc *t = &f->tables[i];
+        if (!col_name_valid(t->name) || t->column_count == 0 ||
+            t->column_count > OM_COL_MAX_COLUMNS) {
+            return OM_ERR_COL_FORMAT;
+        }
+        uint64_t stride = col_chunk_stride(t->column_count);
+        if (t->columns_offset % 8 != 0 || t->chunks_offset % 8 != 0 ||
+            t->columns_offset > h->footer_size ||
+            (uint64_t)t->column_count * sizeof(OmColColumnDesc) >
+                h->footer_size - t->columns_offset ||
+            t->chunks_offset > h->footer_size ||
+            (uint64_t)t->chunk_count > (h->footer_size - t->chunks_offset) / stride) {
+            return OM_ERR_COL_FORMAT;
+        }
+        const OmColColumnDesc *cols = col_columns(f, t);
+        for (uint32_t c = 0; c < t->column_count; c++) {
+            if (!col_name_valid(cols[c].name) || !col_type_valid(cols[c].type)) {
+                return OM_ERR_COL_FORMAT;
+            }
+        }
+        uint64_t rows = 0;
+        for (uint32_t k = 0; k < t->chunk_count; k++) {
+            const uint8_t *entry = col_chunk_entry(f, t, k);
+            const OmColChunkDesc *cd = (const OmColChunkDesc *)entry;
+            const OmColChunkColumn *cc = (const OmColChunkColumn *)(entry + sizeof(*cd));
+            if (cd->rows == 0 || cd->rows > h->chunk_rows || cd->first_row != rows) {
+                return OM_ERR_COL_FORMAT;
+            }
+            for (uint32_t c = 0; c < t->column_count; c++) {
+                uint64_t bytes = (uint64_t)cd->rows * om_col_type_width((OmColType)cols[c].type);
+                if (cc[c].offset % OM_COL_ALIGN != 0 || cc[c].offset < sizeof(*h) ||
+                    cc[c].offset > h->footer_offset ||
+                    bytes > h->footer_offset - cc[c].offset) {
+                    return OM_ERR_COL_FORMAT;
+                }
+            }
+            rows += cd->rows;
+        }
+        if (rows != t->row_count) {
+            return OM_ERR_COL_FORMAT;
+        }
+    }
+    return 0;
+}
+
+int om_col_open(OmColFile **out, const char *path) {
+    if (!out || !path) {
+        return OM_ERR_NULL_PARAM;
+    }
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return OM_ERR_COL_OPEN;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return OM_ERR_COL_OPEN;
+    }
+    if ((uint64_t)st.st_size < sizeof(OmColFileHeader)) {
+        close(fd);
+        return OM_ERR_COL_FORMAT;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return OM_ERR_COL_OPEN;
+    }
+    OmColFile *f = calloc(1, sizeof(*f));
+    if (!f) {
+        munmap(map, (size_t)st.st_size);
+        return OM_ERR_ALLOC_FAILED;
+    }
+    f->map = map;
+    f->size = (size_t)st.st_size;
+    f->hdr = map;
+    f->footer = f->map + f->hdr->footer_offset;
+    f->tables = (const OmColTableDesc *)f->footer;
+    int rc = col_validate(f);
+    if (rc != 0) {
+        om_col_close(f);
+        return rc;
+    }
+    *out = f;
+    return 0;
+}
+
+void om_col_close(OmColFile *f) {
+    if (!f) {
+        return;
+    }
+    munmap((void *)f->map, f->size);
+    free(f);
+}
+
+const OmColFileHeader *om_col_header(const OmColFile *f) {
+    return f->hdr;
+}
+
+uint32_t om_col_table_count(const OmColFile *f) {
+    return f->hdr->table_count;
+}
+
+const OmColTableDesc *om_col_table(const OmColFile *f, uint32_t table) {
+    return table < f->hdr->table_count ? &f->tables[table] : NULL;
+}
+
+const OmColColumnDesc *om_col_column(const OmColFile *f, uint32_t table, uint32_t column) {
+    const OmColTableDesc *t = om_col_table(f, table);
+    if (!t || column >= t->column_count) {
+        return NULL;
+    }
+    return &col_columns(f, t)[column];
+}
+
+int om_col_table_find(const OmColFile *f, const char *name) {
+    for (uint32_t i = 0; i < f->hdr->table_count; i++) {
+        if (strcmp(f->tables[i].name, name) == 0) {
+            return (int)i;
+        }
+    }
+    return OM_ERR_NOT_FOUND;
+}
+
+int om_col_column_find(const OmColFile *f, uint32_t table, const char *name) {
+    const OmColTableDesc *t = om_col_table(f, table);
+    if (!t) {
+        return OM_ERR_NOT_FOUND;
+    }
+    const OmColColumnDesc *cols = col_columns(f, t);
+    for (uint32_t c = 0; c < t->column_count; c++) {
+        if (strcmp(cols[c].name, name) == 0) {
+            return (int)c;
+        }
+    }
+    return OM_ERR_NOT_FOUND;
+}
+
+const OmColChunkDesc *om_col_chunk(const OmColFile *f, uint32_t table, uint32_t chunk) {
+    const OmColTableDesc *t = om_col_table(f, table);
+    if (!t || chunk >= t->chunk_count) {
+        return NULL;
+    }
+    return (const OmColChunkDesc *)col_chunk_entry(f, t, chunk);
+}
+
+const OmColChunkColumn *om_col_chunk_column(const OmColFile *f, uint32_t table,
+                                            uint32_t chunk, uint32_t column) {
+    const OmColTableDesc *t = om_col_table(f, table);
+    if (!t || chunk >= t->chunk_count || column >= t->column_count) {
+        return NULL;
+    }
+    const uint8_t *entry = col_chunk_entry(f, t, chunk);
+    return &((const OmColChunkColumn *)(entry + sizeof(OmColChunkDesc)))[column];
+}
+
+/* ============================================================================
+ * Scan
+ * ============================================================================ */
+
+int om_col_scan_init(OmColScan *scan, const OmColFile *f, uint32_t table,
+                     const OmColPred *preds, uint32_t pred_count) {
+    if (!scan || !f || (pred_count && !preds)) {
+        return OM_ERR_NULL_PARAM;
+    }
+    const OmColTableDesc *t = om_col_table(f, table);
+    if (!t || pred_count > OM_COL_MAX_PREDS) {
+        return OM_ERR_OUT_OF_RANGE;
+    }
+    for (uint32_t i = 0; i < pred_count; i++) {
+        if (preds[i].column >= t->column_count) {
+            return OM_ERR_OUT_OF_RANGE;
+        }
+    }
+    memset(scan, 0, sizeof(*scan));
+    scan->file = f;
+    scan->table = table;
+    scan->pred_count = pred_count;
+    if (pred_count) {
+        memcpy(scan->preds, preds, pred_count * sizeof(*preds));
+        scan->sel = malloc((size_t)f->hdr->chunk_rows * sizeof(uint32_t));
+        if (!scan->sel) {
+            return OM_ERR_ALLOC_FAILED;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Selection kernels. Branch-free: every row index is stored and the output
+ * count advances by the comparison result. (x - lo) <= (hi - lo) in unsigned
+ * arithmetic tests lo <= x <= hi with one compare.
+ */
+static uint32_t col_select_all(const void *col, OmColType type, uint32_t rows,
+                               uint64_t lo, uint64_t span, uint32_t *sel) {
+    uint32_t n = 0;
+#define COL_SELECT_ALL(T) do { \
+        const T *v = col; \
+        for (uint32_t i = 0; i < rows; i++) { \
+            sel[n] = i; \
+            n += (uint64_t)v[i] - lo <= span; \
+        } \
+    } while (0)
+    switch (type) {
+        case OM_COL_U8:  COL_SELECT_ALL(uint8_t); break;
+        case OM_COL_U16: COL_SELECT_ALL(uint16_t); break;
+        case OM_COL_U32: COL_SELECT_ALL(uint32_t); break;
+        case OM_COL_U64:
+        default:         COL_SELECT_ALL(uint64_t); break;
+    }
+#undef COL_SELECT_ALL
+    return n;
+}
+
+static uint32_t col_select_refine(const void *col, OmColType type, uint32_t count,
+                                  uint64_t lo, uint64_t span, uint32_t *sel) {
+    uint32_t n = 0;
+#define COL_SELECT_REFINE(T) do { \
+        const T *v = col; \
+        for (uint32_t j = 0; j < count; j++) { \
+            uint32_t r = sel[j]; \
+            sel[n] = r; \
+            n += (uint64_t)v[r] - lo <= span; \
+        } \
+    } while (0)
+    switch (type) {
+        case OM_COL_U8:  COL_SELECT_REFINE(uint8_t); break;
+        case OM_COL_U16: COL_SELECT_REFINE(uint16_t); break;
+        case OM_COL_U32: COL_SELECT_REFINE(uint32_t); break;
+        case OM_COL_U64:
+        default:         COL_SELECT_REFINE(uint64_t); break;
+    }
+#undef COL_SELECT_REFINE
+    return n;
+}
+
+int om_col_scan_next(OmColScan *scan, OmColBatch *batch) {
+    const OmColFile *f = scan->file;
+    const OmColTableDesc *t = &f->tables[scan->table];
+    const OmColColumnDesc *cols = col_columns(f, t);
+
+    while (scan->next_chunk < t->chunk_count) {
+        const uint8_t *entry = col_chunk_entry(f, t, scan->next_chunk++);
+        const OmColChunkDesc *cd = (const OmColChunkDesc *)entry;
+        const OmColChunkColumn *cc = (const OmColChunkColumn *)(entry + sizeof(*cd));
+
+        /* Chunk statistics first: skip, or pass whole, or filter rows */
+        bool skip = false;
+        bool whole = true;
+        for (uint32_t i = 0; i < scan->pred_count && !skip; i++) {
+            const OmColPred *p = &scan->preds[i];
+            const OmColChunkColumn *st = &cc[p->column];
+            skip = p->min > p->max || st->max < p->min || st->min > p->max;
+            whole &= st->min >= p->min && st->max <= p->max;
+        }
+        if (skip) {
+            scan->chunks_skipped++;
+            continue;
+        }
+        scan->chunks_scanned++;
+
+        uint32_t count = cd->rows;
+        bool filtered = false;
+        if (!whole) {
+            for (uint32_t i = 0; i < scan->pred_count && count > 0; i++) {
+                const OmColPred *p = &scan->preds[i];
+                const OmColChunkColumn *st = &cc[p->column];
+                if (st->min >= p->min && st->max <= p->max) {
+                    continue;   /* every row passes this one */
+                }
+                const void *col = f->map + st->offset;
+                OmColType type = (OmColType)cols[p->column].type;
+                count = filtered
+                    ? col_select_refine(col, type, count, p->min, p->max - p->min, scan->sel)
+                    : col_select_all(col, type, cd->rows, p->min, p->max - p->min, scan->sel);
+                filtered = true;
+            }
+            if (count == 0) {
+                continue;
+            }
+        }
+
+        batch->first_row = cd->first_row;
+        batch->rows = cd->rows;
+        batch->count = count;
+        batch->sel = filtered ? scan->sel : NULL;
+        for (uint32_t c = 0; c < t->column_count; c++) {
+            batch->cols[c] = f->map + cc[c].offset;
+        }
+        scan->rows_selected += count;
+        return 1;
+    }
+    return 0;
+}
+
+void om_col_scan_close(OmColScan *scan) {
+    if (scan) {
+        free(scan->sel);
+        scan->sel = NULL;
+    }
+}
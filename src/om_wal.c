@@ -275,6 +275,17 @@ void om_wal_set_post_write(OmWal *wal,
     }
 }
 
+void om_wal_set_clock(OmWal *wal, uint64_t (*fn)(void *ctx), void *ctx) {
+    if (wal) {
+        wal->clock_ns = fn;
+        wal->clock_ctx = ctx;
+    }
+}
+
+static inline uint64_t wal_timestamp_ns(const OmWal *wal) {
+    return wal->clock_ns ? wal->clock_ns(wal->clock_ctx) : wal_get_timestamp_ns();
+}
+
 void om_wal_close(OmWal *wal) {
     if (!wal) return;
 
@@ -368,7 +379,7 @@ uint64_t om_wal_insert(OmWal *wal, struct OmSlabSlot *slot, uint16_t product_id)
     insert.product_id = product_id;
     insert.user_data_size = (uint32_t)user_data_size;
     insert.aux_data_size = (uint32_t)aux_data_size;
-    insert.timestamp_ns = wal_get_timestamp_ns();
+    insert.timestamp_ns = wal_timestamp_ns(wal);
 
     memcpy((char *)wal->buffer + wal->buffer_used, &insert, sizeof(OmWalInsert));
     wal->buffer_used += sizeof(OmWalInsert);
@@ -411,7 +422,7 @@ uint64_t om_wal_cancel(OmWal *wal, uint32_t order_id, uint32_t slot_idx, uint16_
     OmWalCancel rec;
     memset(&rec, 0, sizeof(rec));
     rec.order_id = order_id;
-    rec.timestamp_ns = wal_get_timestamp_ns();
+    rec.timestamp_ns = wal_timestamp_ns(wal);
     rec.slot_idx = slot_idx;
     rec.product_id = product_id;
 
@@ -426,7 +437,7 @@ uint64_t om_wal_deactivate(OmWal *wal, uint32_t order_id, uint32_t slot_idx, uin
     OmWalDeactivate rec;
     memset(&rec, 0, sizeof(rec));
     rec.order_id = order_id;
-    rec.timestamp_ns = wal_get_timestamp_ns();
+    rec.timestamp_ns = wal_timestamp_ns(wal);
     rec.slot_idx = slot_idx;
     rec.product_id = product_id;
 
@@ -441,7 +452,7 @@ uint64_t om_wal_activate(OmWal *wal, uint32_t order_id, uint32_t slot_idx, uint1
     OmWalActivate rec;
     memset(&rec, 0, sizeof(rec));
     rec.order_id = order_id;
-    rec.timestamp_ns = wal_get_timestamp_ns();
+    rec.timestamp_ns = wal_timestamp_ns(wal);
     rec.slot_idx = slot_idx;
     rec.product_id = product_id;
 
@@ -662,6 +673,28 @@ void om_wal_replay_close(OmWalReplay *replay) {
 
 static int replay_advance_file(OmWalReplay *replay);
 
+static inline bool wal_replay_type_valid(uint8_t type) {
+    return (type >= OM_WAL_INSERT && type <= OM_WAL_ACTIVATE) || type >= OM_WAL_USER_BASE;
+}
+
+/* Zeros from file offset `off` (not 4KB aligned) up to the next boundary, or to `avail` */
+static bool wal_is_flush_padding(const uint8_t *p, size_t avail, uint64_t off) {
+    size_t in_block = (size_t)(off & (REPLAY_ALIGN - 1));
+    if (in_block == 0) {
+        return false;
+    }
+    size_t n = REPLAY_ALIGN - in_block;
+    if (n > avail) {
+        n = avail;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (p[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /* Fill buffer from file */
 static int replay_fill_buffer(OmWalReplay *replay) {
     while (replay->eof || replay->file_offset >= replay->file_size) {
@@ -708,6 +741,17 @@ static int replay_fill_buffer(OmWalReplay *replay) {
     return 1;
 }
 
+/*
+ * Refill while buffer_pos is just past a record header: keep the header in
+ * the buffer, the CRC covers it.
+ */
+static int replay_refill_in_record(OmWalReplay *replay) {
+    replay->buffer_pos -= sizeof(OmWalHeader);
+    int ret = replay_fill_buffer(replay);
+    replay->buffer_pos += sizeof(OmWalHeader);
+    return ret;
+}
+
 static int replay_advance_file(OmWalReplay *replay) {
     if (!replay || replay->fd < 0) {
         return OM_ERR_NULL_PARAM;
@@ -760,8 +804,35 @@ int om_wal_replay_next(OmWalReplay *replay, OmWalType *type, void **data,
         uint8_t type_byte = om_wal_header_type(packed);
         uint16_t payload_len = om_wal_header_len(packed);
 
+        /*
+         * om_wal_flush zero-pads every write to 4KB, so zeros up to a 4KB
+         * boundary are padding: the next flush starts at that boundary. The
+         * padding can be shorter than a header.
+         */
+        if (!wal_replay_type_valid(type_byte) &&
+            wal_is_flush_padding((const uint8_t *)record_start,
+                                 replay->buffer_valid - replay->buffer_pos,
+                                 replay->last_record_offset)) {
+            uint64_t next = (replay->last_record_offset + REPLAY_ALIGN - 1) & ~(uint64_t)(REPLAY_ALIGN - 1);
+            if (next < replay->file_size) {
+                uint64_t skip = next - replay->last_record_offset;
+                if (replay->buffer_pos + skip <= replay->buffer_valid) {
+                    replay->buffer_pos += skip;
+                } else {
+                    if (lseek(replay->fd, (off_t)next, SEEK_SET) < 0) {
+                        return OM_ERR_WAL_READ;
+                    }
+                    replay->file_offset = next;
+                    replay->buffer_valid = 0;
+                    replay->buffer_pos = 0;
+                    replay->eof = false;
+                }
+                continue;
+            }
+        }
+
         /* Treat invalid type as EOF (handles zero padding at file end) */
-        if (type_byte < OM_WAL_INSERT || (type_byte > OM_WAL_ACTIVATE && type_byte < OM_WAL_USER_BASE)) {
+        if (!wal_replay_type_valid(type_byte)) {
             if (replay->filename_pattern) {
                 replay->buffer_pos = replay->buffer_valid;
                 int ret = replay_fill_buffer(replay);
@@ -777,7 +848,7 @@ int om_wal_replay_next(OmWalReplay *replay, OmWalType *type, void **data,
 
         if (*type == OM_WAL_INSERT) {
         if (replay->buffer_pos + sizeof(OmWalInsert) > replay->buffer_valid) {
-            int ret = replay_fill_buffer(replay);
+            int ret = replay_refill_in_record(replay);
             if (ret < 0) return OM_ERR_WAL_READ;
             if (ret == 0 || replay->buffer_pos + sizeof(OmWalInsert) > replay->buffer_valid) {
                 return OM_ERR_WAL_TRUNCATED;
@@ -793,7 +864,7 @@ int om_wal_replay_next(OmWalReplay *replay, OmWalType *type, void **data,
 
         size_t needed = *data_len + crc_size;
         if (replay->buffer_pos + needed > replay->buffer_valid) {
-            int ret = replay_fill_buffer(replay);
+            int ret = replay_refill_in_record(replay);
             if (ret < 0) return OM_ERR_WAL_READ;
             if (ret == 0 || replay->buffer_pos + needed > replay->buffer_valid) {
                 return OM_ERR_WAL_TRUNCATED;
@@ -825,7 +896,7 @@ int om_wal_replay_next(OmWalReplay *replay, OmWalType *type, void **data,
 
         size_t needed = *data_len + crc_size;
         if (replay->buffer_pos + needed > replay->buffer_valid) {
-            int ret = replay_fill_buffer(replay);
+            int ret = replay_refill_in_record(replay);
             if (ret < 0) return OM_ERR_WAL_READ;
             if (ret == 0 || replay->buffer_pos + needed > replay->buffer_valid) {
                 return OM_ERR_WAL_TRUNCATED;
@@ -863,6 +934,244 @@ int om_wal_replay_next(OmWalReplay *replay, OmWalType *type, void **data,
     }
 }
 
+/* ============================================================================
+ * WAL REPLAY SEEK
+ * ============================================================================ */
+
+#define SEEK_WINDOW (256 * 1024)  /* bytes scanned to resync inside a flush */
+#define SEEK_CHAIN 3              /* consecutive records that confirm a resync */
+
+/*
+ * Validate the record at buf[pos]: known type, length consistent with the
+ * type, CRC when enabled. Returns the record size or 0.
+ */
+static size_t seek_check_record(const OmWalReplay *replay, const uint8_t *buf, size_t n,
+                                size_t pos, uint64_t *seq) {
+    if (pos + sizeof(OmWalHeader) > n) {
+        return 0;
+    }
+    uint64_t packed;
+    memcpy(&packed, buf + pos, sizeof(packed));
+    uint8_t type = om_wal_header_type(packed);
+    size_t len = om_wal_header_len(packed);
+    *seq = om_wal_header_seq(packed);
+    if (*seq == 0) {
+        return 0;
+    }
+
+    switch (type) {
+        case OM_WAL_INSERT: {
+            if (pos + sizeof(OmWalHeader) + sizeof(OmWalInsert) > n) {
+                return 0;
+            }
+            OmWalInsert ins;
+            memcpy(&ins, buf + pos + sizeof(OmWalHeader), sizeof(ins));
+            if (len != sizeof(OmWalInsert) + (size_t)ins.user_data_size + ins.aux_data_size) {
+                return 0;
+            }
+            break;
+        }
+        case OM_WAL_CANCEL:
+        case OM_WAL_DEACTIVATE:
+        case OM_WAL_ACTIVATE:
+            if (len != sizeof(OmWalCancel)) return 0;
+            break;
+        case OM_WAL_MATCH:
+            if (len != sizeof(OmWalMatch)) return 0;
+            break;
+        case OM_WAL_CHECKPOINT:
+            if (len != wal_payload_size(OM_WAL_CHECKPOINT, 0, 0)) return 0;
+            break;
+        default:
+            if (type < OM_WAL_USER_BASE) return 0;
+            break;
+    }
+
+    size_t crc_size = replay->enable_crc32 ? WAL_CRC32_SIZE : 0;
+    size_t total = sizeof(OmWalHeader) + len + crc_size;
+    if (pos + total > n) {
+        return 0;
+    }
+    if (replay->enable_crc32) {
+        uint32_t stored;
+        memcpy(&stored, buf + pos + sizeof(OmWalHeader) + len, WAL_CRC32_SIZE);
+        if (stored != crc32_compute(buf + pos, sizeof(OmWalHeader) + len)) {
+            return 0;
+        }
+    }
+    return total;
+}
+
+/*
+ * A resync candidate must be followed by SEEK_CHAIN - 1 records with the next
+ * sequence numbers (stepping over flush padding), or by the end of the file.
+ */
+static bool seek_check_chain(const OmWalReplay *replay, const uint8_t *buf, size_t n,
+                             uint64_t base, size_t pos, uint64_t *first_seq) {
+    uint64_t expect = 0;
+    for (int k = 0; k < SEEK_CHAIN; k++) {
+        if (base + pos >= replay->file_size) {
+            return k > 0;
+        }
+        uint64_t seq = 0;
+        size_t size = seek_check_record(replay, buf, n, pos, &seq);
+        if (size == 0 && k > 0 && pos < n && wal_is_flush_padding(buf + pos, n - pos, base + pos)) {
+            uint64_t next = (base + pos + REPLAY_ALIGN - 1) & ~(uint64_t)(REPLAY_ALIGN - 1);
+            if (next >= replay->file_size) {
+                return true;
+            }
+            pos = (size_t)(next - base);
+            size = seek_check_record(replay, buf, n, pos, &seq);
+        }
+        if (size == 0 || (k > 0 && seq != expect)) {
+            return false;
+        }
+        if (k == 0) {
+            *first_seq = seq;
+        }
+        expect = seq + 1;
+        pos += size;
+    }
+    return true;
+}
+
+/* First record at or after byte offset `off` of the current file */
+static int seek_probe(OmWalReplay *replay, uint64_t off, uint64_t *rec_off, uint64_t *rec_seq) {
+    uint8_t *buf = replay->buffer;
+    size_t want = replay->buffer_size < SEEK_WINDOW ? replay->buffer_size : SEEK_WINDOW;
+    if (off >= replay->file_size) {
+        return 0;
+    }
+    if (want > replay->file_size - off) {
+        want = (size_t)(replay->file_size - off);
+    }
+    ssize_t got = pread(replay->fd, buf, want, (off_t)off);
+    if (got < 0) {
+        return OM_ERR_WAL_READ;
+    }
+    size_t n = (size_t)got;
+    /* INSERT payload sizes are not a multiple of 4, so try every byte */
+    for (size_t pos = 0; pos + sizeof(OmWalHeader) <= n; pos++) {
+        if (seek_check_chain(replay, buf, n, off, pos, rec_seq)) {
+            *rec_off = off + pos;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Sequence of the first record of WAL file `index`, 0 if missing or empty */
+static uint64_t seek_file_first_seq(const char *pattern, uint32_t index) {
+    char path[512];
+    snprintf(path, sizeof(path), pattern, index);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    uint64_t packed = 0;
+    ssize_t n = pread(fd, &packed, sizeof(packed), 0);
+    close(fd);
+    if (n != (ssize_t)sizeof(packed)) {
+        return 0;
+    }
+    return om_wal_header_seq(packed);
+}
+
+int om_wal_replay_seek(OmWalReplay *replay, uint64_t sequence) {
+    if (!replay || replay->fd < 0 || !replay->buffer) {
+        return OM_ERR_NULL_PARAM;
+    }
+
+    /* Multi-file: skip whole files whose successor starts at or before target */
+    if (replay->filename_pattern) {
+        while (1) {
+            uint64_t next_first = seek_file_first_seq(replay->filename_pattern,
+                                                      replay->file_index + 1);
+            if (next_first == 0 || next_first > sequence) {
+                break;
+            }
+            int ret = replay_advance_file(replay);
+            if (ret <= 0) {
+                return ret < 0 ? ret : OM_ERR_WAL_OPEN;
+            }
+        }
+    }
+
+    /*
+     * Binary search over 4KB blocks for the last block whose first record is
+     * at or before target. Blocks that do not resync count as "after", which
+     * only makes the caller read a little more.
+     */
+    uint64_t best_off = 0;
+    uint64_t lo = 0;
+    uint64_t hi = (replay->file_size + REPLAY_ALIGN - 1) / REPLAY_ALIGN;
+    while (hi - lo > 1) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        uint64_t rec_off = 0;
+        uint64_t rec_seq = 0;
+        int ret = seek_probe(replay, mid * REPLAY_ALIGN, &rec_off, &rec_seq);
+        if (ret < 0) {
+            return ret;
+        }
+        if (ret == 1 && rec_seq <= sequence) {
+            lo = mid;
+            best_off = rec_off;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lseek(replay->fd, (off_t)best_off, SEEK_SET) < 0) {
+        return OM_ERR_WAL_READ;
+    }
+    replay->file_offset = best_off;
+    replay->buffer_valid = 0;
+    replay->buffer_pos = 0;
+    replay->eof = false;
+    return 0;
+}
+
+int om_wal_replay_seek_offset(OmWalReplay *replay, uint64_t offset, uint64_t *record_offset,
+                              uint64_t *sequence) {
+    if (!replay || replay->fd < 0 || !replay->buffer) {
+        return OM_ERR_NULL_PARAM;
+    }
+
+    uint64_t rec_off = replay->file_size;
+    uint64_t rec_seq = 0;
+    int found = 0;
+    /* Windows overlap by half so a chain cut off at a window end is retried */
+    while (offset < replay->file_size) {
+        found = seek_probe(replay, offset, &rec_off, &rec_seq);
+        if (found != 0) {
+            break;
+        }
+        offset += SEEK_WINDOW / 2;
+    }
+    if (found < 0) {
+        return found;
+    }
+    if (found == 0) {
+        rec_off = replay->file_size;
+        rec_seq = 0;
+    }
+
+    if (lseek(replay->fd, (off_t)rec_off, SEEK_SET) < 0) {
+        return OM_ERR_WAL_READ;
+    }
+    replay->file_offset = rec_off;
+    replay->buffer_valid = 0;
+    replay->buffer_pos = 0;
+    replay->eof = false;
+    if (record_offset) {
+        *record_offset = rec_off;
+    }
+    if (sequence) {
+        *sequence = rec_seq;
+    }
+    return found;
+}
+
 uint64_t om_wal_append_custom(OmWal *wal, OmWalType type, const void *data, size_t len) {
     if (!wal || !data) {
         return 0;
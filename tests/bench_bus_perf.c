@@ -1,6 +1,8 @@
 #include "ombus/om_bus.h"
 #include "ombus/om_bus_tcp.h"
 
+#include "bench_harness.h"
+
 #include <inttypes.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -15,7 +17,11 @@ typedef struct BenchCfg {
     uint32_t shm_batch;
     int run_shm;
     int run_shm_mixed;
+    int run_shm_drain;
     int run_tcp;
+    int run_tcp_uring;
+    const char *json_path;
+    bool counters;
 } BenchCfg;
 
 static uint64_t now_ns(void) {
@@ -48,22 +54,46 @@ static int parse_args(int argc, char **argv, BenchCfg *cfg) {
             if (strcmp(m, "shm") == 0) {
                 cfg->run_shm = 1;
                 cfg->run_shm_mixed = 0;
+                cfg->run_shm_drain = 0;
                 cfg->run_tcp = 0;
+                cfg->run_tcp_uring = 0;
             } else if (strcmp(m, "shm-mixed") == 0) {
                 cfg->run_shm = 0;
                 cfg->run_shm_mixed = 1;
+                cfg->run_shm_drain = 0;
                 cfg->run_tcp = 0;
+                cfg->run_tcp_uring = 0;
+            } else if (strcmp(m, "shm-drain") == 0) {
+                cfg->run_shm = 0;
+                cfg->run_shm_mixed = 0;
+                cfg->run_shm_drain = 1;
+                cfg->run_tcp = 0;
+                cfg->run_tcp_uring = 0;
             } else if (strcmp(m, "tcp") == 0) {
                 cfg->run_shm = 0;
                 cfg->run_shm_mixed = 0;
+                cfg->run_shm_drain = 0;
                 cfg->run_tcp = 1;
+                cfg->run_tcp_uring = 0;
+            } else if (strcmp(m, "tcp-uring") == 0) {
+                cfg->run_shm = 0;
+                cfg->run_shm_mixed = 0;
+                cfg->run_shm_drain = 0;
+                cfg->run_tcp = 1;
+                cfg->run_tcp_uring = 1;
             } else if (strcmp(m, "both") == 0) {
                 cfg->run_shm = 1;
                 cfg->run_shm_mixed = 1;
+                cfg->run_shm_drain = 1;
                 cfg->run_tcp = 1;
+                cfg->run_tcp_uring = 1;
             } else {
                 return -1;
             }
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            cfg->json_path = argv[++i];
+        } else if (strcmp(argv[i], "--no-counters") == 0) {
+            cfg->counters = false;
         } else {
             return -1;
         }
@@ -73,11 +103,13 @@ static int parse_args(int argc, char **argv, BenchCfg *cfg) {
 
 static void usage(const char *prog) {
     fprintf(stderr,
-            "Usage: %s [--mode shm|shm-mixed|tcp|both] [--shm-iters N] [--shm-batch N] [--tcp-iters N]\n",
+            "Usage: %s [--mode shm|shm-mixed|shm-drain|tcp|tcp-uring|both] [--shm-iters N] [--shm-batch N] [--tcp-iters N]\n"
+            "          [--json PATH] [--no-counters]\n",
             prog);
 }
 
-static int run_shm_bench(uint32_t iters, double *ns_per_rec) {
+static int run_shm_bench(uint32_t iters, BenchCounters *ctr, double *ns_per_rec,
+                         BenchCounterSample *hw) {
     OmBusStream *stream = NULL;
     OmBusEndpoint *ep = NULL;
 
@@ -105,6 +137,7 @@ static int run_shm_bench(uint32_t iters, double *ns_per_rec) {
         return rc;
     }
 
+    bench_counters_start(ctr);
     uint64_t t0 = now_ns();
     for (uint32_t i = 0; i < iters; i++) {
         uint64_t payload = (uint64_t)i;
@@ -125,6 +158,7 @@ static int run_shm_bench(uint32_t iters, double *ns_per_rec) {
         }
     }
     uint64_t t1 = now_ns();
+    bench_counters_stop(ctr, hw);
 
     *ns_per_rec = (double)(t1 - t0) / (double)iters;
     om_bus_endpoint_close(ep);
@@ -132,7 +166,8 @@ static int run_shm_bench(uint32_t iters, double *ns_per_rec) {
     return 0;
 }
 
-static int run_tcp_bench(uint32_t iters, double *ns_per_rec) {
+static int run_tcp_bench(uint32_t iters, int uring, BenchCounters *ctr, double *ns_per_rec,
+                         BenchCounterSample *hw) {
     OmBusTcpServer *srv = NULL;
     OmBusTcpClient *client = NULL;
 
@@ -141,6 +176,7 @@ static int run_tcp_bench(uint32_t iters, double *ns_per_rec) {
         .port = 0,
         .max_clients = 8,
         .send_buf_size = 256 * 1024,
+        .mode = uring ? OM_BUS_TCP_SERVER_URING : OM_BUS_TCP_SERVER_COPY,
     };
     int rc = om_bus_tcp_server_create(&srv, &scfg);
     if (rc != 0) return rc;
@@ -150,6 +186,7 @@ static int run_tcp_bench(uint32_t iters, double *ns_per_rec) {
         .port = om_bus_tcp_server_port(srv),
         .recv_buf_size = 256 * 1024,
         .flags = 0,
+        .io_uring = uring != 0,
     };
     rc = om_bus_tcp_client_connect(&client, &ccfg);
     if (rc != 0) {
@@ -168,6 +205,7 @@ static int run_tcp_bench(uint32_t iters, double *ns_per_rec) {
         return OM_ERR_BUS_TCP_CONNECT;
     }
 
+    bench_counters_start(ctr);
     uint64_t t0 = now_ns();
     for (uint32_t i = 0; i < iters; i++) {
         uint64_t payload = (uint64_t)i;
@@ -194,6 +232,7 @@ static int run_tcp_bench(uint32_t iters, double *ns_per_rec) {
         }
     }
     uint64_t t1 = now_ns();
+    bench_counters_stop(ctr, hw);
 
     *ns_per_rec = (double)(t1 - t0) / (double)iters;
     om_bus_tcp_client_close(client);
@@ -203,7 +242,9 @@ static int run_tcp_bench(uint32_t iters, double *ns_per_rec) {
 
 static int run_shm_mixed_bench(uint32_t iters,
                                uint32_t batch,
-                               double *ns_per_rec) {
+                               BenchCounters *ctr,
+                               double *ns_per_rec,
+                               BenchCounterSample *hw) {
     OmBusStream *stream = NULL;
     OmBusEndpoint *ep = NULL;
 
@@ -244,6 +285,7 @@ static int run_shm_mixed_bench(uint32_t iters,
     }
 
     uint64_t seq = 1;
+    bench_counters_start(ctr);
     uint64_t t0 = now_ns();
     uint32_t done = 0;
     while (done < iters) {
@@ -289,6 +331,7 @@ static int run_shm_mixed_bench(uint32_t iters,
         done += chunk;
     }
     uint64_t t1 = now_ns();
+    bench_counters_stop(ctr, hw);
 
     free(pub);
     free(out);
@@ -299,6 +342,111 @@ static int run_shm_mixed_bench(uint32_t iters,
     return 0;
 }
 
+enum { DRAIN_PUBLISH = 0, DRAIN_POLL_BATCH, DRAIN_ITER, DRAIN_PHASES };
+
+typedef struct DrainResult {
+    uint64_t ops[DRAIN_PHASES];
+    double ns_per_rec[DRAIN_PHASES];
+    BenchCounterSample hw[DRAIN_PHASES];
+} DrainResult;
+
+/* Producer and consumer apart: fill the ring (publish), then time draining it
+ * with poll_batch and with the batch iterator on alternate rounds */
+static int run_shm_drain_bench(uint32_t iters,
+                               uint32_t batch,
+                               BenchCounters *ctr,
+                               DrainResult *res) {
+    OmBusStream *stream = NULL;
+    OmBusEndpoint *ep = NULL;
+    const uint32_t cap = 4096;
+
+    OmBusStreamConfig scfg = {
+        .stream_name = "/om-bus-bench-shm-drain",
+        .capacity = cap,
+        .slot_size = 64,
+        .max_consumers = 1,
+    };
+    int rc = om_bus_stream_create(&stream, &scfg);
+    if (rc != 0) return rc;
+
+    OmBusEndpointConfig ecfg = {
+        .stream_name = "/om-bus-bench-shm-drain",
+        .consumer_index = 0,
+        .zero_copy = true,
+    };
+    rc = om_bus_endpoint_open(&ep, &ecfg);
+    if (rc != 0) {
+        om_bus_stream_destroy(stream);
+        return rc;
+    }
+
+    OmBusRecord *out = calloc(batch, sizeof(*out));
+    if (!out) {
+        om_bus_endpoint_close(ep);
+        om_bus_stream_destroy(stream);
+        return OM_ERR_BUS_INIT;
+    }
+
+    memset(res, 0, sizeof(*res));
+    uint64_t seq = 1;
+    uint64_t spent[DRAIN_PHASES] = { 0, 0, 0 };
+    uint64_t sum = 0;
+    for (uint32_t round = 0; rc >= 0 && res->ops[DRAIN_POLL_BATCH + (round & 1U)] < iters;
+         round++) {
+        bench_counters_start(ctr);
+        uint64_t t0 = now_ns();
+        uint32_t put = 0;
+        for (; put < cap && rc >= 0; put++, seq++) {
+            rc = om_bus_stream_publish(stream, seq, 1, &seq, sizeof(seq));
+        }
+        spent[DRAIN_PUBLISH] += now_ns() - t0;
+        bench_counters_stop(ctr, &res->hw[DRAIN_PUBLISH]);
+        res->ops[DRAIN_PUBLISH] += put;
+        if (rc < 0) break;
+
+        uint32_t phase = DRAIN_POLL_BATCH + (round & 1U);
+        bench_counters_start(ctr);
+        t0 = now_ns();
+        uint32_t got = 0;
+        while (got < cap) {
+            if (phase == DRAIN_ITER) {
+                OmBusBatchIter it;
+                OmBusRecord rec;
+                rc = om_bus_endpoint_iter_begin(ep, &it, batch);
+                if (rc < 0) break;
+                while (om_bus_endpoint_iter_next(&it, &rec) == 1) {
+                    sum += rec.wal_seq;
+                }
+                rc = om_bus_endpoint_iter_end(&it);
+            } else {
+                rc = om_bus_endpoint_poll_batch(ep, out, batch);
+                for (int i = 0; i < rc; i++) sum += out[i].wal_seq;
+            }
+            if (rc < 0) break;
+            got += (uint32_t)rc;
+        }
+        spent[phase] += now_ns() - t0;
+        bench_counters_stop(ctr, &res->hw[phase]);
+        res->ops[phase] += got;
+    }
+
+    free(out);
+    om_bus_endpoint_close(ep);
+    om_bus_stream_destroy(stream);
+    if (rc < 0) return rc;
+    if (sum == 0) return OM_ERR_BUS_INIT;
+    for (int p = 0; p < DRAIN_PHASES; p++) {
+        res->ns_per_rec[p] = (double)spent[p] / (double)res->ops[p];
+    }
+    return 0;
+}
+
+static void report(BenchJson *json, const char *name, uint64_t ops, double ns,
+                   const BenchCounterSample *hw) {
+    bench_counters_print(stdout, name, hw, ops);
+    bench_json_phase(json, name, ops, ns, hw);
+}
+
 int main(int argc, char **argv) {
     BenchCfg cfg = {
         .shm_iters = 100000,
@@ -306,7 +454,11 @@ int main(int argc, char **argv) {
         .shm_batch = 32,
         .run_shm = 1,
         .run_shm_mixed = 1,
+        .run_shm_drain = 1,
         .run_tcp = 1,
+        .run_tcp_uring = 0,
+        .json_path = NULL,
+        .counters = true,
     };
 
     if (parse_args(argc, argv, &cfg) != 0) {
@@ -314,40 +466,105 @@ int main(int argc, char **argv) {
         return 2;
     }
 
+    BenchCounters ctr;
+    bench_counters_open(&ctr, cfg.counters);
+
+    BenchJson json = { 0 };
+    if (cfg.json_path) {
+        if (bench_json_open(&json, cfg.json_path, "bench_bus_perf", &ctr) != 0) {
+            fprintf(stderr, "cannot write %s\n", cfg.json_path);
+            bench_counters_close(&ctr);
+            return 1;
+        }
+        bench_json_config_u64(&json, "shm_iters", cfg.shm_iters);
+        bench_json_config_u64(&json, "tcp_iters", cfg.tcp_iters);
+        bench_json_config_u64(&json, "shm_batch", cfg.shm_batch);
+    }
+
     printf("Message bus benchmark\n");
+    bench_counters_describe(stdout, &ctr);
 
+    int status = 0;
     if (cfg.run_shm) {
         double ns = 0.0;
-        int rc = run_shm_bench(cfg.shm_iters, &ns);
+        BenchCounterSample hw = { 0 };
+        int rc = run_shm_bench(cfg.shm_iters, &ctr, &ns, &hw);
         if (rc != 0) {
             fprintf(stderr, "SHM bench failed: %d\n", rc);
-            return 1;
+            status = 1;
+            goto done;
         }
         printf("SHM: iters=%u ns/rec=%.2f rec/s=%.0f\n",
                cfg.shm_iters, ns, 1e9 / ns);
+        report(&json, "shm.roundtrip", cfg.shm_iters, ns, &hw);
     }
 
     if (cfg.run_shm_mixed) {
         double ns = 0.0;
-        int rc = run_shm_mixed_bench(cfg.shm_iters, cfg.shm_batch, &ns);
+        BenchCounterSample hw = { 0 };
+        int rc = run_shm_mixed_bench(cfg.shm_iters, cfg.shm_batch, &ctr, &ns, &hw);
         if (rc != 0) {
             fprintf(stderr, "SHM mixed bench failed: %d\n", rc);
-            return 1;
+            status = 1;
+            goto done;
         }
         printf("SHM(mixed,batch=%u): iters=%u ns/rec=%.2f rec/s=%.0f\n",
                cfg.shm_batch, cfg.shm_iters, ns, 1e9 / ns);
+        report(&json, "shm_mixed.roundtrip", cfg.shm_iters, ns, &hw);
+    }
+
+    if (cfg.run_shm_drain) {
+        DrainResult dr;
+        int rc = run_shm_drain_bench(cfg.shm_iters, cfg.shm_batch, &ctr, &dr);
+        if (rc != 0) {
+            fprintf(stderr, "SHM drain bench failed: %d\n", rc);
+            status = 1;
+            goto done;
+        }
+        printf("SHM(drain,batch=%u): iters=%u publish ns/rec=%.2f poll_batch ns/rec=%.2f iter ns/rec=%.2f\n",
+               cfg.shm_batch, cfg.shm_iters, dr.ns_per_rec[DRAIN_PUBLISH],
+               dr.ns_per_rec[DRAIN_POLL_BATCH], dr.ns_per_rec[DRAIN_ITER]);
+        static const char *const names[DRAIN_PHASES] = {
+            "shm_drain.publish", "shm_drain.poll_batch", "shm_drain.iter",
+        };
+        for (int p = 0; p < DRAIN_PHASES; p++) {
+            report(&json, names[p], dr.ops[p], dr.ns_per_rec[p], &dr.hw[p]);
+        }
     }
 
     if (cfg.run_tcp) {
         double ns = 0.0;
-        int rc = run_tcp_bench(cfg.tcp_iters, &ns);
+        BenchCounterSample hw = { 0 };
+        int rc = run_tcp_bench(cfg.tcp_iters, 0, &ctr, &ns, &hw);
         if (rc != 0) {
             fprintf(stderr, "TCP bench failed: %d\n", rc);
-            return 1;
+            status = 1;
+            goto done;
         }
         printf("TCP(loopback): iters=%u ns/rec=%.2f rec/s=%.0f\n",
                cfg.tcp_iters, ns, 1e9 / ns);
+        report(&json, "tcp.roundtrip", cfg.tcp_iters, ns, &hw);
     }
 
-    return 0;
+    if (cfg.run_tcp_uring) {
+        double ns = 0.0;
+        BenchCounterSample hw = { 0 };
+        int rc = run_tcp_bench(cfg.tcp_iters, 1, &ctr, &ns, &hw);
+        if (rc != 0) {
+            fprintf(stderr, "TCP io_uring bench failed: %d\n", rc);
+            status = 1;
+            goto done;
+        }
+        printf("TCP(loopback,io_uring): iters=%u ns/rec=%.2f rec/s=%.0f\n",
+               cfg.tcp_iters, ns, 1e9 / ns);
+        report(&json, "tcp_uring.roundtrip", cfg.tcp_iters, ns, &hw);
+    }
+
+done:
+    if (bench_json_close(&json) != 0) {
+        fprintf(stderr, "cannot write %s\n", cfg.json_path);
+        status = 1;
+    }
+    bench_counters_close(&ctr);
+    return status;
 }
@@ -0,0 +1,511 @@
+#include "openmatch/om_engine.h"
+#include "openmatch/om_error.h"
+#include "openmatch/om_perf.h"
+
+#include "bench_hist.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Engine throughput/latency harness.
+ *
+ * Synthetic flow per product: a fixed mid, passive limit orders resting 1..spread
+ * ticks away from it (biased toward the touch), marketable IOC orders priced
+ * through the whole window, and cancels of random live orders. Books are
+ * prefilled to --depth orders per side before the timed loop. Each operation
+ * is timed individually (slot alloc + om_engine_match / om_engine_cancel) into a
+ * log-linear histogram; throughput is ops over the wall time of the timed loop.
+ */
+
+#define BENCH_MID        1000000ULL
+#define BENCH_MAX_VOLUME 200U
+
+typedef enum BenchOp {
+    BENCH_OP_INSERT = 0,
+    BENCH_OP_AGGRESS,
+    BENCH_OP_CANCEL,
+    BENCH_OP_COUNT
+} BenchOp;
+
+static const char *const bench_op_names[BENCH_OP_COUNT] = {"insert", "aggress", "cancel"};
+
+typedef struct BenchConfig {
+    uint32_t products;
+    uint32_t depth;
+    uint32_t spread;
+    uint32_t orgs;
+    uint32_t ops;
+    uint32_t warmup;
+    uint32_t cancel_pct;
+    uint32_t aggress_pct;
+    uint32_t seed;
+    const char *preset;
+    const char *wal_path;
+} BenchConfig;
+
+typedef struct BenchPreset {
+    const char *name;
+    const OmPerfConfig *perf;
+} BenchPreset;
+
+static const BenchPreset bench_presets[] = {
+    {"hft", &OM_PERF_HFT},
+    {"recovery", &OM_PERF_RECOVERY},
+    {"default", &OM_PERF_DEFAULT},
+    {"minimal", &OM_PERF_MINIMAL},
+    {"durable", &OM_PERF_DURABLE},
+};
+
+#define BENCH_PRESET_COUNT (sizeof(bench_presets) / sizeof(bench_presets[0]))
+
+/* ============================================================================
+ * Flow state
+ * ============================================================================ */
+
+typedef struct BenchState {
+    OmEngine engine;
+    uint32_t *live;          /* resting order ids, unordered */
+    uint32_t *live_pos;      /* order_id -> index in live (UINT32_MAX = not live) */
+    uint32_t live_count;
+    uint32_t live_cap;
+    uint32_t id_cap;
+    uint64_t rng;
+    uint64_t deals;
+    uint64_t filled;
+    uint64_t skipped;        /* ops turned into another type by the live guards */
+    BenchHist hist[BENCH_OP_COUNT];
+} BenchState;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t bench_rand(BenchState *st) {
+    uint64_t x = st->rng;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    st->rng = x;
+    return x;
+}
+
+static inline void live_add(BenchState *st, uint32_t order_id) {
+    if (order_id >= st->id_cap || st->live_count >= st->live_cap) {
+        return;
+    }
+    st->live_pos[order_id] = st->live_count;
+    st->live[st->live_count++] = order_id;
+}
+
+static inline void live_remove(BenchState *st, uint32_t order_id) {
+    if (order_id >= st->id_cap) {
+        return;
+    }
+    uint32_t pos = st->live_pos[order_id];
+    if (pos == UINT32_MAX) {
+        return;
+    }
+    uint32_t last = st->live[--st->live_count];
+    st->live[pos] = last;
+    st->live_pos[last] = pos;
+    st->live_pos[order_id] = UINT32_MAX;
+}
+
+static void bench_on_deal(const OmSlabSlot *maker, const OmSlabSlot *taker,
+                          uint64_t price, uint64_t qty, void *user_ctx) {
+    (void)maker;
+    (void)taker;
+    (void)price;
+    (void)qty;
+    ((BenchState *)user_ctx)->deals++;
+}
+
+static void bench_on_booked(const OmSlabSlot *order, void *user_ctx) {
+    live_add((BenchState *)user_ctx, order->order_id);
+}
+
+static void bench_on_filled(const OmSlabSlot *order, void *user_ctx) {
+    BenchState *st = (BenchState *)user_ctx;
+    st->filled++;
+    live_remove(st, order->order_id);
+}
+
+static bool bench_pre_booked(const OmSlabSlot *order, void *user_ctx) {
+    (void)user_ctx;
+    return OM_GET_TYPE(order->flags) != OM_TYPE_IOC;
+}
+
+/* ============================================================================
+ * Operations
+ * ============================================================================ */
+
+static inline OmSlabSlot *bench_new_order(BenchState *st, uint64_t price, uint64_t volume,
+                                          uint32_t flags, uint16_t org) {
+    OmDualSlab *slab = &st->engine.orderbook.slab;
+    OmSlabSlot *order = om_slab_alloc(slab);
+    if (!order) {
+        return NULL;
+    }
+    om_slot_set_order_id(order, om_slab_next_order_id(slab));
+    om_slot_set_price(order, price);
+    om_slot_set_volume(order, volume);
+    om_slot_set_volume_remain(order, volume);
+    om_slot_set_flags(order, flags);
+    om_slot_set_org(order, org);
+    return order;
+}
+
+/* Offset from the mid in 1..spread, the smaller of two draws (denser at the touch) */
+static inline uint64_t bench_offset(BenchState *st, uint32_t spread) {
+    uint64_t a = bench_rand(st) % spread;
+    uint64_t b = bench_rand(st) % spread;
+    return 1U + (a < b ? a : b);
+}
+
+static inline int bench_insert(BenchState *st, const BenchConfig *cfg, uint16_t product,
+                               bool bid, uint16_t org, uint64_t volume) {
+    uint64_t off = bench_offset(st, cfg->spread);
+    uint64_t price = bid ? BENCH_MID - off : BENCH_MID + off;
+    OmSlabSlot *order = bench_new_order(st, price, volume,
+                                        (bid ? OM_SIDE_BID : OM_SIDE_ASK) | OM_TYPE_LIMIT, org);
+    if (!order) {
+        return OM_ERR_SLAB_FULL;
+    }
+    return om_engine_match(&st->engine, product, order);
+}
+
+static inline int bench_aggress(BenchState *st, const BenchConfig *cfg, uint16_t product,
+                                bool bid, uint16_t org, uint64_t volume) {
+    uint64_t price = bid ? BENCH_MID + cfg->spread : BENCH_MID - cfg->spread;
+    OmSlabSlot *order = bench_new_order(st, price, volume,
+                                        (bid ? OM_SIDE_BID : OM_SIDE_ASK) | OM_TYPE_IOC, org);
+    if (!order) {
+        return OM_ERR_SLAB_FULL;
+    }
+    int ret = om_engine_match(&st->engine, product, order);
+    /* IOC never rests: the taker slot is ours whether it filled or not */
+    om_slab_free(&st->engine.orderbook.slab, order);
+    return ret;
+}
+
+static inline int bench_cancel(BenchState *st, uint32_t order_id) {
+    live_remove(st, order_id);
+    return om_engine_cancel(&st->engine, order_id) ? 0 : OM_ERR_ORDER_NOT_FOUND;
+}
+
+static int bench_step(BenchState *st, const BenchConfig *cfg, bool record) {
+    uint64_t r = bench_rand(st);
+    uint32_t roll = (uint32_t)(r % 100U);
+    BenchOp op = BENCH_OP_INSERT;
+    if (roll < cfg->cancel_pct) {
+        op = BENCH_OP_CANCEL;
+    } else if (roll < cfg->cancel_pct + cfg->aggress_pct) {
+        op = BENCH_OP_AGGRESS;
+    }
+
+    /* Keep the books near the configured depth whatever the mix */
+    uint32_t target = cfg->products * cfg->depth * 2U;
+    if (op == BENCH_OP_CANCEL && st->live_count == 0) {
+        op = BENCH_OP_INSERT;
+        st->skipped++;
+    } else if (op == BENCH_OP_INSERT && st->live_count >= target * 2U) {
+        op = BENCH_OP_CANCEL;
+        st->skipped++;
+    }
+
+    uint16_t product = (uint16_t)((r >> 8) % cfg->products);
+    bool bid = ((r >> 32) & 1U) != 0;
+    uint16_t org = (uint16_t)(1U + (r >> 33) % cfg->orgs);
+    uint64_t volume = 1U + (r >> 48) % BENCH_MAX_VOLUME;
+    uint32_t victim = 0;
+    if (op == BENCH_OP_CANCEL) {
+        victim = st->live[bench_rand(st) % st->live_count];
+    }
+
+    uint64_t t0 = now_ns();
+    int ret;
+    switch (op) {
+    case BENCH_OP_INSERT:
+        ret = bench_insert(st, cfg, product, bid, org, volume);
+        break;
+    case BENCH_OP_AGGRESS:
+        ret = bench_aggress(st, cfg, product, bid, org, volume);
+        break;
+    default:
+        ret = bench_cancel(st, victim);
+        break;
+    }
+    uint64_t t1 = now_ns();
+
+    if (record) {
+        hist_record(&st->hist[op], t1 - t0);
+    }
+    return ret;
+}
+
+/* ============================================================================
+ * Runner
+ * ============================================================================ */
+
+static void bench_state_destroy(BenchState *st) {
+    om_engine_destroy(&st->engine);
+    free(st->live);
+    free(st->live_pos);
+}
+
+static int bench_state_init(BenchState *st, const BenchConfig *cfg, const BenchPreset *preset,
+                            OmWalConfig *wal_cfg) {
+    memset(st, 0, sizeof(*st));
+    st->rng = 0x9E3779B97F4A7C15ULL ^ cfg->seed;
+    if (st->rng == 0) {
+        st->rng = 1;
+    }
+
+    uint64_t prefill = (uint64_t)cfg->products * cfg->depth * 2U;
+    uint64_t ids = prefill + cfg->warmup + cfg->ops + 2U;
+    if (ids > UINT32_MAX || prefill * 2U + 1U > preset->perf->slab_total_slots) {
+        return OM_ERR_INVALID_PARAM;
+    }
+    st->id_cap = (uint32_t)ids;
+    st->live_cap = (uint32_t)(prefill * 2U + 1U);
+    st->live = calloc(st->live_cap, sizeof(*st->live));
+    st->live_pos = malloc((size_t)st->id_cap * sizeof(*st->live_pos));
+    if (!st->live || !st->live_pos) {
+        bench_state_destroy(st);
+        return OM_ERR_ALLOC_FAILED;
+    }
+    memset(st->live_pos, 0xFF, (size_t)st->id_cap * sizeof(*st->live_pos));
+
+    OmEngineConfig ec = {
+        .wal = wal_cfg,
+        .max_products = cfg->products,
+        .max_org = cfg->orgs + 1U,
+        .hashmap_initial_cap = 0,
+        .callbacks = {
+            .on_deal = bench_on_deal,
+            .on_booked = bench_on_booked,
+            .on_filled = bench_on_filled,
+            .pre_booked = bench_pre_booked,
+            .user_ctx = st,
+        },
+    };
+    int ret = om_engine_init_perf(&st->engine, &ec, preset->perf);
+    if (ret != 0) {
+        free(st->live);
+        free(st->live_pos);
+        return ret;
+    }
+
+    for (uint32_t p = 0; p < cfg->products; p++) {
+        for (uint32_t i = 0; i < cfg->depth * 2U; i++) {
+            uint16_t org = (uint16_t)(1U + bench_rand(st) % cfg->orgs);
+            uint64_t volume = 1U + bench_rand(st) % BENCH_MAX_VOLUME;
+            ret = bench_insert(st, cfg, (uint16_t)p, (i & 1U) == 0, org, volume);
+            if (ret != 0) {
+                bench_state_destroy(st);
+                return ret;
+            }
+        }
+    }
+    return 0;
+}
+
+static int run_preset(const BenchConfig *cfg, const BenchPreset *preset) {
+    char wal_file[512];
+    OmWalConfig wal_cfg;
+    OmWalConfig *wal = NULL;
+    if (cfg->wal_path) {
+        snprintf(wal_file, sizeof(wal_file), "%s.%s", cfg->wal_path, preset->name);
+        unlink(wal_file);
+        memset(&wal_cfg, 0, sizeof(wal_cfg));
+        wal_cfg.filename = wal_file;
+        wal = &wal_cfg;
+    }
+
+    BenchState *st = calloc(1, sizeof(*st));
+    if (!st) {
+        return OM_ERR_ALLOC_FAILED;
+    }
+    int ret = bench_state_init(st, cfg, preset, wal);
+    if (ret != 0) {
+        free(st);
+        return ret;
+    }
+
+    for (uint32_t i = 0; i < cfg->warmup && ret == 0; i++) {
+        ret = bench_step(st, cfg, false);
+    }
+    uint64_t deals0 = st->deals;
+    uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < cfg->ops && ret == 0; i++) {
+        ret = bench_step(st, cfg, true);
+    }
+    uint64_t t1 = now_ns();
+    if (ret != 0) {
+        bench_state_destroy(st);
+        free(st);
+        return ret;
+    }
+
+    double secs = (double)(t1 - t0) / 1e9;
+    printf("\npreset %s: slots=%u wal=%s%s%s\n",
+           preset->name,
+           preset->perf->slab_total_slots,
+           wal ? "on" : "off",
+           wal && preset->perf->wal_use_direct_io ? " direct_io" : "",
+           wal && preset->perf->wal_enable_crc32 ? " crc32" : "");
+    printf("  throughput=%.2f M ops/s  elapsed=%.3fs  deals=%llu  live=%u  mix_adjusted=%llu\n",
+           secs > 0.0 ? (double)cfg->ops / secs / 1e6 : 0.0,
+           secs,
+           (unsigned long long)(st->deals - deals0),
+           st->live_count,
+           (unsigned long long)st->skipped);
+    for (uint32_t op = 0; op < BENCH_OP_COUNT; op++) {
+        hist_print_line(bench_op_names[op], &st->hist[op]);
+    }
+
+    bench_state_destroy(st);
+    free(st);
+    if (wal) {
+        unlink(wal_file);
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * CLI
+ * ============================================================================ */
+
+static int parse_u32(const char *s, uint32_t *out) {
+    char *end = NULL;
+    unsigned long value = strtoul(s, &end, 10);
+    if (!s || *s == '\0' || !end || *end != '\0') {
+        return -1;
+    }
+    if (value > UINT32_MAX) {
+        return -1;
+    }
+    *out = (uint32_t)value;
+    return 0;
+}
+
+static void print_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [--preset hft|recovery|default|minimal|durable|all]\n"
+            "          [--products N] [--depth N] [--spread N] [--orgs N]\n"
+            "          [--ops N] [--warmup N] [--cancel-pct N] [--aggress-pct N]\n"
+            "          [--seed N] [--wal PATH]\n",
+            prog);
+}
+
+static int parse_args(int argc, char **argv, BenchConfig *cfg) {
+    for (int i = 1; i < argc; i++) {
+        uint32_t *dst = NULL;
+        if (strcmp(argv[i], "--preset") == 0 && i + 1 < argc) {
+            cfg->preset = argv[++i];
+            continue;
+        } else if (strcmp(argv[i], "--wal") == 0 && i + 1 < argc) {
+            cfg->wal_path = argv[++i];
+            continue;
+        } else if (strcmp(argv[i], "--products") == 0) {
+            dst = &cfg->products;
+        } else if (strcmp(argv[i], "--depth") == 0) {
+            dst = &cfg->depth;
+        } else if (strcmp(argv[i], "--spread") == 0) {
+            dst = &cfg->spread;
+        } else if (strcmp(argv[i], "--orgs") == 0) {
+            dst = &cfg->orgs;
+        } else if (strcmp(argv[i], "--ops") == 0) {
+            dst = &cfg->ops;
+        } else if (strcmp(argv[i], "--warmup") == 0) {
+            dst = &cfg->warmup;
+        } else if (strcmp(argv[i], "--cancel-pct") == 0) {
+            dst = &cfg->cancel_pct;
+        } else if (strcmp(argv[i], "--aggress-pct") == 0) {
+            dst = &cfg->aggress_pct;
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            dst = &cfg->seed;
+        }
+        if (!dst || i + 1 >= argc || parse_u32(argv[++i], dst) != 0) {
+            return -1;
+        }
+    }
+    if (cfg->products == 0 || cfg->products > UINT16_MAX) {
+        return -1;
+    }
+    if (cfg->orgs == 0 || cfg->orgs >= UINT16_MAX) {
+        return -1;
+    }
+    if (cfg->depth == 0 || cfg->spread == 0 || cfg->spread >= BENCH_MID || cfg->ops == 0) {
+        return -1;
+    }
+    if (cfg->cancel_pct + cfg->aggress_pct > 100U) {
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    BenchConfig cfg = {
+        .products = 16,
+        .depth = 100,
+        .spread = 64,
+        .orgs = 64,
+        .ops = 1000000,
+        .warmup = 100000,
+        .cancel_pct = 30,
+        .aggress_pct = 20,
+        .seed = 1,
+        .preset = "all",
+        .wal_path = NULL,
+    };
+
+    if (parse_args(argc, argv, &cfg) != 0) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    bool all = strcmp(cfg.preset, "all") == 0;
+    bool found = all;
+    for (size_t i = 0; i < BENCH_PRESET_COUNT && !found; i++) {
+        found = strcmp(cfg.preset, bench_presets[i].name) == 0;
+    }
+    if (!found) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    printf("OpenMatch engine perf harness\n");
+    printf("config: products=%u depth=%u spread=%u orgs=%u ops=%u warmup=%u "
+           "mix=insert:%u/aggress:%u/cancel:%u seed=%u wal=%s\n",
+           cfg.products,
+           cfg.depth,
+           cfg.spread,
+           cfg.orgs,
+           cfg.ops,
+           cfg.warmup,
+           100U - cfg.cancel_pct - cfg.aggress_pct,
+           cfg.aggress_pct,
+           cfg.cancel_pct,
+           cfg.seed,
+           cfg.wal_path ? cfg.wal_path : "off");
+
+    for (size_t i = 0; i < BENCH_PRESET_COUNT; i++) {
+        if (!all && strcmp(cfg.preset, bench_presets[i].name) != 0) {
+            continue;
+        }
+        int ret = run_preset(&cfg, &bench_presets[i]);
+        if (ret != 0) {
+            fprintf(stderr, "preset %s failed: %d\n", bench_presets[i].name, ret);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,378 @@
+#include "bench_harness.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/utsname.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+static const char *const bench_counter_names[BENCH_CTR_COUNT] = {
+    "cycles", "instructions", "l1d_miss", "llc_miss", "dtlb_miss", "branch_miss",
+};
+
+const char *bench_counter_name(BenchCounterId id) {
+    return (unsigned)id < BENCH_CTR_COUNT ? bench_counter_names[id] : "?";
+}
+
+#ifdef __linux__
+
+#define BENCH_CACHE_READ_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} bench_counter_events[BENCH_CTR_COUNT] = {
+    [BENCH_CTR_CYCLES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    [BENCH_CTR_INSTRUCTIONS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    [BENCH_CTR_L1D_MISS] = {PERF_TYPE_HW_CACHE, BENCH_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D)},
+    [BENCH_CTR_LLC_MISS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    [BENCH_CTR_DTLB_MISS] = {PERF_TYPE_HW_CACHE, BENCH_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB)},
+    [BENCH_CTR_BRANCH_MISS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+static int bench_perf_open(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static bool bench_perf_read(int fd, uint64_t out[3]) {
+    return read(fd, out, 3 * sizeof(uint64_t)) == (ssize_t)(3 * sizeof(uint64_t));
+}
+
+#endif
+
+int bench_counters_open(BenchCounters *c, bool enable) {
+    memset(c, 0, sizeof(*c));
+    for (int i = 0; i < BENCH_CTR_COUNT; i++) {
+        c->fd[i] = -1;
+    }
+    if (!enable) {
+        return 0;
+    }
+#ifdef __linux__
+    for (int i = 0; i < BENCH_CTR_COUNT; i++) {
+        c->fd[i] = bench_perf_open(bench_counter_events[i].type, bench_counter_events[i].config);
+        if (c->fd[i] < 0) {
+            if (c->open_errno == 0) {
+                c->open_errno = errno;
+            }
+            continue;
+        }
+        c->available++;
+    }
+#else
+    c->open_errno = ENOSYS;
+#endif
+    return c->available;
+}
+
+void bench_counters_close(BenchCounters *c) {
+    for (int i = 0; i < BENCH_CTR_COUNT; i++) {
+        if (c->fd[i] >= 0) {
+            close(c->fd[i]);
+            c->fd[i] = -1;
+        }
+    }
+    c->available = 0;
+}
+
+void bench_counters_start(BenchCounters *c) {
+#ifdef __linux__
+    for (int i = 0; i < BENCH_CTR_COUNT; i++) {
+        if (c->fd[i] >= 0 && !bench_perf_read(c->fd[i], c->snap[i])) {
+            memset(c->snap[i], 0, sizeof(c->snap[i]));
+        }
+    }
+#else
+    (void)c;
+#endif
+}
+
+void bench_counters_stop(BenchCounters *c, BenchCounterSample *acc) {
+#ifdef __linux__
+    for (int i = 0; i < BENCH_CTR_COUNT; i++) {
+        uint64_t now[3];
+        if (c->fd[i] < 0 || !bench_perf_read(c->fd[i], now)) {
+            continue;
+        }
+        uint64_t value = now[0] - c->snap[i][0];
+        uint64_t enabled = now[1] - c->snap[i][1];
+        uint64_t running = now[2] - c->snap[i][2];
+        if (running == 0) {
+            continue; /* never scheduled on the PMU in this window */
+        }
+        double scaled = (double)value;
+        if (running < enabled) {
+            scaled *= (double)enabled / (double)running;
+        }
+        acc->value[i] += scaled;
+        acc->valid[i] = true;
+    }
+#else
+    (void)c;
+    (void)acc;
+#endif
+}
+
+static int bench_read_paranoid(void) {
+    int level = -99;
+    FILE *fp = fopen("/proc/sys/kernel/perf_event_paranoid", "r");
+    if (fp) {
+        if (fscanf(fp, "%d", &level) != 1) {
+            level = -99;
+        }
+        fclose(fp);
+    }
+    return level;
+}
+
+void bench_counters_describe(FILE *out, const BenchCounters *c) {
+    if (c->available == 0) {
+        if (c->open_errno == 0) {
+            fprintf(out, "hw counters: disabled\n");
+            return;
+        }
+        fprintf(out, "hw counters: unavailable (%s", strerror(c->open_errno));
+        int paranoid = bench_read_paranoid();
+        if (paranoid != -99) {
+            fprintf(out, ", perf_event_paranoid=%d", paranoid);
+        }
+        fprintf(out, ")\n");
+        return;
+    }
+    fprintf(out, "hw counters:");
+    for (int i = 0; i < BENCH_CTR_COUNT; i++) {
+        fprintf(out, " %s%s", bench_counter_names[i], c->fd[i] >= 0 ? "" : "(n/a)");
+    }
+    fprintf(out, "\n");
+}
+
+void bench_counters_print(FILE *out, const char *label, const BenchCounterSample *s,
+                          uint64_t ops) {
+    bool any = false;
+    for (int i = 0; i < BENCH_CTR_COUNT; i++) {
+        any = any || s->valid[i];
+    }
+    if (!any || ops == 0) {
+        return;
+    }
+    fprintf(out, "  %-12s hw/op:", label);
+    for (int i = 0; i < BENCH_CTR_COUNT; i++) {
+        if (s->valid[i]) {
+            fprintf(out, " %s=%.2f", bench_counter_names[i], s->value[i] / (double)ops);
+        } else {
+            fprintf(out, " %s=n/a", bench_counter_names[i]);
+        }
+    }
+    if (s->valid[BENCH_CTR_CYCLES] && s->valid[BENCH_CTR_INSTRUCTIONS] &&
+        s->value[BENCH_CTR_CYCLES] > 0.0) {
+        fprintf(out, " ipc=%.2f", s->value[BENCH_CTR_INSTRUCTIONS] / s->value[BENCH_CTR_CYCLES]);
+    }
+    fprintf(out, "\n");
+}
+
+/* ---- JSON ---- */
+
+enum { BENCH_JSON_HEAD = 0, BENCH_JSON_CONFIG, BENCH_JSON_PHASES };
+
+static void bench_json_string(FILE *fp, const char *s) {
+    fputc('"', fp);
+    for (; s && *s; s++) {
+        unsigned char ch = (unsigned char)*s;
+        if (ch == '"' || ch == '\\') {
+            fprintf(fp, "\\%c", ch);
+        } else if (ch < 0x20) {
+            fprintf(fp, "\\u%04x", ch);
+        } else {
+            fputc(ch, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+static void bench_cpu_model(char *buf, size_t len) {
+    snprintf(buf, len, "unknown");
+    FILE *fp = fopen("/proc/cpuinfo", "r");
+    if (!fp) {
+        return;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), fp)) {
+        if (strncmp(line, "model name", 10) != 0) {
+            continue;
+        }
+        const char *v = strchr(line, ':');
+        if (v) {
+            v++;
+            while (*v == ' ' || *v == '\t') v++;
+            snprintf(buf, len, "%s", v);
+            buf[strcspn(buf, "\n")] = '\0';
+        }
+        break;
+    }
+    fclose(fp);
+}
+
+static void bench_json_host(FILE *fp) {
+    char host[256] = "unknown";
+    char cpu[256];
+    char stamp[32] = "";
+    struct utsname un;
+
+    if (gethostname(host, sizeof(host)) != 0) {
+        snprintf(host, sizeof(host), "unknown");
+    }
+    host[sizeof(host) - 1] = '\0';
+    bench_cpu_model(cpu, sizeof(cpu));
+    time_t now = time(NULL);
+    struct tm tm;
+    if (gmtime_r(&now, &tm)) {
+        strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", &tm);
+    }
+
+    fprintf(fp, "  \"host\": {\n    \"hostname\": ");
+    bench_json_string(fp, host);
+    if (uname(&un) == 0) {
+        fprintf(fp, ",\n    \"os\": ");
+        bench_json_string(fp, un.sysname);
+        fprintf(fp, ",\n    \"kernel\": ");
+        bench_json_string(fp, un.release);
+        fprintf(fp, ",\n    \"machine\": ");
+        bench_json_string(fp, un.machine);
+    }
+    fprintf(fp, ",\n    \"cpu_model\": ");
+    bench_json_string(fp, cpu);
+    fprintf(fp, ",\n    \"online_cpus\": %ld", sysconf(_SC_NPROCESSORS_ONLN));
+#ifdef __VERSION__
+    fprintf(fp, ",\n    \"compiler\": ");
+    bench_json_string(fp, __VERSION__);
+#endif
+#ifdef NDEBUG
+    fprintf(fp, ",\n    \"ndebug\": true");
+#else
+    fprintf(fp, ",\n    \"ndebug\": false");
+#endif
+    int paranoid = bench_read_paranoid();
+    if (paranoid != -99) {
+        fprintf(fp, ",\n    \"perf_event_paranoid\": %d", paranoid);
+    }
+    fprintf(fp, ",\n    \"timestamp\": ");
+    bench_json_string(fp, stamp);
+    fprintf(fp, "\n  }");
+}
+
+int bench_json_open(BenchJson *j, const char *path, const char *benchmark,
+                    const BenchCounters *c) {
+    memset(j, 0, sizeof(*j));
+    j->fp = fopen(path, "w");
+    if (!j->fp) {
+        return -1;
+    }
+    fprintf(j->fp, "{\n  \"benchmark\": ");
+    bench_json_string(j->fp, benchmark);
+    fprintf(j->fp, ",\n");
+    bench_json_host(j->fp);
+    fprintf(j->fp, ",\n  \"counters\": [");
+    int n = 0;
+    for (int i = 0; i < BENCH_CTR_COUNT; i++) {
+        if (c && c->fd[i] >= 0) {
+            fprintf(j->fp, "%s\"%s\"", n++ ? ", " : "", bench_counter_names[i]);
+        }
+    }
+    fprintf(j->fp, "]");
+    j->state = BENCH_JSON_HEAD;
+    return 0;
+}
+
+static void bench_json_config_key(BenchJson *j, const char *key) {
+    if (j->state == BENCH_JSON_HEAD) {
+        fprintf(j->fp, ",\n  \"config\": {");
+        j->state = BENCH_JSON_CONFIG;
+        j->items = 0;
+    }
+    fprintf(j->fp, "%s\n    ", j->items++ ? "," : "");
+    bench_json_string(j->fp, key);
+    fprintf(j->fp, ": ");
+}
+
+void bench_json_config_u64(BenchJson *j, const char *key, uint64_t value) {
+    if (!j->fp || j->state == BENCH_JSON_PHASES) {
+        return;
+    }
+    bench_json_config_key(j, key);
+    fprintf(j->fp, "%llu", (unsigned long long)value);
+}
+
+void bench_json_config_str(BenchJson *j, const char *key, const char *value) {
+    if (!j->fp || j->state == BENCH_JSON_PHASES) {
+        return;
+    }
+    bench_json_config_key(j, key);
+    bench_json_string(j->fp, value);
+}
+
+static void bench_json_begin_phases(BenchJson *j) {
+    if (j->state == BENCH_JSON_CONFIG) {
+        fprintf(j->fp, "\n  }");
+    }
+    if (j->state != BENCH_JSON_PHASES) {
+        fprintf(j->fp, ",\n  \"phases\": [");
+        j->state = BENCH_JSON_PHASES;
+        j->items = 0;
+    }
+}
+
+void bench_json_phase(BenchJson *j, const char *name, uint64_t ops, double ns_per_op,
+                      const BenchCounterSample *s) {
+    if (!j->fp) {
+        return;
+    }
+    bench_json_begin_phases(j);
+    fprintf(j->fp, "%s\n    {\"name\": ", j->items++ ? "," : "");
+    bench_json_string(j->fp, name);
+    fprintf(j->fp, ", \"ops\": %llu, \"ns_per_op\": %.3f, \"per_op\": {",
+            (unsigned long long)ops, ns_per_op);
+    for (int i = 0; i < BENCH_CTR_COUNT; i++) {
+        fprintf(j->fp, "%s\"%s\": ", i ? ", " : "", bench_counter_names[i]);
+        if (s && s->valid[i] && ops > 0) {
+            fprintf(j->fp, "%.4f", s->value[i] / (double)ops);
+        } else {
+            fprintf(j->fp, "null");
+        }
+    }
+    fprintf(j->fp, "}, \"ipc\": ");
+    if (s && s->valid[BENCH_CTR_CYCLES] && s->valid[BENCH_CTR_INSTRUCTIONS] &&
+        s->value[BENCH_CTR_CYCLES] > 0.0) {
+        fprintf(j->fp, "%.4f", s->value[BENCH_CTR_INSTRUCTIONS] / s->value[BENCH_CTR_CYCLES]);
+    } else {
+        fprintf(j->fp, "null");
+    }
+    fprintf(j->fp, "}");
+}
+
+int bench_json_close(BenchJson *j) {
+    if (!j->fp) {
+        return 0;
+    }
+    bench_json_begin_phases(j);
+    fprintf(j->fp, "\n  ]\n}\n");
+    int rc = ferror(j->fp) ? -1 : 0;
+    if (fclose(j->fp) != 0) {
+        rc = -1;
+    }
+    j->fp = NULL;
+    return rc;
+}
@@ -0,0 +1,88 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+/*
+ * Shared benchmark harness: hardware performance counters and JSON reports.
+ *
+ * Counters wrap perf_event_open(2) for the calling thread, user space only.
+ * Each event is opened on its own, so a PMU that lacks one event (or a VM
+ * that exposes none) leaves the others usable; a counter that cannot be
+ * opened is reported as unavailable and the benchmark runs unchanged. When
+ * the kernel multiplexes events the counts are scaled by enabled/running time.
+ *
+ * Usage per phase:
+ *
+ *     BenchCounterSample hw = {0};
+ *     bench_counters_start(&ctr);
+ *     ... timed loop ...
+ *     bench_counters_stop(&ctr, &hw);   // adds the delta, may be repeated
+ *     bench_counters_print(stdout, "insert", &hw, ops);
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef enum BenchCounterId {
+    BENCH_CTR_CYCLES = 0,
+    BENCH_CTR_INSTRUCTIONS,
+    BENCH_CTR_L1D_MISS,
+    BENCH_CTR_LLC_MISS,
+    BENCH_CTR_DTLB_MISS,
+    BENCH_CTR_BRANCH_MISS,
+    BENCH_CTR_COUNT
+} BenchCounterId;
+
+typedef struct BenchCounters {
+    int fd[BENCH_CTR_COUNT];
+    uint64_t snap[BENCH_CTR_COUNT][3];  /* value, time_enabled, time_running */
+    int available;                      /* number of open counters */
+    int open_errno;                     /* first perf_event_open failure */
+} BenchCounters;
+
+/* Accumulated event counts over one or more start/stop windows */
+typedef struct BenchCounterSample {
+    double value[BENCH_CTR_COUNT];
+    bool valid[BENCH_CTR_COUNT];
+} BenchCounterSample;
+
+/* Open every counter (none when enable is false); returns how many opened */
+int bench_counters_open(BenchCounters *c, bool enable);
+void bench_counters_close(BenchCounters *c);
+void bench_counters_start(BenchCounters *c);
+void bench_counters_stop(BenchCounters *c, BenchCounterSample *acc);
+
+const char *bench_counter_name(BenchCounterId id);
+
+/* One line naming the open counters, or why there are none */
+void bench_counters_describe(FILE *out, const BenchCounters *c);
+
+/* "  <label> hw/op: cycles=... ipc=..."; prints nothing without counters */
+void bench_counters_print(FILE *out, const char *label, const BenchCounterSample *s,
+                          uint64_t ops);
+
+/*
+ * JSON report:
+ *
+ *     {"benchmark": ..., "host": {...}, "counters": [...],
+ *      "config": {...}, "phases": [{"name", "ops", "ns_per_op",
+ *      "per_op": {"cycles": ..., ...}, "ipc"}, ...]}
+ *
+ * Unavailable counters are written as null. Config keys must be added before
+ * the first phase.
+ */
+typedef struct BenchJson {
+    FILE *fp;
+    int state;
+    int items;
+} BenchJson;
+
+int bench_json_open(BenchJson *j, const char *path, const char *benchmark,
+                    const BenchCounters *c);
+void bench_json_config_u64(BenchJson *j, const char *key, uint64_t value);
+void bench_json_config_str(BenchJson *j, const char *key, const char *value);
+void bench_json_phase(BenchJson *j, const char *name, uint64_t ops, double ns_per_op,
+                      const BenchCounterSample *s);
+int bench_json_close(BenchJson *j);
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef BENCH_HIST_H
+#define BENCH_HIST_H
+
+/*
+ * HdrHistogram-style log-linear latency histogram shared by the benchmarks.
+ *
+ * Values below 2^HIST_SUB_BITS get one bucket each; above that every power of
+ * two is split into 2^HIST_SUB_BITS linear sub-buckets, so a reported value is
+ * within ~3% of the true one. Percentiles report the bucket's highest value.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define HIST_SUB_BITS 5U
+#define HIST_SUB      (1U << HIST_SUB_BITS)
+#define HIST_BUCKETS  ((64U - HIST_SUB_BITS + 1U) * HIST_SUB)
+
+typedef struct BenchHist {
+    uint64_t counts[HIST_BUCKETS];
+    uint64_t total;
+    uint64_t sum;
+    uint64_t max;
+} BenchHist;
+
+static inline uint32_t hist_index(uint64_t v) {
+    if (v < HIST_SUB) {
+        return (uint32_t)v;
+    }
+    uint32_t msb = 63U - (uint32_t)__builtin_clzll(v);
+    uint32_t shift = msb - HIST_SUB_BITS;
+    return (shift + 1U) * HIST_SUB + (uint32_t)((v >> shift) - HIST_SUB);
+}
+
+static inline uint64_t hist_bucket_high(uint32_t idx) {
+    if (idx < HIST_SUB) {
+        return idx;
+    }
+    uint32_t shift = idx / HIST_SUB - 1U;
+    uint64_t sub = (uint64_t)(idx % HIST_SUB) + HIST_SUB;
+    return ((sub + 1U) << shift) - 1U;
+}
+
+static inline void hist_record(BenchHist *h, uint64_t v) {
+    h->counts[hist_index(v)]++;
+    h->total++;
+    h->sum += v;
+    if (v > h->max) {
+        h->max = v;
+    }
+}
+
+static inline uint64_t hist_percentile(const BenchHist *h, double pct) {
+    if (h->total == 0) {
+        return 0;
+    }
+    uint64_t target = (uint64_t)((pct / 100.0) * (double)h->total + 0.5);
+    if (target == 0) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= target) {
+            uint64_t high = hist_bucket_high(i);
+            return high < h->max ? high : h->max;
+        }
+    }
+    return h->max;
+}
+
+/* One summary line: n, mean, p50, p99, p99.9, max (ns) */
+static inline void hist_print_line(const char *name, const BenchHist *h) {
+    if (h->total == 0) {
+        printf("  %-10s n=0\n", name);
+        return;
+    }
+    printf("  %-10s n=%-9llu mean=%7.1fns p50=%6lluns p99=%6lluns p99.9=%7lluns max=%8lluns\n",
+           name,
+           (unsigned long long)h->total,
+           (double)h->sum / (double)h->total,
+           (unsigned long long)hist_percentile(h, 50.0),
+           (unsigned long long)hist_percentile(h, 99.0),
+           (unsigned long long)hist_percentile(h, 99.9),
+           (unsigned long long)h->max);
+}
+
+#endif /* BENCH_HIST_H */
@@ -1,6 +1,8 @@
 #include "openmarket/om_market.h"
 #include "openmatch/om_error.h"
 
+#include "bench_harness.h"
+
 #include <math.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -14,8 +16,25 @@ typedef struct BenchConfig {
     uint32_t iters;
     uint32_t warmup;
     uint32_t total_orgs;
+    const char *json_path;
+    bool counters;
 } BenchConfig;
 
+typedef enum BenchPhase {
+    BENCH_PHASE_INSERT = 0,
+    BENCH_PHASE_MATCH,
+    BENCH_PHASE_CANCEL,
+    BENCH_PHASE_COUNT
+} BenchPhase;
+
+static const char *const bench_phase_names[BENCH_PHASE_COUNT] = {"insert", "match", "cancel"};
+
+typedef struct BenchProfile {
+    double ns[BENCH_PHASE_COUNT];
+    BenchCounterSample hw[BENCH_PHASE_COUNT];
+    double blended_ns;
+} BenchProfile;
+
 static uint64_t bench_dealable(const OmWalInsert *rec, uint16_t viewer_org, void *ctx) {
     (void)ctx;
     if (viewer_org == rec->org) {
@@ -45,7 +64,8 @@ static int parse_u32(const char *s, uint32_t *out) {
 
 static void print_usage(const char *prog) {
     fprintf(stderr,
-            "Usage: %s [--orgs N] [--products N] [--iters N] [--warmup N] [--total-orgs N]\n",
+            "Usage: %s [--orgs N] [--products N] [--iters N] [--warmup N] [--total-orgs N]\n"
+            "          [--json PATH] [--no-counters]\n",
             prog);
 }
 
@@ -73,6 +93,10 @@ static int parse_args(int argc, char **argv, BenchConfig *cfg) {
             if (parse_u32(argv[++i], &cfg->total_orgs) != 0) {
                 return -1;
             }
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            cfg->json_path = argv[++i];
+        } else if (strcmp(argv[i], "--no-counters") == 0) {
+            cfg->counters = false;
         } else {
             return -1;
         }
@@ -153,7 +177,8 @@ static int bench_env_init(BenchEnv *env, const BenchConfig *cfg, uint32_t expect
     return 0;
 }
 
-static int bench_insert_ns(const BenchConfig *cfg, double *out_ns) {
+static int bench_insert_ns(const BenchConfig *cfg, BenchCounters *ctr, double *out_ns,
+                           BenchCounterSample *hw) {
     BenchEnv env;
     int ret = bench_env_init(&env, cfg, cfg->iters + cfg->warmup + 16U);
     if (ret != 0) {
@@ -173,6 +198,7 @@ static int bench_insert_ns(const BenchConfig *cfg, double *out_ns) {
             .product_id = 0,
         };
         if (i == cfg->warmup) {
+            bench_counters_start(ctr);
             t0 = now_ns();
         }
         ret = om_market_worker_process(env.worker, OM_WAL_INSERT, &ins);
@@ -182,6 +208,7 @@ static int bench_insert_ns(const BenchConfig *cfg, double *out_ns) {
         }
     }
     uint64_t t1 = now_ns();
+    bench_counters_stop(ctr, hw);
     *out_ns = (double)(t1 - t0) / (double)cfg->iters;
     bench_env_destroy(&env);
     return 0;
@@ -206,7 +233,8 @@ static int preload_orders(BenchEnv *env, uint32_t count) {
     return 0;
 }
 
-static int bench_match_ns(const BenchConfig *cfg, double *out_ns) {
+static int bench_match_ns(const BenchConfig *cfg, BenchCounters *ctr, double *out_ns,
+                            BenchCounterSample *hw) {
     BenchEnv env;
     int ret = bench_env_init(&env, cfg, cfg->iters + cfg->warmup + 16U);
     if (ret != 0) {
@@ -230,6 +258,7 @@ static int bench_match_ns(const BenchConfig *cfg, double *out_ns) {
             .product_id = 0,
         };
         if (i == cfg->warmup) {
+            bench_counters_start(ctr);
             t0 = now_ns();
         }
         ret = om_market_worker_process(env.worker, OM_WAL_MATCH, &m);
@@ -239,12 +268,14 @@ static int bench_match_ns(const BenchConfig *cfg, double *out_ns) {
         }
     }
     uint64_t t1 = now_ns();
+    bench_counters_stop(ctr, hw);
     *out_ns = (double)(t1 - t0) / (double)cfg->iters;
     bench_env_destroy(&env);
     return 0;
 }
 
-static int bench_cancel_ns(const BenchConfig *cfg, double *out_ns) {
+static int bench_cancel_ns(const BenchConfig *cfg, BenchCounters *ctr, double *out_ns,
+                            BenchCounterSample *hw) {
     BenchEnv env;
     int ret = bench_env_init(&env, cfg, cfg->iters + cfg->warmup + 16U);
     if (ret != 0) {
@@ -265,6 +296,7 @@ static int bench_cancel_ns(const BenchConfig *cfg, double *out_ns) {
             .product_id = 0,
         };
         if (i == cfg->warmup) {
+            bench_counters_start(ctr);
             t0 = now_ns();
         }
         ret = om_market_worker_process(env.worker, OM_WAL_CANCEL, &c);
@@ -274,6 +306,7 @@ static int bench_cancel_ns(const BenchConfig *cfg, double *out_ns) {
         }
     }
     uint64_t t1 = now_ns();
+    bench_counters_stop(ctr, hw);
     *out_ns = (double)(t1 - t0) / (double)cfg->iters;
     bench_env_destroy(&env);
     return 0;
@@ -281,30 +314,54 @@ static int bench_cancel_ns(const BenchConfig *cfg, double *out_ns) {
 
 static int run_profile(const BenchConfig *cfg,
                        uint32_t profile_orgs,
-                       double *insert_ns,
-                       double *match_ns,
-                       double *cancel_ns,
-                       double *blended_ns) {
+                       BenchCounters *ctr,
+                       BenchProfile *out) {
     BenchConfig local = *cfg;
     local.orgs = profile_orgs;
+    memset(out, 0, sizeof(*out));
 
-    int ret = bench_insert_ns(&local, insert_ns);
+    int ret = bench_insert_ns(&local, ctr, &out->ns[BENCH_PHASE_INSERT],
+                              &out->hw[BENCH_PHASE_INSERT]);
     if (ret != 0) {
         return ret;
     }
-    ret = bench_match_ns(&local, match_ns);
+    ret = bench_match_ns(&local, ctr, &out->ns[BENCH_PHASE_MATCH], &out->hw[BENCH_PHASE_MATCH]);
     if (ret != 0) {
         return ret;
     }
-    ret = bench_cancel_ns(&local, cancel_ns);
+    ret = bench_cancel_ns(&local, ctr, &out->ns[BENCH_PHASE_CANCEL],
+                          &out->hw[BENCH_PHASE_CANCEL]);
     if (ret != 0) {
         return ret;
     }
 
-    *blended_ns = *insert_ns * 0.6 + *match_ns * 0.3 + *cancel_ns * 0.1;
+    out->blended_ns = out->ns[BENCH_PHASE_INSERT] * 0.6 + out->ns[BENCH_PHASE_MATCH] * 0.3 +
+                      out->ns[BENCH_PHASE_CANCEL] * 0.1;
     return 0;
 }
 
+static void print_profile(const char *label, uint32_t orgs, const BenchProfile *p, uint64_t ops) {
+    printf("profile %s (%u orgs):%s insert=%.2fns match=%.2fns cancel=%.2fns blended=%.2fns\n",
+           label,
+           orgs,
+           strcmp(label, "low") == 0 ? "  " : "",
+           p->ns[BENCH_PHASE_INSERT],
+           p->ns[BENCH_PHASE_MATCH],
+           p->ns[BENCH_PHASE_CANCEL],
+           p->blended_ns);
+    for (int i = 0; i < BENCH_PHASE_COUNT; i++) {
+        bench_counters_print(stdout, bench_phase_names[i], &p->hw[i], ops);
+    }
+}
+
+static void json_profile(BenchJson *j, const char *label, const BenchProfile *p, uint64_t ops) {
+    char name[32];
+    for (int i = 0; i < BENCH_PHASE_COUNT; i++) {
+        snprintf(name, sizeof(name), "%s.%s", label, bench_phase_names[i]);
+        bench_json_phase(j, name, ops, p->ns[i], &p->hw[i]);
+    }
+}
+
 int main(int argc, char **argv) {
     BenchConfig cfg = {
         .orgs = 1024,
@@ -312,6 +369,8 @@ int main(int argc, char **argv) {
         .iters = 20000,
         .warmup = 2000,
         .total_orgs = 5000,
+        .json_path = NULL,
+        .counters = true,
     };
 
     if (parse_args(argc, argv, &cfg) != 0) {
@@ -324,21 +383,28 @@ int main(int argc, char **argv) {
         low_orgs = 1;
     }
 
-    double i_low = 0.0, m_low = 0.0, c_low = 0.0, b_low = 0.0;
-    double i_high = 0.0, m_high = 0.0, c_high = 0.0, b_high = 0.0;
+    BenchCounters ctr;
+    bench_counters_open(&ctr, cfg.counters);
+
+    BenchProfile low;
+    BenchProfile high;
 
-    int ret = run_profile(&cfg, low_orgs, &i_low, &m_low, &c_low, &b_low);
+    int ret = run_profile(&cfg, low_orgs, &ctr, &low);
     if (ret != 0) {
         fprintf(stderr, "profile(low=%u) failed: %d\n", low_orgs, ret);
+        bench_counters_close(&ctr);
         return 1;
     }
 
-    ret = run_profile(&cfg, cfg.orgs, &i_high, &m_high, &c_high, &b_high);
+    ret = run_profile(&cfg, cfg.orgs, &ctr, &high);
     if (ret != 0) {
         fprintf(stderr, "profile(high=%u) failed: %d\n", cfg.orgs, ret);
+        bench_counters_close(&ctr);
         return 1;
     }
 
+    double b_low = low.blended_ns;
+    double b_high = high.blended_ns;
     double per_org_ns = 0.0;
     double fixed_ns = b_high;
     if (cfg.orgs > low_orgs) {
@@ -366,20 +432,11 @@ int main(int argc, char **argv) {
            cfg.iters,
            cfg.warmup,
            cfg.total_orgs);
+    bench_counters_describe(stdout, &ctr);
 
     printf("\n");
-    printf("profile low (%u orgs):   insert=%.2fns match=%.2fns cancel=%.2fns blended=%.2fns\n",
-           low_orgs,
-           i_low,
-           m_low,
-           c_low,
-           b_low);
-    printf("profile high (%u orgs):  insert=%.2fns match=%.2fns cancel=%.2fns blended=%.2fns\n",
-           cfg.orgs,
-           i_high,
-           m_high,
-           c_high,
-           b_high);
+    print_profile("low", low_orgs, &low, cfg.iters);
+    print_profile("high", cfg.orgs, &high, cfg.iters);
 
     printf("\n");
     printf("fit: fixed_ns=%.2f per_org_ns=%.4f\n", fixed_ns, per_org_ns);
@@ -392,5 +449,29 @@ int main(int argc, char **argv) {
     }
 
     printf("formula: W >= (O * per_org_ns) / (1000 - fixed_ns)\n");
+
+    if (cfg.json_path) {
+        BenchJson j;
+        if (bench_json_open(&j, cfg.json_path, "bench_market_perf", &ctr) != 0) {
+            fprintf(stderr, "cannot write %s\n", cfg.json_path);
+            bench_counters_close(&ctr);
+            return 1;
+        }
+        bench_json_config_u64(&j, "orgs_high", cfg.orgs);
+        bench_json_config_u64(&j, "orgs_low", low_orgs);
+        bench_json_config_u64(&j, "products", cfg.max_products);
+        bench_json_config_u64(&j, "iters", cfg.iters);
+        bench_json_config_u64(&j, "warmup", cfg.warmup);
+        bench_json_config_u64(&j, "total_orgs", cfg.total_orgs);
+        json_profile(&j, "low", &low, cfg.iters);
+        json_profile(&j, "high", &high, cfg.iters);
+        if (bench_json_close(&j) != 0) {
+            fprintf(stderr, "cannot write %s\n", cfg.json_path);
+            bench_counters_close(&ctr);
+            return 1;
+        }
+    }
+
+    bench_counters_close(&ctr);
     return 0;
 }
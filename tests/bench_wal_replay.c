@@ -0,0 +1,927 @@
+#include "openmarket/om_market.h"
+#include "openmatch/om_engine.h"
+#include "openmatch/om_error.h"
+#include "openmatch/om_wal.h"
+
+#include "bench_hist.h"
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * WAL-driven replay harness.
+ *
+ * Loads a WAL (production, or one from tools/wal_maker) into memory, then:
+ *
+ * 1. Engine: re-drives the order flow through a fresh OmEngine and compares
+ *    every on_deal against the recorded MATCH stream. The engine logs an order
+ *    only when it rests (INSERT after its MATCH records, volume = original
+ *    size), so order entry is rebuilt from the log:
+ *      - INSERT with no MATCH run before it: passive order
+ *      - MATCH run for taker T followed by INSERT of T: taker that rested
+ *      - MATCH run for taker T with no INSERT: taker that filled completely,
+ *        replayed as IOC at its worst fill price, side opposite its maker
+ *      - CANCEL / DEACTIVATE / ACTIVATE: the engine call of the same name
+ *        (MATCH records right after an ACTIVATE belong to it)
+ *    Ops run back to back, or at the recorded timestamps with --speed.
+ *
+ * 2. Market: feeds every record, in log order, through one private and one
+ *    public OmMarket worker subscribed to every (org, product) seen.
+ *
+ * Each engine op and each market record is timed into a histogram by type.
+ * Exit status is 3 when the replayed deals diverge from the recorded ones.
+ */
+
+#define REPLAY_NONE       UINT32_MAX
+#define REPLAY_SHOW_MAX   64U
+#define REPLAY_TYPE_COUNT OM_WAL_ACTIVATE
+
+typedef enum ReplayKind {
+    REPLAY_OP_INSERT = 0,
+    REPLAY_OP_TAKER,
+    REPLAY_OP_CANCEL,
+    REPLAY_OP_DEACTIVATE,
+    REPLAY_OP_ACTIVATE,
+    REPLAY_OP_COUNT
+} ReplayKind;
+
+static const char *const replay_op_names[REPLAY_OP_COUNT] = {
+    "insert", "taker", "cancel", "deactivate", "activate"
+};
+
+static const char *const replay_type_names[REPLAY_TYPE_COUNT] = {
+    "insert", "cancel", "match", "checkpoint", "deactivate", "activate"
+};
+
+typedef struct ReplayConfig {
+    const char *wal_path;
+    const char *out_wal;
+    double speed;            /* 0 = back to back */
+    uint32_t show;
+    uint32_t top_levels;
+    bool no_crc;
+    bool engine;
+    bool market;
+} ReplayConfig;
+
+/* One WAL record, payload in ReplayLog.blob at an 8-byte aligned offset */
+typedef struct ReplayRec {
+    uint64_t seq;
+    size_t off;
+    uint32_t len;
+    uint8_t type;
+} ReplayRec;
+
+typedef struct ReplayLog {
+    ReplayRec *recs;
+    size_t count;
+    size_t cap;
+    uint8_t *blob;
+    size_t blob_len;
+    size_t blob_cap;
+    uint64_t type_counts[REPLAY_TYPE_COUNT + 1]; /* last = user / other */
+    uint64_t crc_errors;
+    uint64_t first_ts;
+    uint64_t last_ts;
+    uint32_t max_order_id;
+    uint16_t max_product;
+    uint16_t max_org;
+    uint32_t user_data_size;
+    uint32_t aux_data_size;
+    bool sized;              /* data sizes taken from the first INSERT */
+} ReplayLog;
+
+typedef struct ReplayOp {
+    uint64_t ts_ns;
+    uint64_t seq;
+    uint64_t price;
+    uint64_t volume;
+    uint32_t order_id;
+    uint32_t rec;            /* INSERT record carrying user/aux data */
+    uint32_t match_first;
+    uint32_t match_count;
+    uint16_t product;
+    uint16_t org;
+    uint16_t flags;
+    uint8_t kind;
+    bool skip;               /* taker whose side could not be resolved */
+} ReplayOp;
+
+typedef struct ReplayDivergence {
+    uint64_t seq;
+    uint32_t order_id;
+    uint8_t kind;
+    const char *reason;
+    OmWalMatch expected;
+    OmWalMatch got;
+} ReplayDivergence;
+
+typedef struct ReplayState {
+    const ReplayConfig *cfg;
+    ReplayLog log;
+    ReplayOp *ops;
+    size_t op_count;
+    OmWalMatch *matches;
+    size_t match_count;
+    uint64_t unresolved;
+
+    OmEngine engine;
+    const ReplayOp *cur;
+    uint32_t cur_pos;
+    bool cur_diverged;
+    uint64_t deals;
+    uint64_t deals_mismatched;
+    uint64_t deals_missing;
+    uint64_t deals_extra;
+    uint64_t call_misses;
+    uint64_t ops_diverged;
+    ReplayDivergence shown[REPLAY_SHOW_MAX];
+    uint32_t shown_count;
+
+    BenchHist engine_hist[REPLAY_OP_COUNT];
+    BenchHist private_hist[REPLAY_TYPE_COUNT];
+    BenchHist public_hist[REPLAY_TYPE_COUNT];
+} ReplayState;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline const void *rec_data(const ReplayLog *log, const ReplayRec *r) {
+    return log->blob + r->off;
+}
+
+/* ============================================================================
+ * Load
+ * ============================================================================ */
+
+static int log_append(ReplayLog *log, OmWalType type, uint64_t seq, const void *data, size_t len) {
+    if (log->count == log->cap) {
+        size_t cap = log->cap ? log->cap * 2U : 4096U;
+        ReplayRec *recs = realloc(log->recs, cap * sizeof(*recs));
+        if (!recs) {
+            return OM_ERR_ALLOC_FAILED;
+        }
+        log->recs = recs;
+        log->cap = cap;
+    }
+    size_t off = (log->blob_len + 7U) & ~(size_t)7U;
+    if (off + len > log->blob_cap) {
+        size_t cap = log->blob_cap ? log->blob_cap : 1U << 20;
+        while (cap < off + len) {
+            cap *= 2U;
+        }
+        uint8_t *blob = realloc(log->blob, cap);
+        if (!blob) {
+            return OM_ERR_ALLOC_FAILED;
+        }
+        log->blob = blob;
+        log->blob_cap = cap;
+    }
+    memcpy(log->blob + off, data, len);
+    log->blob_len = off + len;
+    log->recs[log->count++] = (ReplayRec){
+        .seq = seq,
+        .off = off,
+        .len = (uint32_t)len,
+        .type = (uint8_t)type,
+    };
+    return 0;
+}
+
+static void log_note_ts(ReplayLog *log, uint64_t ts) {
+    if (ts == 0) {
+        return;
+    }
+    if (log->first_ts == 0 || ts < log->first_ts) {
+        log->first_ts = ts;
+    }
+    if (ts > log->last_ts) {
+        log->last_ts = ts;
+    }
+}
+
+static int log_load(ReplayLog *log, const char *path, bool no_crc) {
+    OmWalConfig wal_cfg = {.disable_crc32 = no_crc};
+    OmWalReplay replay;
+    if (om_wal_replay_init_with_config(&replay, path, &wal_cfg) != 0) {
+        return OM_ERR_WAL_OPEN;
+    }
+
+    int ret = 0;
+    for (;;) {
+        OmWalType type;
+        void *data;
+        uint64_t seq;
+        size_t len;
+        int rc = om_wal_replay_next(&replay, &type, &data, &seq, &len);
+        if (rc == 0) {
+            break;
+        }
+        if (rc == OM_ERR_WAL_CRC_MISMATCH) {
+            log->crc_errors++;
+            continue;
+        }
+        if (rc < 0) {
+            ret = rc;
+            break;
+        }
+        if (type < OM_WAL_INSERT || type > OM_WAL_ACTIVATE) {
+            log->type_counts[REPLAY_TYPE_COUNT]++;
+            continue;
+        }
+        log->type_counts[type - 1]++;
+
+        /*
+         * Pull out what sizing and pacing need; payloads are memcpy'd (alignment).
+         * Pacing uses the WAL's own (monotonic) record timestamps; MATCH
+         * timestamps come from the engine's realtime clock and are not mixed in.
+         */
+        if (type == OM_WAL_INSERT && len >= sizeof(OmWalInsert)) {
+            OmWalInsert ins;
+            memcpy(&ins, data, sizeof(ins));
+            if (ins.order_id > log->max_order_id && ins.order_id <= UINT32_MAX) {
+                log->max_order_id = (uint32_t)ins.order_id;
+            }
+            if (ins.product_id > log->max_product) {
+                log->max_product = ins.product_id;
+            }
+            if (ins.org > log->max_org) {
+                log->max_org = ins.org;
+            }
+            if (!log->sized) {
+                log->user_data_size = ins.user_data_size;
+                log->aux_data_size = ins.aux_data_size;
+                log->sized = true;
+            }
+            log_note_ts(log, ins.timestamp_ns);
+        } else if (type == OM_WAL_MATCH && len >= sizeof(OmWalMatch)) {
+            OmWalMatch m;
+            memcpy(&m, data, sizeof(m));
+            if (m.product_id > log->max_product) {
+                log->max_product = m.product_id;
+            }
+        } else if (type != OM_WAL_CHECKPOINT && len >= sizeof(OmWalCancel)) {
+            /* CANCEL, DEACTIVATE and ACTIVATE share one layout */
+            OmWalCancel c;
+            memcpy(&c, data, sizeof(c));
+            if (c.product_id > log->max_product) {
+                log->max_product = c.product_id;
+            }
+            log_note_ts(log, c.timestamp_ns);
+        }
+
+        ret = log_append(log, type, seq, data, len);
+        if (ret != 0) {
+            break;
+        }
+    }
+    om_wal_replay_close(&replay);
+    return ret;
+}
+
+/* ============================================================================
+ * Op reconstruction
+ * ============================================================================ */
+
+typedef struct ReplayBuild {
+    ReplayState *st;
+    uint8_t *side_of;        /* order_id -> 1 bid, 2 ask, 0 unknown */
+    uint32_t group;          /* op the current MATCH run belongs to */
+    uint32_t pending;        /* taker op still waiting for its INSERT */
+} ReplayBuild;
+
+static ReplayOp *build_new_op(ReplayBuild *b, uint8_t kind, uint64_t seq) {
+    ReplayState *st = b->st;
+    ReplayOp *op = &st->ops[st->op_count++];
+    memset(op, 0, sizeof(*op));
+    op->kind = kind;
+    op->seq = seq;
+    op->rec = REPLAY_NONE;
+    op->match_first = (uint32_t)st->match_count;
+    return op;
+}
+
+static uint8_t build_side(const ReplayBuild *b, uint64_t order_id) {
+    if (order_id > b->st->log.max_order_id) {
+        return 0;
+    }
+    return b->side_of[order_id];
+}
+
+/* Close a taker that never rested: IOC at its worst fill, opposite its maker */
+static void build_finish_pending(ReplayBuild *b) {
+    if (b->pending == REPLAY_NONE) {
+        return;
+    }
+    ReplayState *st = b->st;
+    ReplayOp *op = &st->ops[b->pending];
+    b->pending = REPLAY_NONE;
+
+    uint8_t maker_side = build_side(b, st->matches[op->match_first].maker_id);
+    if (maker_side == 0) {
+        op->skip = true;
+        st->unresolved++;
+        return;
+    }
+    bool taker_bid = maker_side == 2;
+    op->flags = (uint16_t)((taker_bid ? OM_SIDE_BID : OM_SIDE_ASK) | OM_TYPE_IOC);
+    op->price = st->matches[op->match_first].price;
+    op->volume = 0;
+    for (uint32_t i = 0; i < op->match_count; i++) {
+        const OmWalMatch *m = &st->matches[op->match_first + i];
+        op->volume += m->volume;
+        if (taker_bid ? m->price > op->price : m->price < op->price) {
+            op->price = m->price;
+        }
+    }
+}
+
+static int build_ops(ReplayState *st) {
+    ReplayLog *log = &st->log;
+    st->ops = calloc(log->count + 1U, sizeof(*st->ops));
+    st->matches = calloc(log->type_counts[OM_WAL_MATCH - 1] + 1U, sizeof(*st->matches));
+    ReplayBuild b = {
+        .st = st,
+        .side_of = calloc((size_t)log->max_order_id + 1U, 1U),
+        .group = REPLAY_NONE,
+        .pending = REPLAY_NONE,
+    };
+    if (!st->ops || !st->matches || !b.side_of) {
+        free(b.side_of);
+        return OM_ERR_ALLOC_FAILED;
+    }
+
+    for (size_t i = 0; i < log->count; i++) {
+        const ReplayRec *r = &log->recs[i];
+        const void *data = rec_data(log, r);
+
+        if (r->type == OM_WAL_MATCH) {
+            OmWalMatch m;
+            memcpy(&m, data, sizeof(m));
+            if (b.group == REPLAY_NONE || st->ops[b.group].order_id != m.taker_id) {
+                build_finish_pending(&b);
+                ReplayOp *last = st->op_count ? &st->ops[st->op_count - 1] : NULL;
+                if (last && last->kind == REPLAY_OP_ACTIVATE && last->order_id == m.taker_id &&
+                    last->match_count == 0) {
+                    b.group = (uint32_t)(st->op_count - 1);
+                } else {
+                    ReplayOp *op = build_new_op(&b, REPLAY_OP_TAKER, r->seq);
+                    op->order_id = (uint32_t)m.taker_id;
+                    op->product = m.product_id;
+                    op->ts_ns = st->op_count > 1 ? st->ops[st->op_count - 2].ts_ns : 0;
+                    b.group = b.pending = (uint32_t)(st->op_count - 1);
+                }
+            }
+            st->matches[st->match_count++] = m;
+            st->ops[b.group].match_count++;
+            continue;
+        }
+
+        if (r->type == OM_WAL_INSERT) {
+            OmWalInsert ins;
+            memcpy(&ins, data, sizeof(ins));
+            if (ins.order_id <= log->max_order_id) {
+                b.side_of[ins.order_id] = OM_IS_BID(ins.flags) ? 1U : 2U;
+            }
+            ReplayOp *op;
+            if (b.pending != REPLAY_NONE && st->ops[b.pending].order_id == ins.order_id) {
+                /* The taker rested: its INSERT carries the original size and limit */
+                op = &st->ops[b.pending];
+                b.pending = REPLAY_NONE;
+                op->volume = ins.volume;
+            } else {
+                build_finish_pending(&b);
+                op = build_new_op(&b, REPLAY_OP_INSERT, r->seq);
+                op->order_id = (uint32_t)ins.order_id;
+                op->ts_ns = ins.timestamp_ns;
+                /* Partly filled before the log starts: only the rest is known */
+                op->volume = ins.vol_remain;
+            }
+            op->price = ins.price;
+            op->product = ins.product_id;
+            op->org = ins.org;
+            op->flags = ins.flags;
+            op->rec = (uint32_t)i;
+            b.group = REPLAY_NONE;
+            continue;
+        }
+
+        build_finish_pending(&b);
+        b.group = REPLAY_NONE;
+        if (r->type == OM_WAL_CHECKPOINT) {
+            continue;
+        }
+        static const uint8_t kinds[] = {
+            [OM_WAL_CANCEL] = REPLAY_OP_CANCEL,
+            [OM_WAL_DEACTIVATE] = REPLAY_OP_DEACTIVATE,
+            [OM_WAL_ACTIVATE] = REPLAY_OP_ACTIVATE,
+        };
+        OmWalCancel c;
+        memcpy(&c, data, sizeof(c));
+        ReplayOp *op = build_new_op(&b, kinds[r->type], r->seq);
+        op->order_id = (uint32_t)c.order_id;
+        op->product = c.product_id;
+        op->ts_ns = c.timestamp_ns;
+    }
+    build_finish_pending(&b);
+    free(b.side_of);
+    return 0;
+}
+
+/* ============================================================================
+ * Engine replay
+ * ============================================================================ */
+
+static void note_divergence(ReplayState *st, const char *reason, const OmWalMatch *expected,
+                            const OmWalMatch *got) {
+    if (!st->cur_diverged) {
+        st->cur_diverged = true;
+        st->ops_diverged++;
+    } else {
+        return;
+    }
+    if (st->shown_count >= st->cfg->show || st->shown_count >= REPLAY_SHOW_MAX) {
+        return;
+    }
+    ReplayDivergence *d = &st->shown[st->shown_count++];
+    memset(d, 0, sizeof(*d));
+    d->seq = st->cur->seq;
+    d->order_id = st->cur->order_id;
+    d->kind = st->cur->kind;
+    d->reason = reason;
+    if (expected) {
+        d->expected = *expected;
+    }
+    if (got) {
+        d->got = *got;
+    }
+}
+
+static void replay_on_deal(const OmSlabSlot *maker, const OmSlabSlot *taker,
+                           uint64_t price, uint64_t qty, void *user_ctx) {
+    ReplayState *st = (ReplayState *)user_ctx;
+    st->deals++;
+    OmWalMatch got = {
+        .maker_id = maker->order_id,
+        .taker_id = taker->order_id,
+        .price = price,
+        .volume = qty,
+    };
+    if (st->cur_pos >= st->cur->match_count) {
+        st->deals_extra++;
+        note_divergence(st, "extra deal", NULL, &got);
+        return;
+    }
+    const OmWalMatch *m = &st->matches[st->cur->match_first + st->cur_pos++];
+    if (m->maker_id != got.maker_id || m->taker_id != got.taker_id ||
+        m->price != got.price || m->volume != got.volume) {
+        st->deals_mismatched++;
+        note_divergence(st, "deal differs", m, &got);
+    }
+}
+
+static bool replay_pre_booked(const OmSlabSlot *order, void *user_ctx) {
+    (void)user_ctx;
+    return OM_GET_TYPE(order->flags) != OM_TYPE_IOC;
+}
+
+static int replay_order(ReplayState *st, const ReplayOp *op) {
+    OmDualSlab *slab = &st->engine.orderbook.slab;
+    OmSlabSlot *order = om_slab_alloc(slab);
+    if (!order) {
+        return OM_ERR_SLAB_FULL;
+    }
+    om_slot_set_order_id(order, op->order_id);
+    om_slot_set_price(order, op->price);
+    om_slot_set_volume(order, op->volume);
+    om_slot_set_volume_remain(order, op->volume);
+    om_slot_set_flags(order, op->flags);
+    om_slot_set_org(order, op->org);
+    if (op->rec != REPLAY_NONE) {
+        const ReplayRec *r = &st->log.recs[op->rec];
+        const uint8_t *payload = (const uint8_t *)rec_data(&st->log, r) + sizeof(OmWalInsert);
+        size_t user = slab->config.user_data_size;
+        size_t aux = slab->config.aux_data_size;
+        if (sizeof(OmWalInsert) + user + aux <= r->len) {
+            memcpy(om_slot_get_data(order), payload, user);
+            memcpy(om_slot_get_aux_data(slab, order), payload + user, aux);
+        }
+    }
+
+    int ret = om_engine_match(&st->engine, op->product, order);
+    if (order->volume_remain == 0 || OM_GET_TYPE(order->flags) == OM_TYPE_IOC) {
+        om_slab_free(slab, order);
+    }
+    return ret;
+}
+
+static int replay_engine_init(ReplayState *st, OmWalConfig *wal_cfg) {
+    const ReplayLog *log = &st->log;
+    uint64_t orders = log->type_counts[OM_WAL_INSERT - 1] + st->match_count + 16U;
+    if (orders > UINT32_MAX) {
+        return OM_ERR_INVALID_PARAM;
+    }
+    OmEngineConfig ec = {
+        .slab = {
+            .user_data_size = log->user_data_size,
+            .aux_data_size = log->aux_data_size,
+            .total_slots = (uint32_t)orders,
+        },
+        .wal = wal_cfg,
+        .max_products = (uint32_t)log->max_product + 1U,
+        .max_org = (uint32_t)log->max_org + 1U,
+        .hashmap_initial_cap = 0,
+        .callbacks = {
+            .on_deal = replay_on_deal,
+            .pre_booked = replay_pre_booked,
+            .user_ctx = st,
+        },
+    };
+    return om_engine_init(&st->engine, &ec);
+}
+
+static int replay_engine(ReplayState *st) {
+    const ReplayConfig *cfg = st->cfg;
+    OmWalConfig wal_cfg;
+    if (cfg->out_wal) {
+        memset(&wal_cfg, 0, sizeof(wal_cfg));
+        wal_cfg.filename = cfg->out_wal;
+        wal_cfg.buffer_size = 1024 * 1024;
+        wal_cfg.user_data_size = st->log.user_data_size;
+        wal_cfg.aux_data_size = st->log.aux_data_size;
+    }
+    int ret = replay_engine_init(st, cfg->out_wal ? &wal_cfg : NULL);
+    if (ret != 0) {
+        return ret;
+    }
+
+    uint64_t ts0 = st->log.first_ts;
+    uint64_t late = 0;
+    uint64_t max_lag = 0;
+    uint64_t ops_run = 0;
+    uint64_t start = now_ns();
+    for (size_t i = 0; i < st->op_count; i++) {
+        const ReplayOp *op = &st->ops[i];
+        if (op->skip) {
+            continue;
+        }
+        if (cfg->speed > 0.0 && op->ts_ns > ts0) {
+            uint64_t due = start + (uint64_t)((double)(op->ts_ns - ts0) / cfg->speed);
+            uint64_t now = now_ns();
+            while (now < due) {
+                now = now_ns();
+            }
+            uint64_t lag = now - due;
+            if (lag > max_lag) {
+                max_lag = lag;
+            }
+            if (lag > 10000U) {
+                late++;
+            }
+        }
+
+        st->cur = op;
+        st->cur_pos = 0;
+        st->cur_diverged = false;
+        bool ok = true;
+
+        uint64_t t0 = now_ns();
+        switch (op->kind) {
+        case REPLAY_OP_INSERT:
+        case REPLAY_OP_TAKER:
+            ret = replay_order(st, op);
+            break;
+        case REPLAY_OP_CANCEL:
+            ok = om_engine_cancel(&st->engine, op->order_id);
+            break;
+        case REPLAY_OP_DEACTIVATE:
+            ok = om_engine_deactivate(&st->engine, op->order_id);
+            break;
+        default:
+            ok = om_engine_activate(&st->engine, op->order_id);
+            break;
+        }
+        uint64_t t1 = now_ns();
+        hist_record(&st->engine_hist[op->kind], t1 - t0);
+        ops_run++;
+
+        if (ret == OM_ERR_SLAB_FULL) {
+            break;
+        }
+        if (ret < 0) {
+            ok = false;
+        }
+        ret = 0;
+        if (!ok) {
+            st->call_misses++;
+            note_divergence(st, "order not in book", NULL, NULL);
+        }
+        if (st->cur_pos < op->match_count) {
+            st->deals_missing += op->match_count - st->cur_pos;
+            note_divergence(st, "missing deal", &st->matches[op->match_first + st->cur_pos], NULL);
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+    if (st->engine.wal) {
+        om_wal_flush(st->engine.wal);
+    }
+    om_engine_destroy(&st->engine);
+    if (ret != 0) {
+        return ret;
+    }
+
+    double secs = (double)elapsed / 1e9;
+    printf("\nengine: ops=%llu takers=%llu unresolved=%llu pace=%s%s\n",
+           (unsigned long long)ops_run,
+           (unsigned long long)(st->engine_hist[REPLAY_OP_TAKER].total),
+           (unsigned long long)st->unresolved,
+           cfg->speed > 0.0 ? "recorded" : "max",
+           cfg->out_wal ? " wal=on" : "");
+    if (cfg->speed > 0.0) {
+        printf("  speed=%.2fx late_ops(>10us)=%llu max_lag=%lluns\n",
+               cfg->speed, (unsigned long long)late, (unsigned long long)max_lag);
+    }
+    printf("  throughput=%.2f M ops/s  elapsed=%.3fs\n",
+           secs > 0.0 ? (double)ops_run / secs / 1e6 : 0.0, secs);
+    for (uint32_t k = 0; k < REPLAY_OP_COUNT; k++) {
+        hist_print_line(replay_op_names[k], &st->engine_hist[k]);
+    }
+
+    printf("  divergence: ops=%llu deals_recorded=%llu deals_replayed=%llu "
+           "mismatched=%llu missing=%llu extra=%llu not_in_book=%llu\n",
+           (unsigned long long)st->ops_diverged,
+           (unsigned long long)st->match_count,
+           (unsigned long long)st->deals,
+           (unsigned long long)st->deals_mismatched,
+           (unsigned long long)st->deals_missing,
+           (unsigned long long)st->deals_extra,
+           (unsigned long long)st->call_misses);
+    for (uint32_t i = 0; i < st->shown_count; i++) {
+        const ReplayDivergence *d = &st->shown[i];
+        printf("    seq[%" PRIu64 "] %s oid[%" PRIu32 "]: %s", d->seq,
+               replay_op_names[d->kind], d->order_id, d->reason);
+        if (d->expected.taker_id || d->expected.maker_id) {
+            printf(" want m[%" PRIu64 "] t[%" PRIu64 "] p[%" PRIu64 "] q[%" PRIu64 "]",
+                   d->expected.maker_id, d->expected.taker_id,
+                   d->expected.price, d->expected.volume);
+        }
+        if (d->got.taker_id || d->got.maker_id) {
+            printf(" got m[%" PRIu64 "] t[%" PRIu64 "] p[%" PRIu64 "] q[%" PRIu64 "]",
+                   d->got.maker_id, d->got.taker_id, d->got.price, d->got.volume);
+        }
+        printf("\n");
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * Market replay
+ * ============================================================================ */
+
+static uint64_t replay_dealable(const OmWalInsert *rec, uint16_t viewer_org, void *ctx) {
+    (void)ctx;
+    if (viewer_org == rec->org) {
+        return 0;
+    }
+    return rec->vol_remain;
+}
+
+static int replay_market(ReplayState *st) {
+    const ReplayLog *log = &st->log;
+    size_t orgs = (size_t)log->max_org + 1U;
+    size_t products = (size_t)log->max_product + 1U;
+    uint8_t *seen = calloc(orgs * products, 1U);
+    OmMarketSubscription *subs = calloc(orgs * products, sizeof(*subs));
+    uint32_t *org_to_worker = calloc((size_t)UINT16_MAX + 1U, sizeof(*org_to_worker));
+    uint32_t *product_to_public = calloc(products, sizeof(*product_to_public));
+    if (!seen || !subs || !org_to_worker || !product_to_public) {
+        free(seen);
+        free(subs);
+        free(org_to_worker);
+        free(product_to_public);
+        return OM_ERR_ALLOC_FAILED;
+    }
+
+    uint32_t sub_count = 0;
+    for (size_t i = 0; i < log->count; i++) {
+        if (log->recs[i].type != OM_WAL_INSERT) {
+            continue;
+        }
+        OmWalInsert ins;
+        memcpy(&ins, rec_data(log, &log->recs[i]), sizeof(ins));
+        size_t key = (size_t)ins.org * products + ins.product_id;
+        if (!seen[key]) {
+            seen[key] = 1;
+            subs[sub_count++] = (OmMarketSubscription){.org_id = ins.org, .product_id = ins.product_id};
+        }
+    }
+    free(seen);
+    if (sub_count == 0) {
+        printf("\nmarket: skipped (no INSERT records)\n");
+        free(subs);
+        free(org_to_worker);
+        free(product_to_public);
+        return 0;
+    }
+
+    OmMarketConfig mc = {
+        .max_products = (uint16_t)products,
+        .worker_count = 1,
+        .public_worker_count = 1,
+        .org_to_worker = org_to_worker,
+        .product_to_public_worker = product_to_public,
+        .subs = subs,
+        .sub_count = sub_count,
+        .expected_orders_per_worker = log->type_counts[OM_WAL_INSERT - 1] + 16U,
+        .expected_subscribers_per_product = sub_count / products + 1U,
+        .expected_price_levels = 64,
+        .top_levels = st->cfg->top_levels,
+        .dealable = replay_dealable,
+        .dealable_ctx = NULL,
+    };
+    OmMarket market;
+    int ret = om_market_init(&market, &mc);
+    if (ret != 0) {
+        free(subs);
+        free(org_to_worker);
+        free(product_to_public);
+        return ret;
+    }
+    OmMarketWorker *worker = om_market_worker(&market, 0);
+    OmMarketPublicWorker *pub = &market.public_workers[0];
+
+    uint64_t errors = 0;
+    uint64_t private_ns = 0;
+    uint64_t public_ns = 0;
+    for (size_t i = 0; i < log->count; i++) {
+        const ReplayRec *r = &log->recs[i];
+        const void *data = rec_data(log, r);
+        uint64_t t0 = now_ns();
+        int prc = om_market_worker_process(worker, (OmWalType)r->type, data);
+        uint64_t t1 = now_ns();
+        int qrc = om_market_public_process(pub, (OmWalType)r->type, data);
+        uint64_t t2 = now_ns();
+        hist_record(&st->private_hist[r->type - 1], t1 - t0);
+        hist_record(&st->public_hist[r->type - 1], t2 - t1);
+        private_ns += t1 - t0;
+        public_ns += t2 - t1;
+        errors += (prc < 0) + (qrc < 0);
+    }
+
+    printf("\nmarket: records=%zu subs=%u top_levels=%u errors=%llu\n",
+           log->count, sub_count, st->cfg->top_levels, (unsigned long long)errors);
+    printf("  private throughput=%.2f M rec/s\n",
+           private_ns ? (double)log->count * 1e3 / (double)private_ns : 0.0);
+    for (uint32_t t = 0; t < REPLAY_TYPE_COUNT; t++) {
+        if (st->private_hist[t].total) {
+            hist_print_line(replay_type_names[t], &st->private_hist[t]);
+        }
+    }
+    printf("  public throughput=%.2f M rec/s\n",
+           public_ns ? (double)log->count * 1e3 / (double)public_ns : 0.0);
+    for (uint32_t t = 0; t < REPLAY_TYPE_COUNT; t++) {
+        if (st->public_hist[t].total) {
+            hist_print_line(replay_type_names[t], &st->public_hist[t]);
+        }
+    }
+
+    om_market_destroy(&market);
+    free(subs);
+    free(org_to_worker);
+    free(product_to_public);
+    return 0;
+}
+
+/* ============================================================================
+ * CLI
+ * ============================================================================ */
+
+static int parse_u32(const char *s, uint32_t *out) {
+    char *end = NULL;
+    unsigned long value = strtoul(s, &end, 10);
+    if (!s || *s == '\0' || !end || *end != '\0') {
+        return -1;
+    }
+    if (value > UINT32_MAX) {
+        return -1;
+    }
+    *out = (uint32_t)value;
+    return 0;
+}
+
+static void print_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [--speed X] [--no-crc] [--engine-only | --market-only]\n"
+            "          [--show N] [--top-levels N] [--out-wal PATH] <wal>\n",
+            prog);
+}
+
+static int parse_args(int argc, char **argv, ReplayConfig *cfg) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            char *end = NULL;
+            cfg->speed = strtod(argv[++i], &end);
+            if (!end || *end != '\0' || cfg->speed < 0.0) {
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--no-crc") == 0) {
+            cfg->no_crc = true;
+        } else if (strcmp(argv[i], "--engine-only") == 0) {
+            cfg->market = false;
+        } else if (strcmp(argv[i], "--market-only") == 0) {
+            cfg->engine = false;
+        } else if (strcmp(argv[i], "--show") == 0 && i + 1 < argc) {
+            if (parse_u32(argv[++i], &cfg->show) != 0) {
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--top-levels") == 0 && i + 1 < argc) {
+            if (parse_u32(argv[++i], &cfg->top_levels) != 0) {
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--out-wal") == 0 && i + 1 < argc) {
+            cfg->out_wal = argv[++i];
+        } else if (argv[i][0] != '-' && !cfg->wal_path) {
+            cfg->wal_path = argv[i];
+        } else {
+            return -1;
+        }
+    }
+    if (!cfg->wal_path || (!cfg->engine && !cfg->market)) {
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    ReplayConfig cfg = {
+        .speed = 0.0,
+        .show = 10,
+        .top_levels = 10,
+        .engine = true,
+        .market = true,
+    };
+
+    if (parse_args(argc, argv, &cfg) != 0) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    ReplayState *st = calloc(1, sizeof(*st));
+    if (!st) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    st->cfg = &cfg;
+
+    int ret = log_load(&st->log, cfg.wal_path, cfg.no_crc);
+    if (ret != 0) {
+        fprintf(stderr, "failed to load wal %s: %d\n", cfg.wal_path, ret);
+        return 1;
+    }
+    const ReplayLog *log = &st->log;
+    printf("OpenMatch WAL replay harness\n");
+    printf("wal: %s records=%zu insert=%llu cancel=%llu match=%llu deactivate=%llu "
+           "activate=%llu other=%llu crc_errors=%llu span=%.3fs\n",
+           cfg.wal_path,
+           log->count,
+           (unsigned long long)log->type_counts[OM_WAL_INSERT - 1],
+           (unsigned long long)log->type_counts[OM_WAL_CANCEL - 1],
+           (unsigned long long)log->type_counts[OM_WAL_MATCH - 1],
+           (unsigned long long)log->type_counts[OM_WAL_DEACTIVATE - 1],
+           (unsigned long long)log->type_counts[OM_WAL_ACTIVATE - 1],
+           (unsigned long long)(log->type_counts[OM_WAL_CHECKPOINT - 1] +
+                                log->type_counts[REPLAY_TYPE_COUNT]),
+           (unsigned long long)log->crc_errors,
+           (double)(log->last_ts - log->first_ts) / 1e9);
+
+    if (cfg.engine) {
+        ret = build_ops(st);
+        if (ret == 0) {
+            ret = replay_engine(st);
+        }
+        if (ret != 0) {
+            fprintf(stderr, "engine replay failed: %d\n", ret);
+        }
+    }
+    if (ret == 0 && cfg.market) {
+        ret = replay_market(st);
+        if (ret != 0) {
+            fprintf(stderr, "market replay failed: %d\n", ret);
+        }
+    }
+
+    int status = ret != 0 ? 1 : (st->ops_diverged ? 3 : 0);
+    free(st->ops);
+    free(st->matches);
+    free(st->log.recs);
+    free(st->log.blob);
+    free(st);
+    return status;
+}
@@ -1,19 +1,25 @@
 #include <arpa/inet.h>
 #include <check.h>
+#include <dirent.h>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <pthread.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
 #include <sys/socket.h>
+#include <time.h>
 #include <unistd.h>
 #include "ombus/om_bus.h"
 #include "ombus/om_bus_tcp.h"
+#include "ombus/om_bus_mcast.h"
 #include "ombus/om_bus_wal.h"
 #include "ombus/om_bus_market.h"
 #include "ombus/om_bus_relay.h"
+#include "ombus/om_bus_fanout.h"
 #include "openmatch/om_engine.h"
 
 /* Unique SHM names per test to avoid collisions */
@@ -294,13 +300,13 @@ START_TEST(test_bus_crc_validation) {
         int fd = shm_open(name, O_RDWR, 0);
         ck_assert_int_ge(fd, 0);
         /* Map enough to reach slot 0: header page + consumer_tails + slot */
-        size_t map_len = 4096 + 1 * 64 + 256;
+        size_t map_len = 4096 + 1 * OM_BUS_CONSUMER_ALIGN + 256;
         char *m = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
         ck_assert_ptr_ne(m, MAP_FAILED);
         close(fd);
-        /* Slot 0 is at: header_page(4096) + max_consumers*64(1*64) + 0*slot_size */
+        /* Slot 0 is at: header page + max_consumers * OM_BUS_CONSUMER_ALIGN */
         /* Payload starts at slot + 24 (slot header size) */
-        char *p = m + 4096 + 1 * 64 + 24;
+        char *p = m + 4096 + 1 * OM_BUS_CONSUMER_ALIGN + 24;
         p[0] ^= 0xFF; /* flip a byte */
         munmap(m, map_len);
     }
@@ -340,7 +346,7 @@ START_TEST(test_bus_record_too_large) {
 }
 END_TEST
 
-/* ---- Test: magic/version mismatch -> endpoint_open error ---- */
+/* ---- Test: magic/version/flags mismatch -> endpoint_open error ---- */
 START_TEST(test_bus_magic_mismatch) {
     const char *name = test_shm_name("magic");
     OmBusStream *stream = NULL;
@@ -349,27 +355,40 @@ START_TEST(test_bus_magic_mismatch) {
         .capacity = 64,
         .slot_size = 256,
         .max_consumers = 1,
-        .flags = 0,
+        .flags = 0x10U,
     };
+    /* Reserved flag bits are refused on create */
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), OM_ERR_BUS_INIT);
+    scfg.flags = 0;
     ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
 
-    /* Corrupt the magic in the SHM header via the stream's internal map.
-     * We need to access the map pointer. Since OmBusStream is opaque,
-     * we open the SHM directly to corrupt it. */
-    {
-        int fd = shm_open(name, O_RDWR, 0);
-        ck_assert_int_ge(fd, 0);
-        uint32_t *magic = mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-        ck_assert_ptr_ne(magic, MAP_FAILED);
-        close(fd);
-        *magic = 0xDEADBEEF; /* corrupt magic */
-        munmap(magic, 4096);
-    }
+    /* Corrupt the SHM header. Since OmBusStream is opaque, we open the SHM
+     * directly to corrupt it. */
+    int fd = shm_open(name, O_RDWR, 0);
+    ck_assert_int_ge(fd, 0);
+    OmBusShmHeader *hdr = mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ck_assert_ptr_ne(hdr, MAP_FAILED);
+    close(fd);
 
     OmBusEndpoint *ep = NULL;
     OmBusEndpointConfig ecfg = { .stream_name = name, .consumer_index = 0, .zero_copy = true };
-    int rc = om_bus_endpoint_open(&ep, &ecfg);
-    ck_assert_int_eq(rc, OM_ERR_BUS_MAGIC_MISMATCH);
+
+    /* A stream from an older layout */
+    hdr->version = OM_BUS_SHM_VERSION - 1U;
+    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), OM_ERR_BUS_VERSION_MISMATCH);
+    hdr->version = OM_BUS_SHM_VERSION;
+
+    /* A stream using a feature this build does not know */
+    hdr->flags |= 0x100U;
+    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), OM_ERR_BUS_VERSION_MISMATCH);
+    hdr->flags &= ~0x100U;
+    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), 0);
+    om_bus_endpoint_close(ep);
+    ep = NULL;
+
+    hdr->magic = 0xDEADBEEF; /* corrupt magic */
+    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), OM_ERR_BUS_MAGIC_MISMATCH);
+    munmap(hdr, 4096);
 
     om_bus_stream_destroy(stream);
 }
@@ -1595,6 +1614,83 @@ START_TEST(test_tcp_auto_reconnect) {
 }
 END_TEST
 
+/* ---- Test: TCP batch poll — whole buffer per call, gap ends a batch ---- */
+START_TEST(test_tcp_client_poll_batch) {
+    OmBusTcpServer *srv = tcp_test_server(0, 0);
+    uint16_t port = om_bus_tcp_server_port(srv);
+    OmBusTcpClient *client = tcp_test_client(port, 0);
+    OmBusTcpAutoClient *ac = NULL;
+    OmBusTcpAutoClientConfig acfg = {
+        .base = { .host = "127.0.0.1", .port = port, .recv_buf_size = 0 },
+        .retry_base_ms = 50,
+        .retry_max_ms = 200,
+    };
+    ck_assert_int_eq(om_bus_tcp_auto_client_create(&ac, &acfg), 0);
+    for (int i = 0; i < 20 && om_bus_tcp_server_client_count(srv) < 2; i++) {
+        om_bus_tcp_server_poll_io(srv);
+        usleep(1000);
+    }
+    ck_assert_uint_eq(om_bus_tcp_server_client_count(srv), 2);
+
+    /* 1..500, then 502..600 */
+    for (uint64_t seq = 1; seq <= 600; seq++) {
+        if (seq == 501) continue;
+        ck_assert_int_eq(om_bus_tcp_server_broadcast(srv, seq, 3, &seq, sizeof(seq)), 0);
+    }
+    ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+    usleep(20000);
+
+    OmBusRecord recs[128];
+    uint64_t next = 1;
+    int calls = 0;
+    while (next <= 500 && calls < 100) {
+        int n = om_bus_tcp_client_poll_batch(client, recs, 128);
+        ck_assert_int_ge(n, 0);
+        for (int i = 0; i < n; i++) {
+            uint64_t v;
+            memcpy(&v, recs[i].payload, sizeof(v));
+            ck_assert_uint_eq(recs[i].wal_seq, next);
+            ck_assert_uint_eq(v, next);
+            next++;
+        }
+        if (n == 0) usleep(1000);
+        calls++;
+    }
+    ck_assert_uint_eq(next, 501);
+    ck_assert_int_lt(calls, 20);
+
+    /* Gap record comes back alone with its status, then the rest */
+    ck_assert_int_eq(om_bus_tcp_client_poll_batch(client, recs, 128),
+                     OM_ERR_BUS_GAP_DETECTED);
+    ck_assert_uint_eq(recs[0].wal_seq, 502);
+    ck_assert_int_eq(om_bus_tcp_client_poll_batch(client, recs, 128), 98);
+    ck_assert_uint_eq(recs[97].wal_seq, 600);
+    ck_assert_uint_eq(om_bus_tcp_client_wal_seq(client), 600);
+
+    /* Auto client: same stream through the wrapper */
+    uint64_t got = 0;
+    for (int i = 0; i < 100 && got < 599; i++) {
+        int n = om_bus_tcp_auto_client_poll_batch(ac, recs, 128);
+        if (n == OM_ERR_BUS_GAP_DETECTED) n = 1;
+        ck_assert_int_ge(n, 0);
+        got += (uint64_t)n;
+        if (n == 0) usleep(1000);
+    }
+    ck_assert_uint_eq(got, 599);
+    ck_assert_uint_eq(om_bus_tcp_auto_client_wal_seq(ac), 600);
+
+    /* Peer close: buffered data first, then DISCONNECTED / reconnecting */
+    om_bus_tcp_server_destroy(srv);
+    usleep(10000);
+    ck_assert_int_eq(om_bus_tcp_client_poll_batch(client, recs, 128),
+                     OM_ERR_BUS_TCP_DISCONNECTED);
+    ck_assert_int_eq(om_bus_tcp_auto_client_poll_batch(ac, recs, 128), 0);
+
+    om_bus_tcp_auto_client_close(ac);
+    om_bus_tcp_client_close(client);
+}
+END_TEST
+
 /* ---- Test: R3 — TCP slow client warning frame ---- */
 START_TEST(test_tcp_slow_client_warning) {
     /* Tiny send buffer: 128 bytes — room for a few small frames */
@@ -1768,19 +1864,19 @@ START_TEST(test_bus_batch_poll_crc) {
     {
         int fd = shm_open(name, O_RDWR, 0);
         ck_assert_int_ge(fd, 0);
-        size_t map_len = 4096 + 1 * 64 + 256 * 16;
+        size_t map_len = 4096 + 1 * OM_BUS_CONSUMER_ALIGN + 256 * 16;
         char *m = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
         ck_assert_ptr_ne(m, MAP_FAILED);
         close(fd);
         /* Slot at index (8 & 63) = 8: offset = header + tails + 8*slot_size + slot_header */
-        char *p = m + 4096 + 1 * 64 + 8 * 256 + 24;
+        char *p = m + 4096 + 1 * OM_BUS_CONSUMER_ALIGN + 8 * 256 + 24;
         p[0] ^= 0xFF;
         munmap(m, map_len);
     }
 
-    /* Batch should return 0 (first record CRC fails, batch stops before it) */
+    /* First record fails its CRC: nothing delivered, the error surfaces */
     count = om_bus_endpoint_poll_batch(ep, recs, 16);
-    ck_assert_int_eq(count, 0);
+    ck_assert_int_eq(count, OM_ERR_BUS_CRC_MISMATCH);
 
     om_bus_endpoint_close(ep);
     om_bus_stream_destroy(stream);
@@ -2030,148 +2126,2580 @@ START_TEST(test_tcp_server_load) {
 }
 END_TEST
 
-START_TEST(test_bus_mixed_poll_batch_sequence_tracking) {
-    const char *name = test_shm_name("mixseq");
-    OmBusStream *stream = NULL;
-    OmBusStreamConfig scfg = {
-        .stream_name = name, .capacity = 64, .slot_size = 256,
-        .max_consumers = 1, .flags = 0,
+/* ---- Test: SHARED server mode — one ring, per-client offsets, wraps ---- */
+static OmBusTcpServer *tcp_test_shared_server(uint32_t ring_size, uint32_t max_lag) {
+    OmBusTcpServerConfig cfg = {
+        .bind_addr = "127.0.0.1",
+        .port = 0,
+        .max_clients = 8,
+        .mode = OM_BUS_TCP_SERVER_SHARED,
+        .ring_size = ring_size,
+        .max_lag_bytes = max_lag,
     };
-    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+    OmBusTcpServer *srv = NULL;
+    ck_assert_int_eq(om_bus_tcp_server_create(&srv, &cfg), 0);
+    ck_assert_ptr_nonnull(srv);
+    return srv;
+}
 
-    OmBusEndpoint *ep = NULL;
-    OmBusEndpointConfig ecfg = {
-        .stream_name = name, .consumer_index = 0, .zero_copy = false,
+START_TEST(test_tcp_shared_broadcast) {
+    /* Non power-of-two ring is rejected */
+    OmBusTcpServer *bad = NULL;
+    OmBusTcpServerConfig bad_cfg = {
+        .bind_addr = "127.0.0.1", .mode = OM_BUS_TCP_SERVER_SHARED,
+        .ring_size = 5000,
     };
-    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), 0);
+    ck_assert_int_eq(om_bus_tcp_server_create(&bad, &bad_cfg), OM_ERR_BUS_NOT_POW2);
 
-    uint32_t payload = 99;
-    for (uint64_t seq = 1; seq <= 6; seq++) {
-        ck_assert_int_eq(om_bus_stream_publish(stream, seq, 1, &payload, sizeof(payload)), 0);
+    /* 64 KB ring; 2000 frames of 16 + 40 bytes wrap it almost twice */
+    OmBusTcpServer *srv = tcp_test_shared_server(64 * 1024, 0);
+    uint16_t port = om_bus_tcp_server_port(srv);
+    OmBusTcpClient *clients[3];
+    for (int c = 0; c < 3; c++) clients[c] = tcp_test_client(port, 0);
+    for (int i = 0; i < 20 && om_bus_tcp_server_client_count(srv) < 3; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+        usleep(1000);
     }
+    ck_assert_uint_eq(om_bus_tcp_server_client_count(srv), 3);
 
-    OmBusRecord rec;
-    ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 1);
-    ck_assert_uint_eq(rec.wal_seq, 1);
+    uint8_t payload[40];
+    OmBusRecord batch[4];
+    uint64_t got[3] = {0, 0, 0};
+    for (uint64_t seq = 1; seq <= 2000; seq += 4) {
+        for (int k = 0; k < 4; k++) {
+            batch[k].wal_seq = seq + (uint64_t)k;
+            batch[k].wal_type = 2;
+            batch[k].payload_len = sizeof(payload);
+            batch[k].payload = payload;
+        }
+        memset(payload, (int)(seq & 0xFF), sizeof(payload));
+        ck_assert_int_eq(om_bus_tcp_server_broadcast_batch(srv, batch, 4), 0);
+        if ((seq - 1) % 100 == 0) {
+            ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+        }
+    }
 
-    OmBusRecord recs[3];
-    int count = om_bus_endpoint_poll_batch(ep, recs, 3);
-    ck_assert_int_eq(count, 3);
-    ck_assert_uint_eq(recs[0].wal_seq, 2);
-    ck_assert_uint_eq(recs[1].wal_seq, 3);
-    ck_assert_uint_eq(recs[2].wal_seq, 4);
+    OmBusRecord rec;
+    for (int attempt = 0; attempt < 500; attempt++) {
+        ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+        bool done = true;
+        for (int c = 0; c < 3; c++) {
+            int rc;
+            while ((rc = om_bus_tcp_client_poll(clients[c], &rec)) == 1) {
+                ck_assert_uint_eq(rec.wal_seq, got[c] + 1);
+                ck_assert_uint_eq(rec.payload_len, 40);
+                got[c]++;
+            }
+            ck_assert_int_eq(rc, 0);
+            if (got[c] < 2000) done = false;
+        }
+        if (done) break;
+        usleep(1000);
+    }
+    for (int c = 0; c < 3; c++) ck_assert_uint_eq(got[c], 2000);
 
-    ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 1);
-    ck_assert_uint_eq(rec.wal_seq, 5);
+    OmBusTcpServerStats stats;
+    om_bus_tcp_server_stats(srv, &stats);
+    ck_assert_uint_eq(stats.records_broadcast, 2000);
+    ck_assert_uint_eq(stats.slow_client_drops, 0);
+    ck_assert_uint_le(stats.max_client_lag, 64 * 1024 / 2);
 
-    om_bus_endpoint_close(ep);
-    om_bus_stream_destroy(stream);
+    for (int c = 0; c < 3; c++) om_bus_tcp_client_close(clients[c]);
+    om_bus_tcp_server_destroy(srv);
 }
 END_TEST
 
-START_TEST(test_bus_batch_then_poll_reorder_detection) {
-    const char *name = test_shm_name("batchreorder");
-    OmBusStream *stream = NULL;
-    OmBusStreamConfig scfg = {
-        .stream_name = name, .capacity = 64, .slot_size = 256,
-        .max_consumers = 1, .flags = OM_BUS_FLAG_REJECT_REORDER,
-    };
-    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+/* ---- Test: SHARED server mode — lag-based slow client warning + drop ---- */
+START_TEST(test_tcp_shared_slow_client) {
+    OmBusTcpServer *srv = tcp_test_shared_server(4096, 1024);
+    uint16_t port = om_bus_tcp_server_port(srv);
+    OmBusTcpClient *client = tcp_test_client(port, 0);
+    for (int i = 0; i < 20 && om_bus_tcp_server_client_count(srv) < 1; i++) {
+        om_bus_tcp_server_poll_io(srv);
+        usleep(1000);
+    }
+    ck_assert_uint_eq(om_bus_tcp_server_client_count(srv), 1);
 
-    OmBusEndpoint *ep = NULL;
-    OmBusEndpointConfig ecfg = {
-        .stream_name = name, .consumer_index = 0, .zero_copy = false,
-    };
-    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), 0);
+    /* Frames larger than the ring are rejected */
+    static uint8_t big[5000];
+    ck_assert_int_eq(om_bus_tcp_server_broadcast(srv, 1, 1, big, sizeof(big)),
+                     OM_ERR_BUS_RECORD_TOO_LARGE);
 
-    uint32_t payload = 7;
-    ck_assert_int_eq(om_bus_stream_publish(stream, 1, 1, &payload, sizeof(payload)), 0);
-    ck_assert_int_eq(om_bus_stream_publish(stream, 2, 1, &payload, sizeof(payload)), 0);
-    ck_assert_int_eq(om_bus_stream_publish(stream, 1, 1, &payload, sizeof(payload)), 0);
+    /* 40 frames x 32 bytes = 1280 bytes of lag > 1024 */
+    uint8_t payload[16];
+    memset(payload, 0x5A, sizeof(payload));
+    for (int i = 0; i < 40; i++) {
+        om_bus_tcp_server_broadcast(srv, (uint64_t)(i + 1), 1, payload, sizeof(payload));
+    }
+    ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+    ck_assert_uint_eq(om_bus_tcp_server_client_count(srv), 0);
 
-    OmBusRecord recs[2];
-    int count = om_bus_endpoint_poll_batch(ep, recs, 2);
-    ck_assert_int_eq(count, 2);
-    ck_assert_uint_eq(recs[0].wal_seq, 1);
-    ck_assert_uint_eq(recs[1].wal_seq, 2);
+    OmBusTcpServerStats stats;
+    om_bus_tcp_server_stats(srv, &stats);
+    ck_assert_uint_eq(stats.slow_client_drops, 1);
 
+    /* Backlog up to the cut, then the warning frame */
+    usleep(20000);
     OmBusRecord rec;
-    ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), OM_ERR_BUS_REORDER_DETECTED);
-    ck_assert_uint_eq(rec.wal_seq, 1);
+    int got_records = 0;
+    int got_warning = 0;
+    for (int attempt = 0; attempt < 200; attempt++) {
+        int rc = om_bus_tcp_client_poll(client, &rec);
+        if (rc == 1) {
+            got_records++;
+        } else if (rc == OM_ERR_BUS_TCP_SLOW_WARNING) {
+            got_warning = 1;
+            break;
+        } else if (rc == 0) {
+            usleep(5000);
+        } else {
+            break;
+        }
+    }
+    ck_assert_int_eq(got_records, 40);
+    ck_assert_int_eq(got_warning, 1);
 
-    om_bus_endpoint_close(ep);
-    om_bus_stream_destroy(stream);
+    om_bus_tcp_client_close(client);
+    om_bus_tcp_server_destroy(srv);
 }
 END_TEST
 
-/* ---- Test: SHM ring wrap-around with high head values ---- */
-START_TEST(test_bus_ring_wrap) {
-    const char *name = test_shm_name("wrap");
-    OmBusStream *stream = NULL;
-    OmBusStreamConfig scfg = {
-        .stream_name = name, .capacity = 16, .slot_size = 64,
-        .max_consumers = 1, .flags = 0,
+/* ---- Test: BATCH frames — negotiated per client, LZ, gaps survive deltas ---- */
+static void tcp_test_batch_payload(uint8_t *p, uint64_t seq) {
+    memset(p, 0, 48);
+    memcpy(p, &seq, sizeof(seq));
+    memcpy(p + 24, "CANCEL--CANCEL--", 16);
+}
+
+START_TEST(test_tcp_batch_frames) {
+    OmBusTcpServer *bad = NULL;
+    OmBusTcpServerConfig bad_cfg = {
+        .bind_addr = "127.0.0.1", .caps = OM_BUS_TCP_CAP_LZ,
     };
-    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+    ck_assert_int_eq(om_bus_tcp_server_create(&bad, &bad_cfg), OM_ERR_BUS_INIT);
 
-    OmBusEndpoint *ep = NULL;
-    OmBusEndpointConfig ecfg = {
-        .stream_name = name, .consumer_index = 0, .zero_copy = true,
+    OmBusTcpServerConfig scfg = {
+        .bind_addr = "127.0.0.1",
+        .caps = OM_BUS_TCP_CAP_BATCH | OM_BUS_TCP_CAP_LZ,
     };
-    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), 0);
+    OmBusTcpServer *srv = NULL;
+    ck_assert_int_eq(om_bus_tcp_server_create(&srv, &scfg), 0);
+    uint16_t port = om_bus_tcp_server_port(srv);
 
-    /* Publish and consume 256 records through a 16-slot ring (16 full wraps) */
+    /* lz: BATCH + LZ; plain: no HELLO; auto: BATCH only */
+    OmBusTcpClientConfig ccfg = {
+        .host = "127.0.0.1", .port = port,
+        .caps = OM_BUS_TCP_CAP_BATCH | OM_BUS_TCP_CAP_LZ,
+    };
+    OmBusTcpClient *lz = NULL;
+    ck_assert_int_eq(om_bus_tcp_client_connect(&lz, &ccfg), 0);
+    OmBusTcpClient *plain = tcp_test_client(port, 0);
+    OmBusTcpAutoClient *ac = NULL;
+    OmBusTcpAutoClientConfig acfg = {
+        .base = { .host = "127.0.0.1", .port = port, .caps = OM_BUS_TCP_CAP_BATCH },
+    };
+    ck_assert_int_eq(om_bus_tcp_auto_client_create(&ac, &acfg), 0);
+    for (int i = 0; i < 20; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+        usleep(1000);
+    }
+    ck_assert_uint_eq(om_bus_tcp_server_client_count(srv), 3);
+
+    /* 6 batches of 50: seq 1..150, then 152..301 (gap inside a batch) */
+    static uint8_t payloads[300][48];
+    OmBusRecord batch[50];
+    uint64_t seq = 1;
+    for (int b = 0; b < 6; b++) {
+        for (int k = 0; k < 50; k++) {
+            if (seq == 151) seq++;
+            uint8_t *p = payloads[b * 50 + k];
+            tcp_test_batch_payload(p, seq);
+            batch[k].wal_seq = seq;
+            batch[k].wal_type = (uint8_t)(1 + (seq & 1));
+            batch[k].payload_len = 48;
+            batch[k].payload = p;
+            seq++;
+        }
+        ck_assert_int_eq(om_bus_tcp_server_broadcast_batch(srv, batch, 50), 0);
+    }
+    for (int i = 0; i < 5; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+        usleep(2000);
+    }
+
+    OmBusTcpServerStats stats;
+    om_bus_tcp_server_stats(srv, &stats);
+    ck_assert_uint_eq(stats.records_broadcast, 300);
+    ck_assert_uint_eq(stats.batch_frames, 12);  /* 6 calls x 2 formats */
+    ck_assert_uint_gt(stats.lz_bytes_saved, 0);
+
+    /* Record-at-a-time poll unpacks compressed frames */
+    uint8_t expect[48];
     OmBusRecord rec;
-    for (int i = 0; i < 256; i++) {
-        uint32_t val = (uint32_t)(i * 7);
-        ck_assert_int_eq(om_bus_stream_publish(stream, (uint64_t)(i + 1), 1,
-                                                &val, sizeof(val)), 0);
-        ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 1);
-        ck_assert_uint_eq(rec.wal_seq, (uint64_t)(i + 1));
-        uint32_t out;
-        memcpy(&out, rec.payload, sizeof(out));
-        ck_assert_uint_eq(out, (uint32_t)(i * 7));
+    uint64_t next = 1;
+    int gaps = 0;
+    for (int attempt = 0; attempt < 1000 && next <= 301; attempt++) {
+        int rc = om_bus_tcp_client_poll(lz, &rec);
+        if (rc == 0) { usleep(1000); continue; }
+        if (rc == OM_ERR_BUS_GAP_DETECTED) {
+            ck_assert_uint_eq(next, 151);
+            gaps++;
+            next++;
+        } else {
+            ck_assert_int_eq(rc, 1);
+        }
+        ck_assert_uint_eq(rec.wal_seq, next);
+        ck_assert_uint_eq(rec.wal_type, 1 + (next & 1));
+        ck_assert_uint_eq(rec.payload_len, 48);
+        tcp_test_batch_payload(expect, next);
+        ck_assert_int_eq(memcmp(rec.payload, expect, 48), 0);
+        next++;
     }
+    ck_assert_uint_eq(next, 302);
+    ck_assert_int_eq(gaps, 1);
 
-    /* Verify correct wal_seq after many wraps */
-    ck_assert_uint_eq(om_bus_endpoint_wal_seq(ep), 256);
+    /* Single frames and plain BATCH frames through poll_batch */
+    OmBusRecord recs[64];
+    uint64_t got[2] = {0, 0};
+    for (int attempt = 0; attempt < 200 && (got[0] < 300 || got[1] < 300); attempt++) {
+        int n0 = om_bus_tcp_client_poll_batch(plain, recs, 64);
+        if (n0 == OM_ERR_BUS_GAP_DETECTED) n0 = 1;
+        ck_assert_int_ge(n0, 0);
+        for (int i = 0; i < n0; i++) {
+            tcp_test_batch_payload(expect, recs[i].wal_seq);
+            ck_assert_int_eq(memcmp(recs[i].payload, expect, 48), 0);
+        }
+        got[0] += (uint64_t)n0;
 
-    om_bus_endpoint_close(ep);
-    om_bus_stream_destroy(stream);
+        int n1 = om_bus_tcp_auto_client_poll_batch(ac, recs, 64);
+        if (n1 == OM_ERR_BUS_GAP_DETECTED) {
+            ck_assert_uint_eq(recs[0].wal_seq, 152);
+            n1 = 1;
+        }
+        ck_assert_int_ge(n1, 0);
+        for (int i = 0; i < n1; i++) {
+            tcp_test_batch_payload(expect, recs[i].wal_seq);
+            ck_assert_int_eq(memcmp(recs[i].payload, expect, 48), 0);
+        }
+        got[1] += (uint64_t)n1;
+        if (n0 == 0 && n1 == 0) usleep(1000);
+    }
+    ck_assert_uint_eq(got[0], 300);
+    ck_assert_uint_eq(got[1], 300);
+    ck_assert_uint_eq(om_bus_tcp_client_wal_seq(plain), 301);
+    ck_assert_uint_eq(om_bus_tcp_auto_client_wal_seq(ac), 301);
+
+    om_bus_tcp_auto_client_close(ac);
+    om_bus_tcp_client_close(plain);
+    om_bus_tcp_client_close(lz);
+    om_bus_tcp_server_destroy(srv);
+
+    /* SHARED: one encoding in the ring; a HELLO lacking LZ is dropped */
+    OmBusTcpServerConfig shcfg = {
+        .bind_addr = "127.0.0.1", .max_clients = 8,
+        .mode = OM_BUS_TCP_SERVER_SHARED, .ring_size = 64 * 1024,
+        .caps = OM_BUS_TCP_CAP_BATCH | OM_BUS_TCP_CAP_LZ,
+    };
+    ck_assert_int_eq(om_bus_tcp_server_create(&srv, &shcfg), 0);
+    ccfg.port = om_bus_tcp_server_port(srv);
+    ck_assert_int_eq(om_bus_tcp_client_connect(&lz, &ccfg), 0);
+    OmBusTcpClient *weak = NULL;
+    ccfg.caps = OM_BUS_TCP_CAP_BATCH;
+    ck_assert_int_eq(om_bus_tcp_client_connect(&weak, &ccfg), 0);
+    for (int i = 0; i < 20; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+        usleep(1000);
+    }
+    ck_assert_uint_eq(om_bus_tcp_server_client_count(srv), 1);
+
+    ck_assert_int_eq(om_bus_tcp_server_broadcast_batch(srv, batch, 50), 0);
+    ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+    int n = 0;
+    for (int attempt = 0; attempt < 100 && n < 50; attempt++) {
+        int rc = om_bus_tcp_client_poll_batch(lz, recs + n, (uint32_t)(64 - n));
+        ck_assert_int_ge(rc, 0);
+        n += rc;
+        if (rc == 0) usleep(1000);
+    }
+    ck_assert_int_eq(n, 50);
+    ck_assert_uint_eq(recs[49].wal_seq, 301);
+    ck_assert_int_eq(memcmp(recs[49].payload, payloads[299], 48), 0);
+
+    om_bus_tcp_client_close(weak);
+    om_bus_tcp_client_close(lz);
+    om_bus_tcp_server_destroy(srv);
 }
 END_TEST
 
-Suite *bus_suite(void) {
-    Suite *s = suite_create("Bus");
-    TCase *tc = tcase_create("SHM");
-    tcase_add_test(tc, test_bus_create_destroy);
-    tcase_add_test(tc, test_bus_publish_poll);
-    tcase_add_test(tc, test_bus_batch);
-    tcase_add_test(tc, test_bus_multi_consumer);
-    tcase_add_test(tc, test_bus_backpressure);
-    tcase_add_test(tc, test_bus_gap_detection);
-    tcase_add_test(tc, test_bus_crc_validation);
-    tcase_add_test(tc, test_bus_record_too_large);
-    tcase_add_test(tc, test_bus_magic_mismatch);
-    tcase_add_test(tc, test_bus_wal_seq_tracking);
-    tcase_add_test(tc, test_bus_large_payload_boundary);
-    tcase_add_test(tc, test_bus_batch_publish);
-    tcase_add_test(tc, test_bus_cursor_persistence);
-    tcase_add_test(tc, test_bus_epoch_restart);
-    tcase_add_test(tc, test_bus_stale_consumer);
-    tcase_add_test(tc, test_bus_relay);
-    tcase_add_test(tc, test_bus_reorder_detection);
-    tcase_add_test(tc, test_bus_batch_poll_crc);
-    tcase_add_test(tc, test_bus_multiple_gaps);
-    tcase_add_test(tc, test_bus_concurrent_consumers);
-    tcase_add_test(tc, test_bus_mixed_poll_batch_sequence_tracking);
-    tcase_add_test(tc, test_bus_batch_then_poll_reorder_detection);
-    tcase_add_test(tc, test_bus_ring_wrap);
-    suite_add_tcase(s, tc);
+/* ---- Test: RESEND — WAL then history replay, auto-client resume, SHARED ---- */
+static uint64_t tcp_test_drain_seq(OmBusTcpClient *client, OmBusTcpServer *srv,
+                                   uint64_t next, uint64_t last) {
+    OmBusRecord recs[64];
+    for (int attempt = 0; attempt < 2000 && next <= last; attempt++) {
+        om_bus_tcp_server_poll_io(srv);
+        int n = om_bus_tcp_client_poll_batch(client, recs, 64);
+        ck_assert_int_ge(n, 0);
+        for (int i = 0; i < n; i++) {
+            uint64_t v;
+            memcpy(&v, recs[i].payload, sizeof(v));
+            ck_assert_uint_eq(recs[i].wal_seq, next);
+            ck_assert_uint_eq(v, next);
+            next++;
+        }
+        if (n == 0) usleep(500);
+    }
+    return next;
+}
 
-    TCase *tc_wal = tcase_create("WAL-Bus");
-    tcase_add_test(tc_wal, test_bus_wal_attach);
-    tcase_add_test(tc_wal, test_bus_wal_match);
+START_TEST(test_tcp_resend) {
+    /* WAL holding seq 1..3000 */
+    const char *wal_path = test_wal_path("resend");
+    unlink(wal_path);
+    OmWalConfig wal_cfg = {
+        .filename = wal_path, .buffer_size = 64 * 1024,
+        .sync_interval_ms = 0, .use_direct_io = false,
+    };
+    OmWal wal;
+    ck_assert_int_eq(om_wal_init(&wal, &wal_cfg), 0);
+    for (uint64_t i = 1; i <= 3000; i++) {
+        ck_assert_uint_eq(om_wal_append_custom(&wal, OM_WAL_USER_BASE, &i, sizeof(i)), i);
+    }
+    ck_assert_int_eq(om_wal_flush(&wal), 0);
+    om_wal_close(&wal);
+
+    /* 16 KB history keeps the newest ~680 records; older ones come from the WAL */
+    OmBusWalHistory wh = { .wal_path = wal_path, .wal_config = &wal_cfg };
+    OmBusTcpServerConfig scfg = {
+        .bind_addr = "127.0.0.1", .history_bytes = 16 * 1024,
+    };
+    om_bus_wal_history_source(&scfg.history_src, &wh);
+    OmBusTcpServer *srv = NULL;
+    ck_assert_int_eq(om_bus_tcp_server_create(&srv, &scfg), 0);
+    OmBusTcpClient *client = tcp_test_client(om_bus_tcp_server_port(srv), 0);
+    ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+
+    for (uint64_t i = 1; i <= 3000; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_broadcast(srv, i, OM_WAL_USER_BASE, &i, sizeof(i)), 0);
+    }
+    ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+
+    /* Frames in flight are dropped; replay 5.. then live 3001..3100 */
+    ck_assert_int_eq(om_bus_tcp_client_resend(client, 5), 0);
+    for (int i = 0; i < 5; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+        usleep(1000);
+    }
+    for (uint64_t i = 3001; i <= 3100; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_broadcast(srv, i, OM_WAL_USER_BASE, &i, sizeof(i)), 0);
+    }
+    ck_assert_uint_eq(tcp_test_drain_seq(client, srv, 5, 3100), 3101);
+
+    OmBusTcpServerStats stats;
+    om_bus_tcp_server_stats(srv, &stats);
+    ck_assert_uint_eq(stats.resend_requests, 1);
+    ck_assert_uint_ge(stats.records_replayed, 2996);
+    om_bus_tcp_client_close(client);
+    om_bus_tcp_server_destroy(srv);
+
+    /* The WAL source seeks: past OM_BUS_WAL_HISTORY_SCAN records in, the
+     * first next() already lands on the requested seq */
+    unlink(wal_path);
+    ck_assert_int_eq(om_wal_init(&wal, &wal_cfg), 0);
+    for (uint64_t i = 1; i <= 3 * OM_BUS_WAL_HISTORY_SCAN; i++) {
+        ck_assert_uint_eq(om_wal_append_custom(&wal, OM_WAL_USER_BASE, &i, sizeof(i)), i);
+    }
+    ck_assert_int_eq(om_wal_flush(&wal), 0);
+    om_wal_close(&wal);
+    OmBusTcpHistorySource hs;
+    om_bus_wal_history_source(&hs, &wh);
+    void *cursor = hs.open(hs.ctx, 3 * OM_BUS_WAL_HISTORY_SCAN - 10);
+    ck_assert_ptr_nonnull(cursor);
+    OmBusRecord hrec;
+    ck_assert_int_eq(hs.next(cursor, &hrec), 1);
+    ck_assert_uint_eq(hrec.wal_seq, 3 * OM_BUS_WAL_HISTORY_SCAN - 10);
+    ck_assert_int_eq(hs.next(cursor, &hrec), 1);
+    ck_assert_uint_eq(hrec.wal_seq, 3 * OM_BUS_WAL_HISTORY_SCAN - 9);
+    hs.close(cursor);
+    unlink(wal_path);
+
+    /* Auto-client: dropped as a slow client, reconnects, resumes gap-free */
+    OmBusTcpServerConfig acfg_srv = {
+        .bind_addr = "127.0.0.1", .send_buf_size = 4096, .history_bytes = 16 * 1024,
+    };
+    ck_assert_int_eq(om_bus_tcp_server_create(&srv, &acfg_srv), 0);
+    OmBusTcpAutoClient *ac = NULL;
+    OmBusTcpAutoClientConfig acfg = {
+        .base = { .host = "127.0.0.1", .port = om_bus_tcp_server_port(srv) },
+        .retry_base_ms = 5, .retry_max_ms = 20,
+    };
+    ck_assert_int_eq(om_bus_tcp_auto_client_create(&ac, &acfg), 0);
+    ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+    for (uint64_t i = 1; i <= 400; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_broadcast(srv, i, 1, &i, sizeof(i)), 0);
+    }
+    om_bus_tcp_server_stats(srv, &stats);
+    ck_assert_uint_eq(stats.slow_client_drops, 1);
+
+    OmBusRecord rec;
+    uint64_t next = 1;
+    for (int attempt = 0; attempt < 5000 && next <= 400; attempt++) {
+        om_bus_tcp_server_poll_io(srv);
+        int rc = om_bus_tcp_auto_client_poll(ac, &rec);
+        if (rc == 1) {
+            ck_assert_uint_eq(rec.wal_seq, next);
+            next++;
+        } else if (rc == 0) {
+            usleep(200);
+        } else {
+            ck_assert_int_eq(rc, OM_ERR_BUS_TCP_SLOW_WARNING);
+        }
+    }
+    ck_assert_uint_eq(next, 401);
+    om_bus_tcp_server_stats(srv, &stats);
+    ck_assert_uint_eq(stats.clients_accepted, 2);
+    ck_assert_uint_eq(stats.resend_requests, 1);
+    om_bus_tcp_auto_client_close(ac);
+    om_bus_tcp_server_destroy(srv);
+
+    /* SHARED: catch-up from the history, then back onto the ring */
+    OmBusTcpServerConfig shcfg = {
+        .bind_addr = "127.0.0.1", .mode = OM_BUS_TCP_SERVER_SHARED,
+        .ring_size = 64 * 1024, .history_bytes = 16 * 1024,
+    };
+    ck_assert_int_eq(om_bus_tcp_server_create(&srv, &shcfg), 0);
+    client = tcp_test_client(om_bus_tcp_server_port(srv), 0);
+    for (int i = 0; i < 20 && om_bus_tcp_server_client_count(srv) < 1; i++) {
+        om_bus_tcp_server_poll_io(srv);
+        usleep(1000);
+    }
+    for (uint64_t i = 1; i <= 100; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_broadcast(srv, i, 1, &i, sizeof(i)), 0);
+    }
+    ck_assert_uint_eq(tcp_test_drain_seq(client, srv, 1, 100), 101);
+    ck_assert_int_eq(om_bus_tcp_client_resend(client, 50), 0);
+    for (int i = 0; i < 5; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+        usleep(1000);
+    }
+    for (uint64_t i = 101; i <= 110; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_broadcast(srv, i, 1, &i, sizeof(i)), 0);
+    }
+    ck_assert_uint_eq(tcp_test_drain_seq(client, srv, 50, 110), 111);
+    om_bus_tcp_client_close(client);
+    om_bus_tcp_server_destroy(srv);
+}
+END_TEST
+
+/* ---- Test: RESEND from a history source the filter mostly drops ---- */
+#define TCP_SRC_UNWANTED 5000U
+
+typedef struct {
+    uint64_t next_seq;
+    uint32_t calls;
+    uint64_t payload;
+} TcpTestSource;
+
+static void *tcp_test_src_open(void *ctx, uint64_t from_seq) {
+    TcpTestSource *src = ctx;
+    src->next_seq = from_seq;
+    return src;
+}
+
+/* Type 1 records 1..TCP_SRC_UNWANTED, then one type 2 record */
+static int tcp_test_src_next(void *cursor, OmBusRecord *rec) {
+    TcpTestSource *src = cursor;
+    src->calls++;
+    if (src->next_seq > TCP_SRC_UNWANTED + 1U) return 0;
+    src->payload = src->next_seq;
+    rec->wal_seq = src->next_seq;
+    rec->wal_type = src->next_seq > TCP_SRC_UNWANTED ? 2U : 1U;
+    rec->payload = &src->payload;
+    rec->payload_len = sizeof(src->payload);
+    src->next_seq++;
+    return 1;
+}
+
+static void tcp_test_src_close(void *cursor) {
+    (void)cursor;
+}
+
+START_TEST(test_tcp_resend_filter_budget) {
+    TcpTestSource src = {0};
+    OmBusTcpServerConfig scfg = {
+        .bind_addr = "127.0.0.1", .history_bytes = 16 * 1024,
+        .history_src = {
+            .open = tcp_test_src_open, .next = tcp_test_src_next,
+            .close = tcp_test_src_close, .ctx = &src,
+        },
+    };
+    OmBusTcpServer *srv = NULL;
+    ck_assert_int_eq(om_bus_tcp_server_create(&srv, &scfg), 0);
+    OmBusTcpClientConfig ccfg = {
+        .host = "127.0.0.1", .port = om_bus_tcp_server_port(srv),
+        .type_mask = OM_BUS_TCP_TYPE_BIT(2U),
+    };
+    OmBusTcpClient *client = NULL;
+    ck_assert_int_eq(om_bus_tcp_client_connect(&client, &ccfg), 0);
+    for (int i = 0; i < 20 && om_bus_tcp_server_client_count(srv) < 1; i++) {
+        om_bus_tcp_server_poll_io(srv);
+        usleep(1000);
+    }
+    ck_assert_int_eq(om_bus_tcp_client_resend(client, 1), 0);
+
+    /* Every poll_io examines a bounded share of the source, so the first one
+     * that reaches it returns long before the unwanted run is exhausted */
+    uint32_t polls = 0;
+    OmBusRecord rec;
+    int rc = 0;
+    for (int attempt = 0; attempt < 5000 && rc != 1; attempt++) {
+        uint32_t before = src.calls;
+        ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+        if (src.calls > before) {
+            ck_assert_uint_lt(src.calls - before, TCP_SRC_UNWANTED / 2U);
+            polls++;
+        }
+        rc = om_bus_tcp_client_poll(client, &rec);
+        ck_assert_int_ge(rc, 0);
+        if (rc == 0 && src.calls == before) usleep(200);
+    }
+    ck_assert_int_eq(rc, 1);
+    ck_assert_uint_eq(rec.wal_seq, TCP_SRC_UNWANTED + 1U);
+    ck_assert_uint_gt(polls, 2);
+
+    OmBusTcpServerStats stats;
+    om_bus_tcp_server_stats(srv, &stats);
+    ck_assert_uint_eq(stats.records_replayed, 1);
+    om_bus_tcp_client_close(client);
+    om_bus_tcp_server_destroy(srv);
+}
+END_TEST
+
+/* ---- Test: SUBSCRIBE filters — product set + type mask, SKIP keeps gaps visible ---- */
+/* seq % 50 == 0: user record (no product); else INSERT/CANCEL/MATCH by seq % 3,
+ * product seq % 10 */
+static uint8_t tcp_test_sub_record(uint64_t seq, uint8_t *p, uint16_t *len) {
+    memset(p, 0, 128);
+    if (seq % 50 == 0) {
+        memcpy(p, &seq, sizeof(seq));
+        *len = sizeof(seq);
+        return OM_WAL_USER_BASE;
+    }
+    uint16_t product = (uint16_t)(seq % 10);
+    switch (seq % 3) {
+    case 0: {
+        OmWalInsert ins = { .order_id = seq, .product_id = product };
+        memcpy(p, &ins, sizeof(ins));
+        *len = sizeof(ins);
+        return OM_WAL_INSERT;
+    }
+    case 1: {
+        OmWalCancel c = { .order_id = seq, .product_id = product };
+        memcpy(p, &c, sizeof(c));
+        *len = sizeof(c);
+        return OM_WAL_CANCEL;
+    }
+    default: {
+        OmWalMatch m = { .maker_id = seq, .product_id = product };
+        memcpy(p, &m, sizeof(m));
+        *len = sizeof(m);
+        return OM_WAL_MATCH;
+    }
+    }
+}
+
+/* who 0: CANCEL|MATCH of products {3, 7}; who 1: all types, even products */
+static bool tcp_test_sub_wants(int who, uint64_t seq) {
+    if (seq % 50 == 0) return who == 1;
+    if (who == 0) return seq % 3 != 0 && (seq % 10 == 3 || seq % 10 == 7);
+    return seq % 2 == 0;
+}
+
+/* Receive seqs 1..last minus [601, 605) as filtered for `who`; the first
+ * one after the hole must report the gap */
+static void tcp_test_sub_expect(OmBusTcpClient *client, OmBusTcpServer *srv, int who,
+                                uint64_t last, bool batch) {
+    uint64_t next = 1;
+    bool gap_seen = false;
+    for (int attempt = 0; attempt < 2000; attempt++) {
+        while (next <= last && (!tcp_test_sub_wants(who, next) || (next > 600 && next < 605))) {
+            next++;
+        }
+        if (next > last) break;
+        om_bus_tcp_server_poll_io(srv);
+        OmBusRecord recs[32];
+        int n = batch ? om_bus_tcp_client_poll_batch(client, recs, 32)
+                      : om_bus_tcp_client_poll(client, &recs[0]);
+        if (n == 0) {
+            usleep(500);
+            continue;
+        }
+        if (n == OM_ERR_BUS_GAP_DETECTED) {
+            ck_assert(!gap_seen && next > 604);
+            gap_seen = true;
+            n = 1;
+        } else {
+            ck_assert_int_gt(n, 0);
+        }
+        for (int i = 0; i < n; i++) {
+            while (!tcp_test_sub_wants(who, next) || (next > 600 && next < 605)) next++;
+            ck_assert_uint_eq(recs[i].wal_seq, next);
+            ck_assert_int_ne(recs[i].wal_type, OM_BUS_TCP_WAL_TYPE_SKIP);
+            if (recs[i].wal_seq % 50 != 0) {
+                ck_assert_int_eq(om_bus_wal_product_of(recs[i].wal_type, recs[i].payload,
+                                                       recs[i].payload_len),
+                                 (int)(next % 10));
+            }
+            next++;
+        }
+    }
+    ck_assert(gap_seen);
+    ck_assert_uint_gt(next, last);
+}
+
+START_TEST(test_tcp_subscribe_filter) {
+    OmBusTcpServerConfig scfg = {
+        .bind_addr = "127.0.0.1",
+        .caps = OM_BUS_TCP_CAP_BATCH | OM_BUS_TCP_CAP_LZ,
+        .history_bytes = 128 * 1024,
+        .product_of = om_bus_wal_product_of,
+    };
+    OmBusTcpServer *srv = NULL;
+    ck_assert_int_eq(om_bus_tcp_server_create(&srv, &scfg), 0);
+    uint16_t port = om_bus_tcp_server_port(srv);
+
+    /* sel: two products, two types, BATCH+LZ; many: 150 ids (two SUBSCRIBE
+     * frames), single frames; full: no filter */
+    static const uint16_t sel_products[] = { 7, 3 };
+    OmBusTcpClientConfig sel_cfg = {
+        .host = "127.0.0.1", .port = port,
+        .caps = OM_BUS_TCP_CAP_BATCH | OM_BUS_TCP_CAP_LZ,
+        .type_mask = OM_BUS_TCP_TYPE_BIT(OM_WAL_CANCEL) | OM_BUS_TCP_TYPE_BIT(OM_WAL_MATCH),
+        .products = sel_products, .product_count = 2,
+    };
+    static uint16_t many_products[150];
+    for (int i = 0; i < 150; i++) many_products[i] = (uint16_t)(i * 2);
+    OmBusTcpClientConfig many_cfg = {
+        .host = "127.0.0.1", .port = port,
+        .products = many_products, .product_count = 150,
+    };
+    OmBusTcpClient *sel = NULL, *many = NULL;
+    ck_assert_int_eq(om_bus_tcp_client_connect(&sel, &sel_cfg), 0);
+    ck_assert_int_eq(om_bus_tcp_client_connect(&many, &many_cfg), 0);
+    OmBusTcpClient *full = tcp_test_client(port, 0);
+    for (int i = 0; i < 20; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+        usleep(1000);
+    }
+    ck_assert_uint_eq(om_bus_tcp_server_client_count(srv), 3);
+
+    /* 1..500 in batches of 25, then 505..1000 one by one (601..604 missing) */
+    static uint8_t payloads[25][128];
+    OmBusRecord batch[25];
+    for (uint64_t seq = 1; seq <= 500; seq += 25) {
+        for (int k = 0; k < 25; k++) {
+            uint16_t len;
+            uint8_t type = tcp_test_sub_record(seq + (uint64_t)k, payloads[k], &len);
+            batch[k] = (OmBusRecord){ .wal_seq = seq + (uint64_t)k, .wal_type = type,
+                                      .payload_len = len, .payload = payloads[k] };
+        }
+        ck_assert_int_eq(om_bus_tcp_server_broadcast_batch(srv, batch, 25), 0);
+        om_bus_tcp_server_poll_io(srv);
+    }
+    for (uint64_t seq = 501; seq <= 1000; seq++) {
+        if (seq > 600 && seq < 605) continue;
+        uint8_t p[128];
+        uint16_t len;
+        uint8_t type = tcp_test_sub_record(seq, p, &len);
+        ck_assert_int_eq(om_bus_tcp_server_broadcast(srv, seq, type, p, len), 0);
+    }
+
+    tcp_test_sub_expect(sel, srv, 0, 1000, true);
+    tcp_test_sub_expect(many, srv, 1, 1000, false);
+
+    uint64_t full_next = 1;
+    OmBusRecord rec;
+    for (int attempt = 0; attempt < 4000 && full_next <= 1000; attempt++) {
+        om_bus_tcp_server_poll_io(srv);
+        int rc = om_bus_tcp_client_poll(full, &rec);
+        if (rc == 0) {
+            usleep(200);
+            continue;
+        }
+        if (full_next == 601) full_next = 605;
+        ck_assert_int_eq(rc, full_next == 605 ? OM_ERR_BUS_GAP_DETECTED : 1);
+        ck_assert_uint_eq(rec.wal_seq, full_next);
+        full_next++;
+    }
+    ck_assert_uint_eq(full_next, 1001);
+
+    OmBusTcpServerStats stats;
+    om_bus_tcp_server_stats(srv, &stats);
+    ck_assert_uint_gt(stats.records_filtered, 1000);
+
+    /* Nothing wanted in 1001..1010: an idle SKIP still moves both to 1010 */
+    for (uint64_t seq = 1001; seq <= 1010; seq++) {
+        OmWalCancel c = { .order_id = seq, .product_id = 5 };
+        ck_assert_int_eq(om_bus_tcp_server_broadcast(srv, seq, OM_WAL_CANCEL, &c, sizeof(c)), 0);
+    }
+    for (int attempt = 0; attempt < 400; attempt++) {
+        om_bus_tcp_server_poll_io(srv);
+        ck_assert_int_eq(om_bus_tcp_client_poll(sel, &rec), 0);
+        ck_assert_int_eq(om_bus_tcp_client_poll(many, &rec), 0);
+        if (om_bus_tcp_client_wal_seq(sel) == 1010 &&
+            om_bus_tcp_client_wal_seq(many) == 1010) {
+            break;
+        }
+        usleep(1000);
+    }
+    ck_assert_uint_eq(om_bus_tcp_client_wal_seq(sel), 1010);
+    ck_assert_uint_eq(om_bus_tcp_client_wal_seq(many), 1010);
+
+    /* RESEND replays the history through the same filter */
+    ck_assert_int_eq(om_bus_tcp_client_resend(sel, 1), 0);
+    tcp_test_sub_expect(sel, srv, 0, 1000, true);
+
+    om_bus_tcp_client_close(sel);
+    om_bus_tcp_client_close(many);
+    om_bus_tcp_client_close(full);
+    om_bus_tcp_server_destroy(srv);
+}
+END_TEST
+
+/* ---- Test: URING server mode and io_uring clients ---- */
+START_TEST(test_tcp_uring) {
+    OmBusTcpServerConfig scfg = {
+        .bind_addr = "127.0.0.1", .max_clients = 4,
+        .mode = OM_BUS_TCP_SERVER_URING, .caps = OM_BUS_TCP_CAP_BATCH,
+        .history_bytes = 128 * 1024,
+    };
+    OmBusTcpServer *srv = NULL;
+    ck_assert_int_eq(om_bus_tcp_server_create(&srv, &scfg), 0);
+    uint16_t port = om_bus_tcp_server_port(srv);
+
+    /* Plain, io_uring, and io_uring with BATCH frames */
+    OmBusTcpClientConfig ccfg[3] = {
+        { .host = "127.0.0.1", .port = port },
+        { .host = "127.0.0.1", .port = port, .io_uring = true },
+        { .host = "127.0.0.1", .port = port, .io_uring = true,
+          .caps = OM_BUS_TCP_CAP_BATCH },
+    };
+    OmBusTcpClient *clients[3];
+    for (int c = 0; c < 3; c++) {
+        ck_assert_int_eq(om_bus_tcp_client_connect(&clients[c], &ccfg[c]), 0);
+    }
+    for (int i = 0; i < 200 && om_bus_tcp_server_client_count(srv) < 3; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+        usleep(1000);
+    }
+    ck_assert_uint_eq(om_bus_tcp_server_client_count(srv), 3);
+    /* Let the HELLO arrive before the first batch */
+    for (int i = 0; i < 20; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+        usleep(1000);
+    }
+
+    OmBusRecord batch[8];
+    uint64_t vals[8];
+    for (uint64_t seq = 1; seq <= 3000; seq += 8) {
+        for (int k = 0; k < 8; k++) {
+            vals[k] = seq + (uint64_t)k;
+            batch[k].wal_seq = vals[k];
+            batch[k].wal_type = 2;
+            batch[k].payload_len = sizeof(vals[k]);
+            batch[k].payload = &vals[k];
+        }
+        ck_assert_int_eq(om_bus_tcp_server_broadcast_batch(srv, batch, 8), 0);
+        if (seq % 200 == 1) ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+    }
+    for (int c = 0; c < 3; c++) {
+        ck_assert_uint_eq(tcp_test_drain_seq(clients[c], srv, 1, 3000), 3001);
+    }
+
+    OmBusTcpServerStats stats;
+    om_bus_tcp_server_stats(srv, &stats);
+    ck_assert_uint_gt(stats.batch_frames, 0);
+    ck_assert_uint_eq(stats.slow_client_drops, 0);
+
+    /* RESEND over the ring: the ack, then the replay from history */
+    ck_assert_int_eq(om_bus_tcp_client_resend(clients[1], 2500), 0);
+    ck_assert_uint_eq(tcp_test_drain_seq(clients[1], srv, 2500, 3000), 3001);
+
+    /* Disconnects are seen through the multishot poll, and the slot is reused */
+    om_bus_tcp_client_close(clients[2]);
+    for (int i = 0; i < 200 && om_bus_tcp_server_client_count(srv) > 2; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+        usleep(1000);
+    }
+    ck_assert_uint_eq(om_bus_tcp_server_client_count(srv), 2);
+    ck_assert_int_eq(om_bus_tcp_client_connect(&clients[2], &ccfg[1]), 0);
+    for (int i = 0; i < 200 && om_bus_tcp_server_client_count(srv) < 3; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+        usleep(1000);
+    }
+    ck_assert_uint_eq(om_bus_tcp_server_client_count(srv), 3);
+    uint64_t v = 3001;
+    ck_assert_int_eq(om_bus_tcp_server_broadcast(srv, v, 2, &v, sizeof(v)), 0);
+    ck_assert_uint_eq(tcp_test_drain_seq(clients[2], srv, 3001, 3001), 3002);
+
+    /* Server going away ends the io_uring client's read */
+    om_bus_tcp_server_destroy(srv);
+    OmBusRecord rec;
+    int rc = 0;
+    for (int i = 0; i < 200 && (rc = om_bus_tcp_client_poll(clients[1], &rec)) >= 0; i++) {
+        usleep(1000);
+    }
+    ck_assert_int_eq(rc, OM_ERR_BUS_TCP_DISCONNECTED);
+
+    for (int c = 0; c < 3; c++) om_bus_tcp_client_close(clients[c]);
+
+    /* A client that never reads: its SEND blocks in the ring until the
+     * backlog overflows send_buf and the client is dropped under that SEND.
+     * The slot stays parked until the SEND fails, then takes the next client. */
+    scfg.max_clients = 1;
+    scfg.send_buf_size = 16 * 1024;
+    ck_assert_int_eq(om_bus_tcp_server_create(&srv, &scfg), 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(om_bus_tcp_server_port(srv));
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    int raw = socket(AF_INET, SOCK_STREAM, 0);
+    int small = 4096;
+    setsockopt(raw, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+    ck_assert_int_eq(connect(raw, (struct sockaddr *)&addr, sizeof(addr)), 0);
+    for (int i = 0; i < 200 && om_bus_tcp_server_client_count(srv) < 1; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+        usleep(1000);
+    }
+    ck_assert_uint_eq(om_bus_tcp_server_client_count(srv), 1);
+    uint64_t seq = 1;
+    om_bus_tcp_server_stats(srv, &stats);
+    for (int i = 0; i < 20000 && stats.slow_client_drops == 0; i++) {
+        for (int k = 0; k < 64; k++, seq++) {
+            ck_assert_int_eq(om_bus_tcp_server_broadcast(srv, seq, 2, &seq, sizeof(seq)), 0);
+        }
+        ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+        om_bus_tcp_server_stats(srv, &stats);
+    }
+    ck_assert_uint_eq(stats.slow_client_drops, 1);
+    ck_assert_uint_eq(om_bus_tcp_server_client_count(srv), 0);
+
+    OmBusTcpClientConfig next_cfg = { .host = "127.0.0.1", .port = ntohs(addr.sin_port),
+                                      .io_uring = true };
+    ck_assert_int_eq(om_bus_tcp_client_connect(&clients[0], &next_cfg), 0);
+    for (int i = 0; i < 200 && om_bus_tcp_server_client_count(srv) < 1; i++) {
+        ck_assert_int_eq(om_bus_tcp_server_poll_io(srv), 0);
+        usleep(1000);
+    }
+    ck_assert_uint_eq(om_bus_tcp_server_client_count(srv), 1);
+    ck_assert_int_eq(om_bus_tcp_server_broadcast(srv, seq, 2, &seq, sizeof(seq)), 0);
+    ck_assert_uint_eq(tcp_test_drain_seq(clients[0], srv, seq, seq), seq + 1);
+
+    om_bus_tcp_client_close(clients[0]);
+    close(raw);
+    om_bus_tcp_server_destroy(srv);
+}
+END_TEST
+
+START_TEST(test_bus_mixed_poll_batch_sequence_tracking) {
+    const char *name = test_shm_name("mixseq");
+    OmBusStream *stream = NULL;
+    OmBusStreamConfig scfg = {
+        .stream_name = name, .capacity = 64, .slot_size = 256,
+        .max_consumers = 1, .flags = 0,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+
+    OmBusEndpoint *ep = NULL;
+    OmBusEndpointConfig ecfg = {
+        .stream_name = name, .consumer_index = 0, .zero_copy = false,
+    };
+    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), 0);
+
+    uint32_t payload = 99;
+    for (uint64_t seq = 1; seq <= 6; seq++) {
+        ck_assert_int_eq(om_bus_stream_publish(stream, seq, 1, &payload, sizeof(payload)), 0);
+    }
+
+    OmBusRecord rec;
+    ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 1);
+    ck_assert_uint_eq(rec.wal_seq, 1);
+
+    OmBusRecord recs[3];
+    int count = om_bus_endpoint_poll_batch(ep, recs, 3);
+    ck_assert_int_eq(count, 3);
+    ck_assert_uint_eq(recs[0].wal_seq, 2);
+    ck_assert_uint_eq(recs[1].wal_seq, 3);
+    ck_assert_uint_eq(recs[2].wal_seq, 4);
+
+    ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 1);
+    ck_assert_uint_eq(rec.wal_seq, 5);
+
+    om_bus_endpoint_close(ep);
+    om_bus_stream_destroy(stream);
+}
+END_TEST
+
+START_TEST(test_bus_batch_then_poll_reorder_detection) {
+    const char *name = test_shm_name("batchreorder");
+    OmBusStream *stream = NULL;
+    OmBusStreamConfig scfg = {
+        .stream_name = name, .capacity = 64, .slot_size = 256,
+        .max_consumers = 1, .flags = OM_BUS_FLAG_REJECT_REORDER,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+
+    OmBusEndpoint *ep = NULL;
+    OmBusEndpointConfig ecfg = {
+        .stream_name = name, .consumer_index = 0, .zero_copy = false,
+    };
+    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), 0);
+
+    uint32_t payload = 7;
+    ck_assert_int_eq(om_bus_stream_publish(stream, 1, 1, &payload, sizeof(payload)), 0);
+    ck_assert_int_eq(om_bus_stream_publish(stream, 2, 1, &payload, sizeof(payload)), 0);
+    ck_assert_int_eq(om_bus_stream_publish(stream, 1, 1, &payload, sizeof(payload)), 0);
+
+    OmBusRecord recs[2];
+    int count = om_bus_endpoint_poll_batch(ep, recs, 2);
+    ck_assert_int_eq(count, 2);
+    ck_assert_uint_eq(recs[0].wal_seq, 1);
+    ck_assert_uint_eq(recs[1].wal_seq, 2);
+
+    OmBusRecord rec;
+    ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), OM_ERR_BUS_REORDER_DETECTED);
+    ck_assert_uint_eq(rec.wal_seq, 1);
+
+    om_bus_endpoint_close(ep);
+    om_bus_stream_destroy(stream);
+}
+END_TEST
+
+/* ---- Test: SHM ring wrap-around with high head values ---- */
+START_TEST(test_bus_ring_wrap) {
+    const char *name = test_shm_name("wrap");
+    OmBusStream *stream = NULL;
+    OmBusStreamConfig scfg = {
+        .stream_name = name, .capacity = 16, .slot_size = 64,
+        .max_consumers = 1, .flags = 0,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+
+    OmBusEndpoint *ep = NULL;
+    OmBusEndpointConfig ecfg = {
+        .stream_name = name, .consumer_index = 0, .zero_copy = true,
+    };
+    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), 0);
+
+    /* Publish and consume 256 records through a 16-slot ring (16 full wraps) */
+    OmBusRecord rec;
+    for (int i = 0; i < 256; i++) {
+        uint32_t val = (uint32_t)(i * 7);
+        ck_assert_int_eq(om_bus_stream_publish(stream, (uint64_t)(i + 1), 1,
+                                                &val, sizeof(val)), 0);
+        ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 1);
+        ck_assert_uint_eq(rec.wal_seq, (uint64_t)(i + 1));
+        uint32_t out;
+        memcpy(&out, rec.payload, sizeof(out));
+        ck_assert_uint_eq(out, (uint32_t)(i * 7));
+    }
+
+    /* Verify correct wal_seq after many wraps */
+    ck_assert_uint_eq(om_bus_endpoint_wal_seq(ep), 256);
+
+    om_bus_endpoint_close(ep);
+    om_bus_stream_destroy(stream);
+}
+END_TEST
+
+/* ---- Test: VARLEN records span slots, PAD at ring end, copy-mode poll ---- */
+START_TEST(test_bus_varlen_roundtrip) {
+    const char *name = test_shm_name("varlen");
+    OmBusStream *stream = NULL;
+    OmBusStreamConfig scfg = {
+        .stream_name = name, .capacity = 16, .slot_size = 64,
+        .max_consumers = 1, .flags = OM_BUS_FLAG_CRC | OM_BUS_FLAG_VARLEN,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+
+    OmBusEndpoint *ep = NULL;
+    OmBusEndpointConfig ecfg = {
+        .stream_name = name, .consumer_index = 0, .zero_copy = false,
+    };
+    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), 0);
+
+    /* Max payload = capacity/2 slots - header = 8 * 64 - 24 = 488 */
+    uint8_t big[489];
+    memset(big, 0x5A, sizeof(big));
+    ck_assert_int_eq(om_bus_stream_publish(stream, 1, 1, big, 489),
+                     OM_ERR_BUS_RECORD_TOO_LARGE);
+
+    /* Spans 1, 2, 3, 6 slots; 64 records wrap the 16-slot ring many times */
+    static const uint16_t lens[] = {24, 56, 152, 300};
+    OmBusRecord rec;
+    for (int i = 0; i < 64; i++) {
+        uint16_t len = lens[i % 4];
+        memset(big, (uint8_t)i, len);
+        ck_assert_int_eq(om_bus_stream_publish(stream, (uint64_t)(i + 1), 2,
+                                                big, len), 0);
+        ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 1);
+        ck_assert_uint_eq(rec.wal_seq, (uint64_t)(i + 1));
+        ck_assert_uint_eq(rec.payload_len, len);
+        ck_assert_int_eq(memcmp(rec.payload, big, len), 0);
+    }
+    ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 0);
+
+    OmBusStreamStats st;
+    om_bus_stream_stats(stream, &st);
+    ck_assert_uint_eq(st.records_published, 64);
+    ck_assert_uint_gt(st.slots_padded, 0);
+    /* 16 records each of 1+2+3+6 slots plus padding */
+    ck_assert_uint_eq(st.head, 16U * 12U + st.slots_padded);
+    ck_assert_uint_eq(st.min_tail, st.head);
+
+    om_bus_endpoint_close(ep);
+    om_bus_stream_destroy(stream);
+
+    /* VARLEN requires 8-byte aligned slot size */
+    scfg.slot_size = 60;
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), OM_ERR_BUS_INIT);
+}
+END_TEST
+
+/* Fill a VARLEN payload that will sit at ring position pos: every word that
+ * lands on a slot boundary holds the seq that slot would carry as a record
+ * start one lap later (capacity 16, slot 64, 24-byte header) */
+static void varlen_poison(uint8_t *dst, uint16_t len, uint64_t pos, uint64_t tag) {
+    for (uint16_t o = 0; o + 8U <= len; o += 8U) {
+        uint64_t w = ((o + 24U) % 64U == 0) ? pos + (o + 24U) / 64U + 16U + 1U : tag ^ o;
+        memcpy(dst + o, &w, sizeof(w));
+    }
+    for (uint16_t o = (uint16_t)(len & ~7U); o < len; o++) dst[o] = (uint8_t)tag;
+}
+
+/* ---- Test: VARLEN continuation slots never pass as records on a later lap ---- */
+START_TEST(test_bus_varlen_stale_continuation) {
+    const char *name = test_shm_name("varlens");
+    OmBusStream *stream = NULL;
+    OmBusStreamConfig scfg = {
+        .stream_name = name, .capacity = 16, .slot_size = 64,
+        .max_consumers = 1, .flags = OM_BUS_FLAG_VARLEN,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+
+    OmBusEndpoint *ep = NULL;
+    OmBusEndpointConfig ecfg = {
+        .stream_name = name, .consumer_index = 0, .zero_copy = false,
+    };
+    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), 0);
+
+    /* Mixed 1..7-slot records over ~40 laps; publish and reserve/commit
+     * alternate. The consumer catches up after every record, so it always
+     * reads the slot the next record will start in. */
+    uint8_t buf[420];
+    OmBusRecord rec;
+    uint32_t rng = 7;
+    for (uint64_t seq = 1; seq <= 200; seq++) {
+        rng = rng * 1103515245U + 12345U;
+        uint16_t len = (uint16_t)(8U + (rng >> 16) % 400U);
+        OmBusStreamStats st;
+        om_bus_stream_stats(stream, &st);
+        uint32_t idx = (uint32_t)(st.head & 15U);
+        uint32_t span = (24U + len + 63U) / 64U;
+        uint64_t pos = st.head + (idx + span > 16U ? 16U - idx : 0U);
+        varlen_poison(buf, len, pos, seq);
+
+        if (seq & 1U) {
+            ck_assert_int_eq(om_bus_stream_publish(stream, seq, 2, buf, len), 0);
+        } else {
+            void *dst = NULL;
+            ck_assert_int_eq(om_bus_stream_reserve(stream, len, &dst), 0);
+            /* Not committed yet: nothing to read, poison included */
+            ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 0);
+            memcpy(dst, buf, len);
+            ck_assert_int_eq(om_bus_stream_commit(stream, seq, 2), 0);
+        }
+        ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 1);
+        ck_assert_uint_eq(rec.wal_seq, seq);
+        ck_assert_uint_eq(rec.payload_len, len);
+        ck_assert_int_eq(memcmp(rec.payload, buf, len), 0);
+        ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 0);
+    }
+
+    om_bus_endpoint_close(ep);
+    om_bus_stream_destroy(stream);
+}
+END_TEST
+
+/* ---- Test: VARLEN batch publish + zero-copy batch poll across wraps ---- */
+START_TEST(test_bus_varlen_batch) {
+    const char *name = test_shm_name("varlenb");
+    OmBusStream *stream = NULL;
+    OmBusStreamConfig scfg = {
+        .stream_name = name, .capacity = 32, .slot_size = 64,
+        .max_consumers = 1, .flags = OM_BUS_FLAG_VARLEN,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+
+    OmBusEndpoint *ep = NULL;
+    OmBusEndpointConfig ecfg = {
+        .stream_name = name, .consumer_index = 0, .zero_copy = true,
+    };
+    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), 0);
+
+    uint8_t bufs[6][200];
+    OmBusRecord pub[6];
+    OmBusRecord out[16];
+    uint64_t seq = 1;
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 6; i++) {
+            uint16_t len = (uint16_t)(8 + ((round * 6 + i) * 37) % 190);
+            memset(bufs[i], (uint8_t)(seq & 0xFF), len);
+            pub[i].wal_seq = seq++;
+            pub[i].wal_type = 3;
+            pub[i].payload_len = len;
+            pub[i].payload = bufs[i];
+        }
+        ck_assert_int_eq(om_bus_stream_publish_batch(stream, pub, 6), 0);
+
+        ck_assert_int_eq(om_bus_endpoint_poll_batch(ep, out, 16), 6);
+        for (int i = 0; i < 6; i++) {
+            ck_assert_uint_eq(out[i].wal_seq, pub[i].wal_seq);
+            ck_assert_uint_eq(out[i].payload_len, pub[i].payload_len);
+            ck_assert_int_eq(memcmp(out[i].payload, bufs[i], pub[i].payload_len), 0);
+        }
+    }
+    ck_assert_int_eq(om_bus_endpoint_poll_batch(ep, out, 16), 0);
+    ck_assert_uint_eq(om_bus_endpoint_wal_seq(ep), 120);
+
+    om_bus_endpoint_close(ep);
+    om_bus_stream_destroy(stream);
+}
+END_TEST
+
+/* ---- Test: reserve/commit in-place publish (single + batch, VARLEN + CRC) ---- */
+START_TEST(test_bus_reserve_commit) {
+    const char *name = test_shm_name("resv");
+    OmBusStream *stream = NULL;
+    OmBusStreamConfig scfg = {
+        .stream_name = name, .capacity = 16, .slot_size = 64,
+        .max_consumers = 1, .flags = OM_BUS_FLAG_CRC | OM_BUS_FLAG_VARLEN,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+
+    OmBusEndpoint *ep = NULL;
+    OmBusEndpointConfig ecfg = {
+        .stream_name = name, .consumer_index = 0, .zero_copy = false,
+    };
+    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), 0);
+
+    OmBusRecord rec;
+    uint64_t val = 7;
+    void *ptr = NULL;
+
+    /* Out-of-order calls */
+    ck_assert_int_eq(om_bus_stream_commit(stream, 1, 1), OM_ERR_BUS_RESERVE_STATE);
+    ck_assert_int_eq(om_bus_stream_reserve(stream, 489, &ptr), OM_ERR_BUS_RECORD_TOO_LARGE);
+
+    /* Single: invisible until commit */
+    ck_assert_int_eq(om_bus_stream_reserve(stream, 400, &ptr), 0);
+    memset(ptr, 0xAB, 400);
+    ck_assert_int_eq(om_bus_stream_reserve(stream, 8, &ptr), OM_ERR_BUS_RESERVE_STATE);
+    ck_assert_int_eq(om_bus_stream_publish(stream, 1, 1, &val, sizeof(val)),
+                     OM_ERR_BUS_RESERVE_STATE);
+    ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 0);
+    ck_assert_int_eq(om_bus_stream_commit(stream, 1, 5), 0);
+    ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 1);
+    ck_assert_uint_eq(rec.wal_seq, 1);
+    ck_assert_uint_eq(rec.wal_type, 5);
+    ck_assert_uint_eq(rec.payload_len, 400);
+    ck_assert_uint_eq(((const uint8_t *)rec.payload)[399], 0xAB);
+
+    /* Batch across the ring end: head is at slot 7, the 300B record pads 4 slots */
+    uint16_t lens[4] = {200, 8, 300, 40};
+    void *ptrs[4];
+    uint64_t seqs[4] = {2, 3, 4, 5};
+    uint8_t types[4] = {1, 2, 3, 4};
+    ck_assert_int_eq(om_bus_stream_reserve_batch(stream, lens, 4, ptrs), 0);
+    for (int i = 0; i < 4; i++) memset(ptrs[i], i + 1, lens[i]);
+    ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 0);
+    ck_assert_int_eq(om_bus_stream_commit_batch(stream, seqs, types, 3),
+                     OM_ERR_BUS_RESERVE_STATE);
+    ck_assert_int_eq(om_bus_stream_commit_batch(stream, seqs, types, 4), 0);
+
+    for (int i = 0; i < 4; i++) {
+        ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 1);
+        ck_assert_uint_eq(rec.wal_seq, seqs[i]);
+        ck_assert_uint_eq(rec.wal_type, types[i]);
+        ck_assert_uint_eq(rec.payload_len, lens[i]);
+        ck_assert_uint_eq(((const uint8_t *)rec.payload)[lens[i] - 1], i + 1);
+    }
+    ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 0);
+
+    OmBusStreamStats st;
+    om_bus_stream_stats(stream, &st);
+    ck_assert_uint_eq(st.records_published, 5);
+    ck_assert_uint_eq(st.slots_padded, 4);
+    ck_assert_uint_eq(st.head, 23);
+
+    /* A run larger than the ring can never be reserved */
+    uint16_t big[3] = {400, 400, 400};
+    ck_assert_int_eq(om_bus_stream_reserve_batch(stream, big, 3, ptrs),
+                     OM_ERR_BUS_RECORD_TOO_LARGE);
+    ck_assert_int_eq(om_bus_stream_publish(stream, 6, 1, &val, sizeof(val)), 0);
+
+    om_bus_endpoint_close(ep);
+    om_bus_stream_destroy(stream);
+}
+END_TEST
+
+/* ---- Test: CLAIM consumer group — every record delivered exactly once ---- */
+#define BUS_GROUP_RECORDS 5000U
+
+typedef struct {
+    OmBusEndpoint *ep;
+    _Atomic uint32_t *hits;
+    _Atomic uint32_t *total;
+    uint32_t got;
+} BusGroupMember;
+
+static void *bus_group_member(void *arg) {
+    BusGroupMember *m = (BusGroupMember *)arg;
+    OmBusRecord recs[8];
+    while (atomic_load(m->total) < BUS_GROUP_RECORDS) {
+        int n = om_bus_endpoint_poll_batch(m->ep, recs, 8);
+        if (n <= 0) {
+            om_bus_endpoint_wait(m->ep, 1000000ULL);
+            continue;
+        }
+        for (int i = 0; i < n; i++) {
+            uint64_t v;
+            memcpy(&v, recs[i].payload, sizeof(v));
+            if (v == recs[i].wal_seq && v <= BUS_GROUP_RECORDS) {
+                atomic_fetch_add(&m->hits[v], 1U);
+            }
+        }
+        m->got += (uint32_t)n;
+        atomic_fetch_add(m->total, (uint32_t)n);
+    }
+    om_bus_endpoint_close(m->ep);
+    return NULL;
+}
+
+START_TEST(test_bus_group_claim) {
+    const char *name = test_shm_name("gclaim");
+    OmBusStream *stream = NULL;
+    OmBusStreamConfig scfg = {
+        .stream_name = name, .capacity = 64, .slot_size = 64,
+        .max_consumers = 2, .flags = OM_BUS_FLAG_VARLEN,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+
+    /* Index 0: the group; index 1: an ordinary consumer that sees everything */
+    BusGroupMember members[3];
+    static _Atomic uint32_t hits[BUS_GROUP_RECORDS + 1];
+    _Atomic uint32_t total = 0;
+    for (uint32_t i = 0; i <= BUS_GROUP_RECORDS; i++) atomic_init(&hits[i], 0U);
+    for (int i = 0; i < 3; i++) {
+        OmBusEndpointConfig ecfg = {
+            .stream_name = name, .consumer_index = 0, .zero_copy = true,
+            .group_mode = OM_BUS_GROUP_CLAIM,
+        };
+        members[i] = (BusGroupMember){ .hits = hits, .total = &total };
+        ck_assert_int_eq(om_bus_endpoint_open(&members[i].ep, &ecfg), 0);
+    }
+    OmBusEndpoint *solo = NULL;
+    OmBusEndpointConfig solo_cfg = {
+        .stream_name = name, .consumer_index = 1, .zero_copy = true,
+    };
+    ck_assert_int_eq(om_bus_endpoint_open(&solo, &solo_cfg), 0);
+
+    pthread_t th[3];
+    for (int i = 0; i < 3; i++) {
+        ck_assert_int_eq(pthread_create(&th[i], NULL, bus_group_member, &members[i]), 0);
+    }
+
+    OmBusRecord rec;
+    uint32_t solo_got = 0;
+    uint8_t buf[160] = {0};
+    for (uint64_t seq = 1; seq <= BUS_GROUP_RECORDS; seq++) {
+        memcpy(buf, &seq, sizeof(seq));
+        uint16_t len = (uint16_t)(8 + (seq * 13) % 150);
+        /* Drain the ordinary consumer so only the group applies backpressure */
+        while (om_bus_endpoint_poll(solo, &rec) == 1) solo_got++;
+        ck_assert_int_eq(om_bus_stream_publish(stream, seq, 1, buf, len), 0);
+    }
+    for (int i = 0; i < 3; i++) pthread_join(th[i], NULL);
+    while (om_bus_endpoint_poll(solo, &rec) == 1) solo_got++;
+
+    ck_assert_uint_eq(atomic_load(&total), BUS_GROUP_RECORDS);
+    ck_assert_uint_eq(solo_got, BUS_GROUP_RECORDS);
+    for (uint32_t i = 1; i <= BUS_GROUP_RECORDS; i++) {
+        ck_assert_uint_eq(atomic_load(&hits[i]), 1);
+    }
+    ck_assert_uint_eq(members[0].got + members[1].got + members[2].got,
+                      BUS_GROUP_RECORDS);
+
+    /* Group released everything: its shared tail reached head */
+    OmBusStreamStats st;
+    om_bus_stream_stats(stream, &st);
+    {
+        int fd = shm_open(name, O_RDWR, 0);
+        ck_assert_int_ge(fd, 0);
+        size_t map_len = OM_BUS_HEADER_PAGE + OM_BUS_CONSUMER_ALIGN;
+        char *m = mmap(NULL, map_len, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        ck_assert_ptr_ne(m, MAP_FAILED);
+        OmBusConsumerTail *group = (OmBusConsumerTail *)(m + OM_BUS_HEADER_PAGE);
+        ck_assert_uint_eq(atomic_load(&group->tail), st.head);
+        ck_assert_uint_eq(atomic_load(&group->claim), st.head);
+        ck_assert_uint_eq(atomic_load(&group->members), 0);
+        munmap(m, map_len);
+    }
+
+    om_bus_endpoint_close(solo);
+    om_bus_stream_destroy(stream);
+}
+END_TEST
+
+/* ---- Test: CLAIM release never waits for an older held batch ---- */
+START_TEST(test_bus_group_claim_release) {
+    const char *name = test_shm_name("gclaimrel");
+    OmBusStream *stream = NULL;
+    OmBusStreamConfig scfg = {
+        .stream_name = name, .capacity = 64, .slot_size = 64, .max_consumers = 1,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+
+    OmBusEndpointConfig ecfg = {
+        .stream_name = name, .consumer_index = 0, .zero_copy = true,
+        .group_mode = OM_BUS_GROUP_CLAIM,
+    };
+    OmBusEndpoint *a = NULL;
+    OmBusEndpoint *b = NULL;
+    ck_assert_int_eq(om_bus_endpoint_open(&a, &ecfg), 0);
+    ck_assert_int_eq(om_bus_endpoint_open(&b, &ecfg), 0);
+
+    int fd = shm_open(name, O_RDWR, 0);
+    ck_assert_int_ge(fd, 0);
+    size_t map_len = OM_BUS_HEADER_PAGE + OM_BUS_CONSUMER_ALIGN;
+    char *m = mmap(NULL, map_len, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    ck_assert_ptr_ne(m, MAP_FAILED);
+    OmBusConsumerTail *group = (OmBusConsumerTail *)(m + OM_BUS_HEADER_PAGE);
+
+    uint8_t buf[16] = {0};
+    for (uint64_t seq = 1; seq <= 8; seq++) {
+        ck_assert_int_eq(om_bus_stream_publish(stream, seq, 1, buf, sizeof(buf)), 0);
+    }
+
+    /* A holds 1-2; B claims 3-4, then releases them and claims 5-6 */
+    OmBusRecord recs[2];
+    ck_assert_int_eq(om_bus_endpoint_poll_batch(a, recs, 2), 2);
+    ck_assert_uint_eq(recs[0].wal_seq, 1);
+    ck_assert_int_eq(om_bus_endpoint_poll_batch(b, recs, 2), 2);
+    ck_assert_uint_eq(recs[0].wal_seq, 3);
+    ck_assert_int_eq(om_bus_endpoint_poll_batch(b, recs, 2), 2);
+    ck_assert_uint_eq(recs[0].wal_seq, 5);
+    ck_assert_uint_eq(recs[1].wal_seq, 6);
+    /* A's batch still pins the shared tail */
+    ck_assert_uint_eq(atomic_load(&group->tail), 0);
+
+    /* Releasing the oldest batch moves the tail past B's released one, up to
+     * the batch B still holds */
+    om_bus_endpoint_flush(a);
+    ck_assert_uint_eq(atomic_load(&group->tail), 4);
+    om_bus_endpoint_flush(b);
+    ck_assert_uint_eq(atomic_load(&group->tail), 6);
+    ck_assert_int_eq(om_bus_endpoint_poll_batch(a, recs, 2), 2);
+    ck_assert_uint_eq(recs[0].wal_seq, 7);
+    om_bus_endpoint_flush(a);
+    ck_assert_uint_eq(atomic_load(&group->tail), 8);
+
+    /* Member entries are bounded and freed on close */
+    OmBusEndpoint *more[OM_BUS_CLAIM_MAX_MEMBERS];
+    for (uint32_t i = 0; i < OM_BUS_CLAIM_MAX_MEMBERS - 2U; i++) {
+        ck_assert_int_eq(om_bus_endpoint_open(&more[i], &ecfg), 0);
+    }
+    OmBusEndpoint *extra = NULL;
+    ck_assert_int_eq(om_bus_endpoint_open(&extra, &ecfg), OM_ERR_BUS_INIT);
+    om_bus_endpoint_close(b);
+    ck_assert_int_eq(om_bus_endpoint_open(&extra, &ecfg), 0);
+    om_bus_endpoint_close(extra);
+    for (uint32_t i = 0; i < OM_BUS_CLAIM_MAX_MEMBERS - 2U; i++) {
+        om_bus_endpoint_close(more[i]);
+    }
+    om_bus_endpoint_close(a);
+    ck_assert_uint_eq(atomic_load(&group->members), 0);
+
+    munmap(m, map_len);
+    om_bus_stream_destroy(stream);
+}
+END_TEST
+
+/* ---- Test: PARTITION consumer group — members split the stream ---- */
+static uint32_t bus_test_partition_by_type(const OmBusRecord *rec, void *ctx) {
+    (void)ctx;
+    return rec->wal_type;
+}
+
+START_TEST(test_bus_group_partition) {
+    const char *name = test_shm_name("gpart");
+    OmBusStream *stream = NULL;
+    OmBusStreamConfig scfg = {
+        .stream_name = name, .capacity = 32, .slot_size = 64,
+        .max_consumers = 3, .flags = 0,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+
+    OmBusEndpoint *ep[3] = {NULL, NULL, NULL};
+    for (uint32_t i = 0; i < 2; i++) {
+        OmBusEndpointConfig ecfg = {
+            .stream_name = name, .consumer_index = i, .zero_copy = false,
+            .group_mode = OM_BUS_GROUP_PARTITION, .group_members = 2,
+            .member_id = i,
+        };
+        ck_assert_int_eq(om_bus_endpoint_open(&ep[i], &ecfg), 0);
+    }
+    OmBusEndpointConfig typed = {
+        .stream_name = name, .consumer_index = 2, .zero_copy = true,
+        .group_mode = OM_BUS_GROUP_PARTITION, .group_members = 3,
+        .member_id = 1, .partition_fn = bus_test_partition_by_type,
+    };
+    ck_assert_int_eq(om_bus_endpoint_open(&ep[2], &typed), 0);
+
+    /* member_id out of range is rejected */
+    OmBusEndpoint *bad = NULL;
+    OmBusEndpointConfig bad_cfg = typed;
+    bad_cfg.member_id = 3;
+    ck_assert_int_eq(om_bus_endpoint_open(&bad, &bad_cfg), OM_ERR_BUS_INIT);
+
+    uint64_t val = 0;
+    for (uint64_t seq = 1; seq <= 12; seq++) {
+        ck_assert_int_eq(om_bus_stream_publish(stream, seq, (uint8_t)(seq % 3),
+                                                &val, sizeof(val)), 0);
+    }
+
+    /* Default key = wal_seq: member 0 gets even, member 1 odd */
+    OmBusRecord rec;
+    for (uint64_t expect = 2; expect <= 12; expect += 2) {
+        ck_assert_int_eq(om_bus_endpoint_poll(ep[0], &rec), 1);
+        ck_assert_uint_eq(rec.wal_seq, expect);
+    }
+    ck_assert_int_eq(om_bus_endpoint_poll(ep[0], &rec), 0);
+    ck_assert_uint_eq(om_bus_endpoint_wal_seq(ep[0]), 12);
+
+    OmBusRecord recs[16];
+    ck_assert_int_eq(om_bus_endpoint_poll_batch(ep[1], recs, 16), 6);
+    for (int i = 0; i < 6; i++) ck_assert_uint_eq(recs[i].wal_seq, (uint64_t)(2 * i + 1));
+
+    /* Custom key: wal_type % 3 == 1 */
+    ck_assert_int_eq(om_bus_endpoint_poll_batch(ep[2], recs, 16), 4);
+    for (int i = 0; i < 4; i++) ck_assert_uint_eq(recs[i].wal_type, 1);
+
+    /* Skipped records count as consumed: every member's tail is at head */
+    OmBusStreamStats st;
+    om_bus_stream_stats(stream, &st);
+    ck_assert_uint_eq(st.min_tail, 12);
+
+    /* A gap on a skipped record is reported with the next delivered one */
+    ck_assert_int_eq(om_bus_stream_publish(stream, 14, 0, &val, sizeof(val)), 0);
+    ck_assert_int_eq(om_bus_stream_publish(stream, 15, 0, &val, sizeof(val)), 0);
+    ck_assert_int_eq(om_bus_endpoint_poll(ep[1], &rec), OM_ERR_BUS_GAP_DETECTED);
+    ck_assert_uint_eq(rec.wal_seq, 15);
+
+    for (int i = 0; i < 3; i++) om_bus_endpoint_close(ep[i]);
+    om_bus_stream_destroy(stream);
+}
+END_TEST
+
+/* ---- Test: blocking wait — timeout, and futex wake on publish ---- */
+typedef struct {
+    OmBusStream *stream;
+    uint64_t delay_us;
+} BusWaitPublisher;
+
+static void *bus_wait_publisher(void *arg) {
+    BusWaitPublisher *p = (BusWaitPublisher *)arg;
+    usleep((useconds_t)p->delay_us);
+    uint64_t val = 42;
+    om_bus_stream_publish(p->stream, 1, 1, &val, sizeof(val));
+    return NULL;
+}
+
+static uint64_t bus_test_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+START_TEST(test_bus_endpoint_wait) {
+    const char *name = test_shm_name("wait");
+    OmBusStream *stream = NULL;
+    OmBusStreamConfig scfg = {
+        .stream_name = name, .capacity = 16, .slot_size = 64,
+        .max_consumers = 1, .flags = 0,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+
+    OmBusEndpoint *ep = NULL;
+    OmBusEndpointConfig ecfg = {
+        .stream_name = name, .consumer_index = 0, .zero_copy = true,
+    };
+    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), 0);
+
+    /* Empty ring: check-only and timed waits return 0 */
+    ck_assert_int_eq(om_bus_endpoint_wait(ep, 0), 0);
+    uint64_t t0 = bus_test_now_ns();
+    ck_assert_int_eq(om_bus_endpoint_wait(ep, 5000000ULL), 0);
+    ck_assert_uint_ge(bus_test_now_ns() - t0, 5000000ULL);
+
+    /* No sleepers: publish issues no wake syscall */
+    OmBusStreamStats st;
+    uint64_t val = 7;
+    ck_assert_int_eq(om_bus_stream_publish(stream, 1, 1, &val, sizeof(val)), 0);
+    om_bus_stream_stats(stream, &st);
+    ck_assert_uint_eq(st.wake_calls, 0);
+    ck_assert_int_eq(om_bus_endpoint_wait(ep, OM_BUS_WAIT_FOREVER), 1);
+
+    OmBusRecord rec;
+    ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 1);
+
+    /* Sleeping consumer is woken by a publish from another thread */
+    om_bus_endpoint_close(ep);
+    om_bus_stream_destroy(stream);
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), 0);
+
+    BusWaitPublisher pub = { .stream = stream, .delay_us = 20000 };
+    pthread_t th;
+    ck_assert_int_eq(pthread_create(&th, NULL, bus_wait_publisher, &pub), 0);
+    ck_assert_int_eq(om_bus_endpoint_wait(ep, OM_BUS_WAIT_FOREVER), 1);
+    pthread_join(th, NULL);
+
+    ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 1);
+    memcpy(&val, rec.payload, sizeof(val));
+    ck_assert_uint_eq(val, 42);
+    om_bus_stream_stats(stream, &st);
+    ck_assert_uint_ge(st.wake_calls, 1);
+
+    om_bus_endpoint_close(ep);
+    om_bus_stream_destroy(stream);
+}
+END_TEST
+
+/* ---- Test: commit_every batches shared tail/heartbeat publication ---- */
+START_TEST(test_bus_commit_every) {
+    const char *name = test_shm_name("commit");
+    OmBusStream *stream = NULL;
+    OmBusStreamConfig scfg = {
+        .stream_name = name, .capacity = 16, .slot_size = 64,
+        .max_consumers = 1, .flags = 0,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+
+    OmBusEndpoint *ep = NULL;
+    OmBusEndpointConfig ecfg = {
+        .stream_name = name, .consumer_index = 0, .zero_copy = true,
+        .commit_every = 8,
+    };
+    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), 0);
+
+    uint64_t val = 0;
+    OmBusRecord rec;
+    OmBusStreamStats st;
+    for (int i = 0; i < 5; i++) {
+        ck_assert_int_eq(om_bus_stream_publish(stream, (uint64_t)(i + 1), 1,
+                                                &val, sizeof(val)), 0);
+    }
+    for (int i = 0; i < 5; i++) {
+        ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 1);
+    }
+    /* Local progress visible, shared tail not yet published */
+    ck_assert_uint_eq(om_bus_endpoint_wal_seq(ep), 5);
+    om_bus_stream_stats(stream, &st);
+    ck_assert_uint_eq(st.min_tail, 0);
+
+    /* Empty poll flushes */
+    ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 0);
+    om_bus_stream_stats(stream, &st);
+    ck_assert_uint_eq(st.min_tail, 5);
+
+    /* Fill the ring; the 8th consumed record triggers a commit */
+    for (int i = 5; i < 21; i++) {
+        ck_assert_int_eq(om_bus_stream_publish(stream, (uint64_t)(i + 1), 1,
+                                                &val, sizeof(val)), 0);
+    }
+    for (int i = 0; i < 7; i++) {
+        ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 1);
+    }
+    om_bus_stream_stats(stream, &st);
+    ck_assert_uint_eq(st.min_tail, 5);
+    ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 1);
+    om_bus_stream_stats(stream, &st);
+    ck_assert_uint_eq(st.min_tail, 13);
+
+    /* Batch poll counts records toward the same window */
+    OmBusRecord recs[16];
+    ck_assert_int_eq(om_bus_endpoint_poll_batch(ep, recs, 16), 8);
+    ck_assert_uint_eq(recs[7].wal_seq, 21);
+    om_bus_stream_stats(stream, &st);
+    ck_assert_uint_eq(st.min_tail, 21);
+
+    /* Explicit flush and close keep the shared cursor current */
+    ck_assert_int_eq(om_bus_stream_publish(stream, 22, 1, &val, sizeof(val)), 0);
+    ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 1);
+    om_bus_endpoint_flush(ep);
+    om_bus_stream_stats(stream, &st);
+    ck_assert_uint_eq(st.min_tail, 22);
+
+    om_bus_endpoint_close(ep);
+    om_bus_stream_destroy(stream);
+}
+END_TEST
+
+START_TEST(test_bus_latency_histogram) {
+    const char *name = test_shm_name("latency");
+    OmBusStream *stream = NULL;
+    OmBusStreamConfig scfg = {
+        .stream_name = name, .capacity = 16, .slot_size = 64,
+        .max_consumers = 2, .flags = OM_BUS_FLAG_CRC | OM_BUS_FLAG_TIMESTAMP,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+
+    OmBusEndpoint *ep0 = NULL;
+    OmBusEndpoint *ep1 = NULL;
+    OmBusEndpointConfig ecfg = {
+        .stream_name = name, .consumer_index = 0, .zero_copy = false,
+    };
+    ck_assert_int_eq(om_bus_endpoint_open(&ep0, &ecfg), 0);
+    ecfg.consumer_index = 1;
+    ecfg.zero_copy = true;
+    ck_assert_int_eq(om_bus_endpoint_open(&ep1, &ecfg), 0);
+
+    /* publish_ns takes 8 bytes of the slot */
+    uint8_t buf[40];
+    memset(buf, 0xAB, sizeof(buf));
+    ck_assert_int_eq(om_bus_stream_publish(stream, 1, 1, buf, 33),
+                     OM_ERR_BUS_RECORD_TOO_LARGE);
+    ck_assert_int_eq(om_bus_stream_publish(stream, 1, 1, buf, 32), 0);
+    void *ptr = NULL;
+    ck_assert_int_eq(om_bus_stream_reserve(stream, 32, &ptr), 0);
+    memset(ptr, 0xCD, 32);
+    ck_assert_int_eq(om_bus_stream_commit(stream, 2, 1), 0);
+    OmBusRecord batch[2] = {
+        { .wal_seq = 3, .wal_type = 1, .payload_len = 8, .payload = buf },
+        { .wal_seq = 4, .wal_type = 1, .payload_len = 8, .payload = buf },
+    };
+    ck_assert_int_eq(om_bus_stream_publish_batch(stream, batch, 2), 0);
+
+    usleep(2000);
+
+    OmBusRecord rec;
+    for (uint64_t i = 1; i <= 4; i++) {
+        ck_assert_int_eq(om_bus_endpoint_poll(ep0, &rec), 1);
+        ck_assert_uint_eq(rec.wal_seq, i);
+    }
+    ck_assert_uint_eq(((const uint8_t *)rec.payload)[0], 0xAB);
+    OmBusRecord recs[8];
+    ck_assert_int_eq(om_bus_endpoint_poll_batch(ep1, recs, 8), 4);
+    ck_assert_uint_eq(((const uint8_t *)recs[1].payload)[31], 0xCD);
+
+    OmBusLatencyStats lat;
+    om_bus_endpoint_latency(ep0, &lat);
+    ck_assert_uint_eq(lat.count, 4);
+    ck_assert_uint_ge(lat.max_ns, 2000000U);
+    ck_assert_uint_ge(lat.sum_ns, 4U * 2000000U);
+    uint64_t total = 0;
+    for (uint32_t b = 0; b < OM_BUS_LAT_BUCKETS; b++) total += lat.buckets[b];
+    ck_assert_uint_eq(total, 4);
+    uint64_t p99 = om_bus_latency_percentile(&lat, 0.99);
+    ck_assert_uint_ge(p99, 2000000U);
+    ck_assert_uint_le(p99, lat.max_ns);
+    om_bus_endpoint_latency(ep1, &lat);
+    ck_assert_uint_eq(lat.count, 4);
+    ck_assert_uint_ge(lat.max_ns, 2000000U);
+
+    /* Monitor sees both consumers' gauges without taking a slot */
+    OmBusMonitor *mon = NULL;
+    ck_assert_int_eq(om_bus_monitor_open(&mon, name), 0);
+    ck_assert_uint_eq(om_bus_monitor_consumers(mon), 2);
+    OmBusConsumerLag lag;
+    for (uint32_t c = 0; c < 2; c++) {
+        ck_assert_int_eq(om_bus_monitor_read(mon, c, &lag), 0);
+        ck_assert_uint_eq(lag.tail, 4);
+        ck_assert_uint_eq(lag.lag_slots, 0);
+        ck_assert_uint_eq(lag.wal_seq, 4);
+        ck_assert_uint_ge(lag.lag_ns, 2000000U);
+        ck_assert_uint_ge(lag.lag_max_ns, lag.lag_ns);
+    }
+    ck_assert_int_eq(om_bus_monitor_read(mon, 2, &lag), OM_ERR_BUS_CONSUMER_ID);
+    ck_assert_int_eq(om_bus_stream_publish(stream, 5, 1, buf, 8), 0);
+    ck_assert_int_eq(om_bus_monitor_read(mon, 0, &lag), 0);
+    ck_assert_uint_eq(lag.lag_slots, 1);
+    om_bus_monitor_close(mon);
+
+    /* Percentile: upper bound of the bucket, capped at max */
+    OmBusLatencyStats syn;
+    memset(&syn, 0, sizeof(syn));
+    syn.buckets[3] = 990;
+    syn.buckets[10] = 10;
+    syn.count = 1000;
+    syn.max_ns = 1500;
+    ck_assert_uint_eq(om_bus_latency_percentile(&syn, 0.5), 15);
+    ck_assert_uint_eq(om_bus_latency_percentile(&syn, 0.99), 15);
+    ck_assert_uint_eq(om_bus_latency_percentile(&syn, 0.999), 1500);
+    syn.count = 0;
+    ck_assert_uint_eq(om_bus_latency_percentile(&syn, 0.99), 0);
+
+    om_bus_endpoint_close(ep0);
+    om_bus_endpoint_close(ep1);
+    om_bus_stream_destroy(stream);
+}
+END_TEST
+
+START_TEST(test_bus_fanout) {
+    char pname[128];
+    char cnames[3][128];
+    snprintf(pname, sizeof(pname), "%s", test_shm_name("fanout-p"));
+    OmBusStream *parent = NULL;
+    OmBusStreamConfig pcfg = {
+        .stream_name = pname, .capacity = 64, .slot_size = 128,
+        .max_consumers = 1, .flags = OM_BUS_FLAG_CRC,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&parent, &pcfg), 0);
+
+    OmBusEndpoint *fep = NULL;
+    OmBusEndpointConfig fcfg = {
+        .stream_name = pname, .consumer_index = 0, .zero_copy = true,
+        .commit_every = OM_BUS_FANOUT_COMMIT_EVERY,
+    };
+    ck_assert_int_eq(om_bus_endpoint_open(&fep, &fcfg), 0);
+
+    /* Three children x two consumers; the parent sees one tail */
+    OmBusStream *children[3];
+    OmBusEndpoint *leaves[6];
+    for (int c = 0; c < 3; c++) {
+        snprintf(cnames[c], sizeof(cnames[c]), "%.100s-%d", test_shm_name("fanout-c"), c);
+        OmBusStreamConfig ccfg = {
+            .stream_name = cnames[c], .capacity = 256, .slot_size = 128,
+            .max_consumers = 2, .flags = OM_BUS_FLAG_CRC,
+            .epoch = om_bus_endpoint_epoch(fep),
+        };
+        ck_assert_int_eq(om_bus_stream_create(&children[c], &ccfg), 0);
+        for (int k = 0; k < 2; k++) {
+            OmBusEndpointConfig lcfg = {
+                .stream_name = cnames[c], .consumer_index = (uint32_t)k,
+                .zero_copy = false,
+            };
+            ck_assert_int_eq(om_bus_endpoint_open(&leaves[c * 2 + k], &lcfg), 0);
+        }
+    }
+
+    OmBusFanoutStats st;
+    om_bus_fanout_stats_reset(&st);
+    static OmBusFanoutState fst;
+    memset(&fst, 0, sizeof(fst));
+    OmBusFanoutConfig cfg = {
+        .ep = fep, .children = children, .child_count = 3, .batch = 16,
+        .state = &fst, .stats = &st,
+    };
+
+    /* 200 records, wal_seq 100 missing; parent ring is smaller than the run */
+    uint64_t seq = 1;
+    while (seq <= 201) {
+        for (int i = 0; i < 40 && seq <= 201; i++, seq++) {
+            if (seq == 100) continue;
+            uint64_t val = seq * 7U;
+            ck_assert_int_eq(om_bus_stream_publish(parent, seq, 2, &val, sizeof(val)), 0);
+        }
+        while (om_bus_fanout_step(&cfg) > 0) {
+        }
+        /* Parent slots are released once every child has them */
+        OmBusStreamStats ps;
+        om_bus_stream_stats(parent, &ps);
+        ck_assert_uint_eq(ps.min_tail, ps.head);
+    }
+    ck_assert_uint_eq(st.records_relayed, 200);
+    ck_assert_uint_le(st.batch_max, 16);
+    ck_assert_uint_eq(st.epoch_syncs, 0);
+
+    OmBusRecord rec;
+    for (int l = 0; l < 6; l++) {
+        uint64_t expect = 1;
+        int gaps = 0;
+        int n = 0;
+        int rc;
+        while ((rc = om_bus_endpoint_poll(leaves[l], &rec)) != 0) {
+            if (rc == OM_ERR_BUS_GAP_DETECTED) {
+                gaps++;
+                ck_assert_uint_eq(rec.wal_seq, 101);
+                expect = 101;
+            } else {
+                ck_assert_int_eq(rc, 1);
+            }
+            ck_assert_uint_eq(rec.wal_seq, expect);
+            ck_assert_uint_eq(rec.wal_type, 2);
+            uint64_t val;
+            memcpy(&val, rec.payload, sizeof(val));
+            ck_assert_uint_eq(val, expect * 7U);
+            expect++;
+            n++;
+        }
+        ck_assert_int_eq(n, 200);
+        ck_assert_int_eq(gaps, 1);
+    }
+
+    /* Upstream restart reaches the leaves as EPOCH_CHANGED */
+    usleep(1000);
+    OmBusStream *parent2 = NULL;
+    ck_assert_int_eq(om_bus_stream_create(&parent2, &pcfg), 0);
+    ck_assert_int_eq(om_bus_fanout_step(&cfg), OM_ERR_BUS_EPOCH_CHANGED);
+    om_bus_endpoint_close(fep);
+    ck_assert_int_eq(om_bus_endpoint_open(&fep, &fcfg), 0);
+    cfg.ep = fep;
+    ck_assert_int_eq(om_bus_fanout_step(&cfg), 0);
+    ck_assert_uint_eq(st.epoch_syncs, 3);
+    for (int c = 0; c < 3; c++) {
+        ck_assert_uint_eq(om_bus_stream_epoch(children[c]), om_bus_endpoint_epoch(fep));
+    }
+    for (int l = 0; l < 6; l++) {
+        ck_assert_int_eq(om_bus_endpoint_poll(leaves[l], &rec), OM_ERR_BUS_EPOCH_CHANGED);
+        om_bus_endpoint_close(leaves[l]);
+    }
+
+    om_bus_endpoint_close(fep);
+    for (int c = 0; c < 3; c++) om_bus_stream_destroy(children[c]);
+    om_bus_stream_destroy(parent2);
+    om_bus_stream_destroy(parent);
+}
+END_TEST
+
+/* ---- Test: fan-out retries a failed child without duplicating the others,
+ * and flushes the parent tail every commit_every records ---- */
+START_TEST(test_bus_fanout_retry) {
+    char pname[128];
+    char cnames[3][128];
+    snprintf(pname, sizeof(pname), "%s", test_shm_name("fanoutr-p"));
+    OmBusStream *parent = NULL;
+    OmBusStreamConfig pcfg = {
+        .stream_name = pname, .capacity = 64, .slot_size = 128, .max_consumers = 1,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&parent, &pcfg), 0);
+    OmBusEndpoint *fep = NULL;
+    OmBusEndpointConfig fcfg = {
+        .stream_name = pname, .consumer_index = 0, .zero_copy = true,
+        .commit_every = OM_BUS_FANOUT_COMMIT_EVERY,
+    };
+    ck_assert_int_eq(om_bus_endpoint_open(&fep, &fcfg), 0);
+
+    /* Child 1's slots are too small for the 48-byte records */
+    OmBusStream *children[3];
+    OmBusEndpoint *leaves[3];
+    for (int c = 0; c < 3; c++) {
+        snprintf(cnames[c], sizeof(cnames[c]), "%.100s-%d", test_shm_name("fanoutr-c"), c);
+        OmBusStreamConfig ccfg = {
+            .stream_name = cnames[c], .capacity = 128, .slot_size = c == 1 ? 64 : 128,
+            .max_consumers = 1, .epoch = om_bus_endpoint_epoch(fep),
+        };
+        ck_assert_int_eq(om_bus_stream_create(&children[c], &ccfg), 0);
+        OmBusEndpointConfig lcfg = { .stream_name = cnames[c], .consumer_index = 0 };
+        ck_assert_int_eq(om_bus_endpoint_open(&leaves[c], &lcfg), 0);
+    }
+
+    static OmBusFanoutState fst;
+    memset(&fst, 0, sizeof(fst));
+    OmBusFanoutConfig cfg = {
+        .ep = fep, .children = children, .child_count = 3, .batch = 16,
+        .commit_every = 32, .state = &fst,
+    };
+    uint8_t payload[48] = {0};
+    for (uint64_t seq = 1; seq <= 48; seq++) {
+        memcpy(payload, &seq, sizeof(seq));
+        ck_assert_int_eq(om_bus_stream_publish(parent, seq, 2, payload, sizeof(payload)), 0);
+    }
+
+    /* Child 0 gets the batch, child 1 fails; retrying keeps failing at child 1 */
+    ck_assert_int_eq(om_bus_fanout_step(&cfg), OM_ERR_BUS_RECORD_TOO_LARGE);
+    ck_assert_int_eq(om_bus_fanout_step(&cfg), OM_ERR_BUS_RECORD_TOO_LARGE);
+    ck_assert_uint_eq(fst.next_child, 1);
+    OmBusStreamStats cs;
+    om_bus_stream_stats(children[0], &cs);
+    ck_assert_uint_eq(cs.records_published, 16);
+
+    /* Replace child 1: the held batch goes to children 1 and 2 only */
+    om_bus_endpoint_close(leaves[1]);
+    om_bus_stream_destroy(children[1]);
+    OmBusStreamConfig fixed = {
+        .stream_name = cnames[1], .capacity = 128, .slot_size = 128,
+        .max_consumers = 1, .epoch = om_bus_endpoint_epoch(fep),
+    };
+    ck_assert_int_eq(om_bus_stream_create(&children[1], &fixed), 0);
+    OmBusEndpointConfig lcfg = { .stream_name = cnames[1], .consumer_index = 0 };
+    ck_assert_int_eq(om_bus_endpoint_open(&leaves[1], &lcfg), 0);
+    ck_assert_int_eq(om_bus_fanout_step(&cfg), 16);
+
+    /* 16 records relayed: below commit_every, the parent tail has not moved */
+    OmBusStreamStats ps;
+    om_bus_stream_stats(parent, &ps);
+    ck_assert_uint_eq(ps.min_tail, 0);
+    ck_assert_int_eq(om_bus_fanout_step(&cfg), 16);
+    om_bus_stream_stats(parent, &ps);
+    ck_assert_uint_eq(ps.min_tail, 32);
+    ck_assert_int_eq(om_bus_fanout_step(&cfg), 16);
+    ck_assert_int_eq(om_bus_fanout_step(&cfg), 0);
+    om_bus_stream_stats(parent, &ps);
+    ck_assert_uint_eq(ps.min_tail, ps.head);
+
+    /* Every child saw 1..48 exactly once */
+    OmBusRecord rec;
+    for (int c = 0; c < 3; c++) {
+        uint64_t expect = 1;
+        int rc;
+        while ((rc = om_bus_endpoint_poll(leaves[c], &rec)) != 0) {
+            ck_assert_int_eq(rc, 1);
+            ck_assert_uint_eq(rec.wal_seq, expect);
+            expect++;
+        }
+        ck_assert_uint_eq(expect, 49);
+        om_bus_endpoint_close(leaves[c]);
+        om_bus_stream_destroy(children[c]);
+    }
+    om_bus_endpoint_close(fep);
+    om_bus_stream_destroy(parent);
+}
+END_TEST
+
+START_TEST(test_bus_persistent_ring) {
+    char path[128];
+    char cursor[128];
+    snprintf(path, sizeof(path), "/tmp/ombus-test-persist-%d.ring", getpid());
+    snprintf(cursor, sizeof(cursor), "/tmp/ombus-test-persist-%d.cursor", getpid());
+    unlink(path);
+
+    OmBusStream *stream = NULL;
+    OmBusStreamConfig scfg = {
+        .stream_name = "persist", .path = path, .capacity = 64, .slot_size = 128,
+        .max_consumers = 2, .flags = OM_BUS_FLAG_CRC, .sync_every = 8,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+    OmBusEndpoint *a = NULL;
+    OmBusEndpoint *b = NULL;
+    OmBusEndpointConfig acfg = { .path = path, .consumer_index = 0 };
+    OmBusEndpointConfig bcfg = { .path = path, .consumer_index = 1, .commit_every = 4 };
+    ck_assert_int_eq(om_bus_endpoint_open(&a, &acfg), 0);
+    ck_assert_int_eq(om_bus_endpoint_open(&b, &bcfg), 0);
+    uint64_t epoch = om_bus_stream_epoch(stream);
+
+    for (uint64_t seq = 1; seq <= 30; seq++) {
+        uint64_t val = seq * 3U;
+        ck_assert_int_eq(om_bus_stream_publish(stream, seq, 1, &val, sizeof(val)), 0);
+    }
+    OmBusRecord rec;
+    for (int i = 0; i < 10; i++) ck_assert_int_eq(om_bus_endpoint_poll(a, &rec), 1);
+    ck_assert_int_eq(om_bus_endpoint_save_cursor(a, cursor), 0);
+    for (int i = 0; i < 20; i++) ck_assert_int_eq(om_bus_endpoint_poll(b, &rec), 1);
+    om_bus_endpoint_close(a);
+    om_bus_endpoint_close(b);
+
+    /* Producer dies with a reservation outstanding; the file stays */
+    void *ptr = NULL;
+    ck_assert_int_eq(om_bus_stream_reserve(stream, 8, &ptr), 0);
+    om_bus_stream_destroy(stream);
+    ck_assert_int_eq(access(path, F_OK), 0);
+
+    /* Reopen recovers head, epoch and the last published wal_seq */
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+    OmBusStreamStats st;
+    om_bus_stream_stats(stream, &st);
+    ck_assert_uint_eq(st.head, 30);
+    ck_assert_uint_eq(st.last_wal_seq, 30);
+    ck_assert_uint_eq(om_bus_stream_epoch(stream), epoch);
+    for (uint64_t seq = 31; seq <= 40; seq++) {
+        uint64_t val = seq * 3U;
+        ck_assert_int_eq(om_bus_stream_publish(stream, seq, 1, &val, sizeof(val)), 0);
+    }
+
+    /* Consumer A resumes from its saved cursor without a gap */
+    uint64_t saved = 0;
+    ck_assert_int_eq(om_bus_endpoint_load_cursor(cursor, &saved), 0);
+    ck_assert_uint_eq(saved, 10);
+    acfg.resume_wal_seq = saved;
+    ck_assert_int_eq(om_bus_endpoint_open(&a, &acfg), 0);
+    for (uint64_t seq = 11; seq <= 40; seq++) {
+        ck_assert_int_eq(om_bus_endpoint_poll(a, &rec), 1);
+        ck_assert_uint_eq(rec.wal_seq, seq);
+        uint64_t val;
+        memcpy(&val, rec.payload, sizeof(val));
+        ck_assert_uint_eq(val, seq * 3U);
+    }
+    ck_assert_int_eq(om_bus_endpoint_poll(a, &rec), 0);
+
+    /* B's shared tail is already past 5; resuming at 17 skips forward */
+    bcfg.resume_wal_seq = 5;
+    ck_assert_int_eq(om_bus_endpoint_open(&b, &bcfg), OM_ERR_BUS_CURSOR_LOST);
+    bcfg.resume_wal_seq = 25;
+    ck_assert_int_eq(om_bus_endpoint_open(&b, &bcfg), 0);
+    ck_assert_int_eq(om_bus_endpoint_poll(b, &rec), 1);
+    ck_assert_uint_eq(rec.wal_seq, 26);
+    ck_assert_uint_eq(om_bus_endpoint_wal_seq(b), 26);
+    om_bus_endpoint_close(b);
+
+    /* Lapped tail: resume reports CURSOR_LOST so the caller replays the WAL.
+     * Restart with staleness so the producer may pass the closed consumer A. */
+    om_bus_endpoint_close(a);
+    om_bus_stream_destroy(stream);
+    scfg.staleness_ns = 20000000ULL;  /* 20ms */
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+    OmBusEndpointConfig bcfg_live = { .path = path, .consumer_index = 1 };
+    ck_assert_int_eq(om_bus_endpoint_open(&b, &bcfg_live), 0);
+    usleep(30000);  /* recovery refreshed A's heartbeat; let it go stale */
+    for (uint64_t seq = 41; seq <= 140; seq++) {
+        uint64_t val = seq * 3U;
+        ck_assert_int_eq(om_bus_stream_publish(stream, seq, 1, &val, sizeof(val)), 0);
+        ck_assert_int_eq(om_bus_endpoint_poll(b, &rec), 1);
+    }
+    acfg.resume_wal_seq = 40;
+    ck_assert_int_eq(om_bus_endpoint_open(&a, &acfg), OM_ERR_BUS_CURSOR_LOST);
+    ck_assert_int_eq(om_bus_stream_sync(stream), 0);
+    om_bus_endpoint_close(b);
+    om_bus_stream_destroy(stream);
+
+    /* Different geometry reinitializes the file */
+    scfg.capacity = 128;
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+    om_bus_stream_stats(stream, &st);
+    ck_assert_uint_eq(st.head, 0);
+    ck_assert_uint_eq(st.last_wal_seq, 0);
+    ck_assert_uint_ne(om_bus_stream_epoch(stream), epoch);
+    om_bus_stream_destroy(stream);
+
+    /* Host crash: the header page reached the disk with head = 25, but slot
+     * pages did not. Record 15's payload is torn and 20..24 were never
+     * written. Recovery rolls head back to the last consistent record. */
+    unlink(path);
+    OmBusStreamConfig tcfg = {
+        .stream_name = "persist-torn", .path = path, .capacity = 64, .slot_size = 128,
+        .max_consumers = 1, .flags = OM_BUS_FLAG_CRC,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&stream, &tcfg), 0);
+    OmBusEndpointConfig tecfg = { .path = path, .consumer_index = 0 };
+    ck_assert_int_eq(om_bus_endpoint_open(&a, &tecfg), 0);
+    for (uint64_t seq = 1; seq <= 20; seq++) {
+        ck_assert_int_eq(om_bus_stream_publish(stream, seq, 1, &seq, sizeof(seq)), 0);
+    }
+    for (int i = 0; i < 5; i++) ck_assert_int_eq(om_bus_endpoint_poll(a, &rec), 1);
+    om_bus_endpoint_close(a);
+    om_bus_stream_destroy(stream);
+
+    int fd = open(path, O_RDWR);
+    ck_assert_int_ge(fd, 0);
+    off_t slots = OM_BUS_HEADER_PAGE + OM_BUS_CONSUMER_ALIGN;
+    uint64_t torn_head = 25;
+    ck_assert_int_eq(pwrite(fd, &torn_head, sizeof(torn_head), offsetof(OmBusShmHeader, head)),
+                     (ssize_t)sizeof(torn_head));
+    uint8_t garbage = 0xEE;
+    ck_assert_int_eq(pwrite(fd, &garbage, 1, slots + 14 * 128 + OM_BUS_SLOT_HEADER_SIZE), 1);
+    close(fd);
+
+    ck_assert_int_eq(om_bus_stream_create(&stream, &tcfg), 0);
+    om_bus_stream_stats(stream, &st);
+    ck_assert_uint_eq(st.head, 14);
+    ck_assert_uint_eq(st.last_wal_seq, 14);
+    tecfg.resume_wal_seq = 5;
+    ck_assert_int_eq(om_bus_endpoint_open(&a, &tecfg), 0);
+    for (uint64_t seq = 15; seq <= 16; seq++) {
+        ck_assert_int_eq(om_bus_stream_publish(stream, seq, 1, &seq, sizeof(seq)), 0);
+    }
+    for (uint64_t seq = 6; seq <= 16; seq++) {
+        ck_assert_int_eq(om_bus_endpoint_poll(a, &rec), 1);
+        ck_assert_uint_eq(rec.wal_seq, seq);
+    }
+    ck_assert_int_eq(om_bus_endpoint_poll(a, &rec), 0);
+
+    /* Monitors attach to file-backed rings by path */
+    OmBusMonitor *mon = NULL;
+    ck_assert_int_eq(om_bus_monitor_open(&mon, path), 0);
+    ck_assert_uint_eq(om_bus_monitor_consumers(mon), 1);
+    OmBusConsumerLag lag;
+    ck_assert_int_eq(om_bus_monitor_read(mon, 0, &lag), 0);
+    ck_assert_uint_eq(lag.tail, 16);
+    ck_assert_uint_eq(lag.wal_seq, 16);
+    ck_assert_uint_eq(lag.lag_slots, 0);
+    om_bus_monitor_close(mon);
+    om_bus_endpoint_close(a);
+    om_bus_stream_destroy(stream);
+
+    unlink(path);
+    unlink(cursor);
+}
+END_TEST
+
+START_TEST(test_bus_map_placement) {
+    const char *name = test_shm_name("placement");
+    OmBusStream *stream = NULL;
+    OmBusStreamConfig scfg = {
+        .stream_name = name, .capacity = 4096, .slot_size = 256,
+        .max_consumers = 1, .flags = OM_BUS_FLAG_CRC,
+        .map_flags = OM_BUS_MAP_THP | OM_BUS_MAP_NUMA_LOCAL | OM_BUS_MAP_PREFAULT,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+
+    /* Best-effort flags: the stats say what took effect */
+    OmBusStreamStats st;
+    om_bus_stream_stats(stream, &st);
+    ck_assert_uint_ge(st.page_size, 4096);
+    ck_assert_uint_eq(st.page_size & (st.page_size - 1U), 0);
+    ck_assert_int_ge(st.numa_node, -1);
+
+    OmBusEndpoint *ep = NULL;
+    OmBusEndpointConfig ecfg = { .stream_name = name, .consumer_index = 0 };
+    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), 0);
+    OmBusRecord rec;
+    for (uint64_t seq = 1; seq <= 5000; seq++) {
+        ck_assert_int_eq(om_bus_stream_publish(stream, seq, 1, &seq, sizeof(seq)), 0);
+        ck_assert_int_eq(om_bus_endpoint_poll(ep, &rec), 1);
+        ck_assert_uint_eq(rec.wal_seq, seq);
+    }
+    om_bus_endpoint_close(ep);
+    om_bus_stream_destroy(stream);
+
+    /* Without placement flags the ring reports the base page, unbound */
+    scfg.map_flags = 0;
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+    om_bus_stream_stats(stream, &st);
+    ck_assert_uint_eq(st.page_size, (uint64_t)sysconf(_SC_PAGESIZE));
+    ck_assert_int_eq(st.numa_node, -1);
+    om_bus_stream_destroy(stream);
+
+    /* HUGETLB is strict: a path outside hugetlbfs is rejected */
+    char path[128];
+    snprintf(path, sizeof(path), "/tmp/ombus-test-hugetlb-%d.ring", getpid());
+    scfg.path = path;
+    scfg.map_flags = OM_BUS_MAP_HUGETLB;
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), OM_ERR_BUS_INIT);
+    unlink(path);
+}
+END_TEST
+
+/* ---- Test: batch iterator, single tail publish ---- */
+START_TEST(test_bus_batch_iter) {
+    const char *name = test_shm_name("batchiter");
+    OmBusStream *stream = NULL;
+    OmBusStreamConfig scfg = {
+        .stream_name = name, .capacity = 256, .slot_size = 128,
+        .max_consumers = 1, .flags = OM_BUS_FLAG_CRC | OM_BUS_FLAG_TIMESTAMP,
+    };
+    ck_assert_int_eq(om_bus_stream_create(&stream, &scfg), 0);
+
+    OmBusEndpoint *ep = NULL;
+    OmBusEndpointConfig ecfg = { .stream_name = name, .consumer_index = 0 };
+    ck_assert_int_eq(om_bus_endpoint_open(&ep, &ecfg), 0);
+    OmBusMonitor *mon = NULL;
+    ck_assert_int_eq(om_bus_monitor_open(&mon, name), 0);
+
+    for (uint64_t seq = 1; seq <= 100; seq++) {
+        ck_assert_int_eq(om_bus_stream_publish(stream, seq, 2, &seq, sizeof(seq)), 0);
+    }
+
+    /* The shared tail does not move until iter_end */
+    OmBusBatchIter it;
+    OmBusRecord rec;
+    OmBusConsumerLag lag;
+    ck_assert_int_eq(om_bus_endpoint_iter_begin(ep, &it, 64), 0);
+    uint64_t want = 1;
+    while (om_bus_endpoint_iter_next(&it, &rec) == 1) {
+        ck_assert_uint_eq(rec.wal_seq, want);
+        ck_assert_uint_eq(rec.wal_type, 2);
+        ck_assert_uint_eq(*(const uint64_t *)rec.payload, want);
+        want++;
+        ck_assert_int_eq(om_bus_monitor_read(mon, 0, &lag), 0);
+        ck_assert_uint_eq(lag.tail, 0);
+    }
+    ck_assert_uint_eq(want, 65);
+    ck_assert_int_eq(om_bus_endpoint_iter_next(&it, &rec), 0);
+    ck_assert_int_eq(om_bus_endpoint_iter_end(&it), 64);
+    ck_assert_int_eq(om_bus_monitor_read(mon, 0, &lag), 0);
+    ck_assert_uint_eq(lag.tail, 64);
+    ck_assert_uint_eq(lag.wal_seq, 64);
+
+    /* Records published after begin are past the head snapshot: picked up
+     * through their slot seqs */
+    ck_assert_int_eq(om_bus_endpoint_iter_begin(ep, &it, 64), 0);
+    for (uint64_t seq = 101; seq <= 104; seq++) {
+        ck_assert_int_eq(om_bus_stream_publish(stream, seq, 2, &seq, sizeof(seq)), 0);
+    }
+    while (om_bus_endpoint_iter_next(&it, &rec) == 1) {
+        ck_assert_uint_eq(rec.wal_seq, want);
+        want++;
+    }
+    ck_assert_int_eq(om_bus_endpoint_iter_end(&it), 40);
+    ck_assert_uint_eq(want, 105);
+
+    /* Empty batch */
+    ck_assert_int_eq(om_bus_endpoint_iter_begin(ep, &it, 64), 0);
+    ck_assert_int_eq(om_bus_endpoint_iter_next(&it, &rec), 0);
+    ck_assert_int_eq(om_bus_endpoint_iter_end(&it), 0);
+
+    OmBusLatencyStats lat;
+    om_bus_endpoint_latency(ep, &lat);
+    ck_assert_uint_eq(lat.count, 104);
+
+    /* CLAIM members use poll_batch */
+    OmBusEndpoint *claim = NULL;
+    ecfg.group_mode = OM_BUS_GROUP_CLAIM;
+    ck_assert_int_eq(om_bus_endpoint_open(&claim, &ecfg), 0);
+    ck_assert_int_eq(om_bus_endpoint_iter_begin(claim, &it, 64), OM_ERR_BUS_INIT);
+    om_bus_endpoint_close(claim);
+
+    om_bus_monitor_close(mon);
+    om_bus_endpoint_close(ep);
+    om_bus_stream_destroy(stream);
+}
+END_TEST
+
+/* ---- Test: multicast delivery and TCP gap-fill over loopback ---- */
+
+/* Drain rx up to wal_seq `last` while serving pub's side channel. Returns
+ * the number of GAP_DETECTED results; seqs must increase and payloads
+ * match. */
+static int mcast_drain(OmBusMcastPublisher *pub, OmBusMcastReceiver *rx,
+                       uint64_t last) {
+    int gaps = 0;
+    uint64_t prev = om_bus_mcast_receiver_wal_seq(rx);
+    for (int spins = 0; om_bus_mcast_receiver_wal_seq(rx) < last; spins++) {
+        ck_assert_int_lt(spins, 200000);
+        ck_assert_int_eq(om_bus_mcast_publisher_poll_io(pub), 0);
+        OmBusRecord rec;
+        int rc = om_bus_mcast_receiver_poll(rx, &rec);
+        if (rc == 0) {
+            usleep(20);
+            continue;
+        }
+        if (rc == OM_ERR_BUS_GAP_DETECTED) {
+            gaps++;
+        } else {
+            ck_assert_int_eq(rc, 1);
+            ck_assert_uint_eq(rec.wal_seq, prev + 1);
+        }
+        ck_assert_uint_gt(rec.wal_seq, prev);
+        ck_assert_uint_eq(rec.payload_len, sizeof(uint64_t));
+        ck_assert_uint_eq((uintptr_t)rec.payload % 8U, 0);
+        uint64_t v;
+        memcpy(&v, rec.payload, sizeof(v));
+        ck_assert_uint_eq(v, rec.wal_seq);
+        prev = rec.wal_seq;
+    }
+    return gaps;
+}
+
+START_TEST(test_mcast_gap_fill) {
+    char group[32];
+    snprintf(group, sizeof(group), "239.255.%d.%d", (getpid() >> 8) & 0xFF,
+             (getpid() & 0xFF) | 1);
+    uint16_t port = (uint16_t)(20000 + getpid() % 20000);
+
+    /* 4 KB history holds the newest ~170 records */
+    OmBusMcastPublisherConfig pcfg = {
+        .group = group, .port = port, .iface_addr = "127.0.0.1", .loop = true,
+        .heartbeat_ms = 10,
+        .fill = { .bind_addr = "127.0.0.1", .history_bytes = 4096 },
+    };
+    OmBusMcastPublisher *pub = NULL;
+    ck_assert_int_eq(om_bus_mcast_publisher_create(&pub, &pcfg), 0);
+
+    /* A tiny receive buffer makes the kernel drop datagrams we don't read */
+    OmBusMcastReceiverConfig rcfg = {
+        .group = group, .port = port, .iface_addr = "127.0.0.1",
+        .fill_host = "127.0.0.1", .fill_port = om_bus_mcast_publisher_fill_port(pub),
+        .rcvbuf_bytes = 1024,
+    };
+    OmBusMcastReceiver *rx = NULL;
+    ck_assert_int_eq(om_bus_mcast_receiver_create(&rx, &rcfg), 0);
+
+    /* Packed batch: one datagram carries many records */
+    OmBusRecord recs[40];
+    uint64_t vals[40];
+    for (int i = 0; i < 40; i++) {
+        vals[i] = (uint64_t)(i + 1);
+        recs[i] = (OmBusRecord){ .wal_seq = vals[i], .wal_type = 1,
+                                 .payload_len = sizeof(uint64_t), .payload = &vals[i] };
+    }
+    ck_assert_int_eq(om_bus_mcast_publish_batch(pub, recs, 40), 0);
+    ck_assert_int_eq(mcast_drain(pub, rx, 40), 0);
+    OmBusMcastPublisherStats ps;
+    om_bus_mcast_publisher_stats(pub, &ps);
+    ck_assert_uint_eq(ps.records_sent, 40);
+    ck_assert_uint_eq(ps.datagrams_sent, 1);
+
+    /* 100 unread single-record datagrams overflow the socket: the lost ones
+     * come back over TCP, in order and without a gap */
+    uint64_t seq = 41;
+    for (; seq <= 140; seq++) {
+        ck_assert_int_eq(om_bus_mcast_publish(pub, seq, 1, &seq, sizeof(seq)), 0);
+    }
+    ck_assert_int_eq(mcast_drain(pub, rx, 140), 0);
+    OmBusMcastReceiverStats rs;
+    om_bus_mcast_receiver_stats(rx, &rs);
+    ck_assert_uint_ge(rs.gaps, 1);
+    ck_assert_uint_gt(rs.records_filled, 0);
+    ck_assert_uint_eq(rs.fills_failed, 0);
+    ck_assert_uint_eq(rs.records, 140);
+    om_bus_mcast_publisher_stats(pub, &ps);
+    ck_assert_uint_ge(ps.fill_requests, 1);
+
+    /* 400 more outrun the history ring: one GAP, then the rest in order */
+    for (; seq <= 540; seq++) {
+        ck_assert_int_eq(om_bus_mcast_publish(pub, seq, 1, &seq, sizeof(seq)), 0);
+    }
+    ck_assert_int_eq(mcast_drain(pub, rx, 540), 1);
+    om_bus_mcast_receiver_stats(rx, &rs);
+    ck_assert_uint_ge(rs.fills_failed, 1);
+
+    /* Idle publisher: heartbeats only */
+    for (int i = 0; i < 30; i++) {
+        om_bus_mcast_publisher_poll_io(pub);
+        usleep(1000);
+    }
+    om_bus_mcast_publisher_stats(pub, &ps);
+    ck_assert_uint_gt(ps.heartbeats_sent, 0);
+
+    /* Oversized record: nothing sent */
+    static uint8_t big[OM_BUS_MCAST_MTU];
+    ck_assert_int_eq(om_bus_mcast_publish(pub, seq, 1, big, sizeof(big)),
+                     OM_ERR_BUS_RECORD_TOO_LARGE);
+    ck_assert_int_eq(om_bus_mcast_publish(pub, 5, 1, &seq, sizeof(seq)),
+                     OM_ERR_BUS_REORDER_DETECTED);
+
+    om_bus_mcast_receiver_close(rx);
+    om_bus_mcast_publisher_destroy(pub);
+}
+END_TEST
+
+/* Open descriptors of this process */
+static int open_fds(void) {
+    DIR *d = opendir("/proc/self/fd");
+    ck_assert_ptr_nonnull(d);
+    int n = 0;
+    while (readdir(d)) n++;
+    closedir(d);
+    return n;
+}
+
+/* ---- Test: a fill server that never answers: the fill times out, its
+ * client is closed, and the next gap inside the backoff does not reconnect ---- */
+START_TEST(test_mcast_fill_backoff) {
+    char group[32];
+    snprintf(group, sizeof(group), "239.254.%d.%d", (getpid() >> 8) & 0xFF,
+             (getpid() & 0xFF) | 1);
+    uint16_t port = (uint16_t)(20000 + (getpid() + 7) % 20000);
+
+    /* Connects complete in the backlog; RESEND is never read */
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    ck_assert_int_ge(lfd, 0);
+    struct sockaddr_in laddr;
+    memset(&laddr, 0, sizeof(laddr));
+    laddr.sin_family = AF_INET;
+    inet_pton(AF_INET, "127.0.0.1", &laddr.sin_addr);
+    ck_assert_int_eq(bind(lfd, (struct sockaddr *)&laddr, sizeof(laddr)), 0);
+    ck_assert_int_eq(listen(lfd, 8), 0);
+    socklen_t alen = sizeof(laddr);
+    getsockname(lfd, (struct sockaddr *)&laddr, &alen);
+
+    OmBusMcastPublisherConfig pcfg = {
+        .group = group, .port = port, .iface_addr = "127.0.0.1", .loop = true,
+        .heartbeat_ms = 10,
+        .fill = { .bind_addr = "127.0.0.1", .history_bytes = 4096 },
+    };
+    OmBusMcastPublisher *pub = NULL;
+    ck_assert_int_eq(om_bus_mcast_publisher_create(&pub, &pcfg), 0);
+    OmBusMcastReceiverConfig rcfg = {
+        .group = group, .port = port, .iface_addr = "127.0.0.1",
+        .fill_host = "127.0.0.1", .fill_port = ntohs(laddr.sin_port),
+        .rcvbuf_bytes = 1024, .fill_timeout_ms = 20,
+    };
+    OmBusMcastReceiver *rx = NULL;
+    ck_assert_int_eq(om_bus_mcast_receiver_create(&rx, &rcfg), 0);
+    int fds = open_fds();
+
+    uint64_t seq = 1;
+    ck_assert_int_eq(om_bus_mcast_publish(pub, seq, 1, &seq, sizeof(seq)), 0);
+    ck_assert_int_eq(mcast_drain(pub, rx, 1), 0);
+
+    /* Two overflows back to back. The socket keeps the oldest datagrams;
+     * the record sent once they are read finds the gap. The first fill
+     * times out, the second gap falls inside its backoff and is reported
+     * without a connect. */
+    for (int round = 0; round < 2; round++) {
+        uint64_t last = seq + 101U;
+        for (seq++; seq < last; seq++) {
+            ck_assert_int_eq(om_bus_mcast_publish(pub, seq, 1, &seq, sizeof(seq)), 0);
+        }
+        OmBusRecord rec;
+        int rc;
+        while ((rc = om_bus_mcast_receiver_poll(rx, &rec)) == 1) {}
+        ck_assert_int_eq(rc, 0);
+        ck_assert_uint_lt(om_bus_mcast_receiver_wal_seq(rx), last - 1U);
+        ck_assert_int_eq(om_bus_mcast_publish(pub, seq, 1, &seq, sizeof(seq)), 0);
+        ck_assert_int_eq(mcast_drain(pub, rx, last), 1);
+        ck_assert_int_eq(open_fds(), fds);
+    }
+    OmBusMcastReceiverStats rs;
+    om_bus_mcast_receiver_stats(rx, &rs);
+    ck_assert_uint_eq(rs.gaps, 2);
+    ck_assert_uint_eq(rs.fills_failed, 2);
+    ck_assert_uint_eq(rs.records_filled, 0);
+
+    int fl = fcntl(lfd, F_GETFL, 0);
+    fcntl(lfd, F_SETFL, fl | O_NONBLOCK);
+    int conns = 0;
+    for (int afd; (afd = accept(lfd, NULL, NULL)) >= 0; conns++) close(afd);
+    ck_assert_int_eq(conns, 1);
+
+    om_bus_mcast_receiver_close(rx);
+    om_bus_mcast_publisher_destroy(pub);
+    close(lfd);
+}
+END_TEST
+
+START_TEST(test_mcast_fill_connect_stall) {
+    char group[32];
+    snprintf(group, sizeof(group), "239.254.%d.%d", (getpid() >> 8) & 0xFF,
+             (getpid() & 0xFF) | 1);
+    uint16_t port = (uint16_t)(20000 + (getpid() + 11) % 20000);
+
+    /* Backlog 0 with one connection queued: further SYNs are dropped, so a
+     * connect to it stays in progress until the kernel gives up */
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    ck_assert_int_ge(lfd, 0);
+    struct sockaddr_in laddr;
+    memset(&laddr, 0, sizeof(laddr));
+    laddr.sin_family = AF_INET;
+    inet_pton(AF_INET, "127.0.0.1", &laddr.sin_addr);
+    ck_assert_int_eq(bind(lfd, (struct sockaddr *)&laddr, sizeof(laddr)), 0);
+    ck_assert_int_eq(listen(lfd, 0), 0);
+    socklen_t alen = sizeof(laddr);
+    getsockname(lfd, (struct sockaddr *)&laddr, &alen);
+    int qfd = socket(AF_INET, SOCK_STREAM, 0);
+    ck_assert_int_ge(qfd, 0);
+    ck_assert_int_eq(connect(qfd, (struct sockaddr *)&laddr, sizeof(laddr)), 0);
+
+    OmBusMcastPublisherConfig pcfg = {
+        .group = group, .port = port, .iface_addr = "127.0.0.1", .loop = true,
+        .heartbeat_ms = 10,
+        .fill = { .bind_addr = "127.0.0.1", .history_bytes = 4096 },
+    };
+    OmBusMcastPublisher *pub = NULL;
+    ck_assert_int_eq(om_bus_mcast_publisher_create(&pub, &pcfg), 0);
+    OmBusMcastReceiverConfig rcfg = {
+        .group = group, .port = port, .iface_addr = "127.0.0.1",
+        .fill_host = "127.0.0.1", .fill_port = ntohs(laddr.sin_port),
+        .rcvbuf_bytes = 1024, .fill_timeout_ms = 200,
+    };
+    OmBusMcastReceiver *rx = NULL;
+    ck_assert_int_eq(om_bus_mcast_receiver_create(&rx, &rcfg), 0);
+    int fds = open_fds();
+
+    uint64_t seq = 1;
+    ck_assert_int_eq(om_bus_mcast_publish(pub, seq, 1, &seq, sizeof(seq)), 0);
+    ck_assert_int_eq(mcast_drain(pub, rx, 1), 0);
+
+    uint64_t last = seq + 101U;
+    for (seq++; seq < last; seq++) {
+        ck_assert_int_eq(om_bus_mcast_publish(pub, seq, 1, &seq, sizeof(seq)), 0);
+    }
+    OmBusRecord rec;
+    int rc;
+    while ((rc = om_bus_mcast_receiver_poll(rx, &rec)) == 1) {}
+    ck_assert_int_eq(rc, 0);
+    ck_assert_int_eq(om_bus_mcast_publish(pub, seq, 1, &seq, sizeof(seq)), 0);
+
+    /* The connect never completes: every poll returns at once, and the fill
+     * gives up fill_timeout_ms after the connect attempt */
+    uint64_t start = bus_test_now_ns();
+    uint64_t worst = 0;
+    int gaps = 0;
+    while (om_bus_mcast_receiver_wal_seq(rx) < last) {
+        ck_assert_uint_lt(bus_test_now_ns() - start, 5000000000ULL);
+        ck_assert_int_eq(om_bus_mcast_publisher_poll_io(pub), 0);
+        uint64_t t = bus_test_now_ns();
+        rc = om_bus_mcast_receiver_poll(rx, &rec);
+        t = bus_test_now_ns() - t;
+        if (t > worst) worst = t;
+        if (rc == OM_ERR_BUS_GAP_DETECTED) {
+            gaps++;
+        } else if (rc == 0) {
+            usleep(100);
+        } else {
+            ck_assert_int_eq(rc, 1);
+        }
+    }
+    uint64_t elapsed = bus_test_now_ns() - start;
+    ck_assert_int_eq(gaps, 1);
+    ck_assert_uint_lt(worst, 50000000ULL);
+    ck_assert_uint_ge(elapsed, 150000000ULL);
+    ck_assert_uint_lt(elapsed, 2000000000ULL);
+    ck_assert_int_eq(open_fds(), fds);
+
+    OmBusMcastReceiverStats rs;
+    om_bus_mcast_receiver_stats(rx, &rs);
+    ck_assert_uint_eq(rs.gaps, 1);
+    ck_assert_uint_eq(rs.fills_failed, 1);
+    ck_assert_uint_eq(rs.records_filled, 0);
+
+    om_bus_mcast_receiver_close(rx);
+    om_bus_mcast_publisher_destroy(pub);
+    close(qfd);
+    close(lfd);
+}
+END_TEST
+
+Suite *bus_suite(void) {
+    Suite *s = suite_create("Bus");
+    TCase *tc = tcase_create("SHM");
+    tcase_add_test(tc, test_bus_create_destroy);
+    tcase_add_test(tc, test_bus_publish_poll);
+    tcase_add_test(tc, test_bus_batch);
+    tcase_add_test(tc, test_bus_multi_consumer);
+    tcase_add_test(tc, test_bus_backpressure);
+    tcase_add_test(tc, test_bus_gap_detection);
+    tcase_add_test(tc, test_bus_crc_validation);
+    tcase_add_test(tc, test_bus_record_too_large);
+    tcase_add_test(tc, test_bus_magic_mismatch);
+    tcase_add_test(tc, test_bus_wal_seq_tracking);
+    tcase_add_test(tc, test_bus_large_payload_boundary);
+    tcase_add_test(tc, test_bus_batch_publish);
+    tcase_add_test(tc, test_bus_cursor_persistence);
+    tcase_add_test(tc, test_bus_epoch_restart);
+    tcase_add_test(tc, test_bus_stale_consumer);
+    tcase_add_test(tc, test_bus_relay);
+    tcase_add_test(tc, test_bus_reorder_detection);
+    tcase_add_test(tc, test_bus_batch_poll_crc);
+    tcase_add_test(tc, test_bus_multiple_gaps);
+    tcase_add_test(tc, test_bus_concurrent_consumers);
+    tcase_add_test(tc, test_bus_mixed_poll_batch_sequence_tracking);
+    tcase_add_test(tc, test_bus_batch_then_poll_reorder_detection);
+    tcase_add_test(tc, test_bus_ring_wrap);
+    tcase_add_test(tc, test_bus_varlen_roundtrip);
+    tcase_add_test(tc, test_bus_varlen_batch);
+    tcase_add_test(tc, test_bus_varlen_stale_continuation);
+    tcase_add_test(tc, test_bus_reserve_commit);
+    tcase_add_test(tc, test_bus_group_claim);
+    tcase_add_test(tc, test_bus_group_claim_release);
+    tcase_add_test(tc, test_bus_group_partition);
+    tcase_add_test(tc, test_bus_endpoint_wait);
+    tcase_add_test(tc, test_bus_commit_every);
+    tcase_add_test(tc, test_bus_latency_histogram);
+    tcase_add_test(tc, test_bus_fanout);
+    tcase_add_test(tc, test_bus_fanout_retry);
+    tcase_add_test(tc, test_bus_persistent_ring);
+    tcase_add_test(tc, test_bus_map_placement);
+    tcase_add_test(tc, test_bus_batch_iter);
+    suite_add_tcase(s, tc);
+
+    TCase *tc_wal = tcase_create("WAL-Bus");
+    tcase_add_test(tc_wal, test_bus_wal_attach);
+    tcase_add_test(tc_wal, test_bus_wal_match);
     tcase_add_test(tc_wal, test_bus_wal_cancel);
     tcase_add_test(tc_wal, test_bus_worker_roundtrip);
     suite_add_tcase(s, tc_wal);
@@ -2199,7 +4727,37 @@ Suite *bus_suite(void) {
     tcase_add_test(tc_tcp, test_tcp_drain_on_disconnect);
     tcase_add_test(tc_tcp, test_tcp_auto_reconnect_max_retries);
     tcase_add_test(tc_tcp, test_tcp_server_load);
+    tcase_add_test(tc_tcp, test_tcp_shared_broadcast);
+    tcase_add_test(tc_tcp, test_tcp_shared_slow_client);
+    tcase_add_test(tc_tcp, test_tcp_client_poll_batch);
+    tcase_add_test(tc_tcp, test_tcp_batch_frames);
+    tcase_add_test(tc_tcp, test_tcp_resend);
+    tcase_add_test(tc_tcp, test_tcp_resend_filter_budget);
+    tcase_add_test(tc_tcp, test_tcp_subscribe_filter);
+    tcase_add_test(tc_tcp, test_mcast_gap_fill);
+    tcase_add_test(tc_tcp, test_mcast_fill_backoff);
+    tcase_add_test(tc_tcp, test_mcast_fill_connect_stall);
     suite_add_tcase(s, tc_tcp);
 
     return s;
 }
+
+/* The io_uring server needs a recent kernel and no seccomp filter on
+ * io_uring: the runner reports the URING suite as skipped without it */
+bool bus_uring_supported(void) {
+    OmBusTcpServerConfig scfg = {
+        .bind_addr = "127.0.0.1", .max_clients = 1, .mode = OM_BUS_TCP_SERVER_URING,
+    };
+    OmBusTcpServer *srv = NULL;
+    if (om_bus_tcp_server_create(&srv, &scfg) != 0) return false;
+    om_bus_tcp_server_destroy(srv);
+    return true;
+}
+
+Suite *bus_uring_suite(void) {
+    Suite *s = suite_create("Bus-URING");
+    TCase *tc = tcase_create("URING");
+    tcase_add_test(tc, test_tcp_uring);
+    suite_add_tcase(s, tc);
+    return s;
+}
@@ -0,0 +1,268 @@
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "openmatch/om_colfile.h"
+#include "openmatch/om_error.h"
+
+#define TEST_COL_FILE "/tmp/test_colfile.omc"
+#define TEST_COL_ROWS 1050U
+#define TEST_COL_CHUNK 100U
+
+static const OmColColumnDef trade_columns[] = {
+    {"seq", OM_COL_U64},
+    {"price", OM_COL_U32},
+    {"product_id", OM_COL_U16},
+    {"side", OM_COL_U8},
+};
+
+static const OmColColumnDef tick_columns[] = {
+    {"seq", OM_COL_U64},
+    {"bid", OM_COL_U64},
+};
+
+/* Row i of the trade table: seq ascending, product cycling, price spread */
+static void trade_row(uint32_t i, uint64_t v[4]) {
+    v[0] = 1000U + i;
+    v[1] = 50000U + (i * 7919U) % 1000U;
+    v[2] = i % 13U;
+    v[3] = i & 1U;
+}
+
+/* Write TEST_COL_ROWS trades and 3 ticks, interleaved */
+static void write_test_file(void) {
+    OmColWriter *w = NULL;
+    ck_assert_int_eq(om_col_writer_create(&w, TEST_COL_FILE, TEST_COL_CHUNK), 0);
+    int trades = om_col_writer_add_table(w, "trade", trade_columns, 4);
+    int ticks = om_col_writer_add_table(w, "tick", tick_columns, 2);
+    ck_assert_int_eq(trades, 0);
+    ck_assert_int_eq(ticks, 1);
+    for (uint32_t i = 0; i < TEST_COL_ROWS; i++) {
+        uint64_t v[4];
+        trade_row(i, v);
+        ck_assert_int_eq(om_col_writer_append(w, (uint32_t)trades, v), 0);
+        if (i % 400U == 0) {
+            uint64_t t[2] = {i, UINT64_MAX - i};
+            ck_assert_int_eq(om_col_writer_append(w, (uint32_t)ticks, t), 0);
+        }
+    }
+    om_col_writer_set_seq_range(w, 1000, 1000 + TEST_COL_ROWS - 1);
+    ck_assert_int_eq(om_col_writer_close(w), 0);
+}
+
+START_TEST(test_colfile_roundtrip)
+{
+    write_test_file();
+
+    OmColFile *f = NULL;
+    ck_assert_int_eq(om_col_open(&f, TEST_COL_FILE), 0);
+    ck_assert_uint_eq(om_col_table_count(f), 2);
+    ck_assert_uint_eq(om_col_header(f)->last_seq, 1000 + TEST_COL_ROWS - 1);
+
+    int trades = om_col_table_find(f, "trade");
+    ck_assert_int_eq(trades, 0);
+    ck_assert_int_eq(om_col_table_find(f, "quote"), OM_ERR_NOT_FOUND);
+    const OmColTableDesc *t = om_col_table(f, (uint32_t)trades);
+    ck_assert_uint_eq(t->row_count, TEST_COL_ROWS);
+    ck_assert_uint_eq(t->chunk_count, (TEST_COL_ROWS + TEST_COL_CHUNK - 1) / TEST_COL_CHUNK);
+    ck_assert_int_eq(om_col_column_find(f, (uint32_t)trades, "product_id"), 2);
+    ck_assert_uint_eq(om_col_column(f, (uint32_t)trades, 3)->type, OM_COL_U8);
+
+    /* Chunk stats cover exactly the rows written into the chunk */
+    const OmColChunkColumn *seq_stats = om_col_chunk_column(f, (uint32_t)trades, 3, 0);
+    ck_assert_uint_eq(seq_stats->min, 1300);
+    ck_assert_uint_eq(seq_stats->max, 1399);
+    ck_assert_uint_eq(seq_stats->offset % OM_COL_ALIGN, 0);
+    ck_assert_uint_eq(om_col_chunk(f, (uint32_t)trades, 10)->rows, TEST_COL_ROWS % TEST_COL_CHUNK);
+
+    /* Full scan returns every row in order with every column intact */
+    OmColScan scan;
+    OmColBatch b;
+    ck_assert_int_eq(om_col_scan_init(&scan, f, (uint32_t)trades, NULL, 0), 0);
+    uint32_t next = 0;
+    while (om_col_scan_next(&scan, &b)) {
+        ck_assert_ptr_null(b.sel);
+        ck_assert_uint_eq(b.first_row, next);
+        for (uint32_t r = 0; r < b.rows; r++, next++) {
+            uint64_t v[4];
+            trade_row(next, v);
+            for (uint32_t c = 0; c < 4; c++) {
+                ck_assert_uint_eq(om_col_value(b.cols[c], trade_columns[c].type, r), v[c]);
+            }
+        }
+    }
+    ck_assert_uint_eq(next, TEST_COL_ROWS);
+    om_col_scan_close(&scan);
+
+    /* U64 columns keep the full width */
+    int ticks = om_col_table_find(f, "tick");
+    ck_assert_int_eq(om_col_scan_init(&scan, f, (uint32_t)ticks, NULL, 0), 0);
+    ck_assert_int_eq(om_col_scan_next(&scan, &b), 1);
+    ck_assert_uint_eq(b.rows, 3);
+    ck_assert_uint_eq(((const uint64_t *)b.cols[1])[2], UINT64_MAX - 800);
+    ck_assert_int_eq(om_col_scan_next(&scan, &b), 0);
+    om_col_scan_close(&scan);
+
+    om_col_close(f);
+    unlink(TEST_COL_FILE);
+}
+END_TEST
+
+START_TEST(test_colfile_scan_predicates)
+{
+    write_test_file();
+    OmColFile *f = NULL;
+    ck_assert_int_eq(om_col_open(&f, TEST_COL_FILE), 0);
+
+    /* seq range inside chunks 2..4: other chunks skipped on stats alone */
+    OmColPred preds[3] = {
+        {.column = 0, .min = 1250, .max = 1449},
+        {.column = 2, .min = 3, .max = 5},
+        {.column = 3, .min = 1, .max = 1},
+    };
+    OmColScan scan;
+    OmColBatch b;
+    ck_assert_int_eq(om_col_scan_init(&scan, f, 0, preds, 1), 0);
+    uint32_t rows = 0;
+    while (om_col_scan_next(&scan, &b)) {
+        for (uint32_t j = 0; j < b.count; j++) {
+            uint32_t r = b.sel ? b.sel[j] : j;
+            ck_assert_uint_eq(((const uint64_t *)b.cols[0])[r], 1250 + rows);
+            rows++;
+        }
+    }
+    ck_assert_uint_eq(rows, 200);
+    ck_assert_uint_eq(scan.chunks_skipped, 8);
+    ck_assert_uint_eq(scan.chunks_scanned, 3);
+    om_col_scan_close(&scan);
+
+    /* Three predicates AND'ed: compare with a brute-force count */
+    uint32_t expect = 0;
+    for (uint32_t i = 0; i < TEST_COL_ROWS; i++) {
+        uint64_t v[4];
+        trade_row(i, v);
+        expect += v[0] >= 1250 && v[0] <= 1449 && v[2] >= 3 && v[2] <= 5 && v[3] == 1;
+    }
+    ck_assert_int_eq(om_col_scan_init(&scan, f, 0, preds, 3), 0);
+    rows = 0;
+    while (om_col_scan_next(&scan, &b)) {
+        ck_assert_ptr_nonnull(b.sel);
+        for (uint32_t j = 0; j < b.count; j++) {
+            uint32_t r = b.sel[j];
+            ck_assert(j == 0 || r > b.sel[j - 1]);
+            ck_assert_uint_ge(((const uint16_t *)b.cols[2])[r], 3);
+            ck_assert_uint_le(((const uint16_t *)b.cols[2])[r], 5);
+            ck_assert_uint_eq(((const uint8_t *)b.cols[3])[r], 1);
+        }
+        rows += b.count;
+    }
+    ck_assert_uint_eq(rows, expect);
+    ck_assert_uint_eq(scan.rows_selected, expect);
+    om_col_scan_close(&scan);
+
+    /* Range outside the data: nothing scanned */
+    OmColPred none = {.column = 0, .min = 5000, .max = 6000};
+    ck_assert_int_eq(om_col_scan_init(&scan, f, 0, &none, 1), 0);
+    ck_assert_int_eq(om_col_scan_next(&scan, &b), 0);
+    ck_assert_uint_eq(scan.chunks_skipped, 11);
+    om_col_scan_close(&scan);
+
+    /* Bad column index */
+    OmColPred bad = {.column = 4, .min = 0, .max = 1};
+    ck_assert_int_eq(om_col_scan_init(&scan, f, 0, &bad, 1), OM_ERR_OUT_OF_RANGE);
+
+    om_col_close(f);
+    unlink(TEST_COL_FILE);
+}
+END_TEST
+
+START_TEST(test_colfile_schema_errors)
+{
+    OmColWriter *w = NULL;
+    ck_assert_int_eq(om_col_writer_create(&w, TEST_COL_FILE, 0), 0);
+    ck_assert_int_eq(om_col_writer_add_table(w, "trade", trade_columns, 4), 0);
+    ck_assert_int_eq(om_col_writer_add_table(w, "trade", tick_columns, 2), OM_ERR_COL_SCHEMA);
+    ck_assert_int_eq(om_col_writer_add_table(w, "a_table_name_far_too_long", tick_columns, 2),
+                     OM_ERR_COL_SCHEMA);
+    ck_assert_int_eq(om_col_writer_add_table(w, "empty", tick_columns, 0), OM_ERR_COL_SCHEMA);
+    OmColColumnDef dup[2] = {{"seq", OM_COL_U64}, {"seq", OM_COL_U32}};
+    ck_assert_int_eq(om_col_writer_add_table(w, "dup", dup, 2), OM_ERR_COL_SCHEMA);
+    OmColColumnDef badtype[1] = {{"x", (OmColType)9}};
+    ck_assert_int_eq(om_col_writer_add_table(w, "badtype", badtype, 1), OM_ERR_COL_SCHEMA);
+    uint64_t v[4] = {0};
+    ck_assert_int_eq(om_col_writer_append(w, 1, v), OM_ERR_OUT_OF_RANGE);
+    ck_assert_int_eq(om_col_writer_close(w), 0);
+
+    /* A table with no rows is valid */
+    OmColFile *f = NULL;
+    ck_assert_int_eq(om_col_open(&f, TEST_COL_FILE), 0);
+    ck_assert_uint_eq(om_col_table(f, 0)->row_count, 0);
+    ck_assert_ptr_null(om_col_table(f, 1));
+    om_col_close(f);
+    unlink(TEST_COL_FILE);
+}
+END_TEST
+
+/* Rewrite `len` bytes at `offset` of the test file */
+static void patch_file(long offset, const void *data, size_t len) {
+    FILE *fp = fopen(TEST_COL_FILE, "r+b");
+    ck_assert_ptr_nonnull(fp);
+    ck_assert_int_eq(fseek(fp, offset, SEEK_SET), 0);
+    ck_assert_uint_eq(fwrite(data, 1, len, fp), len);
+    fclose(fp);
+}
+
+START_TEST(test_colfile_reject_damaged)
+{
+    OmColFile *f = NULL;
+    ck_assert_int_eq(om_col_open(&f, "/tmp/test_colfile_missing.omc"), OM_ERR_COL_OPEN);
+
+    /* Unfinished export: footer_offset never published */
+    write_test_file();
+    uint64_t zero = 0;
+    patch_file((long)offsetof(OmColFileHeader, footer_offset), &zero, sizeof(zero));
+    ck_assert_int_eq(om_col_open(&f, TEST_COL_FILE), OM_ERR_COL_INCOMPLETE);
+
+    /* Bad magic */
+    write_test_file();
+    patch_file(0, "XXXX", 4);
+    ck_assert_int_eq(om_col_open(&f, TEST_COL_FILE), OM_ERR_COL_FORMAT);
+
+    /* Truncated footer */
+    write_test_file();
+    ck_assert_int_eq(om_col_open(&f, TEST_COL_FILE), 0);
+    uint64_t footer = om_col_header(f)->footer_offset;
+    om_col_close(f);
+    ck_assert_int_eq(truncate(TEST_COL_FILE, (off_t)footer + 100), 0);
+    ck_assert_int_eq(om_col_open(&f, TEST_COL_FILE), OM_ERR_COL_FORMAT);
+
+    /* Column chunk offset pointing past the data region */
+    write_test_file();
+    ck_assert_int_eq(om_col_open(&f, TEST_COL_FILE), 0);
+    const OmColTableDesc *t = om_col_table(f, 0);
+    long at = (long)(footer + t->chunks_offset + sizeof(OmColChunkDesc));
+    om_col_close(f);
+    uint64_t far = footer + OM_COL_ALIGN;
+    patch_file(at, &far, sizeof(far));
+    ck_assert_int_eq(om_col_open(&f, TEST_COL_FILE), OM_ERR_COL_FORMAT);
+
+    unlink(TEST_COL_FILE);
+}
+END_TEST
+
+Suite *colfile_suite(void)
+{
+    Suite *s = suite_create("ColFile");
+    TCase *tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_colfile_roundtrip);
+    tcase_add_test(tc_core, test_colfile_scan_predicates);
+    tcase_add_test(tc_core, test_colfile_schema_errors);
+    tcase_add_test(tc_core, test_colfile_reject_damaged);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
@@ -1,5 +1,8 @@
 #include <check.h>
+#include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 Suite* slab_suite(void);
 Suite* orderbook_suite(void);
@@ -7,15 +10,37 @@ Suite* wal_suite(void);
 Suite* engine_suite(void);
 Suite* market_suite(void);
 Suite* bus_suite(void);
+Suite* colfile_suite(void);
+Suite* bus_uring_suite(void);
+bool bus_uring_supported(void);
 
-int main(void) {
+/* Exit status ctest reports as a skip (SKIP_RETURN_CODE) */
+#define TEST_SKIPPED 77
+
+int main(int argc, char **argv) {
     int number_failed;
-    SRunner *sr = srunner_create(slab_suite());
+    SRunner *sr;
+
+    /* "uring": the io_uring transport alone, skipped where it is unavailable */
+    if (argc > 1 && strcmp(argv[1], "uring") == 0) {
+        if (!bus_uring_supported()) {
+            fprintf(stderr, "io_uring server unavailable (old kernel or seccomp): skipped\n");
+            return TEST_SKIPPED;
+        }
+        sr = srunner_create(bus_uring_suite());
+        srunner_run_all(sr, CK_NORMAL);
+        number_failed = srunner_ntests_failed(sr);
+        srunner_free(sr);
+        return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    sr = srunner_create(slab_suite());
     srunner_add_suite(sr, orderbook_suite());
     srunner_add_suite(sr, wal_suite());
     srunner_add_suite(sr, engine_suite());
     srunner_add_suite(sr, market_suite());
     srunner_add_suite(sr, bus_suite());
+    srunner_add_suite(sr, colfile_suite());
 
     srunner_run_all(sr, CK_NORMAL);
     number_failed = srunner_ntests_failed(sr);
@@ -6,6 +6,7 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <time.h>
 #include "openmatch/om_engine.h"
 #include "openmatch/orderbook.h"
 #include "openmatch/om_wal.h"
@@ -458,6 +459,339 @@ START_TEST(test_wal_match_replay)
 }
 END_TEST
 
+START_TEST(test_wal_replay_across_flushes)
+{
+    cleanup_wal_file();
+
+    OmWalConfig wal_config = {
+        .filename = TEST_WAL_FILE,
+        .buffer_size = 64 * 1024,
+        .sync_interval_ms = 0,
+        .use_direct_io = false,
+        .enable_crc32 = true,
+        .user_data_size = 0,
+        .aux_data_size = 0
+    };
+
+    OmWal wal;
+    ck_assert_int_eq(om_wal_init(&wal, &wal_config), 0);
+
+    /* Each flush zero-pads to 4KB; replay must step over the padding */
+    uint64_t written = 0;
+    for (int batch = 0; batch < 3; batch++) {
+        for (int i = 0; i < 100; i++) {
+            OmWalMatch match = {
+                .maker_id = written + 1,
+                .taker_id = written + 1000,
+                .price = 100,
+                .volume = 1,
+                .product_id = 0
+            };
+            ck_assert_uint_ne(om_wal_match(&wal, &match), 0);
+            written++;
+        }
+        ck_assert_int_eq(om_wal_flush(&wal), 0);
+    }
+    om_wal_close(&wal);
+
+    OmWalReplay replay;
+    ck_assert_int_eq(om_wal_replay_init_with_config(&replay, TEST_WAL_FILE, &wal_config), 0);
+
+    OmWalType type;
+    void *data;
+    uint64_t sequence;
+    size_t data_len;
+    uint64_t seen = 0;
+    int ret;
+    while ((ret = om_wal_replay_next(&replay, &type, &data, &sequence, &data_len)) == 1) {
+        ck_assert_int_eq(type, OM_WAL_MATCH);
+        OmWalMatch rec;
+        memcpy(&rec, data, sizeof(rec));
+        ck_assert_uint_eq(rec.maker_id, seen + 1);
+        seen++;
+    }
+    ck_assert_int_eq(ret, 0);
+    ck_assert_uint_eq(seen, written);
+
+    om_wal_replay_close(&replay);
+    cleanup_wal_file();
+}
+END_TEST
+
+START_TEST(test_wal_replay_short_padding)
+{
+    cleanup_wal_file();
+
+    /* 8 + 112 + 4 (CRC) = 124 bytes; 33 fill 4092 of a 4KB buffer, leaving
+     * 4 bytes of padding, shorter than a record header */
+    OmWalConfig wal_config = {
+        .filename = TEST_WAL_FILE,
+        .buffer_size = 4096,
+        .sync_interval_ms = 0,
+        .use_direct_io = false,
+        .enable_crc32 = true,
+        .user_data_size = 0,
+        .aux_data_size = 0
+    };
+
+    OmWal wal;
+    ck_assert_int_eq(om_wal_init(&wal, &wal_config), 0);
+    uint8_t payload[112];
+    for (int i = 0; i < 100; i++) {
+        memset(payload, i + 1, sizeof(payload));
+        ck_assert_uint_ne(om_wal_append_custom(&wal, (OmWalType)OM_WAL_USER_BASE, payload,
+                                               sizeof(payload)), 0);
+    }
+    ck_assert_int_eq(om_wal_flush(&wal), 0);
+    om_wal_close(&wal);
+
+    OmWalReplay replay;
+    ck_assert_int_eq(om_wal_replay_init_with_config(&replay, TEST_WAL_FILE, &wal_config), 0);
+
+    OmWalType type;
+    void *data;
+    uint64_t sequence;
+    size_t data_len;
+    uint64_t seen = 0;
+    int ret;
+    while ((ret = om_wal_replay_next(&replay, &type, &data, &sequence, &data_len)) == 1) {
+        ck_assert_uint_eq(sequence, seen + 1);
+        ck_assert_uint_eq(data_len, sizeof(payload));
+        seen++;
+    }
+    ck_assert_int_eq(ret, 0);
+    ck_assert_uint_eq(seen, 100);
+
+    om_wal_replay_close(&replay);
+    cleanup_wal_file();
+}
+END_TEST
+
+/* Seek to each target and count records read before reaching it */
+static void check_wal_seek(const OmWalConfig *cfg, uint64_t total) {
+    const uint64_t targets[] = {1, 2, 37, 500, total / 2, total - 1, total, total + 100};
+    for (size_t t = 0; t < sizeof(targets) / sizeof(targets[0]); t++) {
+        OmWalReplay replay;
+        ck_assert_int_eq(om_wal_replay_init_with_config(&replay, cfg->filename, cfg), 0);
+        ck_assert_int_eq(om_wal_replay_seek(&replay, targets[t]), 0);
+
+        OmWalType type;
+        void *data;
+        uint64_t sequence = 0;
+        size_t data_len;
+        uint64_t before = 0;
+        uint64_t prev = 0;
+        int ret;
+        while ((ret = om_wal_replay_next(&replay, &type, &data, &sequence, &data_len)) == 1) {
+            ck_assert(prev == 0 || sequence == prev + 1);
+            prev = sequence;
+            if (sequence >= targets[t]) {
+                break;
+            }
+            before++;
+        }
+        if (targets[t] <= total) {
+            ck_assert_int_eq(ret, 1);
+            ck_assert_uint_eq(sequence, targets[t]);
+            ck_assert_uint_lt(before, 200);
+        } else {
+            ck_assert_int_eq(ret, 0);
+            ck_assert_uint_eq(prev, total);
+        }
+        om_wal_replay_close(&replay);
+    }
+}
+
+START_TEST(test_wal_replay_seek)
+{
+    for (int variant = 0; variant < 3; variant++) {
+        bool multifile = variant == 2;
+        cleanup_wal_file();
+        cleanup_wal_pattern_files();
+
+        OmWalConfig wal_config = {
+            .filename = TEST_WAL_FILE,
+            .filename_pattern = multifile ? TEST_WAL_PATTERN : NULL,
+            .buffer_size = 16 * 1024,
+            .sync_interval_ms = 0,
+            .use_direct_io = false,
+            .disable_crc32 = variant == 1,
+            .user_data_size = 0,
+            .aux_data_size = 0,
+            .wal_max_file_size = multifile ? 512 * 1024 : 0
+        };
+
+        OmWal wal;
+        ck_assert_int_eq(om_wal_init(&wal, &wal_config), 0);
+        const uint64_t total = 20000;
+        for (uint64_t i = 1; i <= total; i++) {
+            if (i % 3 == 0) {
+                ck_assert_uint_ne(om_wal_cancel(&wal, (uint32_t)i, (uint32_t)i, 1), 0);
+            } else {
+                OmWalMatch match = {
+                    .maker_id = i,
+                    .taker_id = i + 1,
+                    .price = 100,
+                    .volume = 1,
+                    .product_id = 1
+                };
+                ck_assert_uint_ne(om_wal_match(&wal, &match), 0);
+            }
+            if (i % 37 == 0) {
+                ck_assert_int_eq(om_wal_flush(&wal), 0);
+            }
+        }
+        om_wal_close(&wal);
+
+        check_wal_seek(&wal_config, total);
+    }
+    cleanup_wal_file();
+    cleanup_wal_pattern_files();
+}
+END_TEST
+
+/* A record whose header ends exactly at the 1MB replay buffer edge keeps it across the refill */
+START_TEST(test_wal_replay_refill_boundary)
+{
+    cleanup_wal_file();
+
+    OmWalConfig wal_config = {
+        .filename = TEST_WAL_FILE,
+        .buffer_size = 4 * 1024 * 1024,
+        .sync_interval_ms = 0,
+        .use_direct_io = false,
+        .enable_crc32 = true,
+        .user_data_size = 0,
+        .aux_data_size = 0
+    };
+
+    /* 1023 records of 8 + 1012 + 4 = 1024 bytes, then one of 1016, put the
+     * next header at [1MB - 8, 1MB) and its payload in the next refill */
+    enum { FILL = 1023, TAIL = 8 };
+    const uint64_t boundary = 1024 * 1024;
+    const uint64_t straddle = FILL + 2;
+    uint8_t payload[1012];
+    OmWal wal;
+    ck_assert_int_eq(om_wal_init(&wal, &wal_config), 0);
+    for (uint64_t i = 1; i <= FILL + 2 + TAIL; i++) {
+        size_t len = i == FILL + 1 ? 1004 : sizeof(payload);
+        memset(payload, (int)(i & 0xff), sizeof(payload));
+        ck_assert_uint_ne(om_wal_append_custom(&wal, (OmWalType)OM_WAL_USER_BASE, payload, len), 0);
+    }
+    ck_assert_int_eq(om_wal_flush(&wal), 0);
+    om_wal_close(&wal);
+
+    OmWalReplay replay;
+    ck_assert_int_eq(om_wal_replay_init_with_config(&replay, TEST_WAL_FILE, &wal_config), 0);
+
+    OmWalType type;
+    void *data;
+    uint64_t sequence;
+    size_t data_len;
+    uint64_t seen = 0;
+    int ret;
+    while ((ret = om_wal_replay_next(&replay, &type, &data, &sequence, &data_len)) == 1) {
+        seen++;
+        ck_assert_uint_eq(sequence, seen);
+        if (sequence == straddle) {
+            ck_assert_uint_eq(replay.last_record_offset, boundary - sizeof(OmWalHeader));
+        }
+        const uint8_t *p = data;
+        ck_assert_uint_eq(p[0], sequence & 0xff);
+        ck_assert_uint_eq(p[data_len - 1], sequence & 0xff);
+    }
+    ck_assert_int_eq(ret, 0);
+    ck_assert_uint_eq(seen, FILL + 2 + TAIL);
+
+    om_wal_replay_close(&replay);
+    cleanup_wal_file();
+}
+END_TEST
+
+/* Byte ranges split at om_wal_replay_seek_offset boundaries cover every record once */
+START_TEST(test_wal_replay_seek_offset)
+{
+    cleanup_wal_file();
+
+    OmWalConfig wal_config = {
+        .filename = TEST_WAL_FILE,
+        .buffer_size = 64 * 1024,
+        .sync_interval_ms = 0,
+        .use_direct_io = false,
+        .user_data_size = 0,
+        .aux_data_size = 0
+    };
+
+    OmWal wal;
+    ck_assert_int_eq(om_wal_init(&wal, &wal_config), 0);
+    const uint64_t total = 100000;
+    for (uint64_t i = 1; i <= total; i++) {
+        if (i % 3 == 0) {
+            ck_assert_uint_ne(om_wal_cancel(&wal, (uint32_t)i, (uint32_t)i, 1), 0);
+        } else {
+            OmWalMatch match = {
+                .maker_id = i,
+                .taker_id = i + 1,
+                .price = 100,
+                .volume = 1,
+                .product_id = 1
+            };
+            ck_assert_uint_ne(om_wal_match(&wal, &match), 0);
+        }
+        if (i % 499 == 0) {
+            ck_assert_int_eq(om_wal_flush(&wal), 0);
+        }
+    }
+    om_wal_close(&wal);
+
+    enum { PARTS = 3 };
+    uint64_t bounds[PARTS + 1];
+    OmWalReplay replay;
+    ck_assert_int_eq(om_wal_replay_init_with_config(&replay, TEST_WAL_FILE, &wal_config), 0);
+    /* Several 1MB refills per range, starting off the 4KB grid */
+    ck_assert_uint_gt(replay.file_size, PARTS * 1024 * 1024);
+    uint64_t file_size = replay.file_size;
+    bounds[0] = 0;
+    bounds[PARTS] = file_size;
+    for (int k = 1; k < PARTS; k++) {
+        uint64_t seq = 0;
+        ck_assert_int_eq(om_wal_replay_seek_offset(&replay, file_size * k / PARTS + 13,
+                                                   &bounds[k], &seq), 1);
+        ck_assert_uint_ge(bounds[k], file_size * k / PARTS + 13);
+        ck_assert_uint_gt(seq, 1);
+    }
+    uint64_t off = 0;
+    uint64_t seq = 1;
+    ck_assert_int_eq(om_wal_replay_seek_offset(&replay, file_size, &off, &seq), 0);
+    ck_assert_uint_eq(off, file_size);
+    ck_assert_uint_eq(seq, 0);
+    om_wal_replay_close(&replay);
+
+    uint64_t expect = 1;
+    for (int k = 0; k < PARTS; k++) {
+        ck_assert_int_eq(om_wal_replay_init_with_config(&replay, TEST_WAL_FILE, &wal_config), 0);
+        if (bounds[k] > 0) {
+            ck_assert_int_eq(om_wal_replay_seek_offset(&replay, bounds[k], &off, NULL), 1);
+            ck_assert_uint_eq(off, bounds[k]);
+        }
+        OmWalType type;
+        void *data;
+        size_t data_len;
+        int ret;
+        while ((ret = om_wal_replay_next(&replay, &type, &data, &seq, &data_len)) == 1 &&
+               replay.last_record_offset < bounds[k + 1]) {
+            ck_assert_uint_eq(seq, expect);
+            expect++;
+        }
+        ck_assert_int_ge(ret, 0);
+        om_wal_replay_close(&replay);
+    }
+    ck_assert_uint_eq(expect, total + 1);
+
+    cleanup_wal_file();
+}
+END_TEST
+
 START_TEST(test_wal_match_recovery_from_engine)
 {
     cleanup_wal_file();
@@ -804,6 +1138,123 @@ START_TEST(test_wal_timestamp_populated)
 }
 END_TEST
 
+static uint64_t test_fake_clock(void *ctx)
+{
+    uint64_t *now = (uint64_t *)ctx;
+    return (*now)++;
+}
+
+START_TEST(test_wal_set_clock)
+{
+    cleanup_wal_file();
+
+    OmSlabConfig config = {
+        .user_data_size = 32,
+        .aux_data_size = 64,
+        .total_slots = 1000
+    };
+
+    OmWalConfig wal_config = {
+        .filename = TEST_WAL_FILE,
+        .buffer_size = 64 * 1024,
+        .sync_interval_ms = 0,
+        .use_direct_io = false,
+        .user_data_size = 32,
+        .aux_data_size = 64
+    };
+
+    OmWal wal;
+    ck_assert_int_eq(om_wal_init(&wal, &wal_config), 0);
+
+    OmOrderbookContext ctx;
+    ck_assert_int_eq(om_orderbook_init(&ctx, &config, &wal, 10, 100, 0), 0);
+
+    uint64_t fake_now = 1000;
+    om_wal_set_clock(&wal, test_fake_clock, &fake_now);
+
+    uint32_t order_id = om_slab_next_order_id(&ctx.slab);
+    OmSlabSlot *slot = om_slab_alloc(&ctx.slab);
+    om_slot_set_order_id(slot, order_id);
+    om_slot_set_price(slot, 10000);
+    om_slot_set_volume(slot, 100);
+    om_slot_set_volume_remain(slot, 100);
+    om_slot_set_flags(slot, OM_SIDE_BID | OM_TYPE_LIMIT);
+    ck_assert_int_eq(om_orderbook_insert(&ctx, 0, slot), 0);
+
+    ck_assert_uint_ne(om_wal_deactivate(&wal, order_id, 0, 0), 0);
+    ck_assert_uint_ne(om_wal_activate(&wal, order_id, 0, 0), 0);
+    ck_assert_uint_ne(om_wal_cancel(&wal, order_id, 0, 0), 0);
+    ck_assert_uint_eq(fake_now, 1004);
+
+    /* NULL goes back to CLOCK_MONOTONIC */
+    om_wal_set_clock(&wal, NULL, NULL);
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t mono_before = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    ck_assert_uint_ne(om_wal_cancel(&wal, order_id + 1, 0, 0), 0);
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t mono_after = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    ck_assert_uint_eq(fake_now, 1004);
+
+    om_wal_flush(&wal);
+    om_wal_close(&wal);
+    om_orderbook_destroy(&ctx);
+
+    OmWalReplay replay;
+    ck_assert_int_eq(om_wal_replay_init_with_config(&replay, TEST_WAL_FILE, &wal_config), 0);
+
+    const OmWalType expect[] = {
+        OM_WAL_INSERT, OM_WAL_DEACTIVATE, OM_WAL_ACTIVATE, OM_WAL_CANCEL, OM_WAL_CANCEL
+    };
+    OmWalType type;
+    void *data;
+    uint64_t sequence;
+    size_t data_len;
+
+    for (size_t i = 0; i < sizeof(expect) / sizeof(expect[0]); i++) {
+        ck_assert_int_eq(om_wal_replay_next(&replay, &type, &data, &sequence, &data_len), 1);
+        ck_assert_int_eq(type, expect[i]);
+
+        uint64_t stamp = 0;
+        switch (type) {
+            case OM_WAL_INSERT: {
+                OmWalInsert rec;
+                memcpy(&rec, data, sizeof(rec));
+                stamp = rec.timestamp_ns;
+                break;
+            }
+            case OM_WAL_DEACTIVATE: {
+                OmWalDeactivate rec;
+                memcpy(&rec, data, sizeof(rec));
+                stamp = rec.timestamp_ns;
+                break;
+            }
+            case OM_WAL_ACTIVATE: {
+                OmWalActivate rec;
+                memcpy(&rec, data, sizeof(rec));
+                stamp = rec.timestamp_ns;
+                break;
+            }
+            default: {
+                OmWalCancel rec;
+                memcpy(&rec, data, sizeof(rec));
+                stamp = rec.timestamp_ns;
+                break;
+            }
+        }
+        if (i < 4) {
+            ck_assert_uint_eq(stamp, 1000 + i);
+        } else {
+            ck_assert_uint_ge(stamp, mono_before);
+            ck_assert_uint_le(stamp, mono_after);
+        }
+    }
+
+    om_wal_replay_close(&replay);
+    cleanup_wal_file();
+}
+END_TEST
+
 Suite *wal_suite(void)
 {
     Suite *s = suite_create("WAL");
@@ -815,7 +1266,13 @@ Suite *wal_suite(void)
     tcase_add_test(tc_core, test_wal_crc32_mismatch);
     tcase_add_test(tc_core, test_wal_aux_data_persistence);
     tcase_add_test(tc_core, test_wal_timestamp_populated);
+    tcase_add_test(tc_core, test_wal_set_clock);
     tcase_add_test(tc_core, test_wal_match_replay);
+    tcase_add_test(tc_core, test_wal_replay_across_flushes);
+    tcase_add_test(tc_core, test_wal_replay_short_padding);
+    tcase_add_test(tc_core, test_wal_replay_seek);
+    tcase_add_test(tc_core, test_wal_replay_refill_boundary);
+    tcase_add_test(tc_core, test_wal_replay_seek_offset);
     tcase_add_test(tc_core, test_wal_match_recovery_from_engine);
     tcase_add_test(tc_core, test_wal_deactivate_activate_recovery);
     tcase_add_test(tc_core, test_wal_custom_record_replay);
@@ -0,0 +1,436 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include "openmatch/om_wal.h"
+#include "openmatch/om_colfile.h"
+#include "openmatch/om_error.h"
+
+/*
+ * Convert WAL files into a columnar file (include/openmatch/om_colfile.h):
+ * one table per record type, one column per record field plus seq.
+ */
+
+typedef enum ExportTable {
+    TABLE_INSERT = 0,
+    TABLE_CANCEL,
+    TABLE_MATCH,
+    TABLE_DEACTIVATE,
+    TABLE_ACTIVATE,
+    TABLE_COUNT
+} ExportTable;
+
+static const OmColColumnDef insert_columns[] = {
+    {"seq", OM_COL_U64},
+    {"timestamp_ns", OM_COL_U64},
+    {"order_id", OM_COL_U64},
+    {"price", OM_COL_U64},
+    {"volume", OM_COL_U64},
+    {"vol_remain", OM_COL_U64},
+    {"org", OM_COL_U16},
+    {"flags", OM_COL_U16},
+    {"product_id", OM_COL_U16},
+};
+
+/* CANCEL, DEACTIVATE and ACTIVATE share one layout */
+static const OmColColumnDef cancel_columns[] = {
+    {"seq", OM_COL_U64},
+    {"timestamp_ns", OM_COL_U64},
+    {"order_id", OM_COL_U64},
+    {"slot_idx", OM_COL_U32},
+    {"product_id", OM_COL_U16},
+};
+
+static const OmColColumnDef match_columns[] = {
+    {"seq", OM_COL_U64},
+    {"timestamp_ns", OM_COL_U64},
+    {"maker_id", OM_COL_U64},
+    {"taker_id", OM_COL_U64},
+    {"price", OM_COL_U64},
+    {"volume", OM_COL_U64},
+    {"product_id", OM_COL_U16},
+};
+
+#define COLUMNS(a) a, (uint32_t)(sizeof(a) / sizeof((a)[0]))
+
+typedef struct Exporter {
+    OmColWriter *writer;
+    int table[TABLE_COUNT];
+    uint64_t rows[TABLE_COUNT];
+
+    /* Filters */
+    bool has_seq;
+    uint64_t seq_from;
+    uint64_t seq_to;
+    bool has_time;
+    uint64_t time_from_ns;
+    uint64_t time_to_ns;
+
+    bool no_crc;
+    bool strict;
+
+    uint64_t first_seq;
+    uint64_t last_seq;
+    uint64_t scanned;
+    uint64_t exported;
+    uint64_t skipped;           /* checkpoint / user / short records */
+    uint64_t crc_errors;
+    bool past_range;            /* seq passed seq_to: later files are newer */
+} Exporter;
+
+/* Parse "from-to" sequence range, e.g. "100-200" */
+static bool parse_u64_token(const char *s, size_t len, uint64_t *out) {
+    if (!s || !out || len == 0 || len >= 32) {
+        return false;
+    }
+    char buf[32];
+    memcpy(buf, s, len);
+    buf[len] = '\0';
+
+    errno = 0;
+    char *end = NULL;
+    unsigned long long v = strtoull(buf, &end, 10);
+    if (errno != 0 || end == buf || *end != '\0') {
+        return false;
+    }
+    *out = (uint64_t)v;
+    return true;
+}
+
+static bool parse_seq_range(const char *arg, uint64_t *from, uint64_t *to) {
+    const char *dash = strchr(arg, '-');
+    if (!dash || dash == arg) {
+        return false;
+    }
+    if (!parse_u64_token(arg, (size_t)(dash - arg), from) ||
+        !parse_u64_token(dash + 1, strlen(dash + 1), to)) {
+        return false;
+    }
+    return *from <= *to;
+}
+
+/* Parse YYYYMMDDHHMMSS (local time) to nanoseconds since epoch */
+static bool parse_time_str(const char *str, uint64_t *out_ns) {
+    char buf[15];
+    memcpy(buf, str, 14);
+    buf[14] = '\0';
+
+    int year, mon, mday, hour, min, sec;
+    if (sscanf(buf, "%4d%2d%2d%2d%2d%2d", &year, &mon, &mday, &hour, &min, &sec) != 6) {
+        return false;
+    }
+    if (mon < 1 || mon > 12 || mday < 1 || mday > 31 ||
+        hour < 0 || hour > 23 || min < 0 || min > 59 || sec < 0 || sec > 59) {
+        return false;
+    }
+    struct tm tm_val;
+    memset(&tm_val, 0, sizeof(tm_val));
+    tm_val.tm_year = year - 1900;
+    tm_val.tm_mon = mon - 1;
+    tm_val.tm_mday = mday;
+    tm_val.tm_hour = hour;
+    tm_val.tm_min = min;
+    tm_val.tm_sec = sec;
+    tm_val.tm_isdst = -1;
+
+    time_t t = mktime(&tm_val);
+    if (t == (time_t)-1) {
+        return false;
+    }
+    struct tm check_tm;
+    if (localtime_r(&t, &check_tm) == NULL || check_tm.tm_mday != mday ||
+        check_tm.tm_mon + 1 != mon || check_tm.tm_year + 1900 != year) {
+        return false;
+    }
+    *out_ns = (uint64_t)t * 1000000000ULL;
+    return true;
+}
+
+/* Parse "YYYYMMDDHHMMSS-YYYYMMDDHHMMSS" time range, inclusive */
+static bool parse_time_range(const char *arg, uint64_t *from_ns, uint64_t *to_ns) {
+    if (strlen(arg) != 29 || arg[14] != '-') {
+        return false;
+    }
+    if (!parse_time_str(arg, from_ns) || !parse_time_str(arg + 15, to_ns)) {
+        return false;
+    }
+    *to_ns += 999999999ULL;
+    return *from_ns <= *to_ns;
+}
+
+/* Append one record to its table; returns false on a write error */
+static bool export_record(Exporter *e, uint64_t seq, OmWalType type,
+                          const void *data, size_t len) {
+    uint64_t v[OM_COL_MAX_COLUMNS];
+    ExportTable table;
+    uint64_t ts;
+
+    switch (type) {
+        case OM_WAL_INSERT: {
+            if (len < sizeof(OmWalInsert)) {
+                e->skipped++;
+                return true;
+            }
+            OmWalInsert rec;
+            memcpy(&rec, data, sizeof(rec));
+            table = TABLE_INSERT;
+            ts = rec.timestamp_ns;
+            v[2] = rec.order_id;
+            v[3] = rec.price;
+            v[4] = rec.volume;
+            v[5] = rec.vol_remain;
+            v[6] = rec.org;
+            v[7] = rec.flags;
+            v[8] = rec.product_id;
+            break;
+        }
+        case OM_WAL_CANCEL:
+        case OM_WAL_DEACTIVATE:
+        case OM_WAL_ACTIVATE: {
+            if (len != sizeof(OmWalCancel)) {
+                e->skipped++;
+                return true;
+            }
+            OmWalCancel rec;
+            memcpy(&rec, data, sizeof(rec));
+            table = type == OM_WAL_CANCEL ? TABLE_CANCEL
+                  : type == OM_WAL_DEACTIVATE ? TABLE_DEACTIVATE : TABLE_ACTIVATE;
+            ts = rec.timestamp_ns;
+            v[2] = rec.order_id;
+            v[3] = rec.slot_idx;
+            v[4] = rec.product_id;
+            break;
+        }
+        case OM_WAL_MATCH: {
+            if (len != sizeof(OmWalMatch)) {
+                e->skipped++;
+                return true;
+            }
+            OmWalMatch rec;
+            memcpy(&rec, data, sizeof(rec));
+            table = TABLE_MATCH;
+            ts = rec.timestamp_ns;
+            v[2] = rec.maker_id;
+            v[3] = rec.taker_id;
+            v[4] = rec.price;
+            v[5] = rec.volume;
+            v[6] = rec.product_id;
+            break;
+        }
+        default:
+            e->skipped++;
+            return true;
+    }
+
+    if (e->has_time && (ts < e->time_from_ns || ts > e->time_to_ns)) {
+        return true;
+    }
+    v[0] = seq;
+    v[1] = ts;
+    int rc = om_col_writer_append(e->writer, (uint32_t)e->table[table], v);
+    if (rc != 0) {
+        fprintf(stderr, "write failed at seq=%" PRIu64 " (%s)\n", seq,
+                om_error_string((OmError)rc));
+        return false;
+    }
+    if (e->exported == 0) {
+        e->first_seq = seq;
+    }
+    e->last_seq = seq;
+    e->exported++;
+    e->rows[table]++;
+    return true;
+}
+
+/* Export one file; returns false on a read or write error */
+static bool export_file(Exporter *e, const char *path) {
+    OmWalReplay replay;
+    if (om_wal_replay_init(&replay, path) != 0) {
+        fprintf(stderr, "failed to open wal: %s\n", path);
+        return false;
+    }
+    if (e->no_crc) {
+        replay.enable_crc32 = false;
+    }
+    if (e->has_seq && e->seq_from > 1 && om_wal_replay_seek(&replay, e->seq_from) != 0) {
+        fprintf(stderr, "seek to seq %" PRIu64 " failed in %s\n", e->seq_from, path);
+        om_wal_replay_close(&replay);
+        return false;
+    }
+
+    OmWalType type;
+    void *data;
+    uint64_t sequence;
+    size_t data_len;
+    bool ok = true;
+    while (1) {
+        int ret = om_wal_replay_next(&replay, &type, &data, &sequence, &data_len);
+        if (ret == 0) {
+            break;
+        }
+        if (ret == OM_ERR_WAL_CRC_MISMATCH) {
+            e->crc_errors++;
+            fprintf(stderr, "CRC mismatch at seq=%" PRIu64 " in %s\n", sequence, path);
+            if (e->strict) {
+                ok = false;
+                break;
+            }
+            continue;
+        }
+        if (ret < 0) {
+            fprintf(stderr, "error reading wal %s (ret=%d)\n", path, ret);
+            ok = false;
+            break;
+        }
+        e->scanned++;
+        if (e->has_seq) {
+            if (sequence < e->seq_from) {
+                continue;
+            }
+            if (sequence > e->seq_to) {
+                e->past_range = true;
+                break;
+            }
+        }
+        if (!export_record(e, sequence, type, data, data_len)) {
+            ok = false;
+            break;
+        }
+    }
+    om_wal_replay_close(&replay);
+    return ok;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options] -o <out_file> <wal_file> [wal_file ...]\n"
+        "\n"
+        "Convert WAL files to a columnar file for analytics.\n"
+        "\n"
+        "options:\n"
+        "  -o path      Output columnar file (required)\n"
+        "  -s from-to   Export sequences from..to (inclusive)\n"
+        "  -r from-to   Export timestamps YYYYMMDDHHMMSS-YYYYMMDDHHMMSS (local)\n"
+        "  -n rows      Rows per chunk (default %u)\n"
+        "  -C           WAL written without CRC32\n"
+        "  -c           Stop at the first CRC error (default: skip and count)\n"
+        "\n"
+        "Tables: insert, cancel, match, deactivate, activate. Every table has\n"
+        "seq and timestamp_ns columns followed by the record's fields.\n"
+        "Files are read in the order given and should be in sequence order.\n",
+        prog, OM_COL_DEFAULT_CHUNK_ROWS);
+}
+
+int main(int argc, char **argv) {
+    static Exporter exporter;
+    Exporter *e = &exporter;
+    const char *out_path = NULL;
+    uint64_t chunk_rows = OM_COL_DEFAULT_CHUNK_ROWS;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "o:s:r:n:Cc")) != -1) {
+        switch (opt) {
+            case 'o':
+                out_path = optarg;
+                break;
+            case 's':
+                if (!parse_seq_range(optarg, &e->seq_from, &e->seq_to)) {
+                    fprintf(stderr, "invalid sequence range: %s\n", optarg);
+                    return 2;
+                }
+                e->has_seq = true;
+                break;
+            case 'r':
+                if (!parse_time_range(optarg, &e->time_from_ns, &e->time_to_ns)) {
+                    fprintf(stderr, "invalid time range: %s\n", optarg);
+                    return 2;
+                }
+                e->has_time = true;
+                break;
+            case 'n':
+                if (!parse_u64_token(optarg, strlen(optarg), &chunk_rows) ||
+                    chunk_rows == 0 || chunk_rows > (1U << 24)) {
+                    fprintf(stderr, "invalid chunk rows: %s (1..16777216)\n", optarg);
+                    return 2;
+                }
+                break;
+            case 'C':
+                e->no_crc = true;
+                break;
+            case 'c':
+                e->strict = true;
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if (!out_path || optind >= argc) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    int rc = om_col_writer_create(&e->writer, out_path, (uint32_t)chunk_rows);
+    if (rc != 0) {
+        fprintf(stderr, "failed to create %s (%s)\n", out_path, om_error_string((OmError)rc));
+        return 1;
+    }
+    static const char *const names[TABLE_COUNT] = {
+        "insert", "cancel", "match", "deactivate", "activate"
+    };
+    e->table[TABLE_INSERT] = om_col_writer_add_table(e->writer, names[TABLE_INSERT],
+                                                     COLUMNS(insert_columns));
+    e->table[TABLE_CANCEL] = om_col_writer_add_table(e->writer, names[TABLE_CANCEL],
+                                                     COLUMNS(cancel_columns));
+    e->table[TABLE_MATCH] = om_col_writer_add_table(e->writer, names[TABLE_MATCH],
+                                                    COLUMNS(match_columns));
+    e->table[TABLE_DEACTIVATE] = om_col_writer_add_table(e->writer, names[TABLE_DEACTIVATE],
+                                                         COLUMNS(cancel_columns));
+    e->table[TABLE_ACTIVATE] = om_col_writer_add_table(e->writer, names[TABLE_ACTIVATE],
+                                                       COLUMNS(cancel_columns));
+    for (int i = 0; i < TABLE_COUNT; i++) {
+        if (e->table[i] < 0) {
+            fprintf(stderr, "failed to add table %s (%s)\n", names[i],
+                    om_error_string((OmError)e->table[i]));
+            om_col_writer_close(e->writer);
+            return 1;
+        }
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int exit_code = 0;
+    for (int fi = optind; fi < argc && !e->past_range; fi++) {
+        if (!export_file(e, argv[fi])) {
+            exit_code = 1;
+            break;
+        }
+    }
+
+    om_col_writer_set_seq_range(e->writer, e->first_seq, e->last_seq);
+    rc = om_col_writer_close(e->writer);
+    if (rc != 0) {
+        fprintf(stderr, "failed to finish %s (%s)\n", out_path, om_error_string((OmError)rc));
+        exit_code = 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double secs = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    fprintf(stderr,
+            "export scanned[%" PRIu64 "] exported[%" PRIu64 "] seq_first[%" PRIu64 "] "
+            "seq_last[%" PRIu64 "] skipped[%" PRIu64 "] crc_errors[%" PRIu64 "] "
+            "secs[%.3f] records_per_s[%.0f]\n",
+            e->scanned, e->exported, e->first_seq, e->last_seq, e->skipped, e->crc_errors,
+            secs, secs > 0 ? (double)e->scanned / secs : 0.0);
+    for (int i = 0; i < TABLE_COUNT; i++) {
+        fprintf(stderr, "table name[%s] rows[%" PRIu64 "]\n", names[i], e->rows[i]);
+    }
+    if (e->crc_errors > 0) {
+        exit_code = 1;
+    }
+    return exit_code;
+}
@@ -9,6 +9,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <time.h>
+#include <math.h>
 #include "openmatch/om_wal.h"
 #include "openmatch/om_slab.h"
 #include "openmatch/orderbook.h"
@@ -58,6 +59,413 @@ static uint64_t rng_range(uint64_t lo, uint64_t hi) {
     return lo + rng_next() % (hi - lo + 1);
 }
 
+/* Uniform double in [0, 1) */
+static double rng_unit(void) {
+    return (double)(rng_next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* Standard normal (Box-Muller) */
+static double rng_normal(void) {
+    double u1 = 1.0 - rng_unit();
+    double u2 = rng_unit();
+    return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+/* Pareto-tailed integer in [1, max]: P(X > x) ~ x^-alpha */
+static uint64_t rng_power_law(double alpha, uint64_t max) {
+    double x = pow(1.0 - rng_unit(), -1.0 / alpha);
+    return x >= (double)max ? max : (uint64_t)x;
+}
+
+/*
+ * Market workload (-w market).
+ *
+ * - Each product has a mid that mean-reverts to its anchor (discrete
+ *   Ornstein-Uhlenbeck step per event on that product).
+ * - Products are drawn from a Zipf distribution: product 0 is the busiest.
+ * - Orgs 1..orgs/8 are market makers. A quote event cancels a burst of the
+ *   maker's orders on the product and reposts as many near the touch.
+ * - Other orgs post passive orders at a power-law distance from the touch,
+ *   cancel, or aggress (-a percent of their new orders). An aggressor sweeps
+ *   the opposite side in price-time order, writing MATCH records, then rests
+ *   its remainder (INSERT after the matches, like the engine) or drops it.
+ * - Timestamps follow a U-shaped intraday rate (busy open and close, lunch
+ *   lull) over a session of -d seconds starting at -t.
+ *
+ * Passive orders never cross, so the log is a consistent price-time book.
+ * DEACTIVATE / ACTIVATE are not generated.
+ */
+typedef enum WalMakerWorkload {
+    WORKLOAD_UNIFORM = 0,
+    WORKLOAD_MARKET
+} WalMakerWorkload;
+
+typedef struct MarketProfile {
+    int orgs;               /* -o: orgs, the first orgs/8 quote */
+    int aggress_pct;        /* -a: percent of non-quoting new orders that cross */
+    double zipf_s;          /* -z: product popularity exponent */
+    uint32_t session_s;     /* -d: session length in seconds */
+    uint64_t start_s;       /* -t: session start, epoch seconds */
+    int depth;              /* -k: orders per side before the farthest is cancelled */
+} MarketProfile;
+
+#define MARKET_ANCHOR 10000.0   /* mid anchor in ticks */
+#define MARKET_REVERT 0.02      /* OU pull towards the anchor per event */
+#define MARKET_SIGMA 0.6        /* OU noise per event, ticks */
+#define MARKET_QUOTE_PCT 40     /* events that are maker quote bursts */
+#define MARKET_CANCEL_PCT 25    /* non-quote events that cancel */
+#define MARKET_QUOTE_ALPHA 2.5  /* maker distance to touch, steep */
+#define MARKET_QUOTE_MAX 10
+#define MARKET_PASSIVE_ALPHA 1.2 /* other passive orders, heavy tail */
+#define MARKET_PASSIVE_MAX 500
+#define MARKET_BURST_MAX 8
+#define MARKET_RATE_POINTS 1024
+
+typedef struct MarketOrder {
+    uint32_t oid;
+    uint32_t slot_idx;
+    uint64_t price;
+    uint64_t remain;
+    uint64_t stamp;         /* time priority */
+    uint16_t org;
+} MarketOrder;
+
+typedef struct MarketSide {
+    MarketOrder *o;
+    size_t n;
+    size_t cap;
+} MarketSide;
+
+typedef struct MarketProduct {
+    double mid;
+    MarketSide side[2];     /* 0 = bids, 1 = asks */
+} MarketProduct;
+
+typedef struct MarketState {
+    const MarketProfile *mp;
+    OmWal *wal;
+    OmOrderbookContext *ctx;
+    MarketProduct *products;
+    double *zipf_cdf;
+    double rate_cdf[MARKET_RATE_POINTS + 1];
+    int n_products;
+    int n_quoters;
+    uint64_t stamp;
+    uint64_t budget;        /* records left to write */
+    double arrivals;        /* unit-rate Poisson time, in events */
+    uint64_t events;
+    uint64_t now_ns;
+    int *counts;
+} MarketState;
+
+static uint64_t market_clock(void *ctx) {
+    return ((const MarketState *)ctx)->now_ns;
+}
+
+/* Relative intraday rate at session fraction x */
+static double market_rate(double x) {
+    double d = (x - 0.5) / 0.08;
+    return 1.0 + 3.0 * exp(-x / 0.05) + 2.0 * exp(-(1.0 - x) / 0.05) - 0.4 * exp(-d * d);
+}
+
+/* Inverse of the normalized cumulative rate, by table lookup */
+static double market_rate_inverse(const MarketState *m, double u) {
+    size_t lo = 0;
+    size_t hi = MARKET_RATE_POINTS;
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (m->rate_cdf[mid] <= u) lo = mid; else hi = mid;
+    }
+    double span = m->rate_cdf[hi] - m->rate_cdf[lo];
+    double f = span > 0.0 ? (u - m->rate_cdf[lo]) / span : 0.0;
+    return ((double)lo + f) / MARKET_RATE_POINTS;
+}
+
+/*
+ * Advance the clock to the next event. Arrivals are unit-rate Poisson in
+ * "events", mapped through the rate curve over the expected event count
+ * (records left / records per event so far).
+ */
+static void market_next_event(MarketState *m, uint64_t written) {
+    m->arrivals += -log(1.0 - rng_unit());
+    m->events++;
+    double per_event = written > 0 ? (double)written / (double)m->events : 1.0;
+    double expected = (double)(written + m->budget) / per_event;
+    double u = expected > 0.0 ? m->arrivals / expected : 1.0;
+    if (u > 1.0) u = 1.0;
+    uint64_t t = m->mp->start_s * 1000000000ULL +
+                 (uint64_t)(market_rate_inverse(m, u) * m->mp->session_s * 1e9);
+    if (t > m->now_ns) {
+        m->now_ns = t;
+    }
+}
+
+static int market_pick_product(const MarketState *m) {
+    double u = rng_unit();
+    int lo = 0;
+    int hi = m->n_products - 1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (m->zipf_cdf[mid] > u) hi = mid; else lo = mid + 1;
+    }
+    return lo;
+}
+
+static bool market_side_push(MarketSide *s, const MarketOrder *o) {
+    if (s->n == s->cap) {
+        size_t cap = s->cap ? s->cap * 2 : 64;
+        MarketOrder *p = realloc(s->o, cap * sizeof(*p));
+        if (!p) return false;
+        s->o = p;
+        s->cap = cap;
+    }
+    s->o[s->n++] = *o;
+    return true;
+}
+
+static void market_side_remove(MarketState *m, MarketSide *s, size_t i) {
+    om_slab_free(&m->ctx->slab, om_slot_from_idx(&m->ctx->slab, s->o[i].slot_idx));
+    s->o[i] = s->o[--s->n];
+}
+
+/* Best order of a side (highest bid / lowest ask, then oldest), SIZE_MAX if empty */
+static size_t market_best(const MarketSide *s, int side) {
+    size_t best = SIZE_MAX;
+    for (size_t i = 0; i < s->n; i++) {
+        const MarketOrder *o = &s->o[i];
+        if (best == SIZE_MAX) { best = i; continue; }
+        const MarketOrder *b = &s->o[best];
+        bool better = side == 0 ? o->price > b->price : o->price < b->price;
+        if (better || (o->price == b->price && o->stamp < b->stamp)) best = i;
+    }
+    return best;
+}
+
+static size_t market_worst(const MarketSide *s, int side) {
+    size_t worst = SIZE_MAX;
+    for (size_t i = 0; i < s->n; i++) {
+        if (worst == SIZE_MAX ||
+            (side == 0 ? s->o[i].price < s->o[worst].price : s->o[i].price > s->o[worst].price)) {
+            worst = i;
+        }
+    }
+    return worst;
+}
+
+static void market_cancel(MarketState *m, uint16_t pid, int side, size_t i) {
+    MarketSide *s = &m->products[pid].side[side];
+    om_wal_cancel(m->wal, s->o[i].oid, s->o[i].slot_idx, pid);
+    market_side_remove(m, s, i);
+    m->counts[1]++;
+    m->budget--;
+}
+
+/* Write an INSERT and rest it on the book */
+static bool market_rest(MarketState *m, uint16_t pid, int side, uint32_t oid,
+                        uint64_t price, uint64_t volume, uint64_t remain, uint16_t org) {
+    OmSlabSlot *slot = om_slab_alloc(&m->ctx->slab);
+    if (!slot) {
+        return false;
+    }
+    slot->order_id = oid;
+    slot->price = price;
+    slot->volume = volume;
+    slot->volume_remain = remain;
+    slot->org = org;
+    slot->flags = side == 0 ? OM_SIDE_BID : OM_SIDE_ASK;
+    om_wal_insert(m->wal, slot, pid);
+    MarketOrder o = {
+        .oid = oid,
+        .slot_idx = om_slot_get_idx(&m->ctx->slab, slot),
+        .price = price,
+        .remain = remain,
+        .stamp = ++m->stamp,
+        .org = org,
+    };
+    m->counts[0]++;
+    m->budget--;
+    if (!market_side_push(&m->products[pid].side[side], &o)) {
+        om_slab_free(&m->ctx->slab, slot);
+        return false;
+    }
+    return true;
+}
+
+/* Passive price `dist` ticks (1 = at the touch) behind the mid, never crossing */
+static uint64_t market_passive_price(const MarketState *m, uint16_t pid, int side, uint64_t dist) {
+    const MarketProduct *p = &m->products[pid];
+    double mid = p->mid;
+    uint64_t price = side == 0 ? (uint64_t)ceil(mid) - dist : (uint64_t)floor(mid) + dist;
+    const MarketSide *opp = &p->side[side ^ 1];
+    size_t best = market_best(opp, side ^ 1);
+    if (best != SIZE_MAX) {
+        uint64_t touch = opp->o[best].price;
+        if (side == 0 && price >= touch) price = touch - 1;
+        if (side == 1 && price <= touch) price = touch + 1;
+    }
+    return price;
+}
+
+static bool market_passive(MarketState *m, uint16_t pid, int side, uint16_t org,
+                           double alpha, uint64_t max_dist, uint64_t volume) {
+    MarketSide *s = &m->products[pid].side[side];
+    if (s->n >= (size_t)m->mp->depth * 2 && m->budget > 1) {
+        market_cancel(m, pid, side, market_worst(s, side));
+    }
+    uint64_t price = market_passive_price(m, pid, side, rng_power_law(alpha, max_dist));
+    return market_rest(m, pid, side, om_slab_next_order_id(&m->ctx->slab), price,
+                       volume, volume, org);
+}
+
+/* Sweep the opposite side up to `limit`; rest or drop what is left */
+static bool market_aggress(MarketState *m, uint16_t pid, int side, uint16_t org) {
+    MarketSide *opp = &m->products[pid].side[side ^ 1];
+    size_t best = market_best(opp, side ^ 1);
+    if (best == SIZE_MAX) {
+        return market_passive(m, pid, side, org, MARKET_PASSIVE_ALPHA, MARKET_QUOTE_MAX,
+                              rng_power_law(1.5, 200));
+    }
+    uint64_t through = rng_power_law(2.0, 5) - 1;
+    uint64_t limit = side == 0 ? opp->o[best].price + through : opp->o[best].price - through;
+    uint64_t volume = rng_power_law(1.1, 500);
+    uint64_t remain = volume;
+    uint32_t taker = om_slab_next_order_id(&m->ctx->slab);
+
+    while (remain > 0 && m->budget > 0 && best != SIZE_MAX) {
+        MarketOrder *mk = &opp->o[best];
+        if (side == 0 ? mk->price > limit : mk->price < limit) {
+            break;
+        }
+        uint64_t fill = remain < mk->remain ? remain : mk->remain;
+        OmWalMatch match = {
+            .maker_id = mk->oid,
+            .taker_id = taker,
+            .price = mk->price,
+            .volume = fill,
+            .timestamp_ns = m->now_ns,
+            .product_id = pid,
+        };
+        om_wal_match(m->wal, &match);
+        m->counts[2]++;
+        m->budget--;
+        remain -= fill;
+        mk->remain -= fill;
+        if (mk->remain == 0) {
+            market_side_remove(m, opp, best);
+        }
+        best = market_best(opp, side ^ 1);
+    }
+    /* Half of the takers are limit orders that rest their remainder */
+    if (remain > 0 && m->budget > 0 && (rng_next() & 1)) {
+        return market_rest(m, pid, side, taker, limit, volume, remain, org);
+    }
+    return true;
+}
+
+/* Maker requote: cancel a burst of its orders on the product, repost near the touch */
+static bool market_quote(MarketState *m, uint16_t pid, uint16_t org) {
+    int burst = 1;
+    while (burst < MARKET_BURST_MAX && (rng_next() % 3) != 0) burst++;
+    for (int side = 0; side < 2; side++) {
+        MarketSide *s = &m->products[pid].side[side];
+        for (size_t i = s->n; i-- > 0 && burst > 0 && m->budget > 1;) {
+            if (s->o[i].org == org) {
+                market_cancel(m, pid, side, i);
+                burst--;
+            }
+        }
+    }
+    int reposts = 1 + (int)(rng_next() % MARKET_BURST_MAX);
+    for (int k = 0; k < reposts && m->budget > 0; k++) {
+        if (!market_passive(m, pid, k & 1, org, MARKET_QUOTE_ALPHA, MARKET_QUOTE_MAX,
+                            rng_range(1, 20) * 10)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int generate_market(OmWal *wal, OmOrderbookContext *ctx, const MarketProfile *mp,
+                           int n_records, int n_products, int counts[6]) {
+    MarketState m = {
+        .mp = mp,
+        .wal = wal,
+        .ctx = ctx,
+        .n_products = n_products,
+        .n_quoters = mp->orgs / 8 > 0 ? mp->orgs / 8 : 1,
+        .budget = (uint64_t)n_records,
+        .now_ns = mp->start_s * 1000000000ULL,
+        .counts = counts,
+    };
+    m.products = calloc((size_t)n_products, sizeof(*m.products));
+    m.zipf_cdf = calloc((size_t)n_products, sizeof(*m.zipf_cdf));
+    if (!m.products || !m.zipf_cdf) {
+        free(m.products);
+        free(m.zipf_cdf);
+        return -1;
+    }
+
+    double sum = 0.0;
+    for (int i = 0; i < n_products; i++) {
+        sum += pow((double)(i + 1), -mp->zipf_s);
+        m.zipf_cdf[i] = sum;
+        m.products[i].mid = MARKET_ANCHOR;
+    }
+    for (int i = 0; i < n_products; i++) {
+        m.zipf_cdf[i] /= sum;
+    }
+    m.rate_cdf[0] = 0.0;
+    for (int i = 1; i <= MARKET_RATE_POINTS; i++) {
+        m.rate_cdf[i] = m.rate_cdf[i - 1] + market_rate((i - 0.5) / MARKET_RATE_POINTS);
+    }
+    for (int i = 1; i <= MARKET_RATE_POINTS; i++) {
+        m.rate_cdf[i] /= m.rate_cdf[MARKET_RATE_POINTS];
+    }
+    om_wal_set_clock(wal, market_clock, &m);
+
+    int rc = 0;
+    while (m.budget > 0) {
+        market_next_event(&m, (uint64_t)n_records - m.budget);
+        uint16_t pid = (uint16_t)market_pick_product(&m);
+        MarketProduct *p = &m.products[pid];
+        p->mid += MARKET_REVERT * (MARKET_ANCHOR - p->mid) + MARKET_SIGMA * rng_normal();
+        if (p->mid < MARKET_ANCHOR / 2) p->mid = MARKET_ANCHOR / 2;
+
+        bool ok;
+        if ((int)(rng_next() % 100) < MARKET_QUOTE_PCT) {
+            ok = market_quote(&m, pid, (uint16_t)rng_range(1, (uint64_t)m.n_quoters));
+        } else {
+            uint16_t org = (uint16_t)rng_range((uint64_t)m.n_quoters + 1,
+                                               (uint64_t)(mp->orgs > m.n_quoters ? mp->orgs : m.n_quoters + 1));
+            int side = (int)(rng_next() & 1);
+            MarketSide *s = &p->side[side];
+            ok = true;
+            if ((int)(rng_next() % 100) < MARKET_CANCEL_PCT && s->n > 0) {
+                market_cancel(&m, pid, side, (size_t)(rng_next() % s->n));
+            } else if ((int)(rng_next() % 100) < mp->aggress_pct) {
+                ok = market_aggress(&m, pid, side, org);
+            } else {
+                ok = market_passive(&m, pid, side, org, MARKET_PASSIVE_ALPHA,
+                                    MARKET_PASSIVE_MAX, rng_power_law(1.5, 200));
+            }
+        }
+        if (!ok) {
+            fprintf(stderr, "slab full at record %" PRIu64 "\n", (uint64_t)n_records - m.budget);
+            rc = -1;
+            break;
+        }
+    }
+
+    om_wal_set_clock(wal, NULL, NULL);
+    for (int i = 0; i < n_products; i++) {
+        free(m.products[i].side[0].o);
+        free(m.products[i].side[1].o);
+    }
+    free(m.products);
+    free(m.zipf_cdf);
+    return rc;
+}
+
 static void usage(const char *prog) {
     fprintf(stderr,
         "usage: %s [options] <output_wal>\n"
@@ -70,14 +478,27 @@ static void usage(const char *prog) {
         "  -C            Disable CRC32 (CRC is on by default)\n"
         "  -p products   Number of product IDs 0..N-1 (default 4)\n"
         "  -S seed       RNG seed (default: from clock)\n"
+        "  -w workload   uniform (default) or market\n"
+        "\n"
+        "market workload:\n"
+        "  -o orgs       Orgs, the first orgs/8 quote (default 64)\n"
+        "  -a pct        Aggressor share of non-quoting new orders (default 10)\n"
+        "  -z s          Zipf exponent of product popularity (default 1.1)\n"
+        "  -d seconds    Session length (default 30600)\n"
+        "  -t epoch      Session start, epoch seconds (default 1736150400)\n"
+        "  -k depth      Orders per side before the farthest is cancelled (default 200)\n"
+        "\n"
+        "uniform mix: ~50%% INSERT, ~15%% CANCEL, ~15%% MATCH,\n"
+        "             ~10%% DEACTIVATE, ~10%% ACTIVATE\n"
         "\n"
-        "Record mix: ~50%% INSERT, ~15%% CANCEL, ~15%% MATCH,\n"
-        "            ~10%% DEACTIVATE, ~10%% ACTIVATE\n"
+        "The seed and a profile line with every option are printed on stderr;\n"
+        "the same options reproduce the same file.\n"
         "\n"
         "examples:\n"
         "  %s -n 1000 /tmp/test.wal\n"
-        "  %s -n 500 -e 3 /tmp/broken.wal\n",
-        prog, prog, prog);
+        "  %s -n 500 -e 3 /tmp/broken.wal\n"
+        "  %s -w market -n 5000000 -p 64 -S 42 /tmp/day.wal\n",
+        prog, prog, prog, prog);
 }
 
 /* Corrupt random payload bytes in `count` distinct records in the WAL file.
@@ -149,9 +570,19 @@ int main(int argc, char **argv) {
     uint64_t seed = 0;
     bool seed_set = false;
     const char *output = NULL;
+    WalMakerWorkload workload = WORKLOAD_UNIFORM;
+    MarketProfile mp = {
+        .orgs = 64,
+        .aggress_pct = 10,
+        .zipf_s = 1.1,
+        .session_s = 30600,
+        .start_s = 1736150400,  /* 2025-01-06 08:00 UTC */
+        .depth = 200,
+    };
+    int v;
 
     int opt;
-    while ((opt = getopt(argc, argv, "n:e:Cp:S:")) != -1) {
+    while ((opt = getopt(argc, argv, "n:e:Cp:S:w:o:a:z:d:t:k:")) != -1) {
         switch (opt) {
             case 'n':
                 if (!parse_int_in_range(optarg, 1, INT_MAX - 1, &n_records)) {
@@ -181,6 +612,57 @@ int main(int argc, char **argv) {
                 }
                 seed_set = true;
                 break;
+            case 'w':
+                if (strcmp(optarg, "uniform") == 0) {
+                    workload = WORKLOAD_UNIFORM;
+                } else if (strcmp(optarg, "market") == 0) {
+                    workload = WORKLOAD_MARKET;
+                } else {
+                    fprintf(stderr, "invalid -w: %s (uniform or market)\n", optarg);
+                    return 2;
+                }
+                break;
+            case 'o':
+                if (!parse_int_in_range(optarg, 2, UINT16_MAX, &mp.orgs)) {
+                    fprintf(stderr, "invalid -o: %s\n", optarg);
+                    return 2;
+                }
+                break;
+            case 'a':
+                if (!parse_int_in_range(optarg, 0, 100, &mp.aggress_pct)) {
+                    fprintf(stderr, "invalid -a: %s\n", optarg);
+                    return 2;
+                }
+                break;
+            case 'z': {
+                char *end = NULL;
+                errno = 0;
+                mp.zipf_s = strtod(optarg, &end);
+                if (errno != 0 || end == optarg || *end != '\0' || !(mp.zipf_s >= 0.0 && mp.zipf_s <= 10.0)) {
+                    fprintf(stderr, "invalid -z: %s\n", optarg);
+                    return 2;
+                }
+                break;
+            }
+            case 'd':
+                if (!parse_int_in_range(optarg, 1, 7 * 86400, &v)) {
+                    fprintf(stderr, "invalid -d: %s\n", optarg);
+                    return 2;
+                }
+                mp.session_s = (uint32_t)v;
+                break;
+            case 't':
+                if (!parse_u64_str(optarg, &mp.start_s) || mp.start_s > 4000000000ULL) {
+                    fprintf(stderr, "invalid -t: %s\n", optarg);
+                    return 2;
+                }
+                break;
+            case 'k':
+                if (!parse_int_in_range(optarg, 1, 1000000, &mp.depth)) {
+                    fprintf(stderr, "invalid -k: %s\n", optarg);
+                    return 2;
+                }
+                break;
             default:
                 usage(argv[0]);
                 return 2;
@@ -205,6 +687,12 @@ int main(int argc, char **argv) {
     }
     rng_state = seed ? seed : 1;
     fprintf(stderr, "seed: %" PRIu64 "\n", rng_state);
+    if (workload == WORKLOAD_MARKET) {
+        fprintf(stderr, "profile: -w market -S %" PRIu64 " -n %d -p %d -o %d -a %d -z %g "
+                "-d %" PRIu32 " -t %" PRIu64 " -k %d%s\n",
+                rng_state, n_records, n_products, mp.orgs, mp.aggress_pct, mp.zipf_s,
+                mp.session_s, mp.start_s, mp.depth, disable_crc ? " -C" : "");
+    }
 
     /* Remove old file */
     unlink(output);
@@ -231,98 +719,109 @@ int main(int argc, char **argv) {
         return 1;
     }
 
-    /* Track live orders for cancel/match/deactivate/activate targets */
-    uint32_t *live_oids = calloc((size_t)n_records, sizeof(uint32_t));
-    uint16_t *live_pids = calloc((size_t)n_records, sizeof(uint16_t));
-    uint32_t *live_slots = calloc((size_t)n_records, sizeof(uint32_t));
-    if (!live_oids || !live_pids || !live_slots) {
-        fprintf(stderr, "failed to allocate live order arrays\n");
-        free(live_oids);
-        free(live_pids);
-        free(live_slots);
-        om_orderbook_destroy(&ctx);
-        om_wal_close(&wal);
-        return 1;
-    }
-    size_t n_live = 0;
-
     int counts[6] = {0}; /* INSERT, CANCEL, MATCH, DEACTIVATE, ACTIVATE, other */
+    int exit_code = 0;
 
-    for (int i = 0; i < n_records; i++) {
-        uint16_t pid = (uint16_t)(rng_next() % (uint64_t)n_products);
-        int roll = (int)(rng_next() % 100);
-
-        if (n_live == 0 || roll < 50) {
-            /* INSERT */
-            uint32_t oid = om_slab_next_order_id(&ctx.slab);
-            OmSlabSlot *slot = om_slab_alloc(&ctx.slab);
-            if (!slot) {
-                fprintf(stderr, "slab full at record %d\n", i);
-                break;
+    if (workload == WORKLOAD_MARKET) {
+        if (generate_market(&wal, &ctx, &mp, n_records, n_products, counts) != 0) {
+            exit_code = 1;
+        }
+    } else {
+        /* Track live orders for cancel/match/deactivate/activate targets */
+        uint32_t *live_oids = calloc((size_t)n_records, sizeof(uint32_t));
+        uint16_t *live_pids = calloc((size_t)n_records, sizeof(uint16_t));
+        uint32_t *live_slots = calloc((size_t)n_records, sizeof(uint32_t));
+        if (!live_oids || !live_pids || !live_slots) {
+            fprintf(stderr, "failed to allocate live order arrays\n");
+            free(live_oids);
+            free(live_pids);
+            free(live_slots);
+            om_orderbook_destroy(&ctx);
+            om_wal_close(&wal);
+            return 1;
+        }
+        size_t n_live = 0;
+
+        for (int i = 0; i < n_records; i++) {
+            uint16_t pid = (uint16_t)(rng_next() % (uint64_t)n_products);
+            int roll = (int)(rng_next() % 100);
+
+            if (n_live == 0 || roll < 50) {
+                /* INSERT */
+                uint32_t oid = om_slab_next_order_id(&ctx.slab);
+                OmSlabSlot *slot = om_slab_alloc(&ctx.slab);
+                if (!slot) {
+                    fprintf(stderr, "slab full at record %d\n", i);
+                    break;
+                }
+                slot->order_id = oid;
+                slot->price = rng_range(9000, 11000);
+                slot->volume = rng_range(1, 100);
+                slot->volume_remain = slot->volume;
+                slot->org = (uint16_t)rng_range(1, 10);
+                slot->flags = (rng_next() & 1) ? OM_SIDE_BID : OM_SIDE_ASK;
+                om_wal_insert(&wal, slot, pid);
+                live_oids[n_live] = oid;
+                live_pids[n_live] = pid;
+                live_slots[n_live] = om_slot_get_idx(&ctx.slab, slot);
+                n_live++;
+                counts[0]++;
+            } else if (roll < 65 && n_live > 0) {
+                /* CANCEL */
+                size_t idx = (size_t)(rng_next() % (uint64_t)n_live);
+                om_wal_cancel(&wal, live_oids[idx], live_slots[idx], live_pids[idx]);
+                live_oids[idx] = live_oids[n_live - 1];
+                live_pids[idx] = live_pids[n_live - 1];
+                live_slots[idx] = live_slots[n_live - 1];
+                n_live--;
+                counts[1]++;
+            } else if (roll < 80 && n_live >= 2) {
+                /* MATCH */
+                size_t m = (size_t)(rng_next() % (uint64_t)n_live);
+                size_t t = (size_t)(rng_next() % (uint64_t)n_live);
+                if (t == m) t = (t + 1) % n_live;
+                OmWalMatch match = {
+                    .maker_id = live_oids[m],
+                    .taker_id = live_oids[t],
+                    .price = rng_range(9000, 11000),
+                    .volume = rng_range(1, 50),
+                    .product_id = live_pids[m],
+                };
+                om_wal_match(&wal, &match);
+                counts[2]++;
+            } else if (roll < 90 && n_live > 0) {
+                /* DEACTIVATE */
+                size_t idx = (size_t)(rng_next() % (uint64_t)n_live);
+                om_wal_deactivate(&wal, live_oids[idx], live_slots[idx], live_pids[idx]);
+                counts[3]++;
+            } else if (n_live > 0) {
+                /* ACTIVATE */
+                size_t idx = (size_t)(rng_next() % (uint64_t)n_live);
+                om_wal_activate(&wal, live_oids[idx], live_slots[idx], live_pids[idx]);
+                counts[4]++;
+            } else {
+                /* Fallback to INSERT */
+                uint32_t oid = om_slab_next_order_id(&ctx.slab);
+                OmSlabSlot *slot = om_slab_alloc(&ctx.slab);
+                if (!slot) break;
+                slot->order_id = oid;
+                slot->price = rng_range(9000, 11000);
+                slot->volume = rng_range(1, 100);
+                slot->volume_remain = slot->volume;
+                slot->org = (uint16_t)rng_range(1, 10);
+                slot->flags = (rng_next() & 1) ? OM_SIDE_BID : OM_SIDE_ASK;
+                om_wal_insert(&wal, slot, pid);
+                live_oids[n_live] = oid;
+                live_pids[n_live] = pid;
+                live_slots[n_live] = om_slot_get_idx(&ctx.slab, slot);
+                n_live++;
+                counts[0]++;
             }
-            slot->order_id = oid;
-            slot->price = rng_range(9000, 11000);
-            slot->volume = rng_range(1, 100);
-            slot->volume_remain = slot->volume;
-            slot->org = (uint16_t)rng_range(1, 10);
-            slot->flags = (rng_next() & 1) ? OM_SIDE_BID : OM_SIDE_ASK;
-            om_wal_insert(&wal, slot, pid);
-            live_oids[n_live] = oid;
-            live_pids[n_live] = pid;
-            live_slots[n_live] = om_slot_get_idx(&ctx.slab, slot);
-            n_live++;
-            counts[0]++;
-        } else if (roll < 65 && n_live > 0) {
-            /* CANCEL */
-            size_t idx = (size_t)(rng_next() % (uint64_t)n_live);
-            om_wal_cancel(&wal, live_oids[idx], live_slots[idx], live_pids[idx]);
-            live_oids[idx] = live_oids[n_live - 1];
-            live_pids[idx] = live_pids[n_live - 1];
-            live_slots[idx] = live_slots[n_live - 1];
-            n_live--;
-            counts[1]++;
-        } else if (roll < 80 && n_live >= 2) {
-            /* MATCH */
-            size_t m = (size_t)(rng_next() % (uint64_t)n_live);
-            size_t t = (size_t)(rng_next() % (uint64_t)n_live);
-            if (t == m) t = (t + 1) % n_live;
-            OmWalMatch match = {
-                .maker_id = live_oids[m],
-                .taker_id = live_oids[t],
-                .price = rng_range(9000, 11000),
-                .volume = rng_range(1, 50),
-                .product_id = live_pids[m],
-            };
-            om_wal_match(&wal, &match);
-            counts[2]++;
-        } else if (roll < 90 && n_live > 0) {
-            /* DEACTIVATE */
-            size_t idx = (size_t)(rng_next() % (uint64_t)n_live);
-            om_wal_deactivate(&wal, live_oids[idx], live_slots[idx], live_pids[idx]);
-            counts[3]++;
-        } else if (n_live > 0) {
-            /* ACTIVATE */
-            size_t idx = (size_t)(rng_next() % (uint64_t)n_live);
-            om_wal_activate(&wal, live_oids[idx], live_slots[idx], live_pids[idx]);
-            counts[4]++;
-        } else {
-            /* Fallback to INSERT */
-            uint32_t oid = om_slab_next_order_id(&ctx.slab);
-            OmSlabSlot *slot = om_slab_alloc(&ctx.slab);
-            if (!slot) break;
-            slot->order_id = oid;
-            slot->price = rng_range(9000, 11000);
-            slot->volume = rng_range(1, 100);
-            slot->volume_remain = slot->volume;
-            slot->org = (uint16_t)rng_range(1, 10);
-            slot->flags = (rng_next() & 1) ? OM_SIDE_BID : OM_SIDE_ASK;
-            om_wal_insert(&wal, slot, pid);
-            live_oids[n_live] = oid;
-            live_pids[n_live] = pid;
-            live_slots[n_live] = om_slot_get_idx(&ctx.slab, slot);
-            n_live++;
-            counts[0]++;
         }
+
+        free(live_oids);
+        free(live_pids);
+        free(live_slots);
     }
 
     om_wal_flush(&wal);
@@ -340,9 +839,5 @@ int main(int argc, char **argv) {
         corrupt_records(output, n_corrupt, total);
     }
 
-    free(live_oids);
-    free(live_pids);
-    free(live_slots);
-
-    return 0;
+    return exit_code;
 }
@@ -0,0 +1,690 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include "openmatch/om_wal.h"
+#include "openmatch/om_error.h"
+#include "ombus/om_bus.h"
+#include "ombus/om_bus_error.h"
+#include "ombus/om_bus_tcp.h"
+
+/*
+ * Publish a recorded WAL onto the bus for load tests.
+ *
+ * Records are read with OmWalReplay and published to an SHM stream, a TCP
+ * server, or both. Pacing follows the recorded timestamps (times a speed
+ * factor), a fixed rate, or no pacing at all. Records that are already due
+ * are published together with publish_batch / broadcast_batch, so batches
+ * form on bursts and are full at max rate.
+ */
+
+#define PLAYER_MAX_BATCH 4096
+#define PLAYER_ARENA_BYTES (1024 * 1024)
+#define PLAYER_SPIN_NS 50000ULL     /* sleep until this close to due, then spin */
+#define PLAYER_POLL_NS 1000000ULL   /* TCP poll_io interval while waiting */
+#define PLAYER_TYPES (OM_WAL_ACTIVATE + 1)
+
+typedef enum PlayerPace {
+    PACE_RECORDED = 0,
+    PACE_RATE,
+    PACE_MAX
+} PlayerPace;
+
+typedef struct Player {
+    /* Options */
+    PlayerPace pace;
+    double speed;
+    double rate;
+    uint32_t batch;
+    uint64_t loops;             /* 0 = until interrupted */
+    uint64_t report_ns;         /* rate window; peak rate is over these windows */
+    bool report_print;          /* print a line per window */
+    bool no_crc;
+
+    OmBusStream *stream;
+    OmBusTcpServer *tcp;
+
+    /* Pending batch; payloads are copied out of the replay buffer */
+    OmBusRecord recs[PLAYER_MAX_BATCH];
+    uint32_t n_pending;
+    uint8_t *arena;
+    size_t arena_cap;
+    size_t arena_used;
+
+    /* Pacing */
+    uint64_t start_ns;          /* wall clock (monotonic) at first record */
+    uint64_t log_first_ns;      /* first recorded timestamp of the current loop */
+    uint64_t log_pos_ns;        /* recorded time since log_first_ns, non-decreasing */
+    uint64_t loop_base_ns;      /* recorded time played by earlier loops */
+    bool have_log_time;
+
+    /* wal_seq keeps increasing across loops */
+    uint64_t seq_offset;
+    uint64_t loop_last_seq;
+
+    /* Totals */
+    uint64_t played;
+    uint64_t bytes;
+    uint64_t by_type[PLAYER_TYPES];
+    uint64_t skipped;
+    uint64_t crc_errors;
+    uint64_t publish_calls;
+    uint64_t shm_stalls;
+    uint64_t max_behind_ns;
+
+    /* Interval report */
+    uint64_t report_at_ns;
+    uint64_t report_played;
+    uint64_t report_bytes;
+    uint64_t report_behind_ns;
+    double peak_rate;
+} Player;
+
+static volatile sig_atomic_t player_stop = 0;
+
+static void on_signal(int sig) {
+    (void)sig;
+    player_stop = 1;
+}
+
+/*
+ * The SHM ring applies backpressure: until every consumer slot is attached,
+ * or behind a slow consumer, publish waits for room. Count the stalls and keep TCP clients served.
+ */
+static void on_backpressure(uint64_t head, uint64_t min_tail, void *ctx) {
+    Player *p = ctx;
+    if (p->shm_stalls++ == 0) {
+        fprintf(stderr, "SHM ring full (head=%" PRIu64 " min_tail=%" PRIu64
+                "): waiting for consumers\n", head, min_tail);
+    }
+    if (p->tcp) {
+        om_bus_tcp_server_poll_io(p->tcp);
+    }
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Pacing time of a record. MATCH records are paced with the record before
+ * them: the engine stamps them with CLOCK_REALTIME and the other records with
+ * the WAL's CLOCK_MONOTONIC.
+ */
+static bool record_pace_timestamp(OmWalType type, const void *data, size_t data_len,
+                                  uint64_t *ts_out) {
+    switch (type) {
+        case OM_WAL_INSERT:
+            if (data_len >= sizeof(OmWalInsert)) {
+                OmWalInsert rec;
+                memcpy(&rec, data, sizeof(rec));
+                *ts_out = rec.timestamp_ns;
+                return true;
+            }
+            break;
+        case OM_WAL_CANCEL:
+        case OM_WAL_DEACTIVATE:
+        case OM_WAL_ACTIVATE:
+            /* DEACTIVATE / ACTIVATE share the CANCEL layout */
+            if (data_len == sizeof(OmWalCancel)) {
+                OmWalCancel rec;
+                memcpy(&rec, data, sizeof(rec));
+                *ts_out = rec.timestamp_ns;
+                return true;
+            }
+            break;
+        default:
+            break;
+    }
+    return false;
+}
+
+/* When the next record is due, in wall-clock ns; 0 = now */
+static uint64_t player_due(Player *p, OmWalType type, const void *data, size_t data_len) {
+    switch (p->pace) {
+        case PACE_RATE:
+            return p->start_ns + (uint64_t)((double)p->played * 1e9 / p->rate);
+        case PACE_RECORDED: {
+            uint64_t ts;
+            if (record_pace_timestamp(type, data, data_len, &ts)) {
+                if (!p->have_log_time) {
+                    p->log_first_ns = ts;
+                    p->have_log_time = true;
+                }
+                /* Clock steps backwards do not rewind the schedule */
+                if (ts > p->log_first_ns && ts - p->log_first_ns > p->log_pos_ns) {
+                    p->log_pos_ns = ts - p->log_first_ns;
+                }
+            }
+            return p->start_ns + (uint64_t)((double)(p->loop_base_ns + p->log_pos_ns) / p->speed);
+        }
+        case PACE_MAX:
+        default:
+            return 0;
+    }
+}
+
+static void player_skip(Player *p, const OmBusRecord *r) {
+    if (p->skipped++ == 0) {
+        fprintf(stderr, "seq=%" PRIu64 " len=%" PRIu16 " does not fit an SHM slot, "
+                "skipping such records (raise -z or use -V)\n", r->wal_seq, r->payload_len);
+    }
+}
+
+static void player_publish_stream(Player *p) {
+    int rc = p->n_pending == 1
+        ? om_bus_stream_publish(p->stream, p->recs[0].wal_seq, p->recs[0].wal_type,
+                                p->recs[0].payload, p->recs[0].payload_len)
+        : om_bus_stream_publish_batch(p->stream, p->recs, p->n_pending);
+    if (rc == OM_ERR_BUS_RECORD_TOO_LARGE) {
+        /* Some record does not fit a slot: publish one by one, skip those */
+        for (uint32_t i = 0; i < p->n_pending; i++) {
+            const OmBusRecord *r = &p->recs[i];
+            if (p->n_pending == 1 ||
+                om_bus_stream_publish(p->stream, r->wal_seq, r->wal_type, r->payload,
+                                      r->payload_len) != 0) {
+                player_skip(p, r);
+            }
+        }
+    } else if (rc != 0) {
+        fprintf(stderr, "publish failed seq=%" PRIu64 " (rc=%d)\n", p->recs[0].wal_seq, rc);
+        p->skipped += p->n_pending;
+    }
+}
+
+static void player_flush(Player *p) {
+    if (p->n_pending == 0) {
+        return;
+    }
+    if (p->stream) {
+        player_publish_stream(p);
+    }
+    if (p->tcp) {
+        int rc = om_bus_tcp_server_broadcast_batch(p->tcp, p->recs, p->n_pending);
+        if (rc != 0) {
+            fprintf(stderr, "broadcast failed seq=%" PRIu64 " (rc=%d)\n", p->recs[0].wal_seq, rc);
+        }
+        om_bus_tcp_server_poll_io(p->tcp);
+    }
+    p->publish_calls++;
+    p->n_pending = 0;
+    p->arena_used = 0;
+}
+
+/* Close a rate window: track the peak, print a line if asked */
+static void player_report(Player *p, uint64_t now) {
+    double span = (double)(now - p->report_at_ns + p->report_ns) / 1e9;
+    double rate = (double)(p->played - p->report_played) / span;
+    if (rate > p->peak_rate) {
+        p->peak_rate = rate;
+    }
+    if (p->report_print) {
+        fprintf(stderr, "t=%.1fs rate=%.0f rec/s %.2f MB/s played=%" PRIu64,
+                (double)(now - p->start_ns) / 1e9, rate,
+                (double)(p->bytes - p->report_bytes) / span / 1e6, p->played);
+        if (p->pace != PACE_MAX) {
+            fprintf(stderr, " behind=%.3fms", (double)p->report_behind_ns / 1e6);
+        }
+        if (p->tcp) {
+            fprintf(stderr, " clients=%" PRIu32, om_bus_tcp_server_client_count(p->tcp));
+        }
+        fprintf(stderr, "\n");
+    }
+    p->report_played = p->played;
+    p->report_bytes = p->bytes;
+    p->report_behind_ns = 0;
+    p->report_at_ns = now + p->report_ns;
+}
+
+/* Sleep then spin until `due`, keeping the TCP server's I/O going */
+static void player_wait(Player *p, uint64_t due) {
+    uint64_t now = now_ns();
+    while (now < due && !player_stop) {
+        if (p->tcp) {
+            om_bus_tcp_server_poll_io(p->tcp);
+        }
+        if (now >= p->report_at_ns) {
+            player_report(p, now);
+        }
+        uint64_t left = due - now;
+        if (left > PLAYER_SPIN_NS) {
+            uint64_t nap = left - PLAYER_SPIN_NS;
+            if (p->tcp && nap > PLAYER_POLL_NS) {
+                nap = PLAYER_POLL_NS;
+            }
+            struct timespec ts = {
+                .tv_sec = (time_t)(nap / 1000000000ULL),
+                .tv_nsec = (long)(nap % 1000000000ULL),
+            };
+            nanosleep(&ts, NULL);
+        }
+        now = now_ns();
+    }
+}
+
+static bool player_append(Player *p, uint64_t seq, OmWalType type, const void *data,
+                          uint16_t len) {
+    if (p->n_pending == p->batch || p->arena_used + len > p->arena_cap) {
+        player_flush(p);
+    }
+    if (len > p->arena_cap) {
+        /* Nothing pending, so growing the arena cannot leave stale pointers */
+        uint8_t *arena = realloc(p->arena, len);
+        if (!arena) {
+            return false;
+        }
+        p->arena = arena;
+        p->arena_cap = len;
+    }
+    memcpy(p->arena + p->arena_used, data, len);
+    p->recs[p->n_pending++] = (OmBusRecord){
+        .wal_seq = seq,
+        .wal_type = (uint8_t)type,
+        .payload_len = len,
+        .payload = p->arena + p->arena_used,
+    };
+    p->arena_used += len;
+    return true;
+}
+
+/* Play one file; returns false on a read error */
+static bool player_play_file(Player *p, const char *path) {
+    OmWalReplay replay;
+    if (om_wal_replay_init(&replay, path) != 0) {
+        fprintf(stderr, "failed to open wal: %s\n", path);
+        return false;
+    }
+    if (p->no_crc) {
+        replay.enable_crc32 = false;
+    }
+
+    OmWalType type;
+    void *data;
+    uint64_t sequence;
+    size_t data_len;
+    bool ok = true;
+
+    while (!player_stop) {
+        int ret = om_wal_replay_next(&replay, &type, &data, &sequence, &data_len);
+        if (ret == 0) {
+            break;
+        }
+        if (ret == OM_ERR_WAL_CRC_MISMATCH) {
+            p->crc_errors++;
+            continue;
+        }
+        if (ret < 0) {
+            fprintf(stderr, "error reading wal %s (ret=%d)\n", path, ret);
+            ok = false;
+            break;
+        }
+        if (data_len > UINT16_MAX) {
+            p->skipped++;
+            continue;
+        }
+
+        if (p->start_ns == 0) {
+            p->start_ns = now_ns();
+            p->report_at_ns = p->start_ns + p->report_ns;
+        }
+        uint64_t due = player_due(p, type, data, data_len);
+        uint64_t now = now_ns();
+        if (due > now) {
+            /* Nothing else is due yet: send what is pending, then wait */
+            player_flush(p);
+            player_wait(p, due);
+            now = now_ns();
+        } else if (due > 0 && now - due > p->report_behind_ns) {
+            p->report_behind_ns = now - due;
+            if (p->report_behind_ns > p->max_behind_ns) {
+                p->max_behind_ns = p->report_behind_ns;
+            }
+        }
+
+        if (!player_append(p, sequence + p->seq_offset, type, data, (uint16_t)data_len)) {
+            fprintf(stderr, "out of memory\n");
+            ok = false;
+            break;
+        }
+        if (sequence > p->loop_last_seq) {
+            p->loop_last_seq = sequence;
+        }
+        p->played++;
+        p->bytes += data_len;
+        p->by_type[type < PLAYER_TYPES ? type : 0]++;
+
+        if (now >= p->report_at_ns) {
+            player_report(p, now);
+        }
+    }
+
+    om_wal_replay_close(&replay);
+    return ok;
+}
+
+static void player_summary(Player *p) {
+    uint64_t elapsed = p->start_ns ? now_ns() - p->start_ns : 0;
+    double secs = (double)elapsed / 1e9;
+    double total = p->played > 0 ? (double)p->played : 1.0;
+    double avg = secs > 0 ? (double)p->played / secs : 0.0;
+    if (p->peak_rate < avg) {
+        p->peak_rate = avg;     /* shorter than one window */
+    }
+    fprintf(stderr,
+            "played: records=%" PRIu64 " bytes=%" PRIu64 " elapsed=%.3fs rate=%.0f rec/s "
+            "peak=%.0f rec/s (%.0fms window) batches=%" PRIu64 " skipped=%" PRIu64 " crc_errors=%" PRIu64 "\n",
+            p->played, p->bytes, secs, avg,
+            p->peak_rate, (double)p->report_ns / 1e6, p->publish_calls, p->skipped, p->crc_errors);
+    fprintf(stderr,
+            "mix: insert=%.1f%% cancel=%.1f%% match=%.1f%% deactivate=%.1f%% activate=%.1f%% "
+            "other=%.1f%%\n",
+            100.0 * (double)p->by_type[OM_WAL_INSERT] / total,
+            100.0 * (double)p->by_type[OM_WAL_CANCEL] / total,
+            100.0 * (double)p->by_type[OM_WAL_MATCH] / total,
+            100.0 * (double)p->by_type[OM_WAL_DEACTIVATE] / total,
+            100.0 * (double)p->by_type[OM_WAL_ACTIVATE] / total,
+            100.0 * (double)(p->by_type[0] + p->by_type[OM_WAL_CHECKPOINT]) / total);
+    if (p->pace != PACE_MAX) {
+        fprintf(stderr, "pacing: max_behind=%.3fms\n", (double)p->max_behind_ns / 1e6);
+    }
+    if (p->stream) {
+        fprintf(stderr, "shm: backpressure_stalls=%" PRIu64 "\n", p->shm_stalls);
+    }
+    if (p->tcp) {
+        OmBusTcpServerStats st;
+        om_bus_tcp_server_stats(p->tcp, &st);
+        fprintf(stderr, "tcp: clients=%" PRIu32 " broadcast=%" PRIu64 " batch_frames=%" PRIu64
+                " slow_client_drops=%" PRIu64 "\n",
+                om_bus_tcp_server_client_count(p->tcp), st.records_broadcast,
+                st.batch_frames, st.slow_client_drops);
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options] <wal_file> [wal_file ...]\n"
+        "\n"
+        "Publish a recorded WAL onto the bus at its original pace.\n"
+        "\n"
+        "output (at least one):\n"
+        "  -s stream_name   Create an SHM stream and publish to it\n"
+        "  -T port          Serve a TCP bus on port (0 = ephemeral)\n"
+        "\n"
+        "pacing (default: recorded timestamps at speed 1):\n"
+        "  -x speed         Recorded pace times speed (2 = twice as fast)\n"
+        "  -r rate          Fixed rate, records per second\n"
+        "  -R               Max rate, no pacing\n"
+        "\n"
+        "options:\n"
+        "  -b batch         Max records per publish call (default 64, max %d)\n"
+        "  -l loops         Play the files N times, 0 = until interrupted (default 1)\n"
+        "  -i ms            Rate report interval (default 1000, 0 = summary only)\n"
+        "  -C               WAL written without CRC32\n"
+        "  -N capacity      SHM ring capacity (default %u)\n"
+        "  -z slot_size     SHM slot size (default %u)\n"
+        "  -c consumers     SHM consumer slots, all must attach (default 1)\n"
+        "  -V               SHM variable-length records\n"
+        "  -m mode          TCP server mode: copy (default), shared, uring\n"
+        "  -w clients       TCP: wait for N clients before playing\n"
+        "\n"
+        "The SHM ring applies backpressure: the player waits once the ring is full\n"
+        "until every consumer slot is attached and reading.\n"
+        "Loops keep wal_seq increasing: each pass adds the previous passes' last\n"
+        "sequence. MATCH records are paced with the record before them.\n",
+        prog, PLAYER_MAX_BATCH, OM_BUS_DEFAULT_CAPACITY, OM_BUS_DEFAULT_SLOT_SIZE);
+}
+
+static bool parse_u64_arg(const char *s, uint64_t min, uint64_t max, uint64_t *out) {
+    errno = 0;
+    char *end = NULL;
+    unsigned long long v = strtoull(s, &end, 10);
+    if (errno != 0 || end == s || *end != '\0' || v < min || v > max) {
+        return false;
+    }
+    *out = (uint64_t)v;
+    return true;
+}
+
+static bool parse_positive_double(const char *s, double *out) {
+    errno = 0;
+    char *end = NULL;
+    double v = strtod(s, &end);
+    if (errno != 0 || end == s || *end != '\0' || !(v > 0.0)) {
+        return false;
+    }
+    *out = v;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    static Player player;
+    Player *p = &player;
+    p->pace = PACE_RECORDED;
+    p->speed = 1.0;
+    p->batch = 64;
+    p->loops = 1;
+    p->report_ns = 1000000000ULL;
+    p->report_print = true;
+
+    const char *stream_name = NULL;
+    bool tcp = false;
+    uint64_t port = 0;
+    uint64_t wait_clients = 0;
+    uint32_t tcp_mode = OM_BUS_TCP_SERVER_COPY;
+    uint64_t capacity = OM_BUS_DEFAULT_CAPACITY;
+    uint64_t slot_size = OM_BUS_DEFAULT_SLOT_SIZE;
+    uint64_t max_consumers = 1;
+    uint32_t flags = 0;
+    uint64_t v;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:T:x:r:Rb:l:i:CN:z:c:Vm:w:")) != -1) {
+        switch (opt) {
+            case 's':
+                stream_name = optarg;
+                break;
+            case 'T':
+                if (!parse_u64_arg(optarg, 0, UINT16_MAX, &port)) {
+                    fprintf(stderr, "invalid port: %s\n", optarg);
+                    return 2;
+                }
+                tcp = true;
+                break;
+            case 'x':
+                if (!parse_positive_double(optarg, &p->speed)) {
+                    fprintf(stderr, "invalid speed: %s\n", optarg);
+                    return 2;
+                }
+                p->pace = PACE_RECORDED;
+                break;
+            case 'r':
+                if (!parse_positive_double(optarg, &p->rate)) {
+                    fprintf(stderr, "invalid rate: %s\n", optarg);
+                    return 2;
+                }
+                p->pace = PACE_RATE;
+                break;
+            case 'R':
+                p->pace = PACE_MAX;
+                break;
+            case 'b':
+                if (!parse_u64_arg(optarg, 1, PLAYER_MAX_BATCH, &v)) {
+                    fprintf(stderr, "invalid batch: %s (1..%d)\n", optarg, PLAYER_MAX_BATCH);
+                    return 2;
+                }
+                p->batch = (uint32_t)v;
+                break;
+            case 'l':
+                if (!parse_u64_arg(optarg, 0, UINT64_MAX, &p->loops)) {
+                    fprintf(stderr, "invalid loop count: %s\n", optarg);
+                    return 2;
+                }
+                break;
+            case 'i':
+                if (!parse_u64_arg(optarg, 0, 3600000, &v)) {
+                    fprintf(stderr, "invalid report interval: %s\n", optarg);
+                    return 2;
+                }
+                p->report_print = v > 0;
+                if (v > 0) {
+                    p->report_ns = v * 1000000ULL;
+                }
+                break;
+            case 'C':
+                p->no_crc = true;
+                break;
+            case 'N':
+                if (!parse_u64_arg(optarg, 2, UINT32_MAX, &capacity) || (capacity & (capacity - 1))) {
+                    fprintf(stderr, "invalid capacity: %s (power of two)\n", optarg);
+                    return 2;
+                }
+                break;
+            case 'z':
+                if (!parse_u64_arg(optarg, 64, UINT32_MAX, &slot_size)) {
+                    fprintf(stderr, "invalid slot size: %s\n", optarg);
+                    return 2;
+                }
+                break;
+            case 'c':
+                if (!parse_u64_arg(optarg, 1, 64, &max_consumers)) {
+                    fprintf(stderr, "invalid consumer count: %s\n", optarg);
+                    return 2;
+                }
+                break;
+            case 'V':
+                flags |= OM_BUS_FLAG_VARLEN;
+                break;
+            case 'm':
+                if (strcmp(optarg, "copy") == 0) {
+                    tcp_mode = OM_BUS_TCP_SERVER_COPY;
+                } else if (strcmp(optarg, "shared") == 0) {
+                    tcp_mode = OM_BUS_TCP_SERVER_SHARED;
+                } else if (strcmp(optarg, "uring") == 0) {
+                    tcp_mode = OM_BUS_TCP_SERVER_URING;
+                } else {
+                    fprintf(stderr, "invalid tcp mode: %s (copy, shared, uring)\n", optarg);
+                    return 2;
+                }
+                break;
+            case 'w':
+                if (!parse_u64_arg(optarg, 0, 65536, &wait_clients)) {
+                    fprintf(stderr, "invalid client count: %s\n", optarg);
+                    return 2;
+                }
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    if (optind >= argc || (!stream_name && !tcp)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    int exit_code = 0;
+    p->arena = malloc(PLAYER_ARENA_BYTES);
+    p->arena_cap = PLAYER_ARENA_BYTES;
+    if (!p->arena) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    if (stream_name) {
+        OmBusStreamConfig cfg = {
+            .stream_name = stream_name,
+            .capacity = (uint32_t)capacity,
+            .slot_size = (uint32_t)slot_size,
+            .max_consumers = (uint32_t)max_consumers,
+            .flags = flags,
+            .backpressure_cb = on_backpressure,
+            .backpressure_ctx = p,
+        };
+        int rc = om_bus_stream_create(&p->stream, &cfg);
+        if (rc != 0) {
+            fprintf(stderr, "failed to create bus stream '%s' (rc=%d)\n", stream_name, rc);
+            exit_code = 1;
+            goto done;
+        }
+        fprintf(stderr, "publishing to SHM stream '%s'\n", stream_name);
+    }
+    if (tcp) {
+        OmBusTcpServerConfig cfg = {
+            .port = (uint16_t)port,
+            .mode = tcp_mode,
+            .caps = OM_BUS_TCP_CAP_BATCH,
+        };
+        int rc = om_bus_tcp_server_create(&p->tcp, &cfg);
+        if (rc != 0) {
+            fprintf(stderr, "failed to create tcp server on port %" PRIu64 " (rc=%d)\n", port, rc);
+            exit_code = 1;
+            goto done;
+        }
+        fprintf(stderr, "serving TCP bus on port %" PRIu16 "\n", om_bus_tcp_server_port(p->tcp));
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sa.sa_flags = SA_RESETHAND;     /* a second signal ends a stalled player */
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    if (p->tcp && wait_clients > 0) {
+        fprintf(stderr, "waiting for %" PRIu64 " client(s)\n", wait_clients);
+        while (!player_stop && om_bus_tcp_server_client_count(p->tcp) < wait_clients) {
+            om_bus_tcp_server_poll_io(p->tcp);
+            struct timespec ts = {0, (long)PLAYER_POLL_NS};
+            nanosleep(&ts, NULL);
+        }
+    }
+
+    for (uint64_t loop = 0; !player_stop && (p->loops == 0 || loop < p->loops); loop++) {
+        uint64_t played_before = p->played;
+        for (int fi = optind; fi < argc && !player_stop; fi++) {
+            if (!player_play_file(p, argv[fi])) {
+                exit_code = 1;
+            }
+        }
+        if (p->played == played_before) {
+            break;  /* nothing to play: do not spin in loop mode */
+        }
+        /* Next pass continues the schedule and the sequence */
+        p->loop_base_ns += p->log_pos_ns;
+        p->log_pos_ns = 0;
+        p->have_log_time = false;
+        p->seq_offset += p->loop_last_seq;
+        p->loop_last_seq = 0;
+    }
+    player_flush(p);
+    if (p->tcp) {
+        /* Let clients drain what was just broadcast */
+        for (int i = 0; i < 100; i++) {
+            om_bus_tcp_server_poll_io(p->tcp);
+            struct timespec ts = {0, (long)PLAYER_POLL_NS};
+            nanosleep(&ts, NULL);
+        }
+    }
+    player_summary(p);
+    if (p->crc_errors > 0) {
+        exit_code = 1;
+    }
+
+done:
+    if (p->tcp) {
+        om_bus_tcp_server_destroy(p->tcp);
+    }
+    if (p->stream) {
+        om_bus_stream_destroy(p->stream);
+    }
+    free(p->arena);
+    return exit_code;
+}
@@ -3,6 +3,9 @@
 #include <strings.h>
 #include <stdbool.h>
 #include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <sys/stat.h>
 
 #include "sqlite3ext.h"
 SQLITE_EXTENSION_INIT1
@@ -15,6 +18,7 @@ typedef struct WalQueryVtab {
     char *filename;
     char *pattern;
     OmWalConfig config;
+    double est_records;         /* log size / typical record size, for xBestIndex */
 } WalQueryVtab;
 
 typedef struct WalQueryCursor {
@@ -35,6 +39,19 @@ typedef struct WalQueryCursor {
     uint32_t computed_crc;
     bool crc_ok;
     uint64_t file_offset;
+
+    /* Pushed-down constraints (see WalQueryPlan) */
+    int64_t seq_lo;
+    int64_t seq_hi;
+    int64_t ts_lo;
+    int64_t ts_hi;
+    int64_t type_eq;
+    int64_t product_eq;
+    int64_t order_eq;
+    bool has_ts;
+    bool has_type;
+    bool has_product;
+    bool has_order;
 } WalQueryCursor;
 
 enum WalQueryColumn {
@@ -62,6 +79,33 @@ enum WalQueryColumn {
     WAL_COL_FILE_OFFSET
 };
 
+/*
+ * xBestIndex plan: one idxNum bit per pushed-down constraint, and xFilter
+ * receives the values in bit order. seq ranges seek and stop early (sequence
+ * numbers increase through the log); the rest are checked in xNext before a
+ * row reaches SQLite. timestamp_ns cannot stop the scan: MATCH records carry
+ * the engine's realtime clock, the others the WAL's monotonic one.
+ */
+enum WalQueryPlan {
+    WAL_PLAN_SEQ_EQ = 0,
+    WAL_PLAN_SEQ_GT,
+    WAL_PLAN_SEQ_GE,
+    WAL_PLAN_SEQ_LT,
+    WAL_PLAN_SEQ_LE,
+    WAL_PLAN_TYPE_EQ,
+    WAL_PLAN_PRODUCT_EQ,
+    WAL_PLAN_ORDER_EQ,
+    WAL_PLAN_TS_EQ,
+    WAL_PLAN_TS_GT,
+    WAL_PLAN_TS_GE,
+    WAL_PLAN_TS_LT,
+    WAL_PLAN_TS_LE,
+    WAL_PLAN_COUNT
+};
+
+/* Typical on-disk record size, used to turn log bytes into a row estimate */
+#define WAL_QUERY_EST_RECORD_BYTES 48.0
+
 static const char *wal_type_name(OmWalType type) {
     switch (type) {
         case OM_WAL_INSERT: return "INSERT";
@@ -158,6 +202,25 @@ static int wal_query_connect(sqlite3 *db, void *pAux, int argc, const char *cons
     vtab->config.use_direct_io = false;
     vtab->config.wal_max_file_size = 0;
 
+    struct stat st;
+    double bytes = 0.0;
+    if (vtab->pattern) {
+        char path[512];
+        for (uint32_t idx = file_index; idx < file_index + 100000U; idx++) {
+            snprintf(path, sizeof(path), vtab->pattern, idx);
+            if (stat(path, &st) != 0) {
+                break;
+            }
+            bytes += (double)st.st_size;
+        }
+    } else if (stat(vtab->filename, &st) == 0) {
+        bytes = (double)st.st_size;
+    }
+    vtab->est_records = bytes / WAL_QUERY_EST_RECORD_BYTES;
+    if (vtab->est_records < 1.0) {
+        vtab->est_records = 1.0;
+    }
+
     int rc = sqlite3_declare_vtab(db,
                                  "CREATE TABLE x("
                                  "seq INTEGER,"
@@ -192,9 +255,104 @@ static int wal_query_connect(sqlite3 *db, void *pAux, int argc, const char *cons
     return SQLITE_OK;
 }
 
+static int wal_query_plan_slot(int col, unsigned char op) {
+    if (col == -1 || col == WAL_COL_SEQ) {
+        switch (op) {
+            case SQLITE_INDEX_CONSTRAINT_EQ: return WAL_PLAN_SEQ_EQ;
+            case SQLITE_INDEX_CONSTRAINT_GT: return WAL_PLAN_SEQ_GT;
+            case SQLITE_INDEX_CONSTRAINT_GE: return WAL_PLAN_SEQ_GE;
+            case SQLITE_INDEX_CONSTRAINT_LT: return WAL_PLAN_SEQ_LT;
+            case SQLITE_INDEX_CONSTRAINT_LE: return WAL_PLAN_SEQ_LE;
+            default: return -1;
+        }
+    }
+    if (col == WAL_COL_TIMESTAMP_NS) {
+        switch (op) {
+            case SQLITE_INDEX_CONSTRAINT_EQ: return WAL_PLAN_TS_EQ;
+            case SQLITE_INDEX_CONSTRAINT_GT: return WAL_PLAN_TS_GT;
+            case SQLITE_INDEX_CONSTRAINT_GE: return WAL_PLAN_TS_GE;
+            case SQLITE_INDEX_CONSTRAINT_LT: return WAL_PLAN_TS_LT;
+            case SQLITE_INDEX_CONSTRAINT_LE: return WAL_PLAN_TS_LE;
+            default: return -1;
+        }
+    }
+    if (op != SQLITE_INDEX_CONSTRAINT_EQ) {
+        return -1;
+    }
+    switch (col) {
+        case WAL_COL_TYPE: return WAL_PLAN_TYPE_EQ;
+        case WAL_COL_PRODUCT_ID: return WAL_PLAN_PRODUCT_EQ;
+        case WAL_COL_ORDER_ID: return WAL_PLAN_ORDER_EQ;
+        default: return -1;
+    }
+}
+
 static int wal_query_bestindex(sqlite3_vtab *pVtab, sqlite3_index_info *pIdxInfo) {
-    (void)pVtab;
-    (void)pIdxInfo;
+    WalQueryVtab *vtab = (WalQueryVtab *)pVtab;
+    int slot[WAL_PLAN_COUNT];
+    for (int p = 0; p < WAL_PLAN_COUNT; p++) {
+        slot[p] = -1;
+    }
+
+    for (int i = 0; i < pIdxInfo->nConstraint; i++) {
+        const struct sqlite3_index_constraint *c = &pIdxInfo->aConstraint[i];
+        if (!c->usable) {
+            continue;
+        }
+        int p = wal_query_plan_slot(c->iColumn, c->op);
+        if (p >= 0 && slot[p] < 0) {
+            slot[p] = i;
+        }
+    }
+
+    /* Values are narrowed conservatively in xFilter; SQLite re-checks them */
+    int idx_num = 0;
+    int argv_index = 0;
+    for (int p = 0; p < WAL_PLAN_COUNT; p++) {
+        if (slot[p] >= 0) {
+            pIdxInfo->aConstraintUsage[slot[p]].argvIndex = ++argv_index;
+            pIdxInfo->aConstraintUsage[slot[p]].omit = 0;
+            idx_num |= 1 << p;
+        }
+    }
+    pIdxInfo->idxNum = idx_num;
+
+    /* Cost in records read: a seq range seeks (~log2 of the 4KB blocks) */
+    double total = vtab->est_records;
+    double scanned = total;
+    bool seq_lo = (idx_num & ((1 << WAL_PLAN_SEQ_GT) | (1 << WAL_PLAN_SEQ_GE))) != 0;
+    bool seq_hi = (idx_num & ((1 << WAL_PLAN_SEQ_LT) | (1 << WAL_PLAN_SEQ_LE))) != 0;
+    if (idx_num & (1 << WAL_PLAN_SEQ_EQ)) {
+        scanned = 100.0;
+        pIdxInfo->idxFlags |= SQLITE_INDEX_SCAN_UNIQUE;
+    } else if (seq_lo && seq_hi) {
+        scanned = total / 16.0;
+    } else if (seq_lo || seq_hi) {
+        scanned = total / 3.0;
+    }
+    if (scanned > total) {
+        scanned = total;
+    }
+    double seek = (seq_lo || (idx_num & (1 << WAL_PLAN_SEQ_EQ))) ? log2(total + 2.0) * 100.0 : 0.0;
+
+    double rows = (idx_num & (1 << WAL_PLAN_SEQ_EQ)) ? 1.0 : scanned;
+    if (idx_num & (1 << WAL_PLAN_TYPE_EQ)) rows /= 4.0;
+    if (idx_num & (1 << WAL_PLAN_PRODUCT_EQ)) rows /= 32.0;
+    if (idx_num & (1 << WAL_PLAN_ORDER_EQ)) rows = rows > 4.0 ? 4.0 : rows;
+    if (idx_num & (1 << WAL_PLAN_TS_EQ)) rows = rows > 1.0 ? 1.0 : rows;
+    else if (idx_num & ((1 << WAL_PLAN_TS_GT) | (1 << WAL_PLAN_TS_GE) |
+                        (1 << WAL_PLAN_TS_LT) | (1 << WAL_PLAN_TS_LE))) rows /= 3.0;
+    if (rows < 1.0) rows = 1.0;
+
+    pIdxInfo->estimatedCost = seek + scanned;
+    pIdxInfo->estimatedRows = (sqlite3_int64)rows;
+
+    /* Records come back in seq order */
+    if (pIdxInfo->nOrderBy == 1 &&
+        (pIdxInfo->aOrderBy[0].iColumn == WAL_COL_SEQ || pIdxInfo->aOrderBy[0].iColumn == -1) &&
+        !pIdxInfo->aOrderBy[0].desc) {
+        pIdxInfo->orderByConsumed = 1;
+    }
     return SQLITE_OK;
 }
 
@@ -222,8 +380,8 @@ static int wal_query_close(sqlite3_vtab_cursor *cur) {
     return SQLITE_OK;
 }
 
-static int wal_query_next(sqlite3_vtab_cursor *cur) {
-    WalQueryCursor *cursor = (WalQueryCursor *)cur;
+/* Decode the next WAL record into the cursor */
+static int wal_query_read(WalQueryCursor *cursor) {
     if (!cursor->replay_init) {
         cursor->eof = true;
         return SQLITE_OK;
@@ -306,12 +464,142 @@ static int wal_query_next(sqlite3_vtab_cursor *cur) {
     return SQLITE_OK;
 }
 
+static bool wal_query_order_id(const WalQueryCursor *cursor, int64_t *out) {
+    switch (cursor->type) {
+        case OM_WAL_INSERT: *out = (int64_t)cursor->insert.order_id; return true;
+        case OM_WAL_CANCEL: *out = (int64_t)cursor->cancel.order_id; return true;
+        case OM_WAL_DEACTIVATE: *out = (int64_t)cursor->deactivate.order_id; return true;
+        case OM_WAL_ACTIVATE: *out = (int64_t)cursor->activate.order_id; return true;
+        default: return false;
+    }
+}
+
+static bool wal_query_product_id(const WalQueryCursor *cursor, int64_t *out) {
+    switch (cursor->type) {
+        case OM_WAL_INSERT: *out = cursor->insert.product_id; return true;
+        case OM_WAL_CANCEL: *out = cursor->cancel.product_id; return true;
+        case OM_WAL_MATCH: *out = cursor->match.product_id; return true;
+        case OM_WAL_DEACTIVATE: *out = cursor->deactivate.product_id; return true;
+        case OM_WAL_ACTIVATE: *out = cursor->activate.product_id; return true;
+        default: return false;
+    }
+}
+
+static bool wal_query_timestamp(const WalQueryCursor *cursor, int64_t *out) {
+    switch (cursor->type) {
+        case OM_WAL_INSERT: *out = (int64_t)cursor->insert.timestamp_ns; return true;
+        case OM_WAL_CANCEL: *out = (int64_t)cursor->cancel.timestamp_ns; return true;
+        case OM_WAL_MATCH: *out = (int64_t)cursor->match.timestamp_ns; return true;
+        case OM_WAL_DEACTIVATE: *out = (int64_t)cursor->deactivate.timestamp_ns; return true;
+        case OM_WAL_ACTIVATE: *out = (int64_t)cursor->activate.timestamp_ns; return true;
+        default: return false;
+    }
+}
+
+/* Pushed-down constraints other than the seq range; NULL columns never match */
+static bool wal_query_matches(const WalQueryCursor *cursor) {
+    int64_t v;
+    if (cursor->has_type && (int64_t)cursor->type != cursor->type_eq) {
+        return false;
+    }
+    if (cursor->has_product &&
+        (!wal_query_product_id(cursor, &v) || v != cursor->product_eq)) {
+        return false;
+    }
+    if (cursor->has_order && (!wal_query_order_id(cursor, &v) || v != cursor->order_eq)) {
+        return false;
+    }
+    if (cursor->has_ts &&
+        (!wal_query_timestamp(cursor, &v) || v < cursor->ts_lo || v > cursor->ts_hi)) {
+        return false;
+    }
+    return true;
+}
+
+static int wal_query_next(sqlite3_vtab_cursor *cur) {
+    WalQueryCursor *cursor = (WalQueryCursor *)cur;
+    while (1) {
+        int rc = wal_query_read(cursor);
+        if (rc != SQLITE_OK || cursor->eof) {
+            return rc;
+        }
+        if ((int64_t)cursor->sequence > cursor->seq_hi) {
+            cursor->eof = true;
+            return SQLITE_OK;
+        }
+        if ((int64_t)cursor->sequence >= cursor->seq_lo && wal_query_matches(cursor)) {
+            return SQLITE_OK;
+        }
+    }
+}
+
+/*
+ * Narrow [*lo, *hi] by one constraint value. Values that are not numeric are
+ * left to SQLite; REAL values are rounded inward.
+ */
+static void wal_query_narrow(sqlite3_value *value, int plan_op, int64_t *lo, int64_t *hi) {
+    int vt = sqlite3_value_numeric_type(value);
+    int64_t v_lo;
+    int64_t v_hi;
+    if (vt == SQLITE_INTEGER) {
+        v_lo = v_hi = sqlite3_value_int64(value);
+    } else if (vt == SQLITE_FLOAT) {
+        double d = sqlite3_value_double(value);
+        if (d >= 9.2e18 || d <= -9.2e18) {
+            return;
+        }
+        v_lo = (int64_t)ceil(d);
+        v_hi = (int64_t)floor(d);
+    } else {
+        return;
+    }
+
+    switch (plan_op) {
+        case SQLITE_INDEX_CONSTRAINT_EQ:
+            if (v_lo > *lo) *lo = v_lo;
+            if (v_hi < *hi) *hi = v_hi;
+            break;
+        case SQLITE_INDEX_CONSTRAINT_GT:
+            if (v_hi == INT64_MAX) { *lo = INT64_MAX; *hi = INT64_MIN; break; }
+            if (v_hi + 1 > *lo) *lo = v_hi + 1;
+            break;
+        case SQLITE_INDEX_CONSTRAINT_GE:
+            if (v_lo > *lo) *lo = v_lo;
+            break;
+        case SQLITE_INDEX_CONSTRAINT_LT:
+            if (v_lo == INT64_MIN) { *lo = INT64_MAX; *hi = INT64_MIN; break; }
+            if (v_lo - 1 < *hi) *hi = v_lo - 1;
+            break;
+        case SQLITE_INDEX_CONSTRAINT_LE:
+            if (v_hi < *hi) *hi = v_hi;
+            break;
+        default:
+            break;
+    }
+}
+
+/* Equality value for type/product_id/order_id; false when not an integer */
+static bool wal_query_eq_value(sqlite3_value *value, int64_t *out) {
+    int vt = sqlite3_value_numeric_type(value);
+    if (vt == SQLITE_INTEGER) {
+        *out = sqlite3_value_int64(value);
+        return true;
+    }
+    if (vt == SQLITE_FLOAT) {
+        double d = sqlite3_value_double(value);
+        if (d == floor(d) && d < 9.2e18 && d > -9.2e18) {
+            *out = (int64_t)d;
+            return true;
+        }
+        *out = INT64_MIN; /* non-integral: matches nothing */
+        return true;
+    }
+    return false;
+}
+
 static int wal_query_filter(sqlite3_vtab_cursor *cur, int idxNum, const char *idxStr,
                             int argc, sqlite3_value **argv) {
-    (void)idxNum;
     (void)idxStr;
-    (void)argc;
-    (void)argv;
 
     WalQueryCursor *cursor = (WalQueryCursor *)cur;
     WalQueryVtab *vtab = (WalQueryVtab *)cur->pVtab;
@@ -321,14 +609,87 @@ static int wal_query_filter(sqlite3_vtab_cursor *cur, int idxNum, const char *id
         cursor->replay_init = false;
     }
 
+    static const int plan_ops[WAL_PLAN_COUNT] = {
+        [WAL_PLAN_SEQ_EQ] = SQLITE_INDEX_CONSTRAINT_EQ,
+        [WAL_PLAN_SEQ_GT] = SQLITE_INDEX_CONSTRAINT_GT,
+        [WAL_PLAN_SEQ_GE] = SQLITE_INDEX_CONSTRAINT_GE,
+        [WAL_PLAN_SEQ_LT] = SQLITE_INDEX_CONSTRAINT_LT,
+        [WAL_PLAN_SEQ_LE] = SQLITE_INDEX_CONSTRAINT_LE,
+        [WAL_PLAN_TYPE_EQ] = SQLITE_INDEX_CONSTRAINT_EQ,
+        [WAL_PLAN_PRODUCT_EQ] = SQLITE_INDEX_CONSTRAINT_EQ,
+        [WAL_PLAN_ORDER_EQ] = SQLITE_INDEX_CONSTRAINT_EQ,
+        [WAL_PLAN_TS_EQ] = SQLITE_INDEX_CONSTRAINT_EQ,
+        [WAL_PLAN_TS_GT] = SQLITE_INDEX_CONSTRAINT_GT,
+        [WAL_PLAN_TS_GE] = SQLITE_INDEX_CONSTRAINT_GE,
+        [WAL_PLAN_TS_LT] = SQLITE_INDEX_CONSTRAINT_LT,
+        [WAL_PLAN_TS_LE] = SQLITE_INDEX_CONSTRAINT_LE,
+    };
+
+    cursor->seq_lo = INT64_MIN;
+    cursor->seq_hi = INT64_MAX;
+    cursor->ts_lo = INT64_MIN;
+    cursor->ts_hi = INT64_MAX;
+    cursor->has_ts = false;
+    cursor->has_type = false;
+    cursor->has_product = false;
+    cursor->has_order = false;
+
+    int arg = 0;
+    for (int p = 0; p < WAL_PLAN_COUNT && arg < argc; p++) {
+        if (!(idxNum & (1 << p))) {
+            continue;
+        }
+        sqlite3_value *value = argv[arg++];
+        switch (p) {
+            case WAL_PLAN_SEQ_EQ:
+            case WAL_PLAN_SEQ_GT:
+            case WAL_PLAN_SEQ_GE:
+            case WAL_PLAN_SEQ_LT:
+            case WAL_PLAN_SEQ_LE:
+                wal_query_narrow(value, plan_ops[p], &cursor->seq_lo, &cursor->seq_hi);
+                break;
+            case WAL_PLAN_TS_EQ:
+            case WAL_PLAN_TS_GT:
+            case WAL_PLAN_TS_GE:
+            case WAL_PLAN_TS_LT:
+            case WAL_PLAN_TS_LE:
+                wal_query_narrow(value, plan_ops[p], &cursor->ts_lo, &cursor->ts_hi);
+                cursor->has_ts = true;
+                break;
+            case WAL_PLAN_TYPE_EQ:
+                cursor->has_type = wal_query_eq_value(value, &cursor->type_eq);
+                break;
+            case WAL_PLAN_PRODUCT_EQ:
+                cursor->has_product = wal_query_eq_value(value, &cursor->product_eq);
+                break;
+            case WAL_PLAN_ORDER_EQ:
+                cursor->has_order = wal_query_eq_value(value, &cursor->order_eq);
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (cursor->seq_lo > cursor->seq_hi || cursor->ts_lo > cursor->ts_hi) {
+        cursor->eof = true;
+        return SQLITE_OK;
+    }
+
     int rc = om_wal_replay_init_with_config(&cursor->replay, vtab->config.filename, &vtab->config);
     if (rc != 0) {
         cursor->eof = true;
         return SQLITE_ERROR;
     }
-
     cursor->replay_init = true;
     cursor->eof = false;
+
+    if (cursor->seq_lo > 1) {
+        rc = om_wal_replay_seek(&cursor->replay, (uint64_t)cursor->seq_lo);
+        if (rc != 0) {
+            cursor->eof = true;
+            return SQLITE_ERROR;
+        }
+    }
     return wal_query_next(cur);
 }
 
@@ -353,19 +714,15 @@ static int wal_query_column(sqlite3_vtab_cursor *cur, sqlite3_context *ctx, int
         case WAL_COL_DATA_LEN:
             sqlite3_result_int64(ctx, (sqlite3_int64)cursor->data_len);
             break;
-        case WAL_COL_ORDER_ID:
-            if (cursor->type == OM_WAL_INSERT) {
-                sqlite3_result_int64(ctx, (sqlite3_int64)cursor->insert.order_id);
-            } else if (cursor->type == OM_WAL_CANCEL) {
-                sqlite3_result_int64(ctx, (sqlite3_int64)cursor->cancel.order_id);
-            } else if (cursor->type == OM_WAL_DEACTIVATE) {
-                sqlite3_result_int64(ctx, (sqlite3_int64)cursor->deactivate.order_id);
-            } else if (cursor->type == OM_WAL_ACTIVATE) {
-                sqlite3_result_int64(ctx, (sqlite3_int64)cursor->activate.order_id);
+        case WAL_COL_ORDER_ID: {
+            int64_t v;
+            if (wal_query_order_id(cursor, &v)) {
+                sqlite3_result_int64(ctx, (sqlite3_int64)v);
             } else {
                 sqlite3_result_null(ctx);
             }
             break;
+        }
         case WAL_COL_PRICE:
             if (cursor->type == OM_WAL_INSERT) {
                 sqlite3_result_int64(ctx, (sqlite3_int64)cursor->insert.price);
@@ -403,36 +760,24 @@ static int wal_query_column(sqlite3_vtab_cursor *cur, sqlite3_context *ctx, int
                 sqlite3_result_null(ctx);
             }
             break;
-        case WAL_COL_PRODUCT_ID:
-            if (cursor->type == OM_WAL_INSERT) {
-                sqlite3_result_int(ctx, (int)cursor->insert.product_id);
-            } else if (cursor->type == OM_WAL_CANCEL) {
-                sqlite3_result_int(ctx, (int)cursor->cancel.product_id);
-            } else if (cursor->type == OM_WAL_MATCH) {
-                sqlite3_result_int(ctx, (int)cursor->match.product_id);
-            } else if (cursor->type == OM_WAL_DEACTIVATE) {
-                sqlite3_result_int(ctx, (int)cursor->deactivate.product_id);
-            } else if (cursor->type == OM_WAL_ACTIVATE) {
-                sqlite3_result_int(ctx, (int)cursor->activate.product_id);
+        case WAL_COL_PRODUCT_ID: {
+            int64_t v;
+            if (wal_query_product_id(cursor, &v)) {
+                sqlite3_result_int64(ctx, (sqlite3_int64)v);
             } else {
                 sqlite3_result_null(ctx);
             }
             break;
-        case WAL_COL_TIMESTAMP_NS:
-            if (cursor->type == OM_WAL_INSERT) {
-                sqlite3_result_int64(ctx, (sqlite3_int64)cursor->insert.timestamp_ns);
-            } else if (cursor->type == OM_WAL_CANCEL) {
-                sqlite3_result_int64(ctx, (sqlite3_int64)cursor->cancel.timestamp_ns);
-            } else if (cursor->type == OM_WAL_MATCH) {
-                sqlite3_result_int64(ctx, (sqlite3_int64)cursor->match.timestamp_ns);
-            } else if (cursor->type == OM_WAL_DEACTIVATE) {
-                sqlite3_result_int64(ctx, (sqlite3_int64)cursor->deactivate.timestamp_ns);
-            } else if (cursor->type == OM_WAL_ACTIVATE) {
-                sqlite3_result_int64(ctx, (sqlite3_int64)cursor->activate.timestamp_ns);
+        }
+        case WAL_COL_TIMESTAMP_NS: {
+            int64_t v;
+            if (wal_query_timestamp(cursor, &v)) {
+                sqlite3_result_int64(ctx, (sqlite3_int64)v);
             } else {
                 sqlite3_result_null(ctx);
             }
             break;
+        }
         case WAL_COL_SLOT_IDX:
             if (cursor->type == OM_WAL_CANCEL) {
                 sqlite3_result_int(ctx, (int)cursor->cancel.slot_idx);
@@ -4,14 +4,24 @@
 #include <string.h>
 #include <stdbool.h>
 #include <errno.h>
+#include <pthread.h>
 #include <limits.h>
 #include <time.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include "openmatch/om_wal.h"
 #include "openmatch/om_error.h"
 #include "ombus/om_bus.h"
 
 #define MAX_RANGES 32
+#define MAX_JOBS 256
+
+/* -j splits files into about jobs * UNITS_PER_JOB units, none below UNIT_MIN_BYTES */
+#define UNITS_PER_JOB 4
+#define UNIT_MIN_BYTES (8ULL << 20)
+/* -j: no unit starts more than jobs * UNITS_AHEAD_PER_JOB past the oldest
+ * unfinished one, which bounds the rendered output waiting in temp files */
+#define UNITS_AHEAD_PER_JOB 2
 
 typedef struct {
     uint64_t from;
@@ -269,29 +279,824 @@ static bool get_record_timestamp(OmWalType type, const void *data,
     return false;
 }
 
-/* Check if a record matches any filter. No filters = match all. */
-static bool record_matches(uint64_t seq, OmWalType type, const void *data,
-                           size_t data_len,
-                           const SeqRange *seq_ranges, int n_seq,
-                           const TimeRange *time_ranges, int n_time) {
-    if (n_seq == 0 && n_time == 0) return true;
+/*
+ * Order ids inserted by the -o orgs. Only INSERT records carry the org, so a
+ * first pass collects them and the second pass matches CANCEL / MATCH /
+ * DEACTIVATE / ACTIVATE records by order id. Open addressing, 0 = empty slot.
+ */
+typedef struct OrderSet {
+    uint64_t *keys;
+    size_t cap;
+    size_t count;
+    bool has_zero;
+} OrderSet;
+
+static size_t order_set_slot(uint64_t key, size_t cap) {
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 29) & (cap - 1);
+}
 
-    for (int i = 0; i < n_seq; i++) {
-        if (seq >= seq_ranges[i].from && seq <= seq_ranges[i].to)
-            return true;
+static bool order_set_add(OrderSet *s, uint64_t key) {
+    if (key == 0) {
+        s->has_zero = true;
+        return true;
+    }
+    if ((s->count + 1) * 2 > s->cap) {
+        size_t cap = s->cap ? s->cap * 2 : 1024;
+        uint64_t *keys = calloc(cap, sizeof(*keys));
+        if (!keys) {
+            return false;
+        }
+        for (size_t i = 0; i < s->cap; i++) {
+            if (s->keys[i] == 0) continue;
+            size_t j = order_set_slot(s->keys[i], cap);
+            while (keys[j] != 0) j = (j + 1) & (cap - 1);
+            keys[j] = s->keys[i];
+        }
+        free(s->keys);
+        s->keys = keys;
+        s->cap = cap;
+    }
+    size_t j = order_set_slot(key, s->cap);
+    while (s->keys[j] != 0) {
+        if (s->keys[j] == key) return true;
+        j = (j + 1) & (s->cap - 1);
     }
+    s->keys[j] = key;
+    s->count++;
+    return true;
+}
 
-    uint64_t ts;
-    if (n_time > 0 && get_record_timestamp(type, data, data_len, &ts)) {
-        for (int i = 0; i < n_time; i++) {
-            if (ts >= time_ranges[i].from_ns && ts <= time_ranges[i].to_ns)
-                return true;
+static bool order_set_has(const OrderSet *s, uint64_t key) {
+    if (key == 0) return s->has_zero;
+    if (s->cap == 0) return false;
+    size_t j = order_set_slot(key, s->cap);
+    while (s->keys[j] != 0) {
+        if (s->keys[j] == key) return true;
+        j = (j + 1) & (s->cap - 1);
+    }
+    return false;
+}
+
+static bool order_set_merge(OrderSet *dst, const OrderSet *src) {
+    if (src->has_zero) dst->has_zero = true;
+    for (size_t i = 0; i < src->cap; i++) {
+        if (src->keys[i] != 0 && !order_set_add(dst, src->keys[i])) {
+            return false;
         }
     }
+    return true;
+}
+
+static void order_set_free(OrderSet *s) {
+    free(s->keys);
+    memset(s, 0, sizeof(*s));
+}
+
+/*
+ * -s / -r ranges are OR'ed with each other. -P, -o and -O are each OR'ed
+ * within their own kind and AND'ed with everything else.
+ */
+typedef struct Filter {
+    SeqRange seq[MAX_RANGES];
+    TimeRange time[MAX_RANGES];
+    uint16_t product[MAX_RANGES];
+    uint16_t org[MAX_RANGES];
+    uint64_t order[MAX_RANGES];
+    int n_seq;
+    int n_time;
+    int n_product;
+    int n_org;
+    int n_order;
+    OrderSet org_orders;
+} Filter;
+
+/* Fields the filters and the summary look at, copied out of the payload */
+typedef struct RecordInfo {
+    bool engine;            /* a known engine record with a full payload */
+    uint16_t product_id;
+    uint16_t org;           /* INSERT only */
+    uint64_t order_id;      /* MATCH: maker */
+    uint64_t taker_id;      /* MATCH only */
+    uint64_t price;
+    uint64_t volume;
+} RecordInfo;
+
+static void decode_record(OmWalType type, const void *data, size_t data_len,
+                          RecordInfo *info) {
+    memset(info, 0, sizeof(*info));
+    switch (type) {
+        case OM_WAL_INSERT:
+            if (data_len >= sizeof(OmWalInsert)) {
+                OmWalInsert rec;
+                memcpy(&rec, data, sizeof(rec));
+                info->engine = true;
+                info->product_id = rec.product_id;
+                info->org = rec.org;
+                info->order_id = rec.order_id;
+                info->price = rec.price;
+                info->volume = rec.volume;
+            }
+            break;
+        case OM_WAL_CANCEL:
+        case OM_WAL_DEACTIVATE:
+        case OM_WAL_ACTIVATE:
+            /* DEACTIVATE / ACTIVATE share the CANCEL layout */
+            if (data_len == sizeof(OmWalCancel)) {
+                OmWalCancel rec;
+                memcpy(&rec, data, sizeof(rec));
+                info->engine = true;
+                info->product_id = rec.product_id;
+                info->order_id = rec.order_id;
+            }
+            break;
+        case OM_WAL_MATCH:
+            if (data_len == sizeof(OmWalMatch)) {
+                OmWalMatch rec;
+                memcpy(&rec, data, sizeof(rec));
+                info->engine = true;
+                info->product_id = rec.product_id;
+                info->order_id = rec.maker_id;
+                info->taker_id = rec.taker_id;
+                info->price = rec.price;
+                info->volume = rec.volume;
+            }
+            break;
+        default:
+            break;
+    }
+}
 
+static bool filter_has_u16(const uint16_t *list, int n, uint16_t v) {
+    for (int i = 0; i < n; i++) {
+        if (list[i] == v) return true;
+    }
     return false;
 }
 
+/* Check if a record matches the filters. No filters = match all. */
+static bool record_matches(const Filter *f, uint64_t seq, OmWalType type,
+                           const void *data, size_t data_len, const RecordInfo *info) {
+    if (f->n_seq > 0 || f->n_time > 0) {
+        bool in_range = false;
+        for (int i = 0; i < f->n_seq && !in_range; i++) {
+            in_range = seq >= f->seq[i].from && seq <= f->seq[i].to;
+        }
+        uint64_t ts;
+        if (!in_range && f->n_time > 0 && get_record_timestamp(type, data, data_len, &ts)) {
+            for (int i = 0; i < f->n_time && !in_range; i++) {
+                in_range = ts >= f->time[i].from_ns && ts <= f->time[i].to_ns;
+            }
+        }
+        if (!in_range) return false;
+    }
+
+    if (f->n_product == 0 && f->n_org == 0 && f->n_order == 0) return true;
+    /* Product, org and order filters only apply to engine records */
+    if (!info->engine) return false;
+
+    if (f->n_product > 0 && !filter_has_u16(f->product, f->n_product, info->product_id)) {
+        return false;
+    }
+    if (f->n_org > 0) {
+        bool hit = type == OM_WAL_INSERT
+            ? filter_has_u16(f->org, f->n_org, info->org)
+            : order_set_has(&f->org_orders, info->order_id) ||
+              (type == OM_WAL_MATCH && order_set_has(&f->org_orders, info->taker_id));
+        if (!hit) return false;
+    }
+    if (f->n_order > 0) {
+        bool hit = false;
+        for (int i = 0; i < f->n_order && !hit; i++) {
+            hit = info->order_id == f->order[i] ||
+                  (type == OM_WAL_MATCH && info->taker_id == f->order[i]);
+        }
+        if (!hit) return false;
+    }
+    return true;
+}
+
+/* ---- Summary ---- */
+
+__extension__ typedef unsigned __int128 u128;
+
+#define SUMMARY_PRODUCTS (UINT16_MAX + 1)
+#define SUMMARY_USER_TYPE 0     /* by_type slot for custom records */
+
+typedef struct ProductSummary {
+    uint64_t inserts;
+    uint64_t insert_volume;
+    uint64_t cancels;
+    uint64_t matches;
+    uint64_t match_volume;
+    u128 notional;              /* sum of price * volume over matches */
+    uint64_t deactivates;
+    uint64_t activates;
+} ProductSummary;
+
+/* Totals over the records that pass the filters */
+typedef struct Summary {
+    uint64_t records;
+    uint64_t payload_bytes;
+    uint64_t by_type[OM_WAL_ACTIVATE + 1];
+    ProductSummary *products;   /* indexed by product_id, allocated on first use */
+} Summary;
+
+/* Sequence continuity of one scan unit, over every record read (unfiltered) */
+typedef struct SeqStats {
+    uint64_t scanned;
+    uint64_t first_seq;
+    uint64_t last_seq;
+    uint64_t gaps;
+    uint64_t crc_errors;
+} SeqStats;
+
+static bool summary_add(Summary *s, OmWalType type, size_t data_len, const RecordInfo *info) {
+    s->records++;
+    s->payload_bytes += data_len;
+    s->by_type[type <= OM_WAL_ACTIVATE ? type : SUMMARY_USER_TYPE]++;
+    if (!info->engine) {
+        return true;
+    }
+    if (!s->products) {
+        s->products = calloc(SUMMARY_PRODUCTS, sizeof(*s->products));
+        if (!s->products) {
+            return false;
+        }
+    }
+    ProductSummary *p = &s->products[info->product_id];
+    switch (type) {
+        case OM_WAL_INSERT:
+            p->inserts++;
+            p->insert_volume += info->volume;
+            break;
+        case OM_WAL_CANCEL:
+            p->cancels++;
+            break;
+        case OM_WAL_MATCH:
+            p->matches++;
+            p->match_volume += info->volume;
+            p->notional += (u128)info->price * info->volume;
+            break;
+        case OM_WAL_DEACTIVATE:
+            p->deactivates++;
+            break;
+        case OM_WAL_ACTIVATE:
+            p->activates++;
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+static bool summary_merge(Summary *dst, const Summary *src) {
+    dst->records += src->records;
+    dst->payload_bytes += src->payload_bytes;
+    for (size_t t = 0; t <= OM_WAL_ACTIVATE; t++) {
+        dst->by_type[t] += src->by_type[t];
+    }
+    if (!src->products) {
+        return true;
+    }
+    if (!dst->products) {
+        dst->products = calloc(SUMMARY_PRODUCTS, sizeof(*dst->products));
+        if (!dst->products) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < SUMMARY_PRODUCTS; i++) {
+        ProductSummary *d = &dst->products[i];
+        const ProductSummary *p = &src->products[i];
+        d->inserts += p->inserts;
+        d->insert_volume += p->insert_volume;
+        d->cancels += p->cancels;
+        d->matches += p->matches;
+        d->match_volume += p->match_volume;
+        d->notional += p->notional;
+        d->deactivates += p->deactivates;
+        d->activates += p->activates;
+    }
+    return true;
+}
+
+static void print_u128(FILE *out, u128 v) {
+    char buf[40];
+    size_t i = sizeof(buf);
+    buf[--i] = '\0';
+    do {
+        buf[--i] = (char)('0' + (int)(v % 10));
+        v /= 10;
+    } while (v != 0);
+    fputs(buf + i, out);
+}
+
+static void print_summary(FILE *out, const Summary *s, const SeqStats *seq, int n_files) {
+    fprintf(out, "summary files[%d] scanned[%" PRIu64 "] seq_first[%" PRIu64 "] "
+            "seq_last[%" PRIu64 "] seq_gaps[%" PRIu64 "] crc_errors[%" PRIu64 "]\n",
+            n_files, seq->scanned, seq->first_seq, seq->last_seq, seq->gaps,
+            seq->crc_errors);
+    fprintf(out, "summary records[%" PRIu64 "] bytes[%" PRIu64 "] insert[%" PRIu64 "] "
+            "cancel[%" PRIu64 "] match[%" PRIu64 "] deactivate[%" PRIu64 "] "
+            "activate[%" PRIu64 "] checkpoint[%" PRIu64 "] user[%" PRIu64 "]\n",
+            s->records, s->payload_bytes, s->by_type[OM_WAL_INSERT],
+            s->by_type[OM_WAL_CANCEL], s->by_type[OM_WAL_MATCH],
+            s->by_type[OM_WAL_DEACTIVATE], s->by_type[OM_WAL_ACTIVATE],
+            s->by_type[OM_WAL_CHECKPOINT], s->by_type[SUMMARY_USER_TYPE]);
+    if (!s->products) {
+        return;
+    }
+    for (size_t i = 0; i < SUMMARY_PRODUCTS; i++) {
+        const ProductSummary *p = &s->products[i];
+        if (p->inserts + p->cancels + p->matches + p->deactivates + p->activates == 0) {
+            continue;
+        }
+        fprintf(out, "product pid[%zu] inserts[%" PRIu64 "] insert_vol[%" PRIu64 "] "
+                "cancels[%" PRIu64 "] matches[%" PRIu64 "] match_vol[%" PRIu64 "] notional[",
+                i, p->inserts, p->insert_volume, p->cancels, p->matches, p->match_volume);
+        print_u128(out, p->notional);
+        fprintf(out, "] deactivates[%" PRIu64 "] activates[%" PRIu64 "]\n",
+                p->deactivates, p->activates);
+    }
+}
+
+/* ---- Scan units ---- */
+
+/*
+ * A unit is a byte range of one file. A record belongs to the unit holding
+ * its header; unit boundaries are record offsets found by
+ * om_wal_replay_seek_offset, so consecutive units cover every record once.
+ */
+typedef struct ScanUnit {
+    const char *path;
+    uint64_t start;
+    uint64_t end;               /* UINT64_MAX = to end of file */
+    FILE *out;                  /* rendered records; parallel: temp file until written out */
+    FILE *err;                  /* parallel: diagnostics, created on first use */
+    Summary sum;                /* -S: this unit's records, merged in unit order */
+    SeqStats seq;
+    uint64_t rendered;
+    bool failed;                /* open or read error */
+    bool crc_stop;              /* strict CRC hit a bad record */
+    bool done;
+} ScanUnit;
+
+typedef enum ScanPass {
+    PASS_COLLECT_ORGS,          /* -o: collect order ids of the orgs */
+    PASS_RECORDS
+} ScanPass;
+
+typedef struct Reader {
+    Filter filter;
+    bool format_ts;
+    bool strict_crc;
+    bool no_crc;
+    bool summary;
+    bool parallel;              /* -j > 1 */
+    OmBusStream *stream;        /* sequential mode only */
+    uint64_t replayed;
+    ScanPass pass;
+    ScanUnit *units;
+    size_t n_units;
+    size_t next_unit;           /* claimed with __atomic_fetch_add */
+    size_t stop_unit;           /* lowest unit with a strict CRC stop (atomic) */
+    size_t ahead;               /* units a claim may run past merged */
+    FILE *output;               /* where finished units are written */
+    /* Finished units are written out (and, with -S, folded into total) in
+     * unit order */
+    pthread_mutex_t merge_lock;
+    pthread_cond_t merge_cond;  /* merged advanced */
+    size_t merged;              /* units written out so far */
+    bool stopped;               /* a written unit hit a strict CRC stop */
+    bool merge_oom;
+    Summary total;
+} Reader;
+
+/* Per-thread accumulators, merged once all units are done */
+typedef struct ScanWorker {
+    Reader *reader;
+    OrderSet orders;
+    bool oom;
+} ScanWorker;
+
+static void render_record(FILE *out, uint64_t sequence, OmWalType type, const void *data,
+                          size_t data_len, bool format_ts) {
+    fprintf(out, "seq[%" PRIu64 "] type[%s] len[%zu] ",
+            sequence, wal_type_name(type), data_len);
+
+    /* memcpy to local to avoid unaligned access (UBSan) */
+    switch (type) {
+        case OM_WAL_INSERT:
+            if (data_len >= sizeof(OmWalInsert)) {
+                OmWalInsert rec_i;
+                memcpy(&rec_i, data, sizeof(rec_i));
+                print_insert(out, &rec_i, format_ts);
+            }
+            break;
+        case OM_WAL_CANCEL:
+            if (data_len == sizeof(OmWalCancel)) {
+                OmWalCancel rec_c;
+                memcpy(&rec_c, data, sizeof(rec_c));
+                print_cancel(out, &rec_c, format_ts);
+            }
+            break;
+        case OM_WAL_MATCH:
+            if (data_len == sizeof(OmWalMatch)) {
+                OmWalMatch rec_m;
+                memcpy(&rec_m, data, sizeof(rec_m));
+                print_match(out, &rec_m, format_ts);
+            }
+            break;
+        case OM_WAL_DEACTIVATE:
+            if (data_len == sizeof(OmWalDeactivate)) {
+                OmWalDeactivate rec_d;
+                memcpy(&rec_d, data, sizeof(rec_d));
+                print_deactivate(out, &rec_d, format_ts);
+            }
+            break;
+        case OM_WAL_ACTIVATE:
+            if (data_len == sizeof(OmWalActivate)) {
+                OmWalActivate rec_a;
+                memcpy(&rec_a, data, sizeof(rec_a));
+                print_activate(out, &rec_a, format_ts);
+            }
+            break;
+        default:
+            if (type >= OM_WAL_USER_BASE) {
+                fprintf(out, "user[%zu]", data_len);
+            }
+            break;
+    }
+    fprintf(out, "\n");
+}
+
+/* Diagnostics of a unit. Sequential scans write to stderr; parallel ones
+ * buffer per unit so they come out in unit order, as with -j 1. */
+static FILE *unit_err(const Reader *r, ScanUnit *u) {
+    if (!r->parallel) {
+        return stderr;
+    }
+    if (!u->err) {
+        u->err = tmpfile();
+    }
+    return u->err ? u->err : stderr;
+}
+
+static void copy_stream(FILE *src, FILE *dst) {
+    char buf[65536];
+    size_t n;
+    rewind(src);
+    while ((n = fread(buf, 1, sizeof(buf), src)) > 0) {
+        fwrite(buf, 1, n, dst);
+    }
+}
+
+/* Print (show) or drop a unit's buffered diagnostics */
+static void unit_err_flush(ScanUnit *u, bool show) {
+    if (!u->err) {
+        return;
+    }
+    if (show) {
+        copy_stream(u->err, stderr);
+    }
+    fclose(u->err);
+    u->err = NULL;
+}
+
+static void report_crc_mismatch(FILE *err, const char *wal_path, const OmWalReplay *replay,
+                                uint64_t sequence, OmWalType type, size_t data_len) {
+    fprintf(err,
+        "CRC MISMATCH in %s at seq %" PRIu64 "\n"
+        "  file offset:  %" PRIu64 " (0x%" PRIx64 ")\n"
+        "  stored CRC:   0x%08" PRIx32 " (bad)\n"
+        "  computed CRC: 0x%08" PRIx32 " (good)\n"
+        "  record type:  %s  len: %zu\n"
+        "\n"
+        "To repair, patch 4 bytes at offset %" PRIu64 " + 8 + %zu = %" PRIu64
+        " (0x%" PRIx64 ") with the good CRC value.\n",
+        wal_path, sequence,
+        replay->last_record_offset, replay->last_record_offset,
+        replay->last_stored_crc,
+        replay->last_computed_crc,
+        wal_type_name(type), data_len,
+        replay->last_record_offset,
+        data_len,
+        replay->last_record_offset + 8 + data_len,
+        replay->last_record_offset + 8 + data_len);
+}
+
+static int reader_replay_open(const Reader *r, OmWalReplay *replay, const char *path) {
+    int rc = om_wal_replay_init(replay, path);
+    if (rc == 0 && r->no_crc) {
+        replay->enable_crc32 = false;
+    }
+    return rc;
+}
+
+static void scan_unit(ScanWorker *w, ScanUnit *u, FILE *out) {
+    Reader *r = w->reader;
+    OmWalReplay replay;
+    if (reader_replay_open(r, &replay, u->path) != 0) {
+        if (r->pass == PASS_RECORDS) {
+            fprintf(unit_err(r, u), "failed to open wal: %s\n", u->path);
+        }
+        u->failed = true;
+        return;
+    }
+    if (u->start > 0) {
+        int rc = om_wal_replay_seek_offset(&replay, u->start, NULL, NULL);
+        if (rc < 0) {
+            fprintf(unit_err(r, u), "error seeking wal %s to offset %" PRIu64 " (ret=%d)\n",
+                    u->path, u->start, rc);
+            u->failed = true;
+            om_wal_replay_close(&replay);
+            return;
+        }
+    }
+
+    OmWalType type;
+    void *data;
+    uint64_t sequence;
+    size_t data_len;
+    RecordInfo info;
+
+    while (1) {
+        int ret = om_wal_replay_next(&replay, &type, &data, &sequence, &data_len);
+        if (ret == 0 || replay.last_record_offset >= u->end) {
+            break;
+        }
+        if (ret == OM_ERR_WAL_CRC_MISMATCH) {
+            if (r->pass != PASS_RECORDS) {
+                continue;
+            }
+            report_crc_mismatch(unit_err(r, u), u->path, &replay, sequence, type, data_len);
+            u->seq.crc_errors++;
+            if (r->strict_crc) {
+                u->crc_stop = true;
+                size_t idx = (size_t)(u - r->units);
+                size_t stop = __atomic_load_n(&r->stop_unit, __ATOMIC_RELAXED);
+                while (idx < stop &&
+                       !__atomic_compare_exchange_n(&r->stop_unit, &stop, idx, true,
+                                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                }
+                break;
+            }
+            /* Without -c, warn but continue reading */
+            continue;
+        }
+        if (ret < 0) {
+            fprintf(unit_err(r, u), "error reading wal %s (ret=%d)\n", u->path, ret);
+            u->failed = true;
+            break;
+        }
+
+        decode_record(type, data, data_len, &info);
+
+        if (r->pass == PASS_COLLECT_ORGS) {
+            if (type == OM_WAL_INSERT && info.engine &&
+                filter_has_u16(r->filter.org, r->filter.n_org, info.org) &&
+                !order_set_add(&w->orders, info.order_id)) {
+                w->oom = true;
+                break;
+            }
+            continue;
+        }
+
+        if (u->seq.scanned == 0) {
+            u->seq.first_seq = sequence;
+        } else if (sequence != u->seq.last_seq + 1) {
+            u->seq.gaps++;
+        }
+        u->seq.last_seq = sequence;
+        u->seq.scanned++;
+
+        if (!record_matches(&r->filter, sequence, type, data, data_len, &info)) {
+            continue;
+        }
+
+        u->rendered++;
+
+        if (r->summary) {
+            if (!summary_add(&u->sum, type, data_len, &info)) {
+                w->oom = true;
+                break;
+            }
+        } else {
+            render_record(out, sequence, type, data, data_len, r->format_ts);
+        }
+
+        /* Replay to SHM bus */
+        if (r->stream) {
+            if (data_len > UINT16_MAX) {
+                fprintf(stderr, "publish skipped seq=%" PRIu64 " (payload too large: %zu)\n",
+                        sequence, data_len);
+                continue;
+            }
+            int rc = om_bus_stream_publish(r->stream, sequence, type,
+                                           data, (uint16_t)data_len);
+            if (rc != 0) {
+                fprintf(stderr, "publish failed seq=%" PRIu64 " (rc=%d)\n",
+                        sequence, rc);
+            } else {
+                r->replayed++;
+            }
+        }
+    }
+
+    om_wal_replay_close(&replay);
+}
+
+/*
+ * Mark u done and write out every finished unit in unit order: diagnostics,
+ * then rendered records (-S: fold the summary into the total). Units after
+ * the first strict CRC stop are dropped, since -j 1 never reads them.
+ * Writing units as they finish keeps only the out-of-order ones buffered.
+ */
+static void unit_done(Reader *r, ScanUnit *u) {
+    pthread_mutex_lock(&r->merge_lock);
+    u->done = true;
+    while (r->merged < r->n_units && r->units[r->merged].done) {
+        ScanUnit *m = &r->units[r->merged++];
+        unit_err_flush(m, !r->stopped);
+        if (m->out && m->out != r->output) {
+            if (!r->stopped) {
+                copy_stream(m->out, r->output);
+            }
+            fclose(m->out);
+            m->out = NULL;
+        }
+        if (r->summary && !r->stopped && !summary_merge(&r->total, &m->sum)) {
+            r->merge_oom = true;
+        }
+        if (m->crc_stop) {
+            r->stopped = true;
+        }
+        free(m->sum.products);
+        memset(&m->sum, 0, sizeof(m->sum));
+    }
+    pthread_cond_broadcast(&r->merge_cond);
+    pthread_mutex_unlock(&r->merge_lock);
+}
+
+/* Wait until unit i is within the window past merged; false once a strict
+ * CRC stop before it means it will not be read */
+static bool unit_wait_turn(Reader *r, size_t i) {
+    pthread_mutex_lock(&r->merge_lock);
+    while (i >= r->merged + r->ahead && i <= __atomic_load_n(&r->stop_unit, __ATOMIC_RELAXED)) {
+        pthread_cond_wait(&r->merge_cond, &r->merge_lock);
+    }
+    pthread_mutex_unlock(&r->merge_lock);
+    return i <= __atomic_load_n(&r->stop_unit, __ATOMIC_RELAXED);
+}
+
+static void *scan_worker_main(void *arg) {
+    ScanWorker *w = arg;
+    Reader *r = w->reader;
+    while (!w->oom) {
+        size_t i = __atomic_fetch_add(&r->next_unit, 1, __ATOMIC_RELAXED);
+        /* Units are claimed in order: nothing after a strict CRC stop counts */
+        if (i >= r->n_units || i > __atomic_load_n(&r->stop_unit, __ATOMIC_RELAXED)) {
+            break;
+        }
+        ScanUnit *u = &r->units[i];
+        if (r->pass != PASS_RECORDS) {
+            scan_unit(w, u, u->out);
+            continue;
+        }
+        if (!unit_wait_turn(r, i)) {
+            break;
+        }
+        if (!u->out && !(u->out = tmpfile())) {
+            fprintf(unit_err(r, u), "failed to create temp file: %s\n", strerror(errno));
+            u->failed = true;
+        } else {
+            scan_unit(w, u, u->out);
+        }
+        unit_done(r, u);
+    }
+    return NULL;
+}
+
+/*
+ * Split every file into units of about `target` bytes. Boundaries are
+ * resynced to record headers here, once, so workers never disagree on them.
+ */
+static int build_units(Reader *r, char **paths, int n_files, int jobs) {
+    uint64_t *sizes = calloc((size_t)n_files, sizeof(*sizes));
+    if (!sizes) {
+        return -1;
+    }
+    uint64_t total = 0;
+    for (int fi = 0; fi < n_files; fi++) {
+        struct stat st;
+        if (jobs > 1 && stat(paths[fi], &st) == 0) {
+            sizes[fi] = (uint64_t)st.st_size;
+        }
+        total += sizes[fi];
+    }
+    uint64_t target = total / ((uint64_t)jobs * UNITS_PER_JOB);
+    if (target < UNIT_MIN_BYTES) {
+        target = UNIT_MIN_BYTES;
+    }
+
+    size_t cap = 0;
+    for (int fi = 0; fi < n_files; fi++) {
+        cap += (size_t)((sizes[fi] + target - 1) / target) + 1;
+    }
+    r->units = calloc(cap, sizeof(*r->units));
+    if (!r->units) {
+        free(sizes);
+        return -1;
+    }
+
+    r->n_units = 0;
+    for (int fi = 0; fi < n_files; fi++) {
+        ScanUnit *first = &r->units[r->n_units++];
+        first->path = paths[fi];
+        first->start = 0;
+        first->end = UINT64_MAX;
+        if (sizes[fi] <= target) {
+            continue;
+        }
+
+        OmWalReplay replay;
+        if (reader_replay_open(r, &replay, paths[fi]) != 0) {
+            continue;   /* the worker reports the open failure */
+        }
+        ScanUnit *prev = first;
+        for (uint64_t off = target; off < sizes[fi]; off += target) {
+            uint64_t rec_off = 0;
+            int rc = om_wal_replay_seek_offset(&replay, off & ~(uint64_t)4095, &rec_off, NULL);
+            if (rc <= 0) {
+                break;  /* no record after off: prev runs to the end */
+            }
+            if (rec_off <= prev->start) {
+                continue;
+            }
+            ScanUnit *u = &r->units[r->n_units++];
+            u->path = paths[fi];
+            u->start = rec_off;
+            u->end = UINT64_MAX;
+            prev->end = rec_off;
+            prev = u;
+        }
+        om_wal_replay_close(&replay);
+    }
+    free(sizes);
+    return 0;
+}
+
+/* Run one pass over every unit; returns false if a worker ran out of memory */
+static bool run_pass(Reader *r, ScanPass pass, ScanWorker *workers, int jobs) {
+    r->pass = pass;
+    r->next_unit = 0;
+    r->stop_unit = SIZE_MAX;
+    r->merged = 0;
+    r->stopped = false;
+    for (size_t i = 0; i < r->n_units; i++) {
+        ScanUnit *u = &r->units[i];
+        memset(&u->seq, 0, sizeof(u->seq));
+        u->rendered = 0;
+        u->failed = false;
+        u->crc_stop = false;
+        u->done = false;
+    }
+
+    if (jobs == 1) {
+        /* Sequential: render straight to out, stop at the first strict CRC error */
+        for (size_t i = 0; i < r->n_units && !workers[0].oom; i++) {
+            ScanUnit *u = &r->units[i];
+            scan_unit(&workers[0], u, u->out);
+            if (pass == PASS_RECORDS) {
+                unit_done(r, u);
+            }
+            if (u->crc_stop) {
+                break;
+            }
+        }
+        return !workers[0].oom && !r->merge_oom;
+    }
+
+    pthread_t threads[MAX_JOBS];
+    int started = 0;
+    for (int t = 0; t < jobs; t++) {
+        if (pthread_create(&threads[t], NULL, scan_worker_main, &workers[t]) != 0) {
+            break;
+        }
+        started++;
+    }
+    if (started == 0) {
+        scan_worker_main(&workers[0]);
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    bool ok = !r->merge_oom;
+    for (int t = 0; t < jobs; t++) {
+        ok = ok && !workers[t].oom;
+    }
+    return ok;
+}
+
 static void usage(const char *prog) {
     fprintf(stderr,
         "usage: %s [options] <wal_file> [wal_file ...]\n"
@@ -300,62 +1105,119 @@ static void usage(const char *prog) {
         "  -t                Format timestamps as human-readable\n"
         "  -c                Strict CRC: stop on first corruption\n"
         "                    (without -c, CRC errors are warned but skipped)\n"
+        "  -C                WAL written without CRC32\n"
         "  -s from-to        Sequence range filter (inclusive, repeatable)\n"
         "  -r from-to        Time range filter (inclusive, repeatable)\n"
         "                    Format: YYYYMMDDHHMMSS-YYYYMMDDHHMMSS\n"
+        "  -P product_id     Product filter (repeatable)\n"
+        "  -o org            Org filter: the org's INSERTs and every record\n"
+        "                    on those orders (repeatable)\n"
+        "  -O order_id       Order filter, maker or taker for MATCH (repeatable)\n"
+        "  -S                Print a summary instead of records\n"
+        "  -j jobs           Scan with N threads (0 = online CPUs, default 1)\n"
         "  -p stream_name    Replay matching records to SHM bus stream\n"
         "\n"
         "Multiple WAL files are processed in order. Shell glob works:\n"
         "  %s -s 1-100 /tmp/wal_*.log\n"
         "\n"
         "Multiple -s and -r filters form OR logic: a record is included\n"
-        "if it falls within ANY specified range.\n"
+        "if it falls within ANY specified range. -P, -o and -O narrow\n"
+        "that further (OR within each option, AND across options).\n"
+        "\n"
+        "With -j, files and byte ranges of large files are scanned\n"
+        "concurrently; records, totals and diagnostics still come out\n"
+        "in log order.\n"
         "\n"
         "With -p, output goes to stderr and records are published to\n"
         "the named SHM bus stream for downstream consumers.\n",
         prog, prog);
 }
 
+static bool parse_u64_arg(const char *arg, uint64_t max, uint64_t *out) {
+    return parse_u64_token(arg, strlen(arg), out) && *out <= max;
+}
+
 int main(int argc, char **argv) {
-    bool format_ts = false;
-    bool strict_crc = false;
+    static Reader reader;
+    Reader *r = &reader;
     const char *stream_name = NULL;
-
-    SeqRange seq_ranges[MAX_RANGES];
-    TimeRange time_ranges[MAX_RANGES];
-    int n_seq = 0;
-    int n_time = 0;
+    int jobs = 1;
 
     int opt;
-    while ((opt = getopt(argc, argv, "tcs:r:p:")) != -1) {
+    uint64_t v;
+    while ((opt = getopt(argc, argv, "tcCs:r:P:o:O:Sj:p:")) != -1) {
         switch (opt) {
             case 't':
-                format_ts = true;
+                r->format_ts = true;
                 break;
             case 'c':
-                strict_crc = true;
+                r->strict_crc = true;
+                break;
+            case 'C':
+                r->no_crc = true;
                 break;
             case 's':
-                if (n_seq >= MAX_RANGES) {
+                if (r->filter.n_seq >= MAX_RANGES) {
                     fprintf(stderr, "too many -s ranges (max %d)\n", MAX_RANGES);
                     return 2;
                 }
-                if (!parse_seq_range(optarg, &seq_ranges[n_seq])) {
+                if (!parse_seq_range(optarg, &r->filter.seq[r->filter.n_seq])) {
                     fprintf(stderr, "invalid sequence range: %s\n", optarg);
                     return 2;
                 }
-                n_seq++;
+                r->filter.n_seq++;
                 break;
             case 'r':
-                if (n_time >= MAX_RANGES) {
+                if (r->filter.n_time >= MAX_RANGES) {
                     fprintf(stderr, "too many -r ranges (max %d)\n", MAX_RANGES);
                     return 2;
                 }
-                if (!parse_time_range(optarg, &time_ranges[n_time])) {
+                if (!parse_time_range(optarg, &r->filter.time[r->filter.n_time])) {
                     fprintf(stderr, "invalid time range: %s (expected YYYYMMDDHHMMSS-YYYYMMDDHHMMSS)\n", optarg);
                     return 2;
                 }
-                n_time++;
+                r->filter.n_time++;
+                break;
+            case 'P':
+            case 'o':
+                if ((opt == 'P' ? r->filter.n_product : r->filter.n_org) >= MAX_RANGES) {
+                    fprintf(stderr, "too many -%c filters (max %d)\n", opt, MAX_RANGES);
+                    return 2;
+                }
+                if (!parse_u64_arg(optarg, UINT16_MAX, &v)) {
+                    fprintf(stderr, "invalid %s: %s\n", opt == 'P' ? "product id" : "org", optarg);
+                    return 2;
+                }
+                if (opt == 'P') {
+                    r->filter.product[r->filter.n_product++] = (uint16_t)v;
+                } else {
+                    r->filter.org[r->filter.n_org++] = (uint16_t)v;
+                }
+                break;
+            case 'O':
+                if (r->filter.n_order >= MAX_RANGES) {
+                    fprintf(stderr, "too many -O filters (max %d)\n", MAX_RANGES);
+                    return 2;
+                }
+                if (!parse_u64_arg(optarg, UINT64_MAX, &v)) {
+                    fprintf(stderr, "invalid order id: %s\n", optarg);
+                    return 2;
+                }
+                r->filter.order[r->filter.n_order++] = v;
+                break;
+            case 'S':
+                r->summary = true;
+                break;
+            case 'j':
+                if (!parse_u64_arg(optarg, MAX_JOBS, &v)) {
+                    fprintf(stderr, "invalid job count: %s (max %d)\n", optarg, MAX_JOBS);
+                    return 2;
+                }
+                jobs = (int)v;
+                if (jobs == 0) {
+                    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+                    jobs = cpus < 1 ? 1 : (cpus > MAX_JOBS ? MAX_JOBS : (int)cpus);
+                }
                 break;
             case 'p':
                 stream_name = optarg;
@@ -370,6 +1232,10 @@ int main(int argc, char **argv) {
         usage(argv[0]);
         return 2;
     }
+    if (stream_name && jobs > 1) {
+        fprintf(stderr, "-p publishes in log order and cannot be combined with -j\n");
+        return 2;
+    }
 
     int n_files = argc - optind;
 
@@ -377,7 +1243,6 @@ int main(int argc, char **argv) {
     FILE *out = stream_name ? stderr : stdout;
 
     /* Create SHM bus stream if replay requested */
-    OmBusStream *stream = NULL;
     if (stream_name) {
         OmBusStreamConfig cfg = {
             .stream_name = stream_name,
@@ -385,7 +1250,7 @@ int main(int argc, char **argv) {
             .slot_size = OM_BUS_DEFAULT_SLOT_SIZE,
             .max_consumers = OM_BUS_DEFAULT_MAX_CONSUMERS,
         };
-        int rc = om_bus_stream_create(&stream, &cfg);
+        int rc = om_bus_stream_create(&r->stream, &cfg);
         if (rc != 0) {
             fprintf(stderr, "failed to create bus stream '%s' (rc=%d)\n",
                     stream_name, rc);
@@ -394,149 +1259,105 @@ int main(int argc, char **argv) {
         fprintf(stderr, "replaying to SHM stream '%s'\n", stream_name);
     }
 
-    OmWalType type;
-    void *data;
-    uint64_t sequence;
-    size_t data_len;
-    uint64_t rendered = 0;
-    uint64_t replayed = 0;
     int exit_code = 0;
-    bool strict_stop = false;
-
-    for (int fi = 0; fi < n_files; fi++) {
-        const char *wal_path = argv[optind + fi];
+    ScanWorker *workers = calloc((size_t)jobs, sizeof(*workers));
+    if (!workers || build_units(r, argv + optind, n_files, jobs) != 0) {
+        fprintf(stderr, "out of memory\n");
+        exit_code = 1;
+        goto done;
+    }
+    for (int t = 0; t < jobs; t++) {
+        workers[t].reader = r;
+    }
+    r->parallel = jobs > 1;
+    r->ahead = (size_t)jobs * UNITS_AHEAD_PER_JOB;
+    r->output = out;
+    pthread_mutex_init(&r->merge_lock, NULL);
+    pthread_cond_init(&r->merge_cond, NULL);
 
-        OmWalReplay replay;
-        int init_rc = om_wal_replay_init(&replay, wal_path);
-        if (init_rc != 0) {
-            fprintf(stderr, "failed to open wal: %s\n", wal_path);
+    /* -o: order ids come from the org's INSERTs, anywhere in the log */
+    if (r->filter.n_org > 0) {
+        bool ok = run_pass(r, PASS_COLLECT_ORGS, workers, jobs);
+        for (size_t i = 0; i < r->n_units; i++) {
+            unit_err_flush(&r->units[i], true);
+        }
+        for (int t = 0; t < jobs && ok; t++) {
+            ok = order_set_merge(&r->filter.org_orders, &workers[t].orders);
+            order_set_free(&workers[t].orders);
+        }
+        if (!ok) {
+            fprintf(stderr, "out of memory collecting org orders\n");
             exit_code = 1;
-            continue;
+            goto done;
         }
+    }
 
-        while (1) {
-            int ret = om_wal_replay_next(&replay, &type, &data, &sequence, &data_len);
-            if (ret == 0) {
-                break;
-            }
-            if (ret == OM_ERR_WAL_CRC_MISMATCH) {
-                fprintf(stderr,
-                    "CRC MISMATCH in %s at seq %" PRIu64 "\n"
-                    "  file offset:  %" PRIu64 " (0x%" PRIx64 ")\n"
-                    "  stored CRC:   0x%08" PRIx32 " (bad)\n"
-                    "  computed CRC: 0x%08" PRIx32 " (good)\n"
-                    "  record type:  %s  len: %zu\n"
-                    "\n"
-                    "To repair, patch 4 bytes at offset %" PRIu64 " + 8 + %zu = %" PRIu64
-                    " (0x%" PRIx64 ") with the good CRC value.\n",
-                    wal_path, sequence,
-                    replay.last_record_offset, replay.last_record_offset,
-                    replay.last_stored_crc,
-                    replay.last_computed_crc,
-                    wal_type_name(type), data_len,
-                    replay.last_record_offset,
-                    data_len,
-                    replay.last_record_offset + 8 + data_len,
-                    replay.last_record_offset + 8 + data_len);
-                exit_code = 1;
-                if (strict_crc) {
-                    strict_stop = true;
-                    break;
-                }
-                /* Without -c, warn but continue reading */
-                continue;
-            }
-            if (ret < 0) {
-                fprintf(stderr, "error reading wal %s (ret=%d)\n", wal_path, ret);
-                exit_code = 1;
-                break;
-            }
+    /* Parallel rendering goes to a temp file per unit in flight, written
+     * out in unit order as the units before it finish */
+    for (size_t i = 0; i < r->n_units; i++) {
+        if (jobs == 1 || r->summary) {
+            r->units[i].out = out;
+        }
+    }
 
-            if (!record_matches(sequence, type, data, data_len,
-                                seq_ranges, n_seq, time_ranges, n_time)) {
-                continue;
-            }
+    if (!run_pass(r, PASS_RECORDS, workers, jobs)) {
+        fprintf(stderr, "out of memory\n");
+        exit_code = 1;
+        goto done;
+    }
 
-            rendered++;
-
-            /* Render record */
-            fprintf(out, "seq[%" PRIu64 "] type[%s] len[%zu] ",
-                    sequence, wal_type_name(type), data_len);
-
-            /* memcpy to local to avoid unaligned access (UBSan) */
-            switch (type) {
-                case OM_WAL_INSERT:
-                    if (data_len >= sizeof(OmWalInsert)) {
-                        OmWalInsert rec_i;
-                        memcpy(&rec_i, data, sizeof(rec_i));
-                        print_insert(out, &rec_i, format_ts);
-                    }
-                    break;
-                case OM_WAL_CANCEL:
-                    if (data_len == sizeof(OmWalCancel)) {
-                        OmWalCancel rec_c;
-                        memcpy(&rec_c, data, sizeof(rec_c));
-                        print_cancel(out, &rec_c, format_ts);
-                    }
-                    break;
-                case OM_WAL_MATCH:
-                    if (data_len == sizeof(OmWalMatch)) {
-                        OmWalMatch rec_m;
-                        memcpy(&rec_m, data, sizeof(rec_m));
-                        print_match(out, &rec_m, format_ts);
-                    }
-                    break;
-                case OM_WAL_DEACTIVATE:
-                    if (data_len == sizeof(OmWalDeactivate)) {
-                        OmWalDeactivate rec_d;
-                        memcpy(&rec_d, data, sizeof(rec_d));
-                        print_deactivate(out, &rec_d, format_ts);
-                    }
-                    break;
-                case OM_WAL_ACTIVATE:
-                    if (data_len == sizeof(OmWalActivate)) {
-                        OmWalActivate rec_a;
-                        memcpy(&rec_a, data, sizeof(rec_a));
-                        print_activate(out, &rec_a, format_ts);
-                    }
-                    break;
-                default:
-                    if (type >= OM_WAL_USER_BASE) {
-                        fprintf(out, "user[%zu]", data_len);
-                    }
-                    break;
-            }
-            fprintf(out, "\n");
-
-            /* Replay to SHM bus */
-            if (stream) {
-                if (data_len > UINT16_MAX) {
-                    fprintf(stderr, "publish skipped seq=%" PRIu64 " (payload too large: %zu)\n",
-                            sequence, data_len);
-                    continue;
-                }
-                int rc = om_bus_stream_publish(stream, sequence, type,
-                                               data, (uint16_t)data_len);
-                if (rc != 0) {
-                    fprintf(stderr, "publish failed seq=%" PRIu64 " (rc=%d)\n",
-                            sequence, rc);
-                } else {
-                    replayed++;
-                }
+    uint64_t rendered = 0;
+    SeqStats seq = {0};
+    for (size_t i = 0; i < r->n_units; i++) {
+        ScanUnit *u = &r->units[i];
+        rendered += u->rendered;
+        if (u->failed || u->seq.crc_errors > 0) {
+            exit_code = 1;
+        }
+        seq.crc_errors += u->seq.crc_errors;
+        if (u->seq.scanned > 0) {
+            if (seq.scanned == 0) {
+                seq.first_seq = u->seq.first_seq;
+            } else if (u->seq.first_seq != seq.last_seq + 1) {
+                seq.gaps++;
             }
+            seq.last_seq = u->seq.last_seq;
+            seq.scanned += u->seq.scanned;
+            seq.gaps += u->seq.gaps;
         }
-
-        om_wal_replay_close(&replay);
-        if (strict_stop) {
+        if (u->crc_stop) {
             break;
         }
     }
 
-    if (stream) {
+    if (r->summary) {
+        print_summary(out, &r->total, &seq, n_files);
+    }
+
+    if (r->stream) {
         fprintf(stderr, "replay done: %" PRIu64 " rendered, %" PRIu64 " published to '%s'\n",
-                rendered, replayed, stream_name);
-        om_bus_stream_destroy(stream);
+                rendered, r->replayed, stream_name);
     }
 
+done:
+    if (r->stream) {
+        om_bus_stream_destroy(r->stream);
+    }
+    for (size_t i = 0; i < r->n_units; i++) {
+        if (r->units[i].out && r->units[i].out != out) {
+            fclose(r->units[i].out);
+        }
+        unit_err_flush(&r->units[i], false);
+        free(r->units[i].sum.products);
+    }
+    free(r->units);
+    free(r->total.products);
+    if (workers) {
+        for (int t = 0; t < jobs; t++) {
+            order_set_free(&workers[t].orders);
+        }
+    }
+    free(workers);
+    order_set_free(&r->filter.org_orders);
     return exit_code;
 }